@@ -0,0 +1,168 @@
+/**
+ * @file v4_event.cpp
+ * @brief Dispatch of interrupt events to V4 handler words
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include "v4_event.hpp"
+
+namespace v4ports
+{
+
+EventDispatcher::EventDispatcher(Vm* vm, Clock clock)
+    : vm_(vm), clock_(clock), stats_since_(clock())
+{
+}
+
+int EventDispatcher::attach(EventRing& ring)
+{
+  if (ring_count_ >= EVENT_RINGS_MAX)
+  {
+    return EVENT_ERR_FULL;
+  }
+  dropped_base_[ring_count_] = ring.dropped();
+  rings_[ring_count_++] = &ring;
+  return 0;
+}
+
+int EventDispatcher::bind(uint16_t source, int wid)
+{
+  if (source >= EVENT_SOURCES_MAX)
+  {
+    return EVENT_ERR_SOURCE;
+  }
+  Word* word = (wid >= 0) ? vm_get_word(vm_, wid) : nullptr;
+  if (word == nullptr)
+  {
+    return EVENT_ERR_WORD;
+  }
+  handlers_[source] = word;
+  return 0;
+}
+
+void EventDispatcher::unbind(uint16_t source)
+{
+  if (source < EVENT_SOURCES_MAX)
+  {
+    handlers_[source] = nullptr;
+  }
+}
+
+// Ring whose next event was posted first (stamps compared with wrap-around)
+EventRing* EventDispatcher::oldest() const
+{
+  EventRing* best = nullptr;
+  uint32_t best_stamp = 0;
+  for (size_t i = 0; i < ring_count_; i++)
+  {
+    const Event* ev = rings_[i]->front();
+    if (ev != nullptr &&
+        (best == nullptr || static_cast<int32_t>(ev->stamp_us - best_stamp) < 0))
+    {
+      best = rings_[i];
+      best_stamp = ev->stamp_us;
+    }
+  }
+  return best;
+}
+
+void EventDispatcher::record_latency(uint32_t latency_us)
+{
+  stats_.latency_sum_us += latency_us;
+  if (latency_us > stats_.latency_max_us)
+  {
+    stats_.latency_max_us = latency_us;
+  }
+  size_t bucket = 0;
+  while (bucket < EVENT_LATENCY_BUCKETS - 1 && (latency_us >> bucket) != 0)
+  {
+    bucket++;
+  }
+  stats_.latency_hist[bucket]++;
+}
+
+size_t EventDispatcher::dispatch(size_t max_events, uint32_t budget_us)
+{
+  uint64_t start = clock_();
+  size_t taken = 0;
+  while (max_events == 0 || taken < max_events)
+  {
+    if (budget_us != 0 && taken > 0 && clock_() - start >= budget_us)
+    {
+      break;
+    }
+    EventRing* ring = oldest();
+    Event ev;
+    if (ring == nullptr || !ring->pop(ev))
+    {
+      return taken;
+    }
+    taken++;
+
+    Word* handler = (ev.source < EVENT_SOURCES_MAX) ? handlers_[ev.source] : nullptr;
+    if (handler == nullptr)
+    {
+      stats_.unhandled++;
+      continue;
+    }
+
+    record_latency(static_cast<uint32_t>(clock_()) - ev.stamp_us);
+    stats_.dispatched++;
+    v4_err err = vm_ds_push(vm_, ev.value);
+    if (err == 0)
+    {
+      err = vm_exec(vm_, handler);
+    }
+    if (err != 0)
+    {
+      stats_.faults++;
+      stats_.last_error = err;
+    }
+  }
+
+  if (pending())
+  {
+    stats_.budget_stops++;
+  }
+  return taken;
+}
+
+bool EventDispatcher::pending() const
+{
+  for (size_t i = 0; i < ring_count_; i++)
+  {
+    if (rings_[i]->front() != nullptr)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+EventStats EventDispatcher::stats() const
+{
+  EventStats s = stats_;
+  for (size_t i = 0; i < ring_count_; i++)
+  {
+    s.dropped += rings_[i]->dropped() - dropped_base_[i];
+    if (rings_[i]->high_water() > s.high_water)
+    {
+      s.high_water = rings_[i]->high_water();
+    }
+  }
+  return s;
+}
+
+void EventDispatcher::reset_stats()
+{
+  stats_ = {};
+  for (size_t i = 0; i < ring_count_; i++)
+  {
+    dropped_base_[i] = rings_[i]->dropped();
+  }
+  stats_since_ = clock_();
+}
+
+}  // namespace v4ports
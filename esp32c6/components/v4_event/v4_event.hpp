@@ -0,0 +1,174 @@
+/**
+ * @file v4_event.hpp
+ * @brief Dispatch of interrupt events to V4 handler words
+ *
+ * Instead of polling GPIO levels in a loop, a program binds a handler
+ * word to an event source and the VM task calls dispatch() whenever it is
+ * woken (or between other work). Interrupt handlers post events into
+ * EventRings; dispatch() takes them oldest first across all attached
+ * rings and runs the word bound to each event's source with the event
+ * value on the data stack:
+ *
+ *   : on-button ( level -- ) 0= if led-toggle then ;
+ *
+ * Latency is bounded by the caller: dispatch() stops after a number of
+ * events or a time budget, whichever comes first, and leaves the rest
+ * queued. A handler runs to completion (V4 cannot preempt a word), so
+ * handlers should be short. The time from the producer's stamp to the
+ * start of the handler is recorded per event as ISR-to-handler latency.
+ *
+ * Portable (no ESP-IDF dependencies) so it can be built and benchmarked
+ * on a Linux host as well as on the target; v4_event_isr.hpp has the
+ * ESP32-C6 GPIO and timer producers.
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "v4/vm_api.h"
+#include "v4_event_ring.hpp"
+
+namespace v4ports
+{
+
+/// Number of event sources (source ids 0 .. EVENT_SOURCES_MAX - 1)
+constexpr size_t EVENT_SOURCES_MAX = 32;
+
+/// Rings one dispatcher drains (one per producing ISR)
+constexpr size_t EVENT_RINGS_MAX = 4;
+
+/// Latency histogram buckets: bucket i counts latencies below 2^i us, the
+/// last one everything longer
+constexpr size_t EVENT_LATENCY_BUCKETS = 16;
+
+/// Event error codes (negative, like V4 errors)
+constexpr int EVENT_ERR_SOURCE = -180;  ///< Source id out of range
+constexpr int EVENT_ERR_FULL = -181;    ///< EVENT_RINGS_MAX rings already attached
+constexpr int EVENT_ERR_WORD = -182;    ///< No word with that id
+
+/**
+ * @brief Dispatch statistics
+ */
+struct EventStats
+{
+  uint32_t dispatched;      ///< Handlers run
+  uint32_t unhandled;       ///< Events of sources without a handler (discarded)
+  uint32_t faults;          ///< Handlers that returned a VM error
+  int last_error;           ///< Last handler VM error (0 = none)
+  uint32_t dropped;         ///< Events dropped by full rings (all rings)
+  uint32_t high_water;      ///< Deepest ring fill since start (all rings)
+  uint32_t budget_stops;    ///< dispatch() calls that left events queued
+  uint64_t latency_sum_us;  ///< Sum of ISR-to-handler latencies
+  uint32_t latency_max_us;  ///< Worst ISR-to-handler latency
+  uint32_t latency_hist[EVENT_LATENCY_BUCKETS];  ///< Latency histogram (log2 us)
+};
+
+/**
+ * @brief Runs handler words for queued events
+ *
+ * Example usage:
+ * @code
+ * static v4ports::Event slots[64];
+ * static v4ports::EventRing button_ring(slots, 64);
+ * v4ports::EventDispatcher events(vm, clock_us);
+ * events.attach(button_ring);
+ * events.bind(BUTTON, on_button_wid);
+ * while (true)
+ * {
+ *   wait_for_notification();
+ *   events.dispatch(16, 1000);
+ * }
+ * @endcode
+ *
+ * Not thread-safe: attach(), bind() and dispatch() belong to the VM task.
+ */
+class EventDispatcher
+{
+ public:
+  /// Monotonic microsecond clock (the producers stamp with its low 32 bits)
+  using Clock = uint64_t (*)();
+
+  /**
+   * @brief Construct a dispatcher without rings or handlers
+   *
+   * @param vm     VM that runs the handler words
+   * @param clock  Microsecond clock
+   */
+  EventDispatcher(Vm* vm, Clock clock);
+
+  // Non-copyable (holds references to the rings)
+  EventDispatcher(const EventDispatcher&) = delete;
+  EventDispatcher& operator=(const EventDispatcher&) = delete;
+
+  /**
+   * @brief Drain @p ring as well
+   *
+   * @return 0 or EVENT_ERR_FULL
+   */
+  int attach(EventRing& ring);
+
+  /**
+   * @brief Run word @p wid for events of @p source, with ( value -- )
+   *
+   * @return 0, EVENT_ERR_SOURCE or EVENT_ERR_WORD
+   */
+  int bind(uint16_t source, int wid);
+
+  /**
+   * @brief Stop handling @p source; its events are discarded
+   */
+  void unbind(uint16_t source);
+
+  /**
+   * @brief Run handlers for queued events, oldest first
+   *
+   * @param max_events  Most events to handle (0 = no limit)
+   * @param budget_us   Stop once this much time has passed (0 = no limit);
+   *                    checked between handlers
+   * @return Number of events taken from the rings
+   */
+  size_t dispatch(size_t max_events, uint32_t budget_us);
+
+  /**
+   * @brief Check whether any attached ring holds events
+   */
+  bool pending() const;
+
+  /**
+   * @brief Get the statistics
+   */
+  EventStats stats() const;
+
+  /**
+   * @brief Get the time covered by the statistics
+   */
+  uint64_t elapsed_us() const
+  {
+    return clock_() - stats_since_;
+  }
+
+  /**
+   * @brief Clear all statistics (ring drop counters are reported as deltas)
+   */
+  void reset_stats();
+
+ private:
+  EventRing* oldest() const;
+  void record_latency(uint32_t latency_us);
+
+  Vm* vm_;
+  Clock clock_;
+  EventRing* rings_[EVENT_RINGS_MAX] = {};
+  size_t ring_count_ = 0;
+  Word* handlers_[EVENT_SOURCES_MAX] = {};
+  EventStats stats_ = {};
+  uint32_t dropped_base_[EVENT_RINGS_MAX] = {};
+  uint64_t stats_since_;
+};
+
+}  // namespace v4ports
@@ -0,0 +1,181 @@
+/**
+ * @file v4_event_isr.cpp
+ * @brief ESP32-C6 GPIO and timer interrupts as event producers
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include "v4_event_isr.hpp"
+
+#include "driver/gptimer.h"
+#include "esp_timer.h"
+
+namespace v4ports
+{
+
+namespace
+{
+
+struct Producer
+{
+  EventRing* ring;  // nullptr = free slot
+  TaskHandle_t notify;
+  uint16_t source;
+  gpio_num_t pin;
+  int32_t ticks;
+};
+
+Producer producers[EVENT_ISR_MAX];
+bool gpio_service_installed = false;
+
+// Push from ISR context; pdTRUE if a higher-priority task was woken
+BaseType_t post(Producer* p, int32_t value)
+{
+  uint32_t now = static_cast<uint32_t>(esp_timer_get_time());
+  p->ring->push({p->source, 0, value, now});
+  BaseType_t woken = pdFALSE;
+  if (p->notify != nullptr)
+  {
+    vTaskNotifyGiveFromISR(p->notify, &woken);
+  }
+  return woken;
+}
+
+void gpio_isr(void* arg)
+{
+  Producer* p = static_cast<Producer*>(arg);
+  BaseType_t woken = post(p, gpio_get_level(p->pin));
+  portYIELD_FROM_ISR(woken);
+}
+
+bool timer_isr(gptimer_handle_t, const gptimer_alarm_event_data_t*, void* arg)
+{
+  Producer* p = static_cast<Producer*>(arg);
+  return post(p, ++p->ticks) == pdTRUE;
+}
+
+// Reserve a slot for @p ring, which must not have a producer yet
+esp_err_t new_producer(EventRing& ring, uint16_t source, TaskHandle_t notify,
+                       Producer*& out)
+{
+  Producer* free_slot = nullptr;
+  for (Producer& p : producers)
+  {
+    if (p.ring == &ring)
+    {
+      return ESP_ERR_INVALID_STATE;
+    }
+    if (p.ring == nullptr && free_slot == nullptr)
+    {
+      free_slot = &p;
+    }
+  }
+  if (free_slot == nullptr)
+  {
+    return ESP_ERR_NO_MEM;
+  }
+  *free_slot = {&ring, notify, source, GPIO_NUM_NC, 0};
+  out = free_slot;
+  return ESP_OK;
+}
+
+// Give back the slot of an attachment that failed
+void release_producer(Producer* p)
+{
+  p->ring = nullptr;
+}
+
+}  // namespace
+
+esp_err_t event_gpio_attach(EventRing& ring, gpio_num_t pin, gpio_int_type_t edge,
+                            uint16_t source, TaskHandle_t notify)
+{
+  Producer* p = nullptr;
+  esp_err_t err = new_producer(ring, source, notify, p);
+  if (err != ESP_OK)
+  {
+    return err;
+  }
+  p->pin = pin;
+
+  gpio_config_t io = {
+      .pin_bit_mask = 1ULL << pin,
+      .mode = GPIO_MODE_INPUT,
+      .pull_up_en = GPIO_PULLUP_ENABLE,
+      .pull_down_en = GPIO_PULLDOWN_DISABLE,
+      .intr_type = edge,
+  };
+  err = gpio_config(&io);
+  if (err == ESP_OK && !gpio_service_installed)
+  {
+    err = gpio_install_isr_service(0);
+    gpio_service_installed = (err == ESP_OK);
+  }
+  if (err == ESP_OK)
+  {
+    err = gpio_isr_handler_add(pin, gpio_isr, p);
+  }
+  if (err != ESP_OK)
+  {
+    release_producer(p);
+  }
+  return err;
+}
+
+esp_err_t event_timer_attach(EventRing& ring, uint32_t period_us, uint16_t source,
+                             TaskHandle_t notify)
+{
+  Producer* p = nullptr;
+  esp_err_t err = new_producer(ring, source, notify, p);
+  if (err != ESP_OK)
+  {
+    return err;
+  }
+
+  gptimer_handle_t timer = nullptr;
+  gptimer_config_t cfg = {};
+  cfg.clk_src = GPTIMER_CLK_SRC_DEFAULT;
+  cfg.direction = GPTIMER_COUNT_UP;
+  cfg.resolution_hz = 1000000;
+  err = gptimer_new_timer(&cfg, &timer);
+  if (err != ESP_OK)
+  {
+    release_producer(p);
+    return err;
+  }
+
+  gptimer_event_callbacks_t callbacks = {.on_alarm = timer_isr};
+  gptimer_alarm_config_t alarm = {};
+  alarm.alarm_count = period_us;
+  alarm.reload_count = 0;
+  alarm.flags.auto_reload_on_alarm = true;
+
+  err = gptimer_register_event_callbacks(timer, &callbacks, p);
+  if (err == ESP_OK)
+  {
+    err = gptimer_set_alarm_action(timer, &alarm);
+  }
+  bool enabled = false;
+  if (err == ESP_OK)
+  {
+    err = gptimer_enable(timer);
+    enabled = (err == ESP_OK);
+  }
+  if (err == ESP_OK)
+  {
+    err = gptimer_start(timer);
+  }
+  if (err != ESP_OK)
+  {
+    if (enabled)
+    {
+      gptimer_disable(timer);
+    }
+    gptimer_del_timer(timer);
+    release_producer(p);
+  }
+  return err;
+}
+
+}  // namespace v4ports
@@ -0,0 +1,65 @@
+/**
+ * @file v4_event_isr.hpp
+ * @brief ESP32-C6 GPIO and timer interrupts as event producers
+ *
+ * Each attachment installs an interrupt handler that stamps the event
+ * with esp_timer_get_time(), pushes it into its own EventRing and wakes
+ * the VM task with a task notification, so the task can block in
+ * ulTaskNotifyTake() and call EventDispatcher::dispatch() when woken:
+ * - GPIO: one event per configured edge, value = pin level in the ISR
+ * - timer: one event per period from a gptimer alarm, value = tick count
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "driver/gpio.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "v4_event_ring.hpp"
+
+namespace v4ports
+{
+
+/// Attachments (GPIO and timer together); a failed attachment takes none
+constexpr size_t EVENT_ISR_MAX = 8;
+
+/**
+ * @brief Post an event per edge on @p pin
+ *
+ * Configures the pin as an input with pull-up and adds a handler to the
+ * GPIO ISR service, which is installed on first use.
+ *
+ * @param ring    Ring of this interrupt only (single producer)
+ * @param pin     GPIO
+ * @param edge    GPIO_INTR_POSEDGE, GPIO_INTR_NEGEDGE or GPIO_INTR_ANYEDGE
+ * @param source  Event source id
+ * @param notify  Task to notify per event (nullptr = none)
+ * @return ESP_OK, ESP_ERR_NO_MEM (EVENT_ISR_MAX reached),
+ *         ESP_ERR_INVALID_STATE (@p ring already has a producer) or a
+ *         driver error
+ */
+esp_err_t event_gpio_attach(EventRing& ring, gpio_num_t pin, gpio_int_type_t edge,
+                            uint16_t source, TaskHandle_t notify);
+
+/**
+ * @brief Post an event every @p period_us from a general-purpose timer
+ *
+ * @param ring       Ring of this interrupt only (single producer)
+ * @param period_us  Period in microseconds (1 MHz timer resolution)
+ * @param source     Event source id
+ * @param notify     Task to notify per event (nullptr = none)
+ * @return ESP_OK, ESP_ERR_NO_MEM (EVENT_ISR_MAX reached),
+ *         ESP_ERR_INVALID_STATE (@p ring already has a producer) or a
+ *         driver error (the timer is deleted again)
+ */
+esp_err_t event_timer_attach(EventRing& ring, uint32_t period_us, uint16_t source,
+                             TaskHandle_t notify);
+
+}  // namespace v4ports
@@ -0,0 +1,187 @@
+/**
+ * @file v4_event_ring.hpp
+ * @brief Lock-free single-producer/single-consumer event ring
+ *
+ * Carries events from an interrupt handler to the task that runs the VM.
+ * The producer only writes the head index and the consumer only writes
+ * the tail, so neither side ever waits for or locks out the other; an ISR
+ * can push while the task is in the middle of a pop. Indices run freely
+ * and are masked on access, so all capacity slots are usable.
+ *
+ * Exactly one producer per ring: interrupts of different priority can
+ * nest on the ESP32-C6, so every ISR that posts events gets its own ring
+ * (EventDispatcher drains several).
+ *
+ * push() and pop() are inline so an ISR calls no out-of-line code; the
+ * ring's storage must be in internal RAM for IRAM-safe ISRs.
+ *
+ * Portable (no ESP-IDF dependencies) so it can be built and benchmarked
+ * on a Linux host as well as on the target.
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace v4ports
+{
+
+/**
+ * @brief One event
+ */
+struct Event
+{
+  uint16_t source;    ///< Source id; selects the handler word
+  uint16_t reserved;  ///< Zero
+  int32_t value;      ///< Passed to the handler on the data stack
+  uint32_t stamp_us;  ///< Producer clock (low 32 bits) when the event was posted
+};
+
+/**
+ * @brief Fixed-size SPSC ring of events
+ *
+ * Example usage:
+ * @code
+ * static v4ports::Event slots[64];
+ * static v4ports::EventRing ring(slots, 64);
+ *
+ * // ISR (producer)
+ * ring.push({BUTTON, 0, level, (uint32_t)esp_timer_get_time()});
+ *
+ * // Task (consumer)
+ * v4ports::Event ev;
+ * while (ring.pop(ev)) { ... }
+ * @endcode
+ */
+class EventRing
+{
+ public:
+  /**
+   * @brief Construct an empty ring
+   *
+   * @param slots     Storage (must outlive the ring)
+   * @param capacity  Number of slots, a power of two (rounded down otherwise)
+   */
+  EventRing(Event* slots, size_t capacity)
+      : slots_(slots), mask_(static_cast<uint32_t>(round_down(capacity) - 1))
+  {
+  }
+
+  // Non-copyable (both sides hold a reference)
+  EventRing(const EventRing&) = delete;
+  EventRing& operator=(const EventRing&) = delete;
+
+  /**
+   * @brief Post an event (producer side, ISR-safe)
+   *
+   * @return true if queued, false if the ring was full (the event is
+   *         dropped and counted)
+   */
+  bool push(const Event& ev)
+  {
+    uint32_t head = head_.load(std::memory_order_relaxed);
+    uint32_t used = head - tail_.load(std::memory_order_acquire);
+    if (used > mask_)
+    {
+      dropped_.store(dropped_.load(std::memory_order_relaxed) + 1,
+                     std::memory_order_relaxed);
+      return false;
+    }
+    slots_[head & mask_] = ev;
+    head_.store(head + 1, std::memory_order_release);
+    if (used + 1 > high_water_.load(std::memory_order_relaxed))
+    {
+      high_water_.store(used + 1, std::memory_order_relaxed);
+    }
+    return true;
+  }
+
+  /**
+   * @brief Look at the oldest event without removing it (consumer side)
+   *
+   * @return Event, or nullptr if the ring is empty
+   */
+  const Event* front() const
+  {
+    uint32_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_.load(std::memory_order_acquire))
+    {
+      return nullptr;
+    }
+    return &slots_[tail & mask_];
+  }
+
+  /**
+   * @brief Take the oldest event (consumer side)
+   *
+   * @return true if @p ev was filled, false if the ring was empty
+   */
+  bool pop(Event& ev)
+  {
+    const Event* e = front();
+    if (e == nullptr)
+    {
+      return false;
+    }
+    ev = *e;
+    tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Get the number of queued events (approximate while in use)
+   */
+  size_t size() const
+  {
+    return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Get the number of slots
+   */
+  size_t capacity() const
+  {
+    return static_cast<size_t>(mask_) + 1;
+  }
+
+  /**
+   * @brief Get the number of events dropped because the ring was full
+   */
+  uint32_t dropped() const
+  {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Get the largest number of queued events seen by the producer
+   */
+  uint32_t high_water() const
+  {
+    return high_water_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  static size_t round_down(size_t n)
+  {
+    size_t p = 1;
+    while (p * 2 <= n && p * 2 <= 0x80000000u)
+    {
+      p *= 2;
+    }
+    return p;
+  }
+
+  Event* slots_;
+  uint32_t mask_;
+  std::atomic<uint32_t> head_{0};  // Written by the producer only
+  std::atomic<uint32_t> tail_{0};  // Written by the consumer only
+  std::atomic<uint32_t> dropped_{0};
+  std::atomic<uint32_t> high_water_{0};
+};
+
+}  // namespace v4ports
@@ -0,0 +1,253 @@
+/**
+ * @file v4_image.c
+ * @brief Linkable multi-word bytecode images
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include "v4_image.h"
+
+#include <string.h>
+
+static uint32_t get_u16(const uint8_t* p)
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+}
+
+static uint32_t get_u32(const uint8_t* p)
+{
+  return get_u16(p) | (get_u16(p + 2) << 16);
+}
+
+uint32_t v4_image_crc32(uint32_t crc, const uint8_t* data, size_t len)
+{
+  crc = ~crc;
+  for (size_t i = 0; i < len; i++)
+  {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; bit++)
+    {
+      crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+  }
+  return ~crc;
+}
+
+// Section pointers of a validated image
+typedef struct
+{
+  V4ImageInfo info;
+  const uint8_t* words;
+  const uint8_t* imports;
+  const uint8_t* relocs;
+  const uint8_t* strings;
+  const uint8_t* code;
+  uint32_t strings_len;
+  uint32_t code_len;
+} Layout;
+
+static int name_valid(const Layout* l, uint32_t off)
+{
+  return off < l->strings_len;
+}
+
+static int layout(const uint8_t* image, size_t len, Layout* l)
+{
+  if (len < V4_IMAGE_HEADER_LEN || get_u32(image) != V4_IMAGE_MAGIC ||
+      get_u16(image + 4) != V4_IMAGE_VERSION)
+  {
+    return V4_IMAGE_ERR_FORMAT;
+  }
+
+  l->info.word_count = (uint16_t)get_u16(image + 8);
+  l->info.import_count = (uint16_t)get_u16(image + 10);
+  l->info.reloc_count = (uint16_t)get_u16(image + 12);
+  l->info.entry = (uint16_t)get_u16(image + 14);
+  l->strings_len = get_u32(image + 16);
+  l->code_len = get_u32(image + 20);
+  uint32_t payload_len = get_u32(image + 24);
+  uint32_t crc = get_u32(image + 28);
+
+  // 64-bit sums so corrupt lengths cannot wrap
+  uint64_t tables = (uint64_t)l->info.word_count * V4_IMAGE_WORD_LEN +
+                    (uint64_t)l->info.import_count * V4_IMAGE_IMPORT_LEN +
+                    (uint64_t)l->info.reloc_count * V4_IMAGE_RELOC_LEN;
+  if ((uint64_t)payload_len > len - V4_IMAGE_HEADER_LEN ||
+      tables + l->strings_len + l->code_len != payload_len || l->strings_len > 0xFFFF)
+  {
+    return V4_IMAGE_ERR_FORMAT;
+  }
+
+  const uint8_t* payload = image + V4_IMAGE_HEADER_LEN;
+  if (v4_image_crc32(0, payload, payload_len) != crc)
+  {
+    return V4_IMAGE_ERR_CHECKSUM;
+  }
+
+  l->words = payload;
+  l->imports = l->words + (size_t)l->info.word_count * V4_IMAGE_WORD_LEN;
+  l->relocs = l->imports + (size_t)l->info.import_count * V4_IMAGE_IMPORT_LEN;
+  l->strings = l->relocs + (size_t)l->info.reloc_count * V4_IMAGE_RELOC_LEN;
+  l->code = l->strings + l->strings_len;
+  l->info.resident_size = l->strings_len + l->code_len;
+
+  // Names must be terminated inside the string section
+  if (l->strings_len > 0 && l->strings[l->strings_len - 1] != '\0')
+  {
+    return V4_IMAGE_ERR_FORMAT;
+  }
+  if (l->info.entry != V4_IMAGE_NO_ENTRY && l->info.entry >= l->info.word_count)
+  {
+    return V4_IMAGE_ERR_FORMAT;
+  }
+
+  for (uint32_t i = 0; i < l->info.word_count; i++)
+  {
+    const uint8_t* w = l->words + i * V4_IMAGE_WORD_LEN;
+    uint32_t code_len = get_u16(w + 2);
+    uint32_t code_off = get_u32(w + 4);
+    if (!name_valid(l, get_u16(w)) || code_len == 0 || code_off > l->code_len ||
+        code_len > l->code_len - code_off)
+    {
+      return V4_IMAGE_ERR_FORMAT;
+    }
+  }
+  for (uint32_t i = 0; i < l->info.import_count; i++)
+  {
+    if (!name_valid(l, get_u16(l->imports + i * V4_IMAGE_IMPORT_LEN)))
+    {
+      return V4_IMAGE_ERR_FORMAT;
+    }
+  }
+  for (uint32_t i = 0; i < l->info.reloc_count; i++)
+  {
+    const uint8_t* r = l->relocs + i * V4_IMAGE_RELOC_LEN;
+    uint32_t off = get_u32(r);
+    uint32_t target = get_u16(r + 4);
+    uint8_t kind = r[6];
+    uint8_t width = r[7];
+    uint32_t targets =
+        (kind == V4_IMAGE_RELOC_WORD) ? l->info.word_count : l->info.import_count;
+    if (kind > V4_IMAGE_RELOC_IMPORT || target >= targets || width == 0 || width > 4 ||
+        off > l->code_len || width > l->code_len - off)
+    {
+      return V4_IMAGE_ERR_FORMAT;
+    }
+  }
+  return 0;
+}
+
+int v4_image_parse(const uint8_t* image, size_t len, V4ImageInfo* info)
+{
+  Layout l;
+  int err = layout(image, len, &l);
+  if (err == 0 && info != NULL)
+  {
+    *info = l.info;
+  }
+  return err;
+}
+
+const char* v4_image_word_name(const uint8_t* image, uint16_t index)
+{
+  uint32_t word_count = get_u16(image + 8);
+  if (index >= word_count)
+  {
+    return NULL;
+  }
+  uint32_t import_count = get_u16(image + 10);
+  uint32_t reloc_count = get_u16(image + 12);
+  const uint8_t* words = image + V4_IMAGE_HEADER_LEN;
+  const char* strings =
+      (const char*)(words + word_count * V4_IMAGE_WORD_LEN +
+                    import_count * V4_IMAGE_IMPORT_LEN +
+                    reloc_count * V4_IMAGE_RELOC_LEN);
+  return strings + get_u16(words + (uint32_t)index * V4_IMAGE_WORD_LEN);
+}
+
+static int resolve_import(const Layout* l, uint32_t index, V4ImageResolver resolve,
+                          void* user)
+{
+  if (resolve == NULL)
+  {
+    return -1;
+  }
+  const char* name =
+      (const char*)l->strings + get_u16(l->imports + index * V4_IMAGE_IMPORT_LEN);
+  return resolve(user, name);
+}
+
+int v4_image_load(struct Vm* vm, const uint8_t* image, size_t len, uint8_t* store,
+                  size_t store_size, V4ImageResolver resolve, void* user, int* wids,
+                  size_t max_wids)
+{
+  Layout l;
+  int err = layout(image, len, &l);
+  if (err != 0)
+  {
+    return err;
+  }
+  if (l.info.resident_size > store_size || l.info.word_count > max_wids)
+  {
+    return V4_IMAGE_ERR_NO_SPACE;
+  }
+
+  // Fail on a missing import before the VM is touched
+  for (uint32_t i = 0; i < l.info.import_count; i++)
+  {
+    if (resolve_import(&l, i, resolve, user) < 0)
+    {
+      return V4_IMAGE_ERR_IMPORT;
+    }
+  }
+
+  // Resident copy: strings, then code
+  memcpy(store, l.strings, l.strings_len);
+  memcpy(store + l.strings_len, l.code, l.code_len);
+  const char* names = (const char*)store;
+  uint8_t* code = store + l.strings_len;
+
+  for (uint32_t i = 0; i < l.info.word_count; i++)
+  {
+    const uint8_t* w = l.words + i * V4_IMAGE_WORD_LEN;
+    const char* name = names + get_u16(w);
+    int wid = vm_register_word(vm, (name[0] != '\0') ? name : NULL, code + get_u32(w + 4),
+                               (int)get_u16(w + 2));
+    if (wid < 0)
+    {
+      return wid;
+    }
+    wids[i] = wid;
+  }
+
+  // The VM runs registered code in place, so references can be patched
+  // now that every word id is known
+  for (uint32_t i = 0; i < l.info.reloc_count; i++)
+  {
+    const uint8_t* r = l.relocs + i * V4_IMAGE_RELOC_LEN;
+    uint32_t target = get_u16(r + 4);
+    uint8_t width = r[7];
+    int wid = (r[6] == V4_IMAGE_RELOC_WORD) ? wids[target]
+                                            : resolve_import(&l, target, resolve, user);
+    if (wid < 0 || (width < 4 && (uint32_t)wid >> (8 * width) != 0))
+    {
+      return V4_IMAGE_ERR_RELOC;
+    }
+    uint8_t* p = code + get_u32(r);
+    for (uint8_t b = 0; b < width; b++)
+    {
+      p[b] = (uint8_t)((uint32_t)wid >> (8 * b));
+    }
+  }
+
+  if (l.info.entry != V4_IMAGE_NO_ENTRY)
+  {
+    v4_err vm_err = vm_exec(vm, vm_get_word(vm, wids[l.info.entry]));
+    if (vm_err != 0)
+    {
+      return vm_err;
+    }
+  }
+  return l.info.word_count;
+}
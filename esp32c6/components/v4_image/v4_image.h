@@ -0,0 +1,133 @@
+/**
+ * @file v4_image.h
+ * @brief Linkable multi-word bytecode images
+ *
+ * An image holds many compiled words with their names, built ahead of time
+ * on a host (linux/image_build, `v4-image-build`). Word ids are assigned by
+ * the VM at registration, so every reference to a word inside the image's
+ * code is listed in a relocation table and patched by the loader; words
+ * the device already has (native words, earlier images) are referenced by
+ * name through the import table. Loading is one pass: copy names and code
+ * to resident memory, register every word, patch references, and run the
+ * optional entry word (the source's top-level code).
+ *
+ *   Header:  [MAGIC "V4IM" u32][VERSION u16][FLAGS u16]
+ *            [WORD_COUNT u16][IMPORT_COUNT u16][RELOC_COUNT u16][ENTRY u16]
+ *            [STRINGS_LEN u32][CODE_LEN u32][PAYLOAD_LEN u32][CRC32 u32]
+ *   Word:    [NAME_OFF u16][CODE_LEN u16][CODE_OFF u32]
+ *   Import:  [NAME_OFF u16]
+ *   Reloc:   [CODE_OFF u32][TARGET u16][KIND u8][WIDTH u8]
+ *   Strings: NUL-terminated names (STRINGS_LEN bytes)
+ *   Code:    word bodies (CODE_LEN bytes)
+ *
+ * All fields are little-endian. The CRC-32 (IEEE) covers the PAYLOAD_LEN
+ * bytes after the header. ENTRY is a word index or 0xFFFF; the entry word
+ * has an empty name. A relocation writes the word id of TARGET (a word
+ * index for KIND 0, an import index for KIND 1) as a WIDTH-byte integer at
+ * CODE_OFF.
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "v4/vm_api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Current image format version */
+#define V4_IMAGE_VERSION 1
+
+/** Image layout */
+#define V4_IMAGE_MAGIC 0x4D493456u /**< "V4IM" */
+#define V4_IMAGE_HEADER_LEN 32
+#define V4_IMAGE_WORD_LEN 8
+#define V4_IMAGE_IMPORT_LEN 2
+#define V4_IMAGE_RELOC_LEN 8
+#define V4_IMAGE_NO_ENTRY 0xFFFFu
+
+/** Relocation kinds */
+#define V4_IMAGE_RELOC_WORD 0   /**< TARGET is a word of the image */
+#define V4_IMAGE_RELOC_IMPORT 1 /**< TARGET is an import */
+
+/** Image error codes (VM errors are passed through unchanged) */
+#define V4_IMAGE_ERR_FORMAT -130   /**< Not an image, unsupported version, bad offsets */
+#define V4_IMAGE_ERR_CHECKSUM -131 /**< CRC mismatch */
+#define V4_IMAGE_ERR_NO_SPACE -132 /**< Resident store or word id array too small */
+#define V4_IMAGE_ERR_IMPORT -133   /**< An import could not be resolved */
+#define V4_IMAGE_ERR_RELOC -134    /**< A word id does not fit its relocation */
+
+/**
+ * @brief Image summary
+ */
+typedef struct V4ImageInfo
+{
+  uint16_t word_count;
+  uint16_t import_count;
+  uint16_t reloc_count;
+  uint16_t entry;          /**< Entry word index, or V4_IMAGE_NO_ENTRY */
+  uint32_t resident_size;  /**< Store bytes needed by v4_image_load() */
+} V4ImageInfo;
+
+/**
+ * @brief Resolve an imported word by name
+ *
+ * @return Word id (>= 0), or a negative value if unknown
+ */
+typedef int (*V4ImageResolver)(void* user, const char* name);
+
+/**
+ * @brief Validate an image (layout, offsets and CRC)
+ *
+ * @param info  Filled in on success (may be NULL)
+ * @return 0, V4_IMAGE_ERR_FORMAT or V4_IMAGE_ERR_CHECKSUM
+ */
+int v4_image_parse(const uint8_t* image, size_t len, V4ImageInfo* info);
+
+/**
+ * @brief Get the name of word @p index of a validated image
+ *
+ * @return Name ("" for the entry word), or NULL if out of range
+ */
+const char* v4_image_word_name(const uint8_t* image, uint16_t index);
+
+/**
+ * @brief Load an image into a VM
+ *
+ * Names and code are copied to @p store, which must stay valid as long as
+ * the VM uses the words (the VM runs code in place); the image itself may
+ * be discarded afterwards. All imports are resolved before anything is
+ * registered, so a missing import leaves the VM unchanged.
+ *
+ * @param vm          VM to register the words in
+ * @param image       Image bytes
+ * @param len         Image length
+ * @param store       Resident memory (at least V4ImageInfo::resident_size)
+ * @param store_size  Size of @p store
+ * @param resolve     Import resolver (may be NULL for images without imports)
+ * @param user        Passed to @p resolve
+ * @param wids        Receives the word id of every word, by word index
+ * @param max_wids    Capacity of @p wids
+ * @return Number of words registered (>= 0), a V4_IMAGE_ERR_* code, or the
+ *         VM error of the entry word (its words stay registered)
+ */
+int v4_image_load(struct Vm* vm, const uint8_t* image, size_t len, uint8_t* store,
+                  size_t store_size, V4ImageResolver resolve, void* user, int* wids,
+                  size_t max_wids);
+
+/**
+ * @brief Update a CRC-32 (IEEE 802.3, reflected) over a byte range
+ *
+ * Start with @p crc = 0; the result is final and can be chained.
+ */
+uint32_t v4_image_crc32(uint32_t crc, const uint8_t* data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,361 @@
+/**
+ * @file v4_link_cache.cpp
+ * @brief Content-addressed bytecode cache for the V4-link port
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include "v4_link_cache.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "v4_link_frame.hpp"
+
+namespace v4ports
+{
+
+namespace
+{
+
+void put_u32(uint8_t* p, uint32_t v)
+{
+  for (int i = 0; i < 4; ++i)
+  {
+    p[i] = static_cast<uint8_t>(v >> (8 * i));
+  }
+}
+
+uint32_t get_u32(const uint8_t* p)
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+         ((uint32_t)p[3] << 24);
+}
+
+}  // namespace
+
+uint64_t program_hash(const uint8_t* code, size_t len)
+{
+  uint64_t h = 0xCBF29CE484222325ULL;
+  for (size_t i = 0; i < len; ++i)
+  {
+    h ^= code[i];
+    h *= 0x100000001B3ULL;
+  }
+  return h;
+}
+
+// ---------------------------------------------------------------------------
+// CacheStore
+
+void CacheStore::encode_header(uint8_t* header, uint64_t hash, const uint8_t* code,
+                               size_t len)
+{
+  put_u32(header, RECORD_MAGIC);
+  put_u32(header + 4, static_cast<uint32_t>(len));
+  put_u32(header + 8, static_cast<uint32_t>(hash));
+  put_u32(header + 12, static_cast<uint32_t>(hash >> 32));
+  put_u32(header + 16, crc32_update(0, code, len));
+}
+
+bool CacheStore::decode_header(const uint8_t* header, uint64_t& hash, size_t& len,
+                               uint32_t& crc)
+{
+  if (get_u32(header) != RECORD_MAGIC)
+  {
+    return false;
+  }
+  len = get_u32(header + 4);
+  hash = (uint64_t)get_u32(header + 8) | ((uint64_t)get_u32(header + 12) << 32);
+  crc = get_u32(header + 16);
+  return len > 0;
+}
+
+// ---------------------------------------------------------------------------
+// FileCacheStore
+
+FileCacheStore::FileCacheStore(const char* path, size_t max_size)
+    : path_(path), max_size_(max_size)
+{
+}
+
+FileCacheStore::~FileCacheStore() = default;
+
+void FileCacheStore::load(const Visitor& visit)
+{
+  size_ = 0;
+  FILE* f = std::fopen(path_.c_str(), "rb");
+  if (f == nullptr)
+  {
+    return;
+  }
+
+  std::vector<uint8_t> code;
+  uint8_t header[RECORD_HEADER_LEN];
+  while (std::fread(header, 1, sizeof(header), f) == sizeof(header))
+  {
+    uint64_t hash;
+    size_t len;
+    uint32_t crc;
+    if (!decode_header(header, hash, len, crc) || len > max_size_)
+    {
+      break;
+    }
+    code.resize(len);
+    if (std::fread(code.data(), 1, len, f) != len ||
+        crc32_update(0, code.data(), len) != crc)
+    {
+      break;
+    }
+    visit(hash, code.data(), len);
+    size_ += sizeof(header) + len;
+  }
+  std::fclose(f);
+}
+
+bool FileCacheStore::append(uint64_t hash, const uint8_t* code, size_t len)
+{
+  if (size_ + RECORD_HEADER_LEN + len > max_size_)
+  {
+    return false;
+  }
+
+  // Overwrite from the end of the last valid record (drops a damaged tail)
+  FILE* f = std::fopen(path_.c_str(), (size_ == 0) ? "wb" : "r+b");
+  if (f == nullptr)
+  {
+    return false;
+  }
+
+  uint8_t header[RECORD_HEADER_LEN];
+  encode_header(header, hash, code, len);
+  bool ok = std::fseek(f, static_cast<long>(size_), SEEK_SET) == 0 &&
+            std::fwrite(header, 1, sizeof(header), f) == sizeof(header) &&
+            std::fwrite(code, 1, len, f) == len;
+  ok = (std::fclose(f) == 0) && ok;
+  if (ok)
+  {
+    size_ += sizeof(header) + len;
+  }
+  return ok;
+}
+
+size_t FileCacheStore::free_space() const
+{
+  return max_size_ - size_;
+}
+
+bool FileCacheStore::clear()
+{
+  FILE* f = std::fopen(path_.c_str(), "wb");
+  if (f == nullptr)
+  {
+    return false;
+  }
+  std::fclose(f);
+  size_ = 0;
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// BytecodeCache
+
+BytecodeCache::BytecodeCache(size_t max_bytes, size_t max_entries)
+    : max_bytes_(max_bytes), max_entries_(max_entries)
+{
+  entries_.reserve(max_entries);
+}
+
+void BytecodeCache::attach_store(CacheStore* store)
+{
+  // Load first so records are not written back while loading
+  store_ = nullptr;
+  if (store != nullptr)
+  {
+    store->load([this](uint64_t hash, const uint8_t* code, size_t len)
+                { insert_ram(hash, code, len); });
+  }
+  // Loaded records are already stored
+  for (Entry& e : entries_)
+  {
+    e.pending = false;
+  }
+  store_ = store;
+  dirty_ = false;
+}
+
+BytecodeCache::Entry* BytecodeCache::find(uint64_t hash)
+{
+  for (Entry& e : entries_)
+  {
+    if (e.hash == hash)
+    {
+      return &e;
+    }
+  }
+  return nullptr;
+}
+
+const uint8_t* BytecodeCache::lookup(uint64_t hash, size_t& len)
+{
+  Entry* e = find(hash);
+  if (e == nullptr)
+  {
+    stats_.misses++;
+    return nullptr;
+  }
+  stats_.hits++;
+  e->last_use = ++clock_;
+  len = e->len;
+  return e->code.get();
+}
+
+bool BytecodeCache::insert(uint64_t hash, const uint8_t* code, size_t len)
+{
+  uint32_t inserts = stats_.inserts;
+  if (!insert_ram(hash, code, len))
+  {
+    return false;
+  }
+  // Written by the next flush(), not on the execution path
+  if (store_ != nullptr && stats_.inserts != inserts)
+  {
+    dirty_ = true;
+  }
+  return true;
+}
+
+bool BytecodeCache::insert_ram(uint64_t hash, const uint8_t* code, size_t len)
+{
+  if (len == 0 || len > max_bytes_ || max_entries_ == 0)
+  {
+    return false;
+  }
+
+  Entry* existing = find(hash);
+  if (existing != nullptr)
+  {
+    existing->last_use = ++clock_;
+    return true;
+  }
+
+  while (entries_.size() >= max_entries_ || bytes_ + len > max_bytes_)
+  {
+    evict_lru();
+  }
+
+  Entry e;
+  e.hash = hash;
+  e.last_use = ++clock_;
+  e.len = len;
+  e.pending = true;
+  e.code.reset(new uint8_t[len]);
+  std::memcpy(e.code.get(), code, len);
+  entries_.push_back(std::move(e));
+  bytes_ += len;
+  stats_.inserts++;
+  return true;
+}
+
+void BytecodeCache::evict_lru()
+{
+  auto lru = std::min_element(entries_.begin(), entries_.end(),
+                              [](const Entry& a, const Entry& b)
+                              { return a.last_use < b.last_use; });
+  bytes_ -= lru->len;
+  // Order does not matter; move the last entry into the hole
+  *lru = std::move(entries_.back());
+  entries_.pop_back();
+  stats_.evictions++;
+}
+
+std::vector<BytecodeCache::Entry*> BytecodeCache::by_age(bool pending_only)
+{
+  std::vector<Entry*> order;
+  order.reserve(entries_.size());
+  for (Entry& e : entries_)
+  {
+    if (e.pending || !pending_only)
+    {
+      order.push_back(&e);
+    }
+  }
+  std::sort(order.begin(), order.end(),
+            [](const Entry* a, const Entry* b) { return a->last_use < b->last_use; });
+  return order;
+}
+
+void BytecodeCache::flush()
+{
+  if (store_ == nullptr || !dirty_)
+  {
+    return;
+  }
+
+  for (Entry* e : by_age(true))
+  {
+    if (CacheStore::record_size(e->len) > store_->free_space())
+    {
+      compact();
+      return;
+    }
+    if (!store_->append(e->hash, e->code.get(), e->len))
+    {
+      // Write error: no erase, and no retry until something new is cached
+      dirty_ = false;
+      return;
+    }
+    e->pending = false;
+    stats_.persisted++;
+  }
+  dirty_ = false;
+}
+
+void BytecodeCache::compact()
+{
+  dirty_ = false;
+  if (!store_->clear())
+  {
+    return;
+  }
+  stats_.compactions++;
+
+  // Keep the most recently used programs that fit, written oldest first so
+  // loading restores their LRU order
+  std::vector<Entry*> order = by_age(false);
+  size_t space = store_->free_space();
+  size_t first = order.size();
+  while (first > 0 && CacheStore::record_size(order[first - 1]->len) <= space)
+  {
+    first--;
+    space -= CacheStore::record_size(order[first]->len);
+  }
+  for (size_t i = 0; i < order.size(); ++i)
+  {
+    Entry* e = order[i];
+    // Programs left out stay RAM only until evicted
+    e->pending = false;
+    if (i >= first && store_->append(e->hash, e->code.get(), e->len))
+    {
+      stats_.persisted++;
+    }
+  }
+}
+
+void BytecodeCache::clear()
+{
+  entries_.clear();
+  bytes_ = 0;
+}
+
+BytecodeCacheStats BytecodeCache::stats() const
+{
+  BytecodeCacheStats s = stats_;
+  s.entries = static_cast<uint32_t>(entries_.size());
+  s.bytes = static_cast<uint32_t>(bytes_);
+  return s;
+}
+
+}  // namespace v4ports
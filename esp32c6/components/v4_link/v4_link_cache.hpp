@@ -0,0 +1,240 @@
+/**
+ * @file v4_link_cache.hpp
+ * @brief Content-addressed bytecode cache for the V4-link port
+ *
+ * Programs received over the link are kept in RAM keyed by a 64-bit hash
+ * of their bytes, so a host can run a program it already sent with a
+ * 9-byte EXEC_HASH frame instead of re-sending the whole payload.
+ *
+ * Portable (no ESP-IDF dependencies) so it can be built and tested on a
+ * Linux host as well as on the target.
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace v4ports
+{
+
+/**
+ * @brief Hash used to address cached programs
+ *
+ * 64-bit FNV-1a over the program bytes. Not cryptographic: it identifies
+ * programs sent by a trusted host, it does not authenticate them.
+ */
+uint64_t program_hash(const uint8_t* code, size_t len);
+
+/**
+ * @brief Persistent backing store for the bytecode cache
+ *
+ * Stores are append-only logs of records:
+ * [MAGIC u32][LEN u32][HASH u64][CRC32 u32][CODE...] (little-endian).
+ * Loading stops at the first record that is erased, truncated or fails
+ * its CRC.
+ */
+class CacheStore
+{
+ public:
+  using Visitor = std::function<void(uint64_t hash, const uint8_t* code, size_t len)>;
+
+  virtual ~CacheStore() = default;
+
+  /**
+   * @brief Visit every valid record, oldest first
+   */
+  virtual void load(const Visitor& visit) = 0;
+
+  /**
+   * @brief Append a record
+   *
+   * @return false if the store is full or the write failed
+   */
+  virtual bool append(uint64_t hash, const uint8_t* code, size_t len) = 0;
+
+  /**
+   * @brief Get the bytes that can still be appended before clear() is needed
+   */
+  virtual size_t free_space() const = 0;
+
+  /**
+   * @brief Erase all records
+   */
+  virtual bool clear() = 0;
+
+  /**
+   * @brief Get the store space taken by a record of @p len code bytes
+   */
+  static size_t record_size(size_t len)
+  {
+    return RECORD_HEADER_LEN + len;
+  }
+
+ protected:
+  static constexpr uint32_t RECORD_MAGIC = 0x43433456;  // "V4CC"
+  static constexpr size_t RECORD_HEADER_LEN = 20;
+
+  /// Encode a record header for @p code
+  static void encode_header(uint8_t* header, uint64_t hash, const uint8_t* code,
+                            size_t len);
+
+  /// Decode a record header; returns false if it is not a record
+  static bool decode_header(const uint8_t* header, uint64_t& hash, size_t& len,
+                            uint32_t& crc);
+};
+
+/**
+ * @brief Cache store in a regular file (Linux host, or VFS on target)
+ */
+class FileCacheStore : public CacheStore
+{
+ public:
+  /**
+   * @param path      File path (created on first append)
+   * @param max_size  Maximum file size in bytes before append() fails
+   */
+  explicit FileCacheStore(const char* path, size_t max_size = 64 * 1024);
+  ~FileCacheStore() override;
+
+  // Non-copyable
+  FileCacheStore(const FileCacheStore&) = delete;
+  FileCacheStore& operator=(const FileCacheStore&) = delete;
+
+  void load(const Visitor& visit) override;
+  bool append(uint64_t hash, const uint8_t* code, size_t len) override;
+  size_t free_space() const override;
+  bool clear() override;
+
+ private:
+  std::string path_;
+  size_t max_size_;
+  size_t size_ = 0;
+};
+
+/**
+ * @brief Bytecode cache statistics
+ */
+struct BytecodeCacheStats
+{
+  uint32_t entries;      ///< Programs currently cached
+  uint32_t bytes;        ///< Bytes currently cached
+  uint32_t hits;         ///< Successful lookups
+  uint32_t misses;       ///< Failed lookups
+  uint32_t inserts;      ///< Programs added
+  uint32_t evictions;    ///< Programs evicted to make room
+  uint32_t persisted;    ///< Records written to the store
+  uint32_t compactions;  ///< Times the store was erased and rewritten
+};
+
+/**
+ * @brief Size-bounded LRU cache of programs keyed by program_hash()
+ *
+ * Both the total byte budget and the number of entries are bounded. Lookup
+ * is a linear scan, which is cheaper than a map for the few dozen entries a
+ * microcontroller keeps.
+ *
+ * With a store attached, new programs are marked pending and written by
+ * flush(), which the owner calls off the hot path (LinkPort does so when
+ * the link goes idle). Only when a pending program no longer fits is the
+ * store cleared and rewritten with the most recently used programs that
+ * fit. A failed write leaves the program pending until the flush after
+ * the next insert, so a broken store is not retried on every call.
+ * Compaction erases flash, so size the store well above the RAM budget.
+ */
+class BytecodeCache
+{
+ public:
+  /**
+   * @param max_bytes    Total bytecode budget in bytes
+   * @param max_entries  Maximum number of programs
+   */
+  BytecodeCache(size_t max_bytes, size_t max_entries);
+
+  // Non-copyable
+  BytecodeCache(const BytecodeCache&) = delete;
+  BytecodeCache& operator=(const BytecodeCache&) = delete;
+
+  /**
+   * @brief Attach a persistent store and load its records
+   *
+   * @param store  Store (must outlive the cache), or nullptr to detach
+   */
+  void attach_store(CacheStore* store);
+
+  /**
+   * @brief Find a program and mark it most recently used
+   *
+   * @param hash  Program hash
+   * @param len   Receives program length
+   * @return Program bytes (valid until the next insert), or nullptr
+   */
+  const uint8_t* lookup(uint64_t hash, size_t& len);
+
+  /**
+   * @brief Add a program (no-op if already cached)
+   *
+   * @return false if the program is larger than the whole budget
+   */
+  bool insert(uint64_t hash, const uint8_t* code, size_t len);
+
+  /**
+   * @brief Write pending programs to the store
+   *
+   * Compacts the store if a pending program does not fit. No-op without a
+   * store or pending programs.
+   */
+  void flush();
+
+  /**
+   * @brief Check whether programs are waiting for flush()
+   */
+  bool dirty() const
+  {
+    return dirty_;
+  }
+
+  /**
+   * @brief Drop all programs from RAM (the store is kept)
+   */
+  void clear();
+
+  /**
+   * @brief Get statistics
+   */
+  BytecodeCacheStats stats() const;
+
+ private:
+  struct Entry
+  {
+    uint64_t hash;
+    uint32_t last_use;
+    size_t len;
+    bool pending;  ///< Not yet written to the store
+    std::unique_ptr<uint8_t[]> code;
+  };
+
+  bool insert_ram(uint64_t hash, const uint8_t* code, size_t len);
+  Entry* find(uint64_t hash);
+  void evict_lru();
+  std::vector<Entry*> by_age(bool pending_only);
+  void compact();
+
+  std::vector<Entry> entries_;
+  size_t max_bytes_;
+  size_t max_entries_;
+  size_t bytes_ = 0;
+  uint32_t clock_ = 0;
+  CacheStore* store_ = nullptr;
+  bool dirty_ = false;
+  BytecodeCacheStats stats_ = {};
+};
+
+}  // namespace v4ports
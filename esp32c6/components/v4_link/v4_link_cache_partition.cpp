@@ -0,0 +1,114 @@
+/**
+ * @file v4_link_cache_partition.cpp
+ * @brief Flash partition backing store for the bytecode cache
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include "v4_link_cache_partition.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include "esp_log.h"
+#include "v4_link_frame.hpp"
+
+static const char* TAG = "v4_link_cache";
+
+namespace v4ports
+{
+
+PartitionCacheStore::PartitionCacheStore(const char* label)
+    : part_(esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                     label))
+{
+  if (part_ == nullptr)
+  {
+    ESP_LOGW(TAG, "Cache partition '%s' not found, cache is RAM only", label);
+  }
+}
+
+void PartitionCacheStore::load(const Visitor& visit)
+{
+  size_ = 0;
+  if (part_ == nullptr)
+  {
+    return;
+  }
+
+  std::vector<uint8_t> code;
+  uint8_t header[RECORD_HEADER_LEN];
+  while (size_ + sizeof(header) <= part_->size)
+  {
+    uint64_t hash;
+    size_t len;
+    uint32_t crc;
+    if (esp_partition_read(part_, size_, header, sizeof(header)) != ESP_OK ||
+        !decode_header(header, hash, len, crc) ||
+        size_ + sizeof(header) + len > part_->size)
+    {
+      break;
+    }
+    code.resize(len);
+    if (esp_partition_read(part_, size_ + sizeof(header), code.data(), len) != ESP_OK ||
+        crc32_update(0, code.data(), len) != crc)
+    {
+      break;
+    }
+    visit(hash, code.data(), len);
+    size_ += sizeof(header) + len;
+  }
+
+  // Anything but erased flash after the last record (e.g. a write cut short
+  // by power loss) cannot be written over; force compaction on next flush
+  size_t probe = std::min(sizeof(header), part_->size - size_);
+  dirty_ = probe > 0 && (esp_partition_read(part_, size_, header, probe) != ESP_OK ||
+                         std::any_of(header, header + probe,
+                                     [](uint8_t b) { return b != 0xFF; }));
+
+  ESP_LOGI(TAG, "Cache partition: %u of %u bytes used", (unsigned)size_,
+           (unsigned)part_->size);
+}
+
+bool PartitionCacheStore::append(uint64_t hash, const uint8_t* code, size_t len)
+{
+  if (part_ == nullptr || dirty_ || size_ + RECORD_HEADER_LEN + len > part_->size)
+  {
+    return false;
+  }
+
+  uint8_t header[RECORD_HEADER_LEN];
+  encode_header(header, hash, code, len);
+  if (esp_partition_write(part_, size_, header, sizeof(header)) != ESP_OK ||
+      esp_partition_write(part_, size_ + sizeof(header), code, len) != ESP_OK)
+  {
+    ESP_LOGE(TAG, "Cache partition write failed");
+    return false;
+  }
+  size_ += sizeof(header) + len;
+  return true;
+}
+
+size_t PartitionCacheStore::free_space() const
+{
+  // Garbage after the last record must be erased before anything fits
+  if (part_ == nullptr || dirty_)
+  {
+    return 0;
+  }
+  return part_->size - size_;
+}
+
+bool PartitionCacheStore::clear()
+{
+  if (part_ == nullptr || esp_partition_erase_range(part_, 0, part_->size) != ESP_OK)
+  {
+    return false;
+  }
+  size_ = 0;
+  dirty_ = false;
+  return true;
+}
+
+}  // namespace v4ports
@@ -0,0 +1,54 @@
+/**
+ * @file v4_link_cache_partition.hpp
+ * @brief Flash partition backing store for the bytecode cache
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#pragma once
+
+#include "esp_partition.h"
+#include "v4_link_cache.hpp"
+
+namespace v4ports
+{
+
+/**
+ * @brief Cache store in a raw data partition
+ *
+ * Records are appended to the partition; compaction erases the whole
+ * partition. Call BytecodeCache::attach_store() (which loads) before use.
+ * Example partitions.csv entry:
+ * @code
+ * v4cache, data, 0x40, , 64K,
+ * @endcode
+ */
+class PartitionCacheStore : public CacheStore
+{
+ public:
+  /**
+   * @param label  Partition label
+   */
+  explicit PartitionCacheStore(const char* label);
+
+  /**
+   * @brief Check whether the partition was found
+   */
+  bool valid() const
+  {
+    return part_ != nullptr;
+  }
+
+  void load(const Visitor& visit) override;
+  bool append(uint64_t hash, const uint8_t* code, size_t len) override;
+  size_t free_space() const override;
+  bool clear() override;
+
+ private:
+  const esp_partition_t* part_;
+  size_t size_ = 0;
+  bool dirty_ = false;
+};
+
+}  // namespace v4ports
@@ -0,0 +1,219 @@
+/**
+ * @file v4_link_exec_worker.cpp
+ * @brief Asynchronous execution of V4-link programs
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include "v4_link_exec_worker.hpp"
+
+#include <cstring>
+#include <utility>
+
+#include "v4_link_frame.hpp"
+
+#ifdef ESP_PLATFORM
+#include "esp_pthread.h"
+#endif
+
+namespace v4ports
+{
+
+namespace
+{
+
+// Worker whose job runs on this thread
+thread_local ExecWorker* current_worker = nullptr;
+
+}  // namespace
+
+ExecWorker::ExecWorker(size_t capacity, const ExecWorkerConfig& cfg)
+    : code_(new uint8_t[capacity]), capacity_(capacity)
+{
+#ifdef ESP_PLATFORM
+  // std::thread picks up the pthread configuration of the creating task
+  esp_pthread_cfg_t thread_cfg = esp_pthread_get_default_config();
+  thread_cfg.stack_size = cfg.stack_size;
+  thread_cfg.prio = cfg.priority;
+  thread_cfg.thread_name = "v4_exec";
+  esp_pthread_set_cfg(&thread_cfg);
+#else
+  (void)cfg;
+#endif
+
+  thread_ = std::thread([this] { run(); });
+
+#ifdef ESP_PLATFORM
+  esp_pthread_cfg_t default_cfg = esp_pthread_get_default_config();
+  esp_pthread_set_cfg(&default_cfg);
+#endif
+}
+
+ExecWorker::~ExecWorker()
+{
+  abort();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  thread_.join();
+}
+
+void ExecWorker::set_runner(Runner runner)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  runner_ = std::move(runner);
+}
+
+uint8_t ExecWorker::submit(const uint8_t* code, size_t len)
+{
+  if (len == 0)
+  {
+    return proto::ERR_INVALID_FRAME;
+  }
+  if (len > capacity_)
+  {
+    return proto::ERR_BUFFER_FULL;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pending_ || running_)
+    {
+      return proto::ERR_BUSY;
+    }
+    std::memcpy(code_.get(), code, len);
+    len_ = len;
+    pending_ = true;
+    aborted_.store(false, std::memory_order_release);
+    state_ = ExecState::RUNNING;
+    job_++;
+    started_ = Clock::now();
+  }
+  cv_.notify_all();
+  return proto::ERR_OK;
+}
+
+bool ExecWorker::busy() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return pending_ || running_;
+}
+
+ExecStatus ExecWorker::status() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return status_locked();
+}
+
+ExecStatus ExecWorker::status_locked() const
+{
+  Clock::time_point end = (state_ == ExecState::RUNNING) ? Clock::now() : finished_;
+  uint32_t elapsed = 0;
+  if (state_ != ExecState::IDLE)
+  {
+    elapsed = static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(end - started_).count());
+  }
+  return {state_, result_, job_, elapsed};
+}
+
+ExecStatus ExecWorker::wait(uint32_t timeout_ms)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+               [this] { return !pending_ && !running_; });
+  return status_locked();
+}
+
+ExecStatus ExecWorker::abort()
+{
+  ExecStatus status;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!pending_ && !running_)
+    {
+      return status_locked();
+    }
+
+    aborted_.store(true, std::memory_order_release);
+    // The VM cannot be stopped from here; only end the delay it may be in
+    if (running_ && abort_hook_ != nullptr)
+    {
+      abort_hook_();
+    }
+    status = status_locked();
+  }
+  // Wakes a job sleeping in sleep()
+  cv_.notify_all();
+  return status;
+}
+
+void ExecWorker::sleep(uint32_t ms)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait_for(lock, std::chrono::milliseconds(ms),
+               [this] { return aborted_.load(std::memory_order_relaxed) || stop_; });
+}
+
+ExecWorker* ExecWorker::current()
+{
+  return current_worker;
+}
+
+void ExecWorker::run()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true)
+  {
+    cv_.wait(lock, [this] { return pending_ || stop_; });
+    if (stop_)
+    {
+      break;
+    }
+
+    pending_ = false;
+    uint8_t result = proto::ERR_ERROR;
+    if (!aborted_ && runner_)
+    {
+      running_ = true;
+      Runner runner = runner_;
+      size_t len = len_;
+      lock.unlock();
+      current_worker = this;
+      result = runner(code_.get(), len);
+      current_worker = nullptr;
+      lock.lock();
+      running_ = false;
+    }
+
+    result_ = aborted_ ? proto::ERR_ABORTED : result;
+    state_ = ExecState::DONE;
+    finished_ = Clock::now();
+    cv_.notify_all();
+  }
+}
+
+}  // namespace v4ports
+
+#ifdef ESP_PLATFORM
+// hal_delay_ms() is linked with --wrap=hal_delay_ms (see CMakeLists.txt), so
+// a job's delays can be ended by abort() without aborting the worker task's
+// other blocking calls
+extern "C" void __real_hal_delay_ms(uint32_t ms);
+
+extern "C" void __wrap_hal_delay_ms(uint32_t ms)
+{
+  v4ports::ExecWorker* worker = v4ports::ExecWorker::current();
+  if (worker != nullptr)
+  {
+    worker->sleep(ms);
+  }
+  else
+  {
+    __real_hal_delay_ms(ms);
+  }
+}
+#endif
@@ -0,0 +1,240 @@
+/**
+ * @file v4_link_exec_worker.hpp
+ * @brief Asynchronous execution of V4-link programs
+ *
+ * ExecWorker runs one program at a time in its own task, so the link keeps
+ * answering PING, STATS and status queries while a long program (e.g. one
+ * sleeping in SYS DELAY_MS) runs. The program is copied into a buffer owned
+ * by the worker, because the VM runs registered code in place.
+ *
+ * V4 has no cancellation API and the worker cannot stop the VM between
+ * instructions, so abort() is cooperative. It drops a job that has not
+ * started, ends the HAL delay a job sleeps in, and sets a flag the runner
+ * checks with aborting() once the VM returns, so the results of an aborted
+ * job can be discarded. On ESP-IDF, hal_delay_ms() is linked with --wrap so
+ * that delays of a job sleep in sleep(), which abort() wakes and which
+ * returns at once for the rest of an aborted job; no other blocking call of
+ * the worker task is interrupted. Elsewhere an optional hook ends the delay
+ * in progress. A program that never returns keeps the worker busy until the
+ * device is reset.
+ *
+ * Uses std::thread (pthreads on ESP-IDF), so the same worker runs on the
+ * target and in the Linux host build.
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+
+#ifndef CONFIG_V4_LINK_EXEC_TASK_PRIORITY
+#define CONFIG_V4_LINK_EXEC_TASK_PRIORITY 4
+#endif
+
+#ifndef CONFIG_V4_LINK_EXEC_TASK_STACK_SIZE
+#define CONFIG_V4_LINK_EXEC_TASK_STACK_SIZE 4096
+#endif
+#endif  // ESP_PLATFORM
+
+namespace v4ports
+{
+
+/**
+ * @brief Asynchronous job state
+ */
+enum class ExecState : uint8_t
+{
+  IDLE = 0,     ///< No job submitted yet
+  RUNNING = 1,  ///< Job submitted and not finished
+  DONE = 2,     ///< Last job finished (see ExecStatus::result)
+};
+
+/**
+ * @brief Status of the current or last job
+ */
+struct ExecStatus
+{
+  ExecState state;
+  uint8_t result;       ///< proto::ERR_* of a finished job
+  uint16_t job;         ///< Job number, incremented per submit()
+  uint32_t elapsed_ms;  ///< Run time so far, or total run time when DONE
+};
+
+#ifdef ESP_PLATFORM
+/**
+ * @brief Worker task configuration
+ */
+struct ExecWorkerConfig
+{
+  int priority = CONFIG_V4_LINK_EXEC_TASK_PRIORITY;          ///< Task priority
+  uint32_t stack_size = CONFIG_V4_LINK_EXEC_TASK_STACK_SIZE;  ///< Stack size (bytes)
+};
+#else
+struct ExecWorkerConfig
+{
+};
+#endif
+
+/**
+ * @brief Single-slot asynchronous program runner
+ *
+ * Example usage:
+ * @code
+ * v4ports::ExecWorker worker(512);
+ * link.set_exec_worker(&worker);  // enables EXEC_ASYNC and friends
+ * @endcode
+ */
+class ExecWorker
+{
+ public:
+  /// Runs a program on the VM and returns a proto::ERR_* code
+  using Runner = std::function<uint8_t(const uint8_t* code, size_t len)>;
+
+  /**
+   * @brief Construct and start the worker task
+   *
+   * @param capacity  Largest program in bytes
+   * @param cfg       Task configuration (ESP-IDF only)
+   */
+  explicit ExecWorker(size_t capacity, const ExecWorkerConfig& cfg = {});
+
+  /**
+   * @brief Destructor
+   *
+   * Aborts a running job and joins the worker task.
+   */
+  ~ExecWorker();
+
+  // Non-copyable
+  ExecWorker(const ExecWorker&) = delete;
+  ExecWorker& operator=(const ExecWorker&) = delete;
+
+  /**
+   * @brief Set the function jobs are run with (done by LinkPort)
+   */
+  void set_runner(Runner runner);
+
+  /**
+   * @brief Set a hook that interrupts a blocking HAL delay
+   *
+   * Called from abort() while a job runs, for HALs whose delays do not go
+   * through sleep() (the Linux host uses hal_host_abort_delay()).
+   */
+  void set_abort_hook(void (*hook)())
+  {
+    abort_hook_ = hook;
+  }
+
+  /**
+   * @brief Copy a program and start running it
+   *
+   * @return proto::ERR_OK, ERR_BUSY while a job runs, ERR_BUFFER_FULL if
+   *         the program exceeds the capacity, ERR_INVALID_FRAME if empty
+   */
+  uint8_t submit(const uint8_t* code, size_t len);
+
+  /**
+   * @brief Check whether a job is running
+   */
+  bool busy() const;
+
+  /**
+   * @brief Get the current or last job status
+   */
+  ExecStatus status() const;
+
+  /**
+   * @brief Wait for the running job to finish
+   *
+   * @param timeout_ms  Maximum wait
+   * @return Status after the wait (RUNNING if it timed out)
+   */
+  ExecStatus wait(uint32_t timeout_ms);
+
+  /**
+   * @brief Ask the running job to stop
+   *
+   * Does not wait. A queued job is dropped; a running job has its current
+   * HAL delay cut short and reports ERR_ABORTED once the VM returns. With
+   * the hook alone, later delays sleep in full and abort() may be called
+   * again to end them.
+   *
+   * @return Status after the request
+   */
+  ExecStatus abort();
+
+  /**
+   * @brief Sleep in the running job, ending early if it is aborted
+   *
+   * For the HAL delay of a job, called on the worker task. Returns at once
+   * once the job has been aborted.
+   */
+  void sleep(uint32_t ms);
+
+  /**
+   * @brief Get the worker whose job runs on the calling thread
+   *
+   * @return The worker, or nullptr outside a job
+   */
+  static ExecWorker* current();
+
+  /**
+   * @brief Check whether the running job was aborted
+   *
+   * For the runner, after the VM returns: an aborted job must not publish
+   * its results (cache entries, profile counters).
+   */
+  bool aborting() const
+  {
+    return aborted_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Get the largest program in bytes
+   */
+  size_t capacity() const
+  {
+    return capacity_;
+  }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  void run();
+  ExecStatus status_locked() const;
+
+  Runner runner_;
+  std::unique_ptr<uint8_t[]> code_;
+  size_t capacity_;
+  size_t len_ = 0;
+  void (*abort_hook_)() = nullptr;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::thread thread_;
+  bool pending_ = false;
+  bool running_ = false;
+  std::atomic<bool> aborted_{false};  // Written under mutex_, read by the runner
+  bool stop_ = false;
+
+  ExecState state_ = ExecState::IDLE;
+  uint8_t result_ = 0;
+  uint16_t job_ = 0;
+  Clock::time_point started_;
+  Clock::time_point finished_;
+};
+
+}  // namespace v4ports
@@ -0,0 +1,290 @@
+/**
+ * @file v4_link_frame.cpp
+ * @brief V4-link frame decoder with bulk ingest
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include "v4_link_frame.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <utility>
+
+namespace v4ports
+{
+
+namespace
+{
+
+// CRC-8 lookup table for polynomial 0x07 (built at compile time)
+constexpr std::array<uint8_t, 256> make_crc8_table()
+{
+  std::array<uint8_t, 256> table{};
+  for (int i = 0; i < 256; ++i)
+  {
+    uint8_t crc = static_cast<uint8_t>(i);
+    for (int bit = 0; bit < 8; ++bit)
+    {
+      crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x07)
+                         : static_cast<uint8_t>(crc << 1);
+    }
+    table[i] = crc;
+  }
+  return table;
+}
+
+constexpr std::array<uint8_t, 256> CRC8_TABLE = make_crc8_table();
+
+// CRC-32 (reflected polynomial 0xEDB88320), nibble table to keep flash usage small
+constexpr uint32_t CRC32_NIBBLE_TABLE[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4,
+    0x4DB26158, 0x5005713C, 0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+    0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+}  // namespace
+
+uint8_t crc8_update(uint8_t crc, const uint8_t* data, size_t len)
+{
+  for (size_t i = 0; i < len; ++i)
+  {
+    crc = CRC8_TABLE[crc ^ data[i]];
+  }
+  return crc;
+}
+
+uint32_t crc32_update(uint32_t crc, const uint8_t* data, size_t len)
+{
+  crc = ~crc;
+  for (size_t i = 0; i < len; ++i)
+  {
+    crc ^= data[i];
+    crc = (crc >> 4) ^ CRC32_NIBBLE_TABLE[crc & 0x0F];
+    crc = (crc >> 4) ^ CRC32_NIBBLE_TABLE[crc & 0x0F];
+  }
+  return ~crc;
+}
+
+FrameDecoder::FrameDecoder(uint8_t* buffer, size_t capacity, FrameHandler on_frame,
+                           ErrorHandler on_error)
+    : buffer_(buffer),
+      capacity_(capacity),
+      on_frame_(std::move(on_frame)),
+      on_error_(std::move(on_error))
+{
+}
+
+void FrameDecoder::reset()
+{
+  state_ = State::WAIT_STX;
+  pos_ = 0;
+}
+
+void FrameDecoder::begin_payload()
+{
+  pos_ = 0;
+  route_dst_ = nullptr;
+  route_header_ = 0;
+  streaming_ = false;
+
+  if (router_)
+  {
+    size_t header = 0;
+    uint8_t* dst = router_(cmd_, len_, header);
+    if (dst != nullptr && header <= len_ && header <= capacity_)
+    {
+      route_dst_ = dst;
+      route_header_ = header;
+    }
+  }
+
+  if (route_dst_ == nullptr && stream_select_)
+  {
+    size_t header = 0;
+    if (stream_select_(cmd_, len_, header) && header <= len_ && header <= capacity_)
+    {
+      streaming_ = true;
+      route_header_ = header;
+    }
+  }
+
+  if (route_dst_ == nullptr && !streaming_ && len_ > capacity_)
+  {
+    // Skip payload and CRC so payload bytes are not mistaken for STX
+    on_error_(proto::ERR_BUFFER_FULL);
+    state_ = State::DISCARD;
+    return;
+  }
+
+  state_ = (len_ > 0) ? State::DATA : State::CRC;
+}
+
+uint8_t* FrameDecoder::payload_dest(size_t& run) const
+{
+  bool routed = route_dst_ != nullptr || streaming_;
+  if (routed && pos_ >= route_header_)
+  {
+    // Streamed bytes have no destination in memory
+    run = len_ - pos_;
+    return streaming_ ? nullptr : route_dst_ + (pos_ - route_header_);
+  }
+  run = (routed ? route_header_ : len_) - pos_;
+  return buffer_ + pos_;
+}
+
+void FrameDecoder::finish(uint8_t crc)
+{
+  state_ = State::WAIT_STX;
+  if (crc != crc_)
+  {
+    on_error_(proto::ERR_INVALID_FRAME);
+    return;
+  }
+  on_frame_(cmd_, buffer_, len_);
+}
+
+void FrameDecoder::step(uint8_t byte)
+{
+  switch (state_)
+  {
+    case State::WAIT_STX:
+      if (byte == proto::STX)
+      {
+        state_ = State::LEN_L;
+        crc_ = 0;
+      }
+      else
+      {
+        discarded_++;
+      }
+      break;
+
+    case State::LEN_L:
+      len_ = byte;
+      crc_ = CRC8_TABLE[crc_ ^ byte];
+      state_ = State::LEN_H;
+      break;
+
+    case State::LEN_H:
+      len_ |= static_cast<uint16_t>(byte) << 8;
+      crc_ = CRC8_TABLE[crc_ ^ byte];
+      state_ = State::CMD;
+      break;
+
+    case State::CMD:
+      cmd_ = byte;
+      crc_ = CRC8_TABLE[crc_ ^ byte];
+      begin_payload();
+      break;
+
+    case State::DATA:
+    {
+      size_t run;
+      uint8_t* dst = payload_dest(run);
+      if (dst != nullptr)
+      {
+        *dst = byte;
+      }
+      else
+      {
+        stream_(&byte, 1);
+      }
+      pos_++;
+      crc_ = CRC8_TABLE[crc_ ^ byte];
+      if (pos_ == len_)
+      {
+        state_ = State::CRC;
+      }
+      break;
+    }
+
+    case State::CRC:
+      finish(byte);
+      break;
+
+    case State::DISCARD:
+      if (++pos_ == static_cast<size_t>(len_) + 1)
+      {
+        state_ = State::WAIT_STX;
+      }
+      break;
+  }
+}
+
+void FrameDecoder::feed_byte(uint8_t byte)
+{
+  step(byte);
+}
+
+void FrameDecoder::feed(const uint8_t* data, size_t len)
+{
+  const uint8_t* p = data;
+  const uint8_t* end = data + len;
+
+  while (p < end)
+  {
+    switch (state_)
+    {
+      case State::WAIT_STX:
+      {
+        // Resync: jump straight to the next STX candidate
+        const void* stx = std::memchr(p, proto::STX, static_cast<size_t>(end - p));
+        if (stx == nullptr)
+        {
+          discarded_ += static_cast<uint32_t>(end - p);
+          return;
+        }
+        discarded_ += static_cast<uint32_t>(static_cast<const uint8_t*>(stx) - p);
+        p = static_cast<const uint8_t*>(stx);
+        step(*p++);
+        break;
+      }
+
+      case State::DATA:
+      {
+        // Copy the whole available payload run at once
+        size_t run;
+        uint8_t* dst = payload_dest(run);
+        size_t n = std::min(run, static_cast<size_t>(end - p));
+        if (dst != nullptr)
+        {
+          std::memcpy(dst, p, n);
+        }
+        else
+        {
+          stream_(p, n);
+        }
+        crc_ = crc8_update(crc_, p, n);
+        pos_ += n;
+        p += n;
+        if (pos_ == len_)
+        {
+          state_ = State::CRC;
+        }
+        break;
+      }
+
+      case State::DISCARD:
+      {
+        size_t n = std::min(static_cast<size_t>(len_) + 1 - pos_,
+                            static_cast<size_t>(end - p));
+        pos_ += n;
+        p += n;
+        if (pos_ == static_cast<size_t>(len_) + 1)
+        {
+          state_ = State::WAIT_STX;
+        }
+        break;
+      }
+
+      default:
+        step(*p++);
+        break;
+    }
+  }
+}
+
+}  // namespace v4ports
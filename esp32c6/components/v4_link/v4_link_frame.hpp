@@ -0,0 +1,297 @@
+/**
+ * @file v4_link_frame.hpp
+ * @brief V4-link frame decoder with bulk ingest
+ *
+ * Portable (no ESP-IDF dependencies) so it can be built and benchmarked
+ * on a Linux host as well as on the target.
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+namespace v4ports
+{
+
+/**
+ * @brief V4-link wire protocol constants
+ *
+ * Frame: [STX(0xA5)][LEN_L][LEN_H][CMD][DATA...][CRC8]
+ * CRC-8 (polynomial 0x07) covers LEN_L through the last DATA byte.
+ */
+namespace proto
+{
+
+constexpr uint8_t STX = 0xA5;
+
+// Commands
+constexpr uint8_t CMD_EXEC = 0x10;
+constexpr uint8_t CMD_PING = 0x20;
+constexpr uint8_t CMD_RESET = 0xFF;
+
+// Chunked upload (programs larger than one frame)
+// BEGIN:  [TOTAL_LEN u32 LE]
+// CHUNK:  [SEQ u16 LE][DATA...]   SEQ starts at 0 and increments per chunk
+// COMMIT: [CRC32 u32 LE]          CRC-32 (IEEE) of the whole image; executes it
+//         [CRC32 u32 LE][FLAGS u8] with COMMIT_LOAD: loads it like LOAD instead
+constexpr uint8_t CMD_BEGIN = 0x11;
+constexpr uint8_t CMD_CHUNK = 0x12;
+constexpr uint8_t CMD_COMMIT = 0x13;
+constexpr size_t CHUNK_HEADER_LEN = 2;
+constexpr uint8_t COMMIT_LOAD = 0x01;
+
+// Tagged (pipelined) frames
+// TAGGED: [SEQ u8][CMD][DATA...]  wraps any other command with a sequence ID
+// Acknowledgements are batched into one frame: [STX][LEN_L][LEN_H][SEQ ERR]...[CRC8]
+// (LEN = 2 * count; plain responses always have LEN = 1). Tagged frames are
+// executed strictly in SEQ order: a gap is answered with ERR_SEQUENCE, and a
+// repeat of one of the last TAG_WINDOW_MAX frames is re-acknowledged with its
+// original result without executing it again. A tagged PING (re)starts the
+// sequence at its SEQ.
+constexpr uint8_t CMD_TAGGED = 0x14;
+constexpr size_t TAG_HEADER_LEN = 2;
+constexpr size_t TAG_WINDOW_MAX = 16;
+
+// Run a cached program: [HASH u64 LE] (program_hash() of its bytes).
+// Every program executed by EXEC or COMMIT is added to the cache.
+constexpr uint8_t CMD_EXEC_HASH = 0x15;
+
+// Commands that return data answer with a data response instead of a plain
+// one: [STX][LEN_L][LEN_H][ERR][DATA...][CRC8] (LEN = 1 + data length). They
+// are not accepted inside TAGGED frames.
+
+// Dump the execution profile: [FLAGS u8] (optional). Data: Profiler::encode().
+// Answered with ERR_ERROR if profiling is not compiled in, and with ERR_BUSY
+// while an asynchronous job runs.
+constexpr uint8_t CMD_PROFILE = 0x16;
+constexpr uint8_t PROFILE_CLEAR = 0x01;  // Clear the profile after dumping it
+
+// Dump link telemetry: [FLAGS u8] (optional). Data: LinkTelemetry::encode().
+constexpr uint8_t CMD_STATS = 0x17;
+constexpr uint8_t STATS_RESET = 0x01;  // Reset the telemetry after dumping it
+
+// Asynchronous execution (needs an ExecWorker)
+// EXEC_ASYNC:  [CODE...]          queue a program and answer at once
+// EXEC_STATUS: (empty)            data: [STATE u8][RESULT u8][JOB u16][ELAPSED_MS u32]
+// EXEC_WAIT:   [TIMEOUT_MS u16]   wait for the job, then answer like EXEC_STATUS
+// EXEC_ABORT:  (empty)            ask the job to stop (ExecWorker::abort()),
+//                                 then answer like EXEC_STATUS
+// While a job runs, commands that use the VM are answered with ERR_BUSY.
+constexpr uint8_t CMD_EXEC_ASYNC = 0x18;
+constexpr uint8_t CMD_EXEC_STATUS = 0x19;
+constexpr uint8_t CMD_EXEC_WAIT = 0x1A;
+constexpr uint8_t CMD_EXEC_ABORT = 0x1B;
+constexpr size_t EXEC_STATUS_LEN = 8;
+
+// Load a linkable image (v4_image.h): [IMAGE...]
+// Data: [COUNT u16][WID u16 x COUNT], the word id of every word of the image.
+// Images larger than one frame are uploaded with BEGIN / CHUNK and a
+// COMMIT carrying COMMIT_LOAD.
+constexpr uint8_t CMD_LOAD = 0x1C;
+
+// Execute a compressed program: [RAW_LEN u16 LE][LZ stream] (v4_link_lz.hpp).
+// The stream is decompressed into the bytecode buffer while the frame
+// arrives, so the frame itself may be longer than the buffer; RAW_LEN must
+// fit the buffer less the header. Not accepted inside TAGGED frames.
+constexpr uint8_t CMD_EXEC_LZ = 0x1D;
+constexpr size_t LZ_HEADER_LEN = 2;
+
+// Error codes
+constexpr uint8_t ERR_OK = 0x00;
+constexpr uint8_t ERR_ERROR = 0x01;
+constexpr uint8_t ERR_INVALID_FRAME = 0x02;
+constexpr uint8_t ERR_BUFFER_FULL = 0x03;
+constexpr uint8_t ERR_VM_ERROR = 0x04;
+constexpr uint8_t ERR_SEQUENCE = 0x05;
+constexpr uint8_t ERR_CHECKSUM = 0x06;
+constexpr uint8_t ERR_NOT_FOUND = 0x07;
+constexpr uint8_t ERR_BUSY = 0x08;
+constexpr uint8_t ERR_ABORTED = 0x09;
+
+}  // namespace proto
+
+/**
+ * @brief Update CRC-8 (polynomial 0x07, init 0x00) over a byte range
+ *
+ * Table-driven; pass the previous result as @p crc to continue a running CRC.
+ */
+uint8_t crc8_update(uint8_t crc, const uint8_t* data, size_t len);
+
+/**
+ * @brief Update CRC-32 (IEEE 802.3, reflected) over a byte range
+ *
+ * Start with @p crc = 0; the result is final (pre/post inversion is applied
+ * internally), so it can be chained across calls.
+ */
+uint32_t crc32_update(uint32_t crc, const uint8_t* data, size_t len);
+
+/**
+ * @brief Streaming V4-link frame decoder
+ *
+ * Payload bytes are written straight into a caller-owned buffer, so a
+ * complete frame is handed to the frame handler without further copies.
+ *
+ * Two ingest paths are provided:
+ * - feed_byte(): one state machine step per byte (reference path)
+ * - feed():      bulk path; memchr() resync to STX and memcpy() of payload runs
+ *
+ * Both paths produce identical results for any input split.
+ *
+ * An optional payload router can redirect the payload of selected commands
+ * past a small header to another destination (e.g. an upload region in VM
+ * memory), so large transfers never pass through the frame buffer. A
+ * payload stream goes one step further and hands those bytes to a consumer
+ * (e.g. a decompressor) as they arrive.
+ */
+class FrameDecoder
+{
+ public:
+  /// Called for every frame that passed the CRC check
+  using FrameHandler =
+      std::function<void(uint8_t cmd, const uint8_t* payload, size_t len)>;
+
+  /// Called when a frame is rejected (ERR_INVALID_FRAME or ERR_BUFFER_FULL)
+  using ErrorHandler = std::function<void(uint8_t err)>;
+
+  /**
+   * @brief Chooses where a frame's payload is written
+   *
+   * Called once the command byte is known. Return nullptr to receive the
+   * whole payload in the frame buffer. Otherwise the first @p header_len
+   * bytes go to the frame buffer and the rest to the returned pointer,
+   * which must have room for (len - header_len) bytes.
+   */
+  using PayloadRouter =
+      std::function<uint8_t*(uint8_t cmd, size_t len, size_t& header_len)>;
+
+  /**
+   * @brief Chooses whether a frame's payload is streamed
+   *
+   * Called when the router did not take the frame. Return true to have the
+   * first @p header_len bytes written to the frame buffer and the rest
+   * passed to the PayloadStream in arrival order, before the CRC is checked.
+   */
+  using StreamSelector =
+      std::function<bool(uint8_t cmd, size_t len, size_t& header_len)>;
+
+  /// Receives the streamed part of a payload
+  using PayloadStream = std::function<void(const uint8_t* data, size_t len)>;
+
+  /**
+   * @brief Construct decoder over a payload buffer
+   *
+   * @param buffer    Payload buffer (must outlive the decoder)
+   * @param capacity  Payload buffer size in bytes
+   * @param on_frame  Handler for valid frames
+   * @param on_error  Handler for rejected frames
+   */
+  FrameDecoder(uint8_t* buffer, size_t capacity, FrameHandler on_frame,
+               ErrorHandler on_error);
+
+  /**
+   * @brief Install a payload router (see PayloadRouter)
+   */
+  void set_router(PayloadRouter router)
+  {
+    router_ = std::move(router);
+  }
+
+  /**
+   * @brief Install a payload stream (see StreamSelector)
+   *
+   * As with a router, the frame handler receives the frame buffer (holding
+   * the header only) and the full payload length.
+   */
+  void set_stream(StreamSelector select, PayloadStream stream)
+  {
+    stream_select_ = std::move(select);
+    stream_ = std::move(stream);
+  }
+
+  /**
+   * @brief Feed a single byte
+   */
+  void feed_byte(uint8_t byte);
+
+  /**
+   * @brief Feed a span of bytes
+   *
+   * @param data  Received bytes
+   * @param len   Number of bytes
+   */
+  void feed(const uint8_t* data, size_t len);
+
+  /**
+   * @brief Drop any partially received frame and wait for STX
+   */
+  void reset();
+
+  /**
+   * @brief Check whether a frame is partially received
+   */
+  bool in_frame() const
+  {
+    return state_ != State::WAIT_STX;
+  }
+
+  /**
+   * @brief Get the number of bytes skipped while waiting for STX
+   *
+   * Counts up from construction and wraps; callers diff successive values.
+   */
+  uint32_t discarded() const
+  {
+    return discarded_;
+  }
+
+  /**
+   * @brief Get payload buffer capacity
+   */
+  size_t capacity() const
+  {
+    return capacity_;
+  }
+
+ private:
+  enum class State : uint8_t
+  {
+    WAIT_STX,
+    LEN_L,
+    LEN_H,
+    CMD,
+    DATA,
+    CRC,
+    DISCARD,
+  };
+
+  void step(uint8_t byte);
+  void begin_payload();
+  void finish(uint8_t crc);
+  uint8_t* payload_dest(size_t& run) const;
+
+  uint8_t* buffer_;
+  size_t capacity_;
+  FrameHandler on_frame_;
+  ErrorHandler on_error_;
+  PayloadRouter router_;
+  StreamSelector stream_select_;
+  PayloadStream stream_;
+
+  State state_ = State::WAIT_STX;
+  uint8_t cmd_ = 0;
+  uint8_t crc_ = 0;
+  uint16_t len_ = 0;
+  size_t pos_ = 0;
+  uint8_t* route_dst_ = nullptr;
+  size_t route_header_ = 0;
+  bool streaming_ = false;
+  uint32_t discarded_ = 0;
+};
+
+}  // namespace v4ports
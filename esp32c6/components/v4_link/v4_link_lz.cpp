@@ -0,0 +1,280 @@
+/**
+ * @file v4_link_lz.cpp
+ * @brief LZ codec for compressed V4-link payloads
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include "v4_link_lz.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace v4ports
+{
+
+namespace
+{
+
+constexpr size_t NIBBLE_MAX = 15;
+constexpr int HASH_BITS = 12;
+constexpr size_t MAX_INPUT = 0xFFFF;
+
+uint32_t hash4(const uint8_t* p)
+{
+  uint32_t v = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+               ((uint32_t)p[3] << 24);
+  return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+// Bounded output writer; overflow sticks
+struct Writer
+{
+  uint8_t* out;
+  size_t cap;
+  size_t len = 0;
+  bool overflow = false;
+
+  void put(uint8_t byte)
+  {
+    if (len < cap)
+    {
+      out[len++] = byte;
+    }
+    else
+    {
+      overflow = true;
+    }
+  }
+
+  void put(const uint8_t* data, size_t n)
+  {
+    if (n > cap - len)
+    {
+      overflow = true;
+      return;
+    }
+    std::memcpy(out + len, data, n);
+    len += n;
+  }
+
+  // Length beyond a nibble: 255 per byte until the last
+  void put_ext(size_t v)
+  {
+    for (; v >= 255; v -= 255)
+    {
+      put(255);
+    }
+    put(static_cast<uint8_t>(v));
+  }
+
+  void sequence(const uint8_t* literals, size_t lit_len, size_t offset, size_t match_len)
+  {
+    size_t m = (match_len != 0) ? match_len - LZ_MIN_MATCH : 0;
+    put(static_cast<uint8_t>((std::min(lit_len, NIBBLE_MAX) << 4) |
+                             std::min(m, NIBBLE_MAX)));
+    if (lit_len >= NIBBLE_MAX)
+    {
+      put_ext(lit_len - NIBBLE_MAX);
+    }
+    put(literals, lit_len);
+    if (match_len == 0)
+    {
+      return;
+    }
+    put(static_cast<uint8_t>(offset));
+    put(static_cast<uint8_t>(offset >> 8));
+    if (m >= NIBBLE_MAX)
+    {
+      put_ext(m - NIBBLE_MAX);
+    }
+  }
+};
+
+}  // namespace
+
+size_t lz_compress(const uint8_t* in, size_t len, uint8_t* out, size_t cap)
+{
+  if (len > MAX_INPUT)
+  {
+    return 0;
+  }
+
+  // Last position + 1 of each hashed 4-byte prefix (0 = none)
+  uint32_t table[1u << HASH_BITS] = {};
+  Writer w{out, cap};
+  size_t anchor = 0;
+  size_t i = 0;
+
+  while (i + LZ_MIN_MATCH <= len)
+  {
+    uint32_t h = hash4(in + i);
+    size_t cand = table[h];
+    table[h] = static_cast<uint32_t>(i + 1);
+    if (cand == 0 || i - (cand - 1) > LZ_WINDOW ||
+        std::memcmp(in + cand - 1, in + i, LZ_MIN_MATCH) != 0)
+    {
+      i++;
+      continue;
+    }
+    cand--;
+
+    size_t match = LZ_MIN_MATCH;
+    while (i + match < len && in[cand + match] == in[i + match])
+    {
+      match++;
+    }
+    w.sequence(in + anchor, i - anchor, i - cand, match);
+
+    // Index the matched positions so later repeats find the nearest copy
+    for (size_t k = i + 1; k < i + match && k + LZ_MIN_MATCH <= len; k++)
+    {
+      table[hash4(in + k)] = static_cast<uint32_t>(k + 1);
+    }
+    i += match;
+    anchor = i;
+  }
+
+  // Final sequence: the remaining literals, no match
+  w.sequence(in + anchor, len - anchor, 0, 0);
+  return w.overflow ? 0 : w.len;
+}
+
+void LzDecoder::begin(uint8_t* out, size_t total)
+{
+  out_ = out;
+  total_ = total;
+  pos_ = 0;
+  count_ = 0;
+  state_ = State::TOKEN;
+}
+
+LzDecoder::State LzDecoder::after_literals() const
+{
+  return (pos_ == total_) ? State::END : State::OFFSET_L;
+}
+
+bool LzDecoder::copy_match()
+{
+  if (count_ > total_ - pos_)
+  {
+    return false;
+  }
+  uint8_t* dst = out_ + pos_;
+  const uint8_t* src = dst - offset_;
+  if (offset_ >= count_)
+  {
+    std::memcpy(dst, src, count_);
+  }
+  else
+  {
+    // Overlapping: byte by byte repeats the last offset_ bytes
+    for (size_t k = 0; k < count_; k++)
+    {
+      dst[k] = src[k];
+    }
+  }
+  pos_ += count_;
+  return true;
+}
+
+bool LzDecoder::feed(const uint8_t* in, size_t len)
+{
+  const uint8_t* p = in;
+  const uint8_t* end = in + len;
+
+  while (p < end)
+  {
+    switch (state_)
+    {
+      case State::TOKEN:
+        token_ = *p++;
+        count_ = token_ >> 4;
+        if (count_ == NIBBLE_MAX)
+        {
+          state_ = State::LIT_EXT;
+        }
+        else
+        {
+          state_ = (count_ > 0) ? State::LITERALS : after_literals();
+        }
+        break;
+
+      case State::LIT_EXT:
+        count_ += *p;
+        state_ = (*p++ == 255) ? State::LIT_EXT : State::LITERALS;
+        break;
+
+      case State::LITERALS:
+      {
+        size_t n = std::min(count_, static_cast<size_t>(end - p));
+        if (n > total_ - pos_)
+        {
+          state_ = State::FAILED;
+          return false;
+        }
+        std::memcpy(out_ + pos_, p, n);
+        pos_ += n;
+        p += n;
+        count_ -= n;
+        if (count_ == 0)
+        {
+          state_ = after_literals();
+        }
+        break;
+      }
+
+      case State::OFFSET_L:
+        offset_ = *p++;
+        state_ = State::OFFSET_H;
+        break;
+
+      case State::OFFSET_H:
+        offset_ |= static_cast<uint16_t>(*p++ << 8);
+        if (offset_ == 0 || offset_ > pos_)
+        {
+          state_ = State::FAILED;
+          return false;
+        }
+        count_ = (token_ & NIBBLE_MAX) + LZ_MIN_MATCH;
+        if ((token_ & NIBBLE_MAX) == NIBBLE_MAX)
+        {
+          state_ = State::MATCH_EXT;
+        }
+        else if (copy_match())
+        {
+          state_ = State::TOKEN;
+        }
+        else
+        {
+          state_ = State::FAILED;
+          return false;
+        }
+        break;
+
+      case State::MATCH_EXT:
+        count_ += *p;
+        if (*p++ == 255)
+        {
+          break;
+        }
+        if (!copy_match())
+        {
+          state_ = State::FAILED;
+          return false;
+        }
+        state_ = State::TOKEN;
+        break;
+
+      case State::END:
+      case State::FAILED:
+        // Data after the end, or a stream already rejected
+        state_ = State::FAILED;
+        return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace v4ports
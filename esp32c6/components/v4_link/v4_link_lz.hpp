@@ -0,0 +1,136 @@
+/**
+ * @file v4_link_lz.hpp
+ * @brief LZ codec for compressed V4-link payloads
+ *
+ * A stream is a sequence of LZ4-style sequences:
+ *
+ *   [TOKEN][LIT_EXT...][LITERALS...][OFFSET u16 LE][MATCH_EXT...]
+ *
+ * The high nibble of TOKEN is the literal count, the low nibble the match
+ * length minus LZ_MIN_MATCH; a nibble of 15 is followed by extension bytes
+ * that are added to it, each 255 except the last. A match copies from
+ * OFFSET bytes back in the output (overlapping copies repeat a pattern).
+ * The decompressed size is sent separately, and the stream ends when it is
+ * reached, right after the literals of the last sequence.
+ *
+ * Matches only reach back into output already produced, so the
+ * decompressed program is its own window: the decoder keeps no history
+ * buffer and a few bytes of state. The compressor limits offsets to
+ * LZ_WINDOW, which keeps its search table small.
+ *
+ * Portable (no ESP-IDF dependencies).
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace v4ports
+{
+
+/// Shortest match the format encodes
+constexpr size_t LZ_MIN_MATCH = 4;
+
+/// Largest match offset the compressor emits
+constexpr size_t LZ_WINDOW = 4096;
+
+/**
+ * @brief Worst-case compressed size of @p len bytes
+ */
+constexpr size_t lz_bound(size_t len)
+{
+  return len + len / 255 + 16;
+}
+
+/**
+ * @brief Compress a buffer (greedy, single pass)
+ *
+ * Meant for host tools and tests; the device only decompresses.
+ *
+ * @param in    Input
+ * @param len   Input length (at most 65535 bytes)
+ * @param out   Output
+ * @param cap   Output capacity (lz_bound(len) always suffices)
+ * @return Compressed length, or 0 if it does not fit or @p len is too large
+ */
+size_t lz_compress(const uint8_t* in, size_t len, uint8_t* out, size_t cap);
+
+/**
+ * @brief Streaming decompressor
+ *
+ * The compressed stream may be fed in pieces of any size; output is
+ * written straight to the destination buffer as the pieces arrive.
+ */
+class LzDecoder
+{
+ public:
+  /**
+   * @brief Start a stream
+   *
+   * @param out    Destination (must hold @p total bytes)
+   * @param total  Decompressed size
+   */
+  void begin(uint8_t* out, size_t total);
+
+  /**
+   * @brief Decode the next piece of the stream
+   *
+   * @return false once the stream is malformed (bad offset, output past
+   *         @p total, data after the end); later calls keep failing
+   */
+  bool feed(const uint8_t* in, size_t len);
+
+  /**
+   * @brief Check whether the whole output has been produced
+   */
+  bool done() const
+  {
+    return state_ == State::END;
+  }
+
+  /**
+   * @brief Check whether the stream was rejected
+   */
+  bool failed() const
+  {
+    return state_ == State::FAILED;
+  }
+
+  /**
+   * @brief Get the number of bytes written so far
+   */
+  size_t produced() const
+  {
+    return pos_;
+  }
+
+ private:
+  enum class State : uint8_t
+  {
+    TOKEN,
+    LIT_EXT,
+    LITERALS,
+    OFFSET_L,
+    OFFSET_H,
+    MATCH_EXT,
+    END,
+    FAILED,
+  };
+
+  bool copy_match();
+  State after_literals() const;
+
+  uint8_t* out_ = nullptr;
+  size_t total_ = 0;
+  size_t pos_ = 0;
+  size_t count_ = 0;  // Literal count or match length being decoded
+  uint8_t token_ = 0;
+  uint16_t offset_ = 0;
+  State state_ = State::END;
+};
+
+}  // namespace v4ports
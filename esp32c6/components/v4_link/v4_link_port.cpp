@@ -1,6 +1,6 @@
 /**
  * @file v4_link_port.cpp
- * @brief V4-link port implementation for ESP32-C6
+ * @brief V4-link port implementation
  *
  * @copyright Copyright 2025 Akihito Kirisaki
  * @license Dual-licensed under MIT or Apache-2.0
@@ -8,83 +8,827 @@
 
 #include "v4_link_port.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
+#include <utility>
 
 #include "esp_log.h"
+#include "v4_image.h"
 
 static const char* TAG = "v4_link_port";
 
 namespace v4ports
 {
 
-Esp32c6LinkPort::Esp32c6LinkPort(Vm* vm, size_t buffer_size) : link_(nullptr)
+namespace
 {
-  // Assert on null VM pointer (programming error)
+
+// Largest DATA of a response other than PROFILE: STATS or the ids of LOAD
+constexpr size_t DATA_LEN_MAX =
+    std::max(LinkTelemetry::ENCODED_LEN, 2 + 2 * LinkPort::IMAGE_WORDS_MAX);
+
+}  // namespace
+
+LinkPort::LinkPort(Vm* vm, std::unique_ptr<Transport> transport, size_t buffer_size)
+    : vm_(vm),
+      transport_(std::move(transport)),
+      buffer_(new uint8_t[buffer_size]),
+      rx_buf_(new uint8_t[RX_CHUNK_SIZE]),
+      decoder_(
+          buffer_.get(), buffer_size,
+          [this](uint8_t cmd, const uint8_t* payload, size_t len)
+          {
+            // Timed from the frame's last byte, not from the start of the span
+            uint64_t t_frame = telemetry_.now();
+            dispatch(cmd, payload, len);
+            telemetry_.record(LinkTelemetry::DECODE, t_frame);
+          },
+          [this](uint8_t err) { decode_error(err); }),
+      data_frame_(new uint8_t[DATA_LEN_MAX + 5])
+{
+  // Assert on null VM/transport pointer (programming error)
   assert(vm != nullptr && "VM pointer must not be null");
+  assert(transport_ != nullptr && "Transport must not be null");
+
+  decoder_.set_router([this](uint8_t cmd, size_t len, size_t& header_len)
+                      { return route(cmd, len, header_len); });
+  decoder_.set_stream([this](uint8_t cmd, size_t len, size_t& header_len)
+                      { return stream_select(cmd, len, header_len); },
+                      [this](const uint8_t* data, size_t len) { stream(data, len); });
+
+  ESP_LOGI(TAG, "V4-link initialized (buffer: %u bytes)", (unsigned)buffer_size);
+}
+
+size_t LinkPort::poll(uint32_t timeout_ms)
+{
+  size_t total = 0;
+
+  // Drain everything the transport has buffered; only the first read may block
+  while (true)
+  {
+    uint32_t wait = (total == 0) ? timeout_ms : 0;
+    int len = transport_->read(rx_buf_.get(), RX_CHUNK_SIZE, wait);
+    if (len <= 0)
+    {
+      if (total == 0 && timeout_ms > 0)
+      {
+        rx_idle();
+      }
+      // Retry output the host was not ready for
+      transport_->flush();
+      break;
+    }
+
+    feed(rx_buf_.get(), static_cast<size_t>(len));
+    total += static_cast<size_t>(len);
+
+    if (static_cast<size_t>(len) < RX_CHUNK_SIZE)
+    {
+      break;
+    }
+  }
+
+  return total;
+}
+
+void LinkPort::rx_idle()
+{
+  if (decoder_.in_frame())
+  {
+    telemetry_.add(LinkTelemetry::IDLE_DROPS);
+    ESP_LOGW(TAG, "RX idle mid-frame, dropping partial frame");
+    decoder_.reset();
+  }
+  // The worker inserts into the cache while it runs a job
+  if (cache_ != nullptr && !vm_busy())
+  {
+    cache_->flush();
+  }
+}
+
+void LinkPort::set_upload_region(uint8_t* base, size_t size)
+{
+  upload_base_ = base;
+  upload_size_ = (base != nullptr) ? size : 0;
+  upload_active_ = false;
+}
+
+void LinkPort::set_image_store(uint8_t* base, size_t size)
+{
+  image_base_ = base;
+  image_size_ = (base != nullptr) ? size : 0;
+  image_used_ = 0;
+  if (base != nullptr && image_wids_ == nullptr)
+  {
+    image_wids_.reset(new int[IMAGE_WORDS_MAX]);
+  }
+}
+
+void LinkPort::set_profiler(Profiler* profiler)
+{
+#if V4_LINK_PROFILE
+  profiler_ = profiler;
+  if (profiler != nullptr && profiler->encoded_size_max() > DATA_LEN_MAX)
+  {
+    // Data response framing: STX, LEN (2), ERR, CRC
+    data_frame_.reset(new uint8_t[profiler->encoded_size_max() + 5]);
+  }
+#else
+  (void)profiler;
+#endif
+}
 
-  // USB Serial/JTAG configuration
-  usb_serial_jtag_driver_config_t usb_config = {
-      .tx_buffer_size = USB_BUF_SIZE,
-      .rx_buffer_size = USB_BUF_SIZE,
-  };
+void LinkPort::set_exec_worker(ExecWorker* worker)
+{
+  worker_ = worker;
+  if (worker != nullptr)
+  {
+    worker->set_runner([this, worker](const uint8_t* code, size_t len)
+                       { return execute_and_cache(code, len, worker); });
+  }
+}
 
-  // Install USB Serial/JTAG driver
-  esp_err_t ret = usb_serial_jtag_driver_install(&usb_config);
-  if (ret != ESP_OK)
+bool LinkPort::vm_busy() const
+{
+  return worker_ != nullptr && worker_->busy();
+}
+
+void LinkPort::feed(const uint8_t* data, size_t len)
+{
+  telemetry_.add(LinkTelemetry::RX_BYTES, static_cast<uint32_t>(len));
+  decoder_.feed(data, len);
+  count_discarded();
+  flush_acks();
+  transport_->flush();
+}
+
+void LinkPort::feed_byte(uint8_t byte)
+{
+  telemetry_.add(LinkTelemetry::RX_BYTES);
+  decoder_.feed_byte(byte);
+  count_discarded();
+  flush_acks();
+  transport_->flush();
+}
+
+void LinkPort::count_discarded()
+{
+  uint32_t discarded = decoder_.discarded();
+  if (discarded != discarded_seen_)
   {
-    ESP_LOGE(TAG, "Failed to install USB Serial/JTAG driver: %s", esp_err_to_name(ret));
-    abort();
+    telemetry_.add(LinkTelemetry::RX_DISCARDED, discarded - discarded_seen_);
+    discarded_seen_ = discarded;
   }
+}
 
-  // Create V4-link instance with USB Serial/JTAG write callback
-  link_ = std::make_unique<v4::link::Link>(
-      vm,
-      [](const uint8_t* data, size_t len)
+void LinkPort::decode_error(uint8_t err)
+{
+  telemetry_.add((err == proto::ERR_BUFFER_FULL) ? LinkTelemetry::OVERSIZED
+                                                 : LinkTelemetry::CRC_ERRORS);
+  respond(err);
+}
+
+void LinkPort::dispatch(uint8_t cmd, const uint8_t* payload, size_t len)
+{
+  telemetry_.add(LinkTelemetry::FRAMES);
+
+  if (cmd == proto::CMD_TAGGED)
+  {
+    tagged(payload, len);
+    return;
+  }
+  if (cmd == proto::CMD_PROFILE)
+  {
+    profile(payload, len);
+    return;
+  }
+  if (cmd == proto::CMD_STATS)
+  {
+    report_stats(payload, len);
+    return;
+  }
+  if (cmd == proto::CMD_EXEC_STATUS || cmd == proto::CMD_EXEC_WAIT ||
+      cmd == proto::CMD_EXEC_ABORT)
+  {
+    exec_control(cmd, payload, len);
+    return;
+  }
+  if (cmd == proto::CMD_LOAD)
+  {
+    if (vm_busy())
+    {
+      respond(proto::ERR_BUSY);
+      return;
+    }
+    load_image(payload, len);
+    return;
+  }
+  if (cmd == proto::CMD_COMMIT && len == 5)
+  {
+    upload_load(payload);
+    return;
+  }
+  if (cmd == proto::CMD_EXEC_LZ)
+  {
+    respond(vm_busy() ? proto::ERR_BUSY : execute_lz(len));
+    return;
+  }
+  respond(process(cmd, payload, len));
+}
+
+uint8_t LinkPort::process(uint8_t cmd, const uint8_t* payload, size_t len)
+{
+  switch (cmd)
+  {
+    case proto::CMD_PING:
+      return proto::ERR_OK;
+
+    case proto::CMD_RESET:
+      if (vm_busy())
       {
-        // Send data via USB Serial/JTAG
-        int written = usb_serial_jtag_write_bytes((const char*)data, len, portMAX_DELAY);
-        if (written < 0)
-        {
-          ESP_LOGE(TAG, "USB Serial/JTAG write failed");
-        }
-      },
-      buffer_size);
+        return proto::ERR_BUSY;
+      }
+      vm_reset(vm_);
+      image_used_ = 0;
+      return proto::ERR_OK;
+
+    case proto::CMD_EXEC:
+      return vm_busy() ? proto::ERR_BUSY : execute_and_cache(payload, len);
+
+    case proto::CMD_EXEC_HASH:
+      return vm_busy() ? proto::ERR_BUSY : execute_hash(payload, len);
 
-  ESP_LOGI(TAG, "V4-link initialized on USB Serial/JTAG");
+    case proto::CMD_EXEC_ASYNC:
+      return (worker_ != nullptr) ? worker_->submit(payload, len) : proto::ERR_ERROR;
+
+    case proto::CMD_BEGIN:
+      return upload_begin(payload, len);
+
+    case proto::CMD_CHUNK:
+      return upload_chunk(payload, len);
+
+    case proto::CMD_COMMIT:
+      return upload_commit(payload, len);
+
+    default:
+      return proto::ERR_ERROR;
+  }
 }
 
-Esp32c6LinkPort::~Esp32c6LinkPort()
+void LinkPort::tagged(const uint8_t* payload, size_t len)
 {
-  usb_serial_jtag_driver_uninstall();
-  ESP_LOGI(TAG, "USB Serial/JTAG driver uninstalled");
+  if (len < proto::TAG_HEADER_LEN)
+  {
+    respond(proto::ERR_INVALID_FRAME);
+    return;
+  }
+
+  uint8_t seq = payload[0];
+  uint8_t cmd = payload[1];
+  uint8_t& result = tag_results_[seq % proto::TAG_WINDOW_MAX];
+
+  if (cmd == proto::CMD_PING)
+  {
+    // Tagged PING opens a new sequence
+    tag_expected_ = static_cast<uint8_t>(seq + 1);
+    tag_synced_ = true;
+    result = proto::ERR_OK;
+    queue_ack(seq, result);
+    return;
+  }
+
+  uint8_t behind = static_cast<uint8_t>(tag_expected_ - seq);
+  if (!tag_synced_ || behind > proto::TAG_WINDOW_MAX)
+  {
+    // Gap: an earlier frame was lost, host retransmits from there
+    queue_ack(seq, proto::ERR_SEQUENCE);
+    return;
+  }
+
+  if (behind != 0)
+  {
+    // Retransmission of an executed frame whose ack was lost
+    queue_ack(seq, result);
+    return;
+  }
+
+  result = (cmd == proto::CMD_TAGGED)
+               ? proto::ERR_ERROR
+               : process(cmd, payload + proto::TAG_HEADER_LEN,
+                         len - proto::TAG_HEADER_LEN);
+  tag_expected_++;
+  queue_ack(seq, result);
 }
 
-void Esp32c6LinkPort::poll()
+void LinkPort::queue_ack(uint8_t seq, uint8_t err)
 {
-  uint8_t buffer[128];
+  telemetry_.result(err);
+  uint8_t* pair = &ack_frame_[3 + 2 * ack_count_];
+  pair[0] = seq;
+  pair[1] = err;
+  if (++ack_count_ == proto::TAG_WINDOW_MAX)
+  {
+    flush_acks();
+  }
+}
 
-  // Read all available data from USB Serial/JTAG (non-blocking)
-  int len = usb_serial_jtag_read_bytes(buffer, sizeof(buffer), 0);
+void LinkPort::flush_acks()
+{
+  if (ack_count_ == 0)
+  {
+    return;
+  }
+
+  // Ack batch: [STX][LEN_L][LEN_H][SEQ ERR]...[CRC8]
+  size_t data_len = 2 * ack_count_;
+  ack_frame_[0] = proto::STX;
+  ack_frame_[1] = static_cast<uint8_t>(data_len);
+  ack_frame_[2] = 0;
+  ack_frame_[3 + data_len] = crc8_update(0, &ack_frame_[1], 2 + data_len);
+  send(ack_frame_, 4 + data_len);
+  ack_count_ = 0;
+}
 
-  if (len > 0)
+void LinkPort::profile(const uint8_t* payload, size_t len)
+{
+  if (len > 1)
   {
-    // Feed each byte to V4-link
-    for (int i = 0; i < len; ++i)
+    respond(proto::ERR_INVALID_FRAME);
+    return;
+  }
+  if (profiler_ == nullptr)
+  {
+    respond(proto::ERR_ERROR);
+    return;
+  }
+  // A running job updates the profile from the worker task
+  if (vm_busy())
+  {
+    respond(proto::ERR_BUSY);
+    return;
+  }
+
+  uint8_t* data = data_frame_.get() + 4;
+  size_t data_len = profiler_->encode(data, profiler_->encoded_size_max());
+  if (len == 1 && (payload[0] & proto::PROFILE_CLEAR) != 0)
+  {
+    profiler_->clear();
+  }
+  respond_data(proto::ERR_OK, data_len);
+}
+
+void LinkPort::report_stats(const uint8_t* payload, size_t len)
+{
+  if (len > 1)
+  {
+    respond(proto::ERR_INVALID_FRAME);
+    return;
+  }
+
+  uint8_t* data = data_frame_.get() + 4;
+  size_t data_len = telemetry_.encode(data, LinkTelemetry::ENCODED_LEN);
+  if (len == 1 && (payload[0] & proto::STATS_RESET) != 0)
+  {
+    telemetry_.reset();
+  }
+  respond_data(proto::ERR_OK, data_len);
+}
+
+void LinkPort::exec_control(uint8_t cmd, const uint8_t* payload, size_t len)
+{
+  if (worker_ == nullptr)
+  {
+    respond(proto::ERR_ERROR);
+    return;
+  }
+
+  ExecStatus status;
+  if (cmd == proto::CMD_EXEC_WAIT)
+  {
+    if (len != 2)
     {
-      link_->feed_byte(buffer[i]);
+      respond(proto::ERR_INVALID_FRAME);
+      return;
     }
+    // Responses to frames already handled go out before the link blocks
+    flush_acks();
+    transport_->flush();
+    status = worker_->wait(static_cast<uint32_t>(payload[0] | (payload[1] << 8)));
+  }
+  else if (len != 0)
+  {
+    respond(proto::ERR_INVALID_FRAME);
+    return;
+  }
+  else
+  {
+    status = (cmd == proto::CMD_EXEC_ABORT) ? worker_->abort() : worker_->status();
   }
+
+  // Status: [STATE u8][RESULT u8][JOB u16][ELAPSED_MS u32]
+  uint8_t* data = data_frame_.get() + 4;
+  data[0] = static_cast<uint8_t>(status.state);
+  data[1] = status.result;
+  data[2] = static_cast<uint8_t>(status.job);
+  data[3] = static_cast<uint8_t>(status.job >> 8);
+  for (int i = 0; i < 4; i++)
+  {
+    data[4 + i] = static_cast<uint8_t>(status.elapsed_ms >> (8 * i));
+  }
+  respond_data(proto::ERR_OK, proto::EXEC_STATUS_LEN);
+}
+
+uint8_t LinkPort::execute(const uint8_t* code, size_t len, uint64_t hash,
+                          const ExecWorker* job)
+{
+  if (len == 0)
+  {
+    return proto::ERR_INVALID_FRAME;
+  }
+
+  int wid = vm_register_word(vm_, nullptr, code, static_cast<int>(len));
+  if (wid < 0)
+  {
+    ESP_LOGE(TAG, "Failed to register bytecode (code %d)", wid);
+    return proto::ERR_VM_ERROR;
+  }
+
+#if V4_LINK_PROFILE
+  if (profiler_ != nullptr)
+  {
+    profiler_->begin(hash);
+  }
+#else
+  (void)hash;
+#endif
+
+  uint64_t t_exec = telemetry_.now();
+  v4_err err = vm_exec(vm_, vm_get_word(vm_, wid));
+  telemetry_.record(LinkTelemetry::EXEC, t_exec);
+  bool aborted = job != nullptr && job->aborting();
+
+#if V4_LINK_PROFILE
+  if (profiler_ != nullptr)
+  {
+    if (aborted)
+    {
+      profiler_->discard();
+    }
+    else
+    {
+      profiler_->end(err == 0);
+    }
+  }
+#endif
+
+  if (err != 0)
+  {
+    ESP_LOGE(TAG, "VM execution failed (code %d)", (int)err);
+    return proto::ERR_VM_ERROR;
+  }
+  return aborted ? proto::ERR_ABORTED : proto::ERR_OK;
+}
+
+uint8_t LinkPort::execute_and_cache(const uint8_t* code, size_t len,
+                                    const ExecWorker* job)
+{
+  bool hashed = (cache_ != nullptr || profiler_ != nullptr);
+  uint64_t hash = hashed ? program_hash(code, len) : 0;
+  uint8_t err = execute(code, len, hash, job);
+  // An aborted job did not run as sent, so it is neither cached nor profiled
+  if (err == proto::ERR_OK && cache_ != nullptr)
+  {
+    cache_->insert(hash, code, len);
+  }
+  return err;
+}
+
+uint8_t LinkPort::execute_hash(const uint8_t* payload, size_t len)
+{
+  if (len != 8)
+  {
+    return proto::ERR_INVALID_FRAME;
+  }
+
+  uint64_t hash = 0;
+  for (int i = 7; i >= 0; --i)
+  {
+    hash = (hash << 8) | payload[i];
+  }
+
+  size_t code_len = 0;
+  const uint8_t* code = (cache_ != nullptr) ? cache_->lookup(hash, code_len) : nullptr;
+  if (code == nullptr)
+  {
+    return proto::ERR_NOT_FOUND;
+  }
+  return execute(code, code_len, hash);
+}
+
+uint8_t* LinkPort::route(uint8_t cmd, size_t len, size_t& header_len)
+{
+  chunk_routed_ = false;
+  if (cmd != proto::CMD_CHUNK || !upload_active_ || len < proto::CHUNK_HEADER_LEN)
+  {
+    return nullptr;
+  }
+
+  size_t data_len = len - proto::CHUNK_HEADER_LEN;
+  if (upload_received_ + data_len > upload_total_)
+  {
+    return nullptr;
+  }
+
+  // Chunk data lands directly at its final position in the upload region
+  chunk_routed_ = true;
+  header_len = proto::CHUNK_HEADER_LEN;
+  return upload_base_ + upload_received_;
+}
+
+bool LinkPort::stream_select(uint8_t cmd, size_t len, size_t& header_len)
+{
+  if (cmd != proto::CMD_EXEC_LZ || len < proto::LZ_HEADER_LEN)
+  {
+    return false;
+  }
+  lz_started_ = false;
+  lz_oversized_ = false;
+  header_len = proto::LZ_HEADER_LEN;
+  return true;
+}
+
+void LinkPort::stream(const uint8_t* data, size_t len)
+{
+  if (!lz_started_)
+  {
+    // The header is complete once the first stream byte arrives
+    lz_started_ = true;
+    size_t raw_len = buffer_[0] | (buffer_[1] << 8);
+    lz_oversized_ = raw_len > decoder_.capacity() - proto::LZ_HEADER_LEN;
+    lz_.begin(buffer_.get() + proto::LZ_HEADER_LEN, lz_oversized_ ? 0 : raw_len);
+  }
+  if (!lz_oversized_)
+  {
+    lz_.feed(data, len);
+  }
+}
+
+uint8_t LinkPort::execute_lz(size_t len)
+{
+  if (len <= proto::LZ_HEADER_LEN || !lz_started_)
+  {
+    return proto::ERR_INVALID_FRAME;
+  }
+  if (lz_oversized_)
+  {
+    return proto::ERR_BUFFER_FULL;
+  }
+  if (!lz_.done())
+  {
+    ESP_LOGE(TAG, "Malformed compressed program");
+    return proto::ERR_INVALID_FRAME;
+  }
+  telemetry_.add(LinkTelemetry::LZ_RAW_BYTES, static_cast<uint32_t>(lz_.produced()));
+  telemetry_.add(LinkTelemetry::LZ_WIRE_BYTES, static_cast<uint32_t>(len));
+  return execute_and_cache(buffer_.get() + proto::LZ_HEADER_LEN, lz_.produced());
+}
+
+uint8_t LinkPort::upload_begin(const uint8_t* payload, size_t len)
+{
+  if (len != 4)
+  {
+    return proto::ERR_INVALID_FRAME;
+  }
+
+  size_t total = (size_t)payload[0] | ((size_t)payload[1] << 8) |
+                 ((size_t)payload[2] << 16) | ((size_t)payload[3] << 24);
+  if (total == 0 || total > upload_size_)
+  {
+    upload_active_ = false;
+    return proto::ERR_BUFFER_FULL;
+  }
+
+  upload_total_ = total;
+  upload_received_ = 0;
+  upload_next_seq_ = 0;
+  upload_active_ = true;
+  return proto::ERR_OK;
+}
+
+uint8_t LinkPort::upload_chunk(const uint8_t* payload, size_t len)
+{
+  if (!upload_active_ || len < proto::CHUNK_HEADER_LEN)
+  {
+    return proto::ERR_SEQUENCE;
+  }
+
+  uint16_t seq = (uint16_t)(payload[0] | (payload[1] << 8));
+
+  // Retransmission of the last accepted chunk (its response was lost)
+  if (seq == (uint16_t)(upload_next_seq_ - 1) && upload_next_seq_ != 0)
+  {
+    return proto::ERR_OK;
+  }
+
+  if (seq != upload_next_seq_)
+  {
+    return proto::ERR_SEQUENCE;
+  }
+
+  size_t data_len = len - proto::CHUNK_HEADER_LEN;
+  if (!chunk_routed_)
+  {
+    // Not routed (overrun, or CHUNK inside a TAGGED frame): data is in the
+    // frame buffer
+    if (upload_received_ + data_len > upload_total_)
+    {
+      return proto::ERR_BUFFER_FULL;
+    }
+    std::memcpy(upload_base_ + upload_received_, payload + proto::CHUNK_HEADER_LEN,
+                data_len);
+  }
+
+  upload_received_ += data_len;
+  upload_next_seq_++;
+  return proto::ERR_OK;
+}
+
+uint8_t LinkPort::upload_commit(const uint8_t* payload, size_t len)
+{
+  if (len != 4)
+  {
+    return proto::ERR_INVALID_FRAME;
+  }
+  if (!upload_active_ || upload_received_ != upload_total_)
+  {
+    return proto::ERR_SEQUENCE;
+  }
+
+  upload_active_ = false;
+  if (vm_busy())
+  {
+    return proto::ERR_BUSY;
+  }
+
+  uint32_t expected = (uint32_t)payload[0] | ((uint32_t)payload[1] << 8) |
+                      ((uint32_t)payload[2] << 16) | ((uint32_t)payload[3] << 24);
+  if (crc32_update(0, upload_base_, upload_total_) != expected)
+  {
+    ESP_LOGE(TAG, "Upload checksum mismatch (%u bytes)", (unsigned)upload_total_);
+    return proto::ERR_CHECKSUM;
+  }
+
+  return execute_and_cache(upload_base_, upload_total_);
+}
+
+void LinkPort::upload_load(const uint8_t* payload)
+{
+  if ((payload[4] & proto::COMMIT_LOAD) == 0)
+  {
+    respond(proto::ERR_INVALID_FRAME);
+    return;
+  }
+  if (!upload_active_ || upload_received_ != upload_total_)
+  {
+    respond(proto::ERR_SEQUENCE);
+    return;
+  }
+
+  upload_active_ = false;
+  if (vm_busy())
+  {
+    respond(proto::ERR_BUSY);
+    return;
+  }
+
+  uint32_t expected = (uint32_t)payload[0] | ((uint32_t)payload[1] << 8) |
+                      ((uint32_t)payload[2] << 16) | ((uint32_t)payload[3] << 24);
+  if (crc32_update(0, upload_base_, upload_total_) != expected)
+  {
+    ESP_LOGE(TAG, "Upload checksum mismatch (%u bytes)", (unsigned)upload_total_);
+    respond(proto::ERR_CHECKSUM);
+    return;
+  }
+
+  load_image(upload_base_, upload_total_);
+}
+
+int LinkPort::resolve_import(void* user, const char* name)
+{
+  const ImportResolver& resolver = static_cast<LinkPort*>(user)->resolver_;
+  return resolver ? resolver(name) : -1;
+}
+
+void LinkPort::load_image(const uint8_t* image, size_t len)
+{
+  if (image_base_ == nullptr)
+  {
+    respond(proto::ERR_BUFFER_FULL);
+    return;
+  }
+
+  V4ImageInfo info = {};
+  v4_image_parse(image, len, &info);
+
+  uint64_t t_exec = telemetry_.now();
+  int count = v4_image_load(vm_, image, len, image_base_ + image_used_,
+                            image_size_ - image_used_, resolve_import, this,
+                            image_wids_.get(), IMAGE_WORDS_MAX);
+  telemetry_.record(LinkTelemetry::EXEC, t_exec);
+
+  if (count < 0)
+  {
+    ESP_LOGE(TAG, "Image load failed (code %d)", count);
+    switch (count)
+    {
+      case V4_IMAGE_ERR_FORMAT:
+        respond(proto::ERR_INVALID_FRAME);
+        break;
+      case V4_IMAGE_ERR_CHECKSUM:
+        respond(proto::ERR_CHECKSUM);
+        break;
+      case V4_IMAGE_ERR_NO_SPACE:
+        respond(proto::ERR_BUFFER_FULL);
+        break;
+      case V4_IMAGE_ERR_IMPORT:
+        respond(proto::ERR_NOT_FOUND);
+        break;
+      default:
+        // Words may already be registered; keep their code resident
+        image_used_ += info.resident_size;
+        respond(proto::ERR_VM_ERROR);
+        break;
+    }
+    return;
+  }
+  image_used_ += info.resident_size;
+
+  // Word ids: [COUNT u16][WID u16 x COUNT]
+  uint8_t* data = data_frame_.get() + 4;
+  data[0] = static_cast<uint8_t>(count);
+  data[1] = static_cast<uint8_t>(count >> 8);
+  for (int i = 0; i < count; i++)
+  {
+    data[2 + 2 * i] = static_cast<uint8_t>(image_wids_[i]);
+    data[3 + 2 * i] = static_cast<uint8_t>(image_wids_[i] >> 8);
+  }
+  respond_data(proto::ERR_OK, 2 + 2 * static_cast<size_t>(count));
+}
+
+void LinkPort::respond(uint8_t err)
+{
+  // Keep responses in arrival order
+  flush_acks();
+
+  // Response: [STX][0x01][0x00][ERR_CODE][CRC8]
+  uint8_t frame[5] = {proto::STX, 0x01, 0x00, err, 0};
+  frame[4] = crc8_update(0, &frame[1], 3);
+  telemetry_.result(err);
+  send(frame, sizeof(frame));
+}
+
+void LinkPort::respond_data(uint8_t err, size_t len)
+{
+  flush_acks();
+
+  // Data response: [STX][LEN_L][LEN_H][ERR_CODE][DATA...][CRC8]
+  // The caller has written DATA in place at data_frame_ + 4
+  uint8_t* frame = data_frame_.get();
+  size_t frame_len = 1 + len;
+  frame[0] = proto::STX;
+  frame[1] = static_cast<uint8_t>(frame_len & 0xFF);
+  frame[2] = static_cast<uint8_t>(frame_len >> 8);
+  frame[3] = err;
+  frame[4 + len] = crc8_update(0, &frame[1], 3 + len);
+  telemetry_.result(err);
+  send(frame, 5 + len);
+}
+
+void LinkPort::send(const uint8_t* frame, size_t len)
+{
+  uint64_t t_tx = telemetry_.now();
+  transport_->write(frame, len);
+  telemetry_.record(LinkTelemetry::TX, t_tx);
+  telemetry_.add(LinkTelemetry::TX_BYTES, static_cast<uint32_t>(len));
+  telemetry_.add(LinkTelemetry::RESPONSES);
+  responses_sent_++;
 }
 
-void Esp32c6LinkPort::reset()
+void LinkPort::reset()
 {
-  link_->reset();
+  vm_reset(vm_);
+  decoder_.reset();
+  upload_active_ = false;
+  image_used_ = 0;
+  tag_synced_ = false;
+  ack_count_ = 0;
   ESP_LOGI(TAG, "VM reset");
 }
 
-size_t Esp32c6LinkPort::buffer_capacity() const
+size_t LinkPort::buffer_capacity() const
 {
-  return link_->buffer_capacity();
+  return decoder_.capacity();
 }
 
 }  // namespace v4ports
@@ -1,8 +1,10 @@
 /**
  * @file v4_link_port.hpp
- * @brief V4-link port for ESP32-C6
+ * @brief V4-link port
  *
- * Wraps V4-link with ESP-IDF UART driver for easy integration.
+ * LinkPort implements V4-link framing and command dispatch over any
+ * Transport. Esp32c6LinkPort binds it to the ESP32-C6 USB Serial/JTAG
+ * controller for easy integration.
  *
  * @copyright Copyright 2025 Akihito Kirisaki
  * @license Dual-licensed under MIT or Apache-2.0
@@ -10,71 +12,127 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <utility>
 
-#include "driver/usb_serial_jtag.h"
 #include "v4/vm_api.h"
-#include "v4link/link.hpp"
+#include "v4_link_cache.hpp"
+#include "v4_link_exec_worker.hpp"
+#include "v4_link_frame.hpp"
+#include "v4_link_lz.hpp"
+#include "v4_link_profiler.hpp"
+#include "v4_link_telemetry.hpp"
+#include "v4_link_transport.hpp"
+
+#ifdef ESP_PLATFORM
+#include "esp_timer.h"
+#include "sdkconfig.h"
+#include "v4_link_transport_usb.hpp"
+
+#ifndef CONFIG_V4_LINK_TX_RING_SIZE
+#define CONFIG_V4_LINK_TX_RING_SIZE 2048
+#endif
+#endif  // ESP_PLATFORM
 
 namespace v4ports
 {
 
 /**
- * @brief ESP32-C6 V4-link port
+ * @brief Transport-independent V4-link port
  *
- * Provides easy-to-use interface for V4-link on ESP32-C6.
- * Handles UART initialization and data transfer automatically.
+ * Decodes frames from a Transport, executes commands on the VM and sends
+ * responses back over the same transport.
  *
- * Example usage:
- * @code
- * // Create VM
- * uint8_t vm_memory[4096];
- * VmConfig cfg = {vm_memory, sizeof(vm_memory), nullptr, 0, nullptr};
- * Vm* vm = vm_create(&cfg);
+ * Programs larger than the bytecode buffer are uploaded with
+ * BEGIN / CHUNK... / COMMIT. Chunk payloads are written by the frame decoder
+ * straight into the upload region (see set_upload_region()), so image size
+ * is bounded by that region rather than by the link buffer.
  *
- * // Create V4-link port
- * v4ports::Esp32c6LinkPort link(vm);
+ * EXEC_LZ carries a compressed program that is decompressed into the
+ * bytecode buffer as the frame arrives, without a second buffer.
  *
- * // Main loop
- * while (true) {
- *   link.poll();
- *   vTaskDelay(pdMS_TO_TICKS(1));
- * }
- * @endcode
+ * With a BytecodeCache attached, executed programs are remembered by hash
+ * and can be run again with EXEC_HASH without re-sending them.
+ *
+ * With a Profiler attached (V4_LINK_PROFILE builds), every execution is
+ * timed per program hash and the profile is served with PROFILE.
+ *
+ * With an image store set, LOAD (or COMMIT with COMMIT_LOAD) registers all
+ * words of a linkable image (see v4_image.h) in one pass; their code and
+ * names stay resident in the store until the VM is reset.
+ *
+ * With an ExecWorker attached, EXEC_ASYNC runs programs in the worker task
+ * and the link stays responsive; commands that need the VM are answered
+ * with ERR_BUSY until the job finishes.
+ *
+ * Link health (bytes, frames, CRC and length errors, resyncs, results by
+ * error code) and decode / exec / TX latency histograms are kept in a
+ * lock-free LinkTelemetry block, readable with stats() and over the link
+ * with STATS.
+ *
+ * Hosts may keep several TAGGED frames in flight; their acknowledgements are
+ * collected while a received span is processed and sent as one batch frame.
  */
-class Esp32c6LinkPort
+class LinkPort
 {
  public:
   /**
-   * @brief Construct ESP32-C6 link port
-   *
-   * Initializes USB Serial/JTAG and V4-link layer.
+   * @brief Construct link port
    *
    * @param vm           Pointer to initialized V4 VM
+   * @param transport    Byte transport (ownership is taken)
    * @param buffer_size  Bytecode buffer size (default: 512)
+   */
+  LinkPort(Vm* vm, std::unique_ptr<Transport> transport, size_t buffer_size = 512);
+
+  virtual ~LinkPort() = default;
+
+  // Non-copyable
+  LinkPort(const LinkPort&) = delete;
+  LinkPort& operator=(const LinkPort&) = delete;
+
+  /**
+   * @brief Poll for incoming data and process
    *
-   * @throws std::runtime_error if USB Serial/JTAG initialization fails
+   * Waits at most @p timeout_ms for data, then drains everything the
+   * transport has buffered and feeds it to feed(). A blocking wait that
+   * receives nothing counts as rx_idle().
+   *
+   * @param timeout_ms  Maximum wait for the first byte (0 = non-blocking)
+   * @return Number of bytes received
    */
-  Esp32c6LinkPort(Vm* vm, size_t buffer_size = 512);
+  size_t poll(uint32_t timeout_ms = 0);
 
   /**
-   * @brief Destructor
+   * @brief Feed received bytes to the frame decoder
+   *
+   * Bulk ingest path: payload bytes are copied straight into the bytecode
+   * buffer and complete frames are dispatched before returning.
    *
-   * Cleans up USB Serial/JTAG driver.
+   * @param data  Received bytes
+   * @param len   Number of bytes
    */
-  ~Esp32c6LinkPort();
+  void feed(const uint8_t* data, size_t len);
 
-  // Non-copyable
-  Esp32c6LinkPort(const Esp32c6LinkPort&) = delete;
-  Esp32c6LinkPort& operator=(const Esp32c6LinkPort&) = delete;
+  /**
+   * @brief Feed a single received byte
+   *
+   * Per-byte path, kept for callers that receive one byte at a time.
+   */
+  void feed_byte(uint8_t byte);
 
   /**
-   * @brief Poll for incoming data and process
+   * @brief Notify the port that RX stayed idle for a whole wait
    *
-   * Call this from main loop. Non-blocking.
-   * Reads all available USB Serial/JTAG data and feeds to V4-link.
+   * Drops a partially received frame, so a corrupted length field cannot
+   * swallow the frames a host retransmits after its own timeout. Also
+   * writes newly cached programs to the cache store (BytecodeCache::flush())
+   * unless an asynchronous job is running.
    */
-  void poll();
+  void rx_idle();
 
   /**
    * @brief Reset VM to initial state
@@ -83,6 +141,130 @@ class Esp32c6LinkPort
    */
   void reset();
 
+  /**
+   * @brief Set the region chunked uploads are assembled in
+   *
+   * Typically a reserved slice of VM memory or arena. Without a region,
+   * BEGIN is rejected with ERR_BUFFER_FULL.
+   *
+   * @param base  Region start (must outlive the port)
+   * @param size  Region size in bytes
+   */
+  void set_upload_region(uint8_t* base, size_t size);
+
+  /// Resolves an image import to a word id (< 0 if unknown)
+  using ImportResolver = std::function<int(const char* name)>;
+
+  /// Maximum number of words per image (LOAD answers with all their ids)
+  static constexpr size_t IMAGE_WORDS_MAX = 240;
+
+  /**
+   * @brief Set the memory loaded images are kept in
+   *
+   * Registered words run in place, so every loaded image's code and names
+   * are appended to this store; it is emptied when the VM is reset. Without
+   * a store, LOAD is rejected with ERR_BUFFER_FULL.
+   *
+   * @param base  Store start (must outlive the port), or nullptr
+   * @param size  Store size in bytes
+   */
+  void set_image_store(uint8_t* base, size_t size);
+
+  /**
+   * @brief Set how image imports (native words, earlier images) are resolved
+   *
+   * Without a resolver, images with imports are rejected with ERR_NOT_FOUND.
+   */
+  void set_import_resolver(ImportResolver resolver)
+  {
+    resolver_ = std::move(resolver);
+  }
+
+  /**
+   * @brief Get the free space of the image store
+   */
+  size_t image_store_free() const
+  {
+    return image_size_ - image_used_;
+  }
+
+  /**
+   * @brief Attach a bytecode cache for EXEC_HASH
+   *
+   * Without a cache, EXEC_HASH is answered with ERR_NOT_FOUND.
+   *
+   * @param cache  Cache (must outlive the port), or nullptr to detach
+   */
+  void set_cache(BytecodeCache* cache)
+  {
+    cache_ = cache;
+  }
+
+  /**
+   * @brief Attach an execution profiler for PROFILE
+   *
+   * Has no effect unless V4_LINK_PROFILE is enabled; PROFILE is then
+   * answered with ERR_ERROR.
+   *
+   * @param profiler  Profiler (must outlive the port), or nullptr to detach
+   */
+  void set_profiler(Profiler* profiler);
+
+  /**
+   * @brief Attach a worker for EXEC_ASYNC / EXEC_STATUS / EXEC_WAIT / EXEC_ABORT
+   *
+   * Without a worker these commands are answered with ERR_ERROR. The worker
+   * runs jobs through this port, so detach or destroy it before the port.
+   *
+   * @param worker  Worker, or nullptr to detach
+   */
+  void set_exec_worker(ExecWorker* worker);
+
+  /**
+   * @brief Set the clock latency histograms are measured with
+   *
+   * Without a clock only the counters are kept.
+   *
+   * @param clock         Free-running 64-bit tick counter, or nullptr
+   * @param ticks_per_us  Clock rate, reported with the histograms
+   */
+  void set_latency_clock(LinkTelemetry::Clock clock, uint16_t ticks_per_us)
+  {
+    telemetry_.set_clock(clock, ticks_per_us);
+  }
+
+  /**
+   * @brief Get link telemetry; safe to call from any task
+   */
+  LinkPortStats stats() const
+  {
+    return telemetry_.snapshot();
+  }
+
+  /**
+   * @brief Clear link telemetry
+   */
+  void reset_stats()
+  {
+    telemetry_.reset();
+  }
+
+  /**
+   * @brief Get maximum image size for chunked uploads
+   */
+  size_t upload_capacity() const
+  {
+    return upload_size_;
+  }
+
+  /**
+   * @brief Get number of response frames sent since construction
+   */
+  uint32_t responses_sent() const
+  {
+    return responses_sent_;
+  }
+
   /**
    * @brief Get buffer capacity
    *
@@ -90,10 +272,158 @@ class Esp32c6LinkPort
    */
   size_t buffer_capacity() const;
 
+  /**
+   * @brief Get the underlying transport
+   */
+  Transport& transport()
+  {
+    return *transport_;
+  }
+
+  const Transport& transport() const
+  {
+    return *transport_;
+  }
+
+ protected:
+  static constexpr size_t RX_CHUNK_SIZE = 1024;
+
  private:
-  std::unique_ptr<v4::link::Link> link_;
+  void dispatch(uint8_t cmd, const uint8_t* payload, size_t len);
+  uint8_t process(uint8_t cmd, const uint8_t* payload, size_t len);
+  void respond(uint8_t err);
+  void respond_data(uint8_t err, size_t len);
+  void send(const uint8_t* frame, size_t len);
+  void decode_error(uint8_t err);
+  void count_discarded();
+  void profile(const uint8_t* payload, size_t len);
+  void report_stats(const uint8_t* payload, size_t len);
+  void exec_control(uint8_t cmd, const uint8_t* payload, size_t len);
+  bool vm_busy() const;
+  void tagged(const uint8_t* payload, size_t len);
+  void queue_ack(uint8_t seq, uint8_t err);
+  void flush_acks();
+  uint8_t* route(uint8_t cmd, size_t len, size_t& header_len);
+  bool stream_select(uint8_t cmd, size_t len, size_t& header_len);
+  void stream(const uint8_t* data, size_t len);
+  uint8_t execute_lz(size_t len);
+  uint8_t execute(const uint8_t* code, size_t len, uint64_t hash,
+                  const ExecWorker* job = nullptr);
+  uint8_t execute_and_cache(const uint8_t* code, size_t len,
+                            const ExecWorker* job = nullptr);
+  uint8_t execute_hash(const uint8_t* payload, size_t len);
+  uint8_t upload_begin(const uint8_t* payload, size_t len);
+  uint8_t upload_chunk(const uint8_t* payload, size_t len);
+  uint8_t upload_commit(const uint8_t* payload, size_t len);
+  void upload_load(const uint8_t* payload);
+  void load_image(const uint8_t* image, size_t len);
+  static int resolve_import(void* user, const char* name);
+
+  Vm* vm_;
+  std::unique_ptr<Transport> transport_;
+  std::unique_ptr<uint8_t[]> buffer_;
+  std::unique_ptr<uint8_t[]> rx_buf_;
+  FrameDecoder decoder_;
+  uint32_t responses_sent_ = 0;
+  BytecodeCache* cache_ = nullptr;
+  Profiler* profiler_ = nullptr;
+  ExecWorker* worker_ = nullptr;
+  std::unique_ptr<uint8_t[]> data_frame_;
+  LinkTelemetry telemetry_;
+  uint32_t discarded_seen_ = 0;
+
+  // Chunked upload state
+  uint8_t* upload_base_ = nullptr;
+  size_t upload_size_ = 0;
+  size_t upload_total_ = 0;
+  size_t upload_received_ = 0;
+  uint16_t upload_next_seq_ = 0;
+  bool upload_active_ = false;
+  bool chunk_routed_ = false;
 
+  // Compressed EXEC state
+  LzDecoder lz_;
+  bool lz_started_ = false;
+  bool lz_oversized_ = false;
+
+  // Image store
+  uint8_t* image_base_ = nullptr;
+  size_t image_size_ = 0;
+  size_t image_used_ = 0;
+  std::unique_ptr<int[]> image_wids_;
+  ImportResolver resolver_;
+
+  // Tagged frame state
+  uint8_t tag_expected_ = 0;
+  bool tag_synced_ = false;
+  uint8_t tag_results_[proto::TAG_WINDOW_MAX] = {};
+  size_t ack_count_ = 0;
+  uint8_t ack_frame_[3 + 2 * proto::TAG_WINDOW_MAX + 1] = {};
+};
+
+#ifdef ESP_PLATFORM
+
+/**
+ * @brief ESP32-C6 V4-link port
+ *
+ * Provides easy-to-use interface for V4-link on ESP32-C6.
+ * Handles USB Serial/JTAG initialization and data transfer automatically.
+ *
+ * Example usage:
+ * @code
+ * // Create VM
+ * uint8_t vm_memory[4096];
+ * VmConfig cfg = {vm_memory, sizeof(vm_memory), nullptr, 0, nullptr};
+ * Vm* vm = vm_create(&cfg);
+ *
+ * // Create V4-link port
+ * v4ports::Esp32c6LinkPort link(vm);
+ *
+ * // Serve the link from a dedicated task (see LinkService)
+ * v4ports::LinkService service(link);
+ * service.start();
+ *
+ * // ...or poll from an existing loop
+ * while (true) {
+ *   link.poll();
+ *   vTaskDelay(pdMS_TO_TICKS(1));
+ * }
+ * @endcode
+ */
+class Esp32c6LinkPort : public LinkPort
+{
+ public:
+  /**
+   * @brief Construct ESP32-C6 link port
+   *
+   * Initializes USB Serial/JTAG and V4-link layer. Responses are queued in
+   * a CONFIG_V4_LINK_TX_RING_SIZE byte ring and never block the caller.
+   * Latency histograms are measured in microseconds (esp_timer).
+   *
+   * @param vm           Pointer to initialized V4 VM
+   * @param buffer_size  Bytecode buffer size (default: 512)
+   */
+  Esp32c6LinkPort(Vm* vm, size_t buffer_size = 512)
+      : LinkPort(vm,
+                 std::make_unique<UsbSerialJtagTransport>(USB_BUF_SIZE,
+                                                          CONFIG_V4_LINK_TX_RING_SIZE),
+                 buffer_size)
+  {
+    set_latency_clock([]() -> uint64_t { return esp_timer_get_time(); }, 1);
+  }
+
+  /**
+   * @brief Get TX queue statistics (queued bytes, high-water, drops)
+   */
+  TxRingStats tx_stats() const
+  {
+    return static_cast<const UsbSerialJtagTransport&>(transport()).tx_stats();
+  }
+
+ private:
   static constexpr size_t USB_BUF_SIZE = 1024;
 };
 
+#endif  // ESP_PLATFORM
+
 }  // namespace v4ports
@@ -0,0 +1,144 @@
+/**
+ * @file v4_link_profiler.cpp
+ * @brief Execution profiler for programs run over V4-link
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include "v4_link_profiler.hpp"
+
+#include <algorithm>
+
+namespace v4ports
+{
+
+namespace
+{
+
+uint8_t* put_le(uint8_t* p, uint64_t v, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+  {
+    *p++ = static_cast<uint8_t>(v >> (8 * i));
+  }
+  return p;
+}
+
+}  // namespace
+
+Profiler::Profiler(Clock clock, uint16_t ticks_per_us, size_t max_entries)
+    : clock_(clock),
+      ticks_per_us_(ticks_per_us),
+      max_entries_(std::min<size_t>(max_entries, 255))
+{
+  entries_.reset(new ProfileEntry[max_entries_]);
+}
+
+ProfileEntry* Profiler::find_or_add(uint64_t hash)
+{
+  for (size_t i = 0; i < count_; i++)
+  {
+    if (entries_[i].hash == hash)
+    {
+      return &entries_[i];
+    }
+  }
+  if (count_ == max_entries_)
+  {
+    return nullptr;
+  }
+
+  ProfileEntry* entry = &entries_[count_++];
+  *entry = {hash, 0, 0, 0, 0};
+  return entry;
+}
+
+void Profiler::begin(uint64_t hash)
+{
+  ProfileEntry* entry = find_or_add(hash);
+  if (entry == nullptr)
+  {
+    untracked_calls_++;
+    return;
+  }
+
+  entry->calls++;
+  start_ = clock_();
+  current_.store(static_cast<int>(entry - entries_.get()), std::memory_order_release);
+}
+
+void Profiler::end(bool ok)
+{
+  int index = current_.exchange(-1, std::memory_order_acq_rel);
+  if (index < 0)
+  {
+    return;
+  }
+
+  ProfileEntry& entry = entries_[index];
+  entry.ticks += clock_() - start_;
+  if (!ok)
+  {
+    entry.errors++;
+  }
+}
+
+void Profiler::discard()
+{
+  int index = current_.exchange(-1, std::memory_order_acq_rel);
+  if (index >= 0)
+  {
+    entries_[index].calls--;
+  }
+}
+
+void Profiler::sample()
+{
+  samples_++;
+  int index = current_.load(std::memory_order_acquire);
+  if (index < 0)
+  {
+    idle_samples_++;
+    return;
+  }
+  entries_[index].samples++;
+}
+
+void Profiler::clear()
+{
+  current_.store(-1, std::memory_order_release);
+  count_ = 0;
+  samples_ = 0;
+  idle_samples_ = 0;
+  untracked_calls_ = 0;
+}
+
+size_t Profiler::encode(uint8_t* out, size_t capacity) const
+{
+  size_t len = HEADER_LEN + ENTRY_LEN * count_;
+  if (capacity < len)
+  {
+    return 0;
+  }
+
+  uint8_t* p = out;
+  p = put_le(p, FORMAT_VERSION, 1);
+  p = put_le(p, count_, 1);
+  p = put_le(p, ticks_per_us_, 2);
+  p = put_le(p, samples_, 4);
+  p = put_le(p, idle_samples_, 4);
+  p = put_le(p, untracked_calls_, 4);
+  for (size_t i = 0; i < count_; i++)
+  {
+    const ProfileEntry& e = entries_[i];
+    p = put_le(p, e.hash, 8);
+    p = put_le(p, e.calls, 4);
+    p = put_le(p, e.errors, 4);
+    p = put_le(p, e.ticks, 8);
+    p = put_le(p, e.samples, 4);
+  }
+  return len;
+}
+
+}  // namespace v4ports
@@ -0,0 +1,159 @@
+/**
+ * @file v4_link_profiler.hpp
+ * @brief Execution profiler for programs run over V4-link
+ *
+ * Attributes VM time to programs by their program_hash(): call count,
+ * cumulative clock ticks and a sampled histogram (a periodic timer calls
+ * sample(), which credits whichever program is executing at that moment).
+ * The profile is dumped over the link with CMD_PROFILE and decoded by the
+ * host tool into a sorted report.
+ *
+ * Instrumentation in LinkPort is compiled only when V4_LINK_PROFILE is
+ * non-zero (CONFIG_V4_LINK_PROFILE on ESP-IDF).
+ *
+ * Portable (no ESP-IDF dependencies) so it can be built and tested on a
+ * Linux host as well as on the target.
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
+#ifndef V4_LINK_PROFILE
+#if defined(CONFIG_V4_LINK_PROFILE)
+#define V4_LINK_PROFILE 1
+#else
+#define V4_LINK_PROFILE 0
+#endif
+#endif
+
+namespace v4ports
+{
+
+/**
+ * @brief Per-program profile counters
+ */
+struct ProfileEntry
+{
+  uint64_t hash;     ///< program_hash() of the program
+  uint32_t calls;    ///< Executions
+  uint32_t errors;   ///< Executions that returned a VM error
+  uint64_t ticks;    ///< Cumulative execution time in clock ticks
+  uint32_t samples;  ///< Timer samples taken while it was executing
+};
+
+/**
+ * @brief Program-level VM profiler
+ *
+ * Wire format of encode() (little-endian):
+ *   Header: [VERSION u8][COUNT u8][TICKS_PER_US u16][SAMPLES u32]
+ *           [IDLE_SAMPLES u32][UNTRACKED_CALLS u32]
+ *   Entry:  [HASH u64][CALLS u32][ERRORS u32][TICKS u64][SAMPLES u32]
+ *
+ * begin()/end() run in the task that executes the VM; sample() may run in
+ * a timer task or interrupt. The entry table is fixed-size, so sample()
+ * never races with allocation.
+ */
+class Profiler
+{
+ public:
+  /// Monotonic tick counter
+  using Clock = uint64_t (*)();
+
+  static constexpr uint8_t FORMAT_VERSION = 1;
+  static constexpr size_t HEADER_LEN = 16;
+  static constexpr size_t ENTRY_LEN = 28;
+
+  /**
+   * @param clock         Tick source
+   * @param ticks_per_us  Clock rate, reported to the host for conversion
+   * @param max_entries   Programs tracked (at most 255); executions of
+   *                      further programs are only counted as untracked
+   */
+  Profiler(Clock clock, uint16_t ticks_per_us, size_t max_entries = 32);
+
+  // Non-copyable
+  Profiler(const Profiler&) = delete;
+  Profiler& operator=(const Profiler&) = delete;
+
+  /**
+   * @brief Mark the start of an execution
+   */
+  void begin(uint64_t hash);
+
+  /**
+   * @brief Mark the end of the execution started by begin()
+   */
+  void end(bool ok);
+
+  /**
+   * @brief End the execution started by begin() without counting it
+   *
+   * For executions that were aborted. Samples already taken are kept.
+   */
+  void discard();
+
+  /**
+   * @brief Take one sample (call periodically)
+   */
+  void sample();
+
+  /**
+   * @brief Drop all counters
+   */
+  void clear();
+
+  /**
+   * @brief Largest encode() output in bytes
+   */
+  size_t encoded_size_max() const
+  {
+    return HEADER_LEN + ENTRY_LEN * max_entries_;
+  }
+
+  /**
+   * @brief Serialize the profile
+   *
+   * @return Bytes written (0 if @p capacity is too small)
+   */
+  size_t encode(uint8_t* out, size_t capacity) const;
+
+  size_t entry_count() const
+  {
+    return count_;
+  }
+
+  const ProfileEntry& entry(size_t i) const
+  {
+    return entries_[i];
+  }
+
+ private:
+  ProfileEntry* find_or_add(uint64_t hash);
+
+  Clock clock_;
+  uint16_t ticks_per_us_;
+  std::unique_ptr<ProfileEntry[]> entries_;
+  size_t max_entries_;
+  size_t count_ = 0;
+
+  // Index of the executing entry, -1 when idle or untracked
+  std::atomic<int> current_{-1};
+  uint64_t start_ = 0;
+
+  uint32_t samples_ = 0;
+  uint32_t idle_samples_ = 0;
+  uint32_t untracked_calls_ = 0;
+};
+
+}  // namespace v4ports
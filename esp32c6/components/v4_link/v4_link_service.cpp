@@ -0,0 +1,177 @@
+/**
+ * @file v4_link_service.cpp
+ * @brief Event-driven V4-link service task for ESP32-C6
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include "v4_link_service.hpp"
+
+#include <memory>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char* TAG = "v4_link_service";
+
+namespace v4ports
+{
+
+LinkService::LinkService(LinkPort& port, const LinkServiceConfig& cfg)
+    : port_(port), cfg_(cfg)
+{
+  reset_stats();
+}
+
+LinkService::~LinkService()
+{
+  stop();
+}
+
+bool LinkService::start()
+{
+  if (task_ != nullptr)
+  {
+    return true;
+  }
+
+  stop_requested_.store(false);
+  stopper_ = nullptr;
+
+  BaseType_t ret =
+      xTaskCreate(task_entry, "v4_link", cfg_.stack_size, this, cfg_.priority, &task_);
+  if (ret != pdPASS)
+  {
+    ESP_LOGE(TAG, "Failed to create link service task");
+    task_ = nullptr;
+    return false;
+  }
+
+  ESP_LOGI(TAG, "Link service started (priority %u, stack %lu bytes)",
+           (unsigned)cfg_.priority, (unsigned long)cfg_.stack_size);
+  return true;
+}
+
+void LinkService::stop()
+{
+  TaskHandle_t self = xTaskGetCurrentTaskHandle();
+
+  taskENTER_CRITICAL(&state_lock_);
+  if (task_ == nullptr)
+  {
+    taskEXIT_CRITICAL(&state_lock_);
+    return;
+  }
+  if (task_ == self)
+  {
+    // From a handler on the service task: the task exits after this
+    // wakeup and clears task_ itself
+    stop_requested_.store(true);
+    taskEXIT_CRITICAL(&state_lock_);
+    return;
+  }
+  // Ask the task to exit and wait for it to acknowledge
+  stopper_ = self;
+  stop_requested_.store(true);
+  taskEXIT_CRITICAL(&state_lock_);
+
+  ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+  ESP_LOGI(TAG, "Link service stopped");
+}
+
+LinkServiceStats LinkService::stats() const
+{
+  taskENTER_CRITICAL(&stats_lock_);
+  LinkServiceStats snapshot = stats_;
+  uint64_t total = rx_to_tx_total_us_;
+  taskEXIT_CRITICAL(&stats_lock_);
+
+  if (snapshot.responses > 0)
+  {
+    snapshot.rx_to_tx_avg_us = (uint32_t)(total / snapshot.responses);
+  }
+  else
+  {
+    snapshot.rx_to_tx_min_us = 0;
+  }
+  return snapshot;
+}
+
+void LinkService::reset_stats()
+{
+  taskENTER_CRITICAL(&stats_lock_);
+  stats_ = {};
+  stats_.rx_to_tx_min_us = UINT32_MAX;
+  rx_to_tx_total_us_ = 0;
+  taskEXIT_CRITICAL(&stats_lock_);
+}
+
+void LinkService::task_entry(void* arg)
+{
+  static_cast<LinkService*>(arg)->run();
+}
+
+void LinkService::run()
+{
+  std::unique_ptr<uint8_t[]> rx(new uint8_t[RX_CHUNK_SIZE]);
+  Transport& transport = port_.transport();
+
+  while (!stop_requested_.load())
+  {
+    // Block until data arrives (or timeout so stop() can take effect)
+    int len = transport.read(rx.get(), RX_CHUNK_SIZE, cfg_.rx_timeout_ms);
+    if (len <= 0)
+    {
+      taskENTER_CRITICAL(&stats_lock_);
+      stats_.idle_timeouts++;
+      taskEXIT_CRITICAL(&stats_lock_);
+      port_.rx_idle();
+      transport.flush();
+      continue;
+    }
+
+    int64_t t_rx = esp_timer_get_time();
+    uint32_t before = port_.responses_sent();
+
+    // Dispatch what woke us, then drain anything that arrived meanwhile
+    port_.feed(rx.get(), static_cast<size_t>(len));
+    size_t drained = port_.poll();
+
+    uint32_t sent = port_.responses_sent() - before;
+    uint32_t rx_to_tx = (uint32_t)(esp_timer_get_time() - t_rx);
+
+    taskENTER_CRITICAL(&stats_lock_);
+    stats_.rx_wakeups++;
+    stats_.rx_bytes += static_cast<uint32_t>(len + drained);
+    if (sent > 0)
+    {
+      // One latency sample per response dispatched in this wakeup
+      stats_.responses += sent;
+      stats_.rx_to_tx_last_us = rx_to_tx;
+      if (rx_to_tx < stats_.rx_to_tx_min_us)
+      {
+        stats_.rx_to_tx_min_us = rx_to_tx;
+      }
+      if (rx_to_tx > stats_.rx_to_tx_max_us)
+      {
+        stats_.rx_to_tx_max_us = rx_to_tx;
+      }
+      rx_to_tx_total_us_ += (uint64_t)rx_to_tx * sent;
+    }
+    taskEXIT_CRITICAL(&stats_lock_);
+  }
+
+  // Either stop() saw task_ cleared or we see its stopper, never neither
+  taskENTER_CRITICAL(&state_lock_);
+  TaskHandle_t stopper = stopper_;
+  task_ = nullptr;
+  taskEXIT_CRITICAL(&state_lock_);
+  if (stopper != nullptr)
+  {
+    xTaskNotifyGive(stopper);
+  }
+  vTaskDelete(nullptr);
+}
+
+}  // namespace v4ports
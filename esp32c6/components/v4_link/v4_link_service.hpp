@@ -0,0 +1,154 @@
+/**
+ * @file v4_link_service.hpp
+ * @brief Event-driven V4-link service task for ESP32-C6
+ *
+ * Runs the link port in a dedicated FreeRTOS task that blocks on transport
+ * RX (USB Serial/JTAG on ESP32-C6), so frames are dispatched as soon as they
+ * arrive instead of on the next polling tick.
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+#include "v4_link_port.hpp"
+
+#ifndef CONFIG_V4_LINK_TASK_PRIORITY
+#define CONFIG_V4_LINK_TASK_PRIORITY 5
+#endif
+
+#ifndef CONFIG_V4_LINK_TASK_STACK_SIZE
+#define CONFIG_V4_LINK_TASK_STACK_SIZE 4096
+#endif
+
+#ifndef CONFIG_V4_LINK_RX_TIMEOUT_MS
+#define CONFIG_V4_LINK_RX_TIMEOUT_MS 100
+#endif
+
+namespace v4ports
+{
+
+/**
+ * @brief Link service statistics
+ *
+ * RX-to-TX time is measured on the device only, from the RX wakeup that
+ * delivered a frame's last byte to the response being handed to the driver.
+ * It covers frame decoding and execution but not USB transfer or host
+ * time, so it is not a host-visible round trip.
+ */
+struct LinkServiceStats
+{
+  uint32_t rx_wakeups;     ///< RX waits that returned data
+  uint32_t idle_timeouts;  ///< RX waits that timed out
+  uint32_t rx_bytes;       ///< Total bytes received
+  uint32_t responses;      ///< Response frames sent
+  uint32_t rx_to_tx_last_us;  ///< Latest RX wakeup to response hand-off
+  uint32_t rx_to_tx_min_us;   ///< Minimum RX wakeup to response hand-off
+  uint32_t rx_to_tx_max_us;   ///< Maximum RX wakeup to response hand-off
+  uint32_t rx_to_tx_avg_us;   ///< Average RX wakeup to response hand-off
+};
+
+/**
+ * @brief Link service task configuration
+ */
+struct LinkServiceConfig
+{
+  UBaseType_t priority = CONFIG_V4_LINK_TASK_PRIORITY;    ///< Task priority
+  uint32_t stack_size = CONFIG_V4_LINK_TASK_STACK_SIZE;   ///< Stack size (bytes)
+  uint32_t rx_timeout_ms = CONFIG_V4_LINK_RX_TIMEOUT_MS;  ///< RX wait timeout
+};
+
+/**
+ * @brief V4-link service task
+ *
+ * Example usage:
+ * @code
+ * v4ports::Esp32c6LinkPort link(vm);
+ * v4ports::LinkService service(link);
+ * service.start();
+ * @endcode
+ */
+class LinkService
+{
+ public:
+  /**
+   * @brief Construct service for a link port
+   *
+   * @param port  Link port to serve (must outlive the service)
+   * @param cfg   Task configuration
+   */
+  explicit LinkService(LinkPort& port, const LinkServiceConfig& cfg = {});
+
+  /**
+   * @brief Destructor
+   *
+   * Stops the service task if running.
+   */
+  ~LinkService();
+
+  // Non-copyable
+  LinkService(const LinkService&) = delete;
+  LinkService& operator=(const LinkService&) = delete;
+
+  /**
+   * @brief Start the service task
+   *
+   * @return true on success, false if the task could not be created
+   */
+  bool start();
+
+  /**
+   * @brief Stop the service task
+   *
+   * Blocks until the task has exited (at most one RX timeout). Called
+   * from the service task itself (e.g. by a frame handler) it only asks
+   * the task to exit after the current wakeup and returns at once, since
+   * waiting there would never finish.
+   */
+  void stop();
+
+  /**
+   * @brief Check whether the service task is running
+   */
+  bool running() const
+  {
+    return task_ != nullptr;
+  }
+
+  /**
+   * @brief Get a consistent snapshot of the service statistics
+   */
+  LinkServiceStats stats() const;
+
+  /**
+   * @brief Clear the service statistics
+   */
+  void reset_stats();
+
+ private:
+  static void task_entry(void* arg);
+  void run();
+
+  LinkPort& port_;
+  LinkServiceConfig cfg_;
+  TaskHandle_t task_ = nullptr;
+  TaskHandle_t stopper_ = nullptr;  // Guarded by state_lock_
+  std::atomic<bool> stop_requested_{false};
+  portMUX_TYPE state_lock_ = portMUX_INITIALIZER_UNLOCKED;
+
+  mutable portMUX_TYPE stats_lock_ = portMUX_INITIALIZER_UNLOCKED;
+  LinkServiceStats stats_ = {};
+  uint64_t rx_to_tx_total_us_ = 0;
+
+  static constexpr size_t RX_CHUNK_SIZE = 1024;
+};
+
+}  // namespace v4ports
@@ -0,0 +1,104 @@
+/**
+ * @file v4_link_telemetry.cpp
+ * @brief Link-layer telemetry counters and latency histograms
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include "v4_link_telemetry.hpp"
+
+namespace v4ports
+{
+
+namespace
+{
+
+uint8_t* put_u32(uint8_t* p, uint32_t v)
+{
+  p[0] = static_cast<uint8_t>(v);
+  p[1] = static_cast<uint8_t>(v >> 8);
+  p[2] = static_cast<uint8_t>(v >> 16);
+  p[3] = static_cast<uint8_t>(v >> 24);
+  return p + 4;
+}
+
+}  // namespace
+
+LinkPortStats LinkTelemetry::snapshot() const
+{
+  LinkPortStats s = {};
+  s.ticks_per_us = ticks_per_us_;
+  s.rx_bytes = counters_[RX_BYTES].load(std::memory_order_relaxed);
+  s.tx_bytes = counters_[TX_BYTES].load(std::memory_order_relaxed);
+  s.frames = counters_[FRAMES].load(std::memory_order_relaxed);
+  s.crc_errors = counters_[CRC_ERRORS].load(std::memory_order_relaxed);
+  s.oversized = counters_[OVERSIZED].load(std::memory_order_relaxed);
+  s.rx_discarded = counters_[RX_DISCARDED].load(std::memory_order_relaxed);
+  s.idle_drops = counters_[IDLE_DROPS].load(std::memory_order_relaxed);
+  s.responses = counters_[RESPONSES].load(std::memory_order_relaxed);
+  s.lz_raw_bytes = counters_[LZ_RAW_BYTES].load(std::memory_order_relaxed);
+  s.lz_wire_bytes = counters_[LZ_WIRE_BYTES].load(std::memory_order_relaxed);
+  for (size_t i = 0; i < LINK_RESULT_CODES; i++)
+  {
+    s.results[i] = results_[i].load(std::memory_order_relaxed);
+  }
+  for (size_t b = 0; b < LINK_LATENCY_BUCKETS; b++)
+  {
+    s.decode[b] = histograms_[DECODE][b].load(std::memory_order_relaxed);
+    s.exec[b] = histograms_[EXEC][b].load(std::memory_order_relaxed);
+    s.tx[b] = histograms_[TX][b].load(std::memory_order_relaxed);
+  }
+  return s;
+}
+
+void LinkTelemetry::reset()
+{
+  for (auto& counter : counters_)
+  {
+    counter.store(0, std::memory_order_relaxed);
+  }
+  for (auto& result : results_)
+  {
+    result.store(0, std::memory_order_relaxed);
+  }
+  for (auto& histogram : histograms_)
+  {
+    for (auto& bucket : histogram)
+    {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+size_t LinkTelemetry::encode(uint8_t* out, size_t capacity) const
+{
+  if (capacity < ENCODED_LEN)
+  {
+    return 0;
+  }
+
+  uint8_t* p = out;
+  *p++ = FORMAT_VERSION;
+  *p++ = static_cast<uint8_t>(LINK_LATENCY_BUCKETS);
+  *p++ = static_cast<uint8_t>(ticks_per_us_);
+  *p++ = static_cast<uint8_t>(ticks_per_us_ >> 8);
+  for (const auto& counter : counters_)
+  {
+    p = put_u32(p, counter.load(std::memory_order_relaxed));
+  }
+  for (const auto& result : results_)
+  {
+    p = put_u32(p, result.load(std::memory_order_relaxed));
+  }
+  for (const auto& histogram : histograms_)
+  {
+    for (const auto& bucket : histogram)
+    {
+      p = put_u32(p, bucket.load(std::memory_order_relaxed));
+    }
+  }
+  return static_cast<size_t>(p - out);
+}
+
+}  // namespace v4ports
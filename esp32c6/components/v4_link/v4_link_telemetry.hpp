@@ -0,0 +1,200 @@
+/**
+ * @file v4_link_telemetry.hpp
+ * @brief Link-layer telemetry counters and latency histograms
+ *
+ * LinkTelemetry is updated by the task that serves the link and may be read
+ * from any other task: every field is a relaxed atomic, so updates never
+ * take a lock and readers never block the link.
+ *
+ * Latencies are kept as log2 histograms of clock ticks. Bucket 0 counts
+ * zero-tick samples and bucket b >= 1 counts samples in [2^(b-1), 2^b); the
+ * top bucket also takes every longer sample. The clock is 64-bit so that a
+ * long EXEC job cannot wrap into a low bucket.
+ *
+ * Portable (no ESP-IDF dependencies) so it can be built and tested on a
+ * Linux host as well as on the target.
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace v4ports
+{
+
+/// Number of log2 latency buckets (the last one is open-ended)
+constexpr size_t LINK_LATENCY_BUCKETS = 33;
+
+/// Number of response error codes counted separately (proto::ERR_*)
+constexpr size_t LINK_RESULT_CODES = 10;
+
+/**
+ * @brief Snapshot of the link telemetry
+ */
+struct LinkPortStats
+{
+  uint16_t ticks_per_us;   ///< Histogram clock rate (0 = latencies not timed)
+  uint32_t rx_bytes;       ///< Bytes received
+  uint32_t tx_bytes;       ///< Bytes handed to the transport
+  uint32_t frames;         ///< Frames that passed the CRC check
+  uint32_t crc_errors;     ///< Frames rejected for a CRC mismatch
+  uint32_t oversized;      ///< Frames rejected for exceeding the buffer
+  uint32_t rx_discarded;   ///< Bytes skipped while resyncing to STX
+  uint32_t idle_drops;     ///< Partial frames dropped after RX idle
+  uint32_t responses;      ///< Response and ack frames sent
+  uint32_t lz_raw_bytes;   ///< Program bytes executed from EXEC_LZ frames
+  uint32_t lz_wire_bytes;  ///< EXEC_LZ payload bytes they arrived as
+
+  /// Command results by error code (plain responses and tagged acks)
+  uint32_t results[LINK_RESULT_CODES];
+
+  /// Frame's last byte to the end of its dispatch
+  uint32_t decode[LINK_LATENCY_BUCKETS];
+  /// VM execution
+  uint32_t exec[LINK_LATENCY_BUCKETS];
+  /// Handing one response frame to the transport
+  uint32_t tx[LINK_LATENCY_BUCKETS];
+};
+
+/**
+ * @brief Lock-free telemetry block of a LinkPort
+ *
+ * Wire format of encode() (little-endian), served with CMD_STATS:
+ *   Header:     [VERSION u8][BUCKETS u8][TICKS_PER_US u16]
+ *   Counters:   [RX_BYTES][TX_BYTES][FRAMES][CRC_ERRORS][OVERSIZED]
+ *               [RX_DISCARDED][IDLE_DROPS][RESPONSES]
+ *               [LZ_RAW_BYTES][LZ_WIRE_BYTES] (u32 each; version 2)
+ *   Results:    LINK_RESULT_CODES x u32, indexed by error code
+ *   Histograms: decode, exec, tx; BUCKETS x u32 each
+ */
+class LinkTelemetry
+{
+ public:
+  /// Free-running 64-bit tick counter
+  using Clock = uint64_t (*)();
+
+  enum Counter : uint8_t
+  {
+    RX_BYTES,
+    TX_BYTES,
+    FRAMES,
+    CRC_ERRORS,
+    OVERSIZED,
+    RX_DISCARDED,
+    IDLE_DROPS,
+    RESPONSES,
+    LZ_RAW_BYTES,
+    LZ_WIRE_BYTES,
+    COUNTER_COUNT,
+  };
+
+  enum Histogram : uint8_t
+  {
+    DECODE,
+    EXEC,
+    TX,
+    HISTOGRAM_COUNT,
+  };
+
+  static constexpr uint8_t FORMAT_VERSION = 2;
+  static constexpr size_t ENCODED_LEN =
+      4 + 4 * (COUNTER_COUNT + LINK_RESULT_CODES +
+               HISTOGRAM_COUNT * LINK_LATENCY_BUCKETS);
+
+  LinkTelemetry() = default;
+
+  // Non-copyable
+  LinkTelemetry(const LinkTelemetry&) = delete;
+  LinkTelemetry& operator=(const LinkTelemetry&) = delete;
+
+  /**
+   * @brief Set the latency clock; without one only counters are kept
+   */
+  void set_clock(Clock clock, uint16_t ticks_per_us)
+  {
+    clock_ = clock;
+    ticks_per_us_ = (clock != nullptr) ? ticks_per_us : 0;
+  }
+
+  bool timed() const
+  {
+    return clock_ != nullptr;
+  }
+
+  uint64_t now() const
+  {
+    return (clock_ != nullptr) ? clock_() : 0;
+  }
+
+  void add(Counter counter, uint32_t n = 1)
+  {
+    counters_[counter].fetch_add(n, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Count a command result (proto::ERR_*)
+   */
+  void result(uint8_t err)
+  {
+    if (err < LINK_RESULT_CODES)
+    {
+      results_[err].fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * @brief Record the ticks elapsed since @p start (a now() value)
+   */
+  void record(Histogram histogram, uint64_t start)
+  {
+    if (clock_ != nullptr)
+    {
+      uint64_t ticks = clock_() - start;
+      histograms_[histogram][bucket(ticks)].fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * @brief Log2 bucket of a tick count, saturating at the top bucket
+   */
+  static size_t bucket(uint64_t ticks)
+  {
+    if (ticks == 0)
+    {
+      return 0;
+    }
+    size_t b = static_cast<size_t>(64 - __builtin_clzll(ticks));
+    return (b < LINK_LATENCY_BUCKETS) ? b : LINK_LATENCY_BUCKETS - 1;
+  }
+
+  /**
+   * @brief Read all counters (each field is read atomically)
+   */
+  LinkPortStats snapshot() const;
+
+  /**
+   * @brief Clear all counters and histograms
+   */
+  void reset();
+
+  /**
+   * @brief Serialize the telemetry
+   *
+   * @return Bytes written (0 if @p capacity < ENCODED_LEN)
+   */
+  size_t encode(uint8_t* out, size_t capacity) const;
+
+ private:
+  Clock clock_ = nullptr;
+  uint16_t ticks_per_us_ = 0;
+  std::atomic<uint32_t> counters_[COUNTER_COUNT] = {};
+  std::atomic<uint32_t> results_[LINK_RESULT_CODES] = {};
+  std::atomic<uint32_t> histograms_[HISTOGRAM_COUNT][LINK_LATENCY_BUCKETS] = {};
+};
+
+}  // namespace v4ports
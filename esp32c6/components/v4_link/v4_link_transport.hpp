@@ -0,0 +1,64 @@
+/**
+ * @file v4_link_transport.hpp
+ * @brief Byte transport interface for the V4-link port
+ *
+ * Decouples LinkPort from the physical link so the same framing and
+ * dispatch code runs over USB Serial/JTAG on target and over POSIX file
+ * descriptors (pty, pipe, Unix socket) on a Linux host.
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace v4ports
+{
+
+/**
+ * @brief Bidirectional byte transport
+ */
+class Transport
+{
+ public:
+  virtual ~Transport() = default;
+
+  /**
+   * @brief Read available bytes
+   *
+   * Waits at most @p timeout_ms for the first byte, then returns whatever
+   * is available without further blocking.
+   *
+   * @param buf         Destination buffer
+   * @param len         Buffer size in bytes
+   * @param timeout_ms  Maximum wait (0 = non-blocking)
+   * @return Number of bytes read (0 on timeout), or -1 on error
+   */
+  virtual int read(uint8_t* buf, size_t len, uint32_t timeout_ms) = 0;
+
+  /**
+   * @brief Write bytes
+   *
+   * Buffered transports only queue the bytes here and send them on flush().
+   *
+   * @param data  Bytes to send
+   * @param len   Number of bytes
+   * @return Number of bytes accepted (0 if dropped), or -1 on error
+   */
+  virtual int write(const uint8_t* data, size_t len) = 0;
+
+  /**
+   * @brief Hand queued output to the driver without blocking
+   *
+   * @return Number of bytes still queued
+   */
+  virtual size_t flush()
+  {
+    return 0;
+  }
+};
+
+}  // namespace v4ports
@@ -0,0 +1,241 @@
+/**
+ * @file v4_link_transport_posix.cpp
+ * @brief POSIX file descriptor transport for Linux host builds
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include "v4_link_transport_posix.hpp"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+namespace v4ports
+{
+
+PosixTransport::PosixTransport(int read_fd, int write_fd, bool owns_fds,
+                               size_t tx_ring_size)
+    : read_fd_(read_fd),
+      write_fd_(write_fd),
+      owns_fds_(owns_fds),
+      write_flags_(fcntl(write_fd, F_GETFL)),
+      tx_(tx_ring_size)
+{
+  // flush() must never block on a peer that stopped reading
+  if (write_flags_ >= 0)
+  {
+    fcntl(write_fd_, F_SETFL, write_flags_ | O_NONBLOCK);
+  }
+}
+
+PosixTransport::~PosixTransport()
+{
+  if (!owns_fds_ && write_flags_ >= 0)
+  {
+    fcntl(write_fd_, F_SETFL, write_flags_);
+  }
+  if (owns_fds_)
+  {
+    close(read_fd_);
+    if (write_fd_ != read_fd_)
+    {
+      close(write_fd_);
+    }
+  }
+  if (hold_fd_ >= 0)
+  {
+    close(hold_fd_);
+  }
+}
+
+std::unique_ptr<PosixTransport> PosixTransport::open_pty(std::string& slave_path)
+{
+  int master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+  {
+    std::perror("posix_openpt");
+    if (master >= 0)
+    {
+      close(master);
+    }
+    return nullptr;
+  }
+
+  const char* name = ptsname(master);
+  if (name == nullptr)
+  {
+    std::perror("ptsname");
+    close(master);
+    return nullptr;
+  }
+  slave_path = name;
+
+  // Raw mode: no echo, no line discipline, 8-bit clean
+  int slave = open(name, O_RDWR | O_NOCTTY);
+  if (slave >= 0)
+  {
+    struct termios tio;
+    if (tcgetattr(slave, &tio) == 0)
+    {
+      cfmakeraw(&tio);
+      tcsetattr(slave, TCSANOW, &tio);
+    }
+  }
+
+  std::unique_ptr<PosixTransport> transport(new PosixTransport(master, master, true));
+  transport->hold_fd_ = slave;
+  return transport;
+}
+
+std::unique_ptr<PosixTransport> PosixTransport::open_stdio()
+{
+  return std::unique_ptr<PosixTransport>(
+      new PosixTransport(STDIN_FILENO, STDOUT_FILENO, false));
+}
+
+std::unique_ptr<PosixTransport> PosixTransport::accept_unix(const std::string& path)
+{
+  struct sockaddr_un addr;
+  if (path.size() >= sizeof(addr.sun_path))
+  {
+    std::fprintf(stderr, "Socket path too long: %s\n", path.c_str());
+    return nullptr;
+  }
+
+  int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listener < 0)
+  {
+    std::perror("socket");
+    return nullptr;
+  }
+
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+  unlink(path.c_str());
+
+  if (bind(listener, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 ||
+      listen(listener, 1) != 0)
+  {
+    std::perror("bind/listen");
+    close(listener);
+    return nullptr;
+  }
+
+  int fd = accept(listener, nullptr, nullptr);
+  close(listener);
+  if (fd < 0)
+  {
+    std::perror("accept");
+    return nullptr;
+  }
+
+  return std::unique_ptr<PosixTransport>(new PosixTransport(fd, fd, true));
+}
+
+int PosixTransport::read(uint8_t* buf, size_t len, uint32_t timeout_ms)
+{
+  struct pollfd pfd = {read_fd_, POLLIN, 0};
+  int ready = poll(&pfd, 1, static_cast<int>(timeout_ms));
+  if (ready < 0)
+  {
+    return (errno == EINTR) ? 0 : -1;
+  }
+  if (ready == 0)
+  {
+    return 0;
+  }
+  if (!(pfd.revents & POLLIN))
+  {
+    // Peer hung up (pipe/socket closed)
+    closed_ = true;
+    return -1;
+  }
+
+  ssize_t n = ::read(read_fd_, buf, len);
+  if (n < 0)
+  {
+    return (errno == EAGAIN || errno == EINTR) ? 0 : -1;
+  }
+  if (n == 0)
+  {
+    closed_ = true;
+    return -1;
+  }
+  return static_cast<int>(n);
+}
+
+int PosixTransport::write(const uint8_t* data, size_t len)
+{
+  std::lock_guard<std::mutex> lock(tx_lock_);
+  return tx_.push(data, len) ? static_cast<int>(len) : 0;
+}
+
+size_t PosixTransport::flush()
+{
+  while (true)
+  {
+    const uint8_t* run;
+    size_t len;
+    {
+      std::lock_guard<std::mutex> lock(tx_lock_);
+      len = tx_.peek(run);
+    }
+    if (len == 0)
+    {
+      return 0;
+    }
+
+    ssize_t n = ::write(write_fd_, run, len);
+    if (n < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      if (errno == EAGAIN)
+      {
+        // Peer not reading: wait briefly, then retry on the next flush
+        struct pollfd pfd = {write_fd_, POLLOUT, 0};
+        if (poll(&pfd, 1, TX_POLL_MS) > 0)
+        {
+          continue;
+        }
+        std::lock_guard<std::mutex> lock(tx_lock_);
+        return tx_.size();
+      }
+      // Peer gone (EPIPE etc.): nothing queued can be delivered
+      closed_ = true;
+      std::lock_guard<std::mutex> lock(tx_lock_);
+      tx_.clear();
+      return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(tx_lock_);
+    tx_.consume(static_cast<size_t>(n));
+  }
+}
+
+TxRingStats PosixTransport::tx_stats() const
+{
+  std::lock_guard<std::mutex> lock(tx_lock_);
+  return tx_.stats();
+}
+
+void PosixTransport::reset_tx_stats()
+{
+  std::lock_guard<std::mutex> lock(tx_lock_);
+  tx_.reset_stats();
+}
+
+}  // namespace v4ports
@@ -0,0 +1,122 @@
+/**
+ * @file v4_link_transport_posix.hpp
+ * @brief POSIX file descriptor transport for Linux host builds
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "v4_link_transport.hpp"
+#include "v4_link_tx_ring.hpp"
+
+namespace v4ports
+{
+
+/**
+ * @brief Transport over POSIX file descriptors
+ *
+ * Works with anything poll()-able: pseudo terminals, pipes, socketpairs
+ * and Unix domain sockets.
+ *
+ * As with the USB transport, write() queues into a bounded TxRing and
+ * flush() writes to the (non-blocking) descriptor, waiting at most
+ * TX_POLL_MS for a peer that is not reading. A stalled peer costs the link
+ * loop that wait per flush; responses that no longer fit are dropped.
+ *
+ * Example usage:
+ * @code
+ * std::string path;
+ * auto transport = v4ports::PosixTransport::open_pty(path);
+ * // Host tools can now open `path` like a serial port
+ * v4ports::LinkPort link(vm, std::move(transport));
+ * @endcode
+ */
+class PosixTransport : public Transport
+{
+ public:
+  /// Longest wait in flush() for the peer to accept output
+  static constexpr int TX_POLL_MS = 10;
+
+  /**
+   * @brief Wrap existing file descriptors
+   *
+   * Puts @p write_fd in non-blocking mode (restored on destruction if the
+   * descriptors are not owned).
+   *
+   * @param read_fd       Descriptor to read from
+   * @param write_fd      Descriptor to write to (may equal read_fd)
+   * @param owns_fds      Close descriptors on destruction
+   * @param tx_ring_size  Outbound queue budget in bytes
+   */
+  PosixTransport(int read_fd, int write_fd, bool owns_fds = true,
+                 size_t tx_ring_size = 4096);
+
+  ~PosixTransport() override;
+
+  // Non-copyable
+  PosixTransport(const PosixTransport&) = delete;
+  PosixTransport& operator=(const PosixTransport&) = delete;
+
+  /**
+   * @brief Create a raw-mode pseudo terminal
+   *
+   * @param slave_path  Receives the slave device path (e.g. /dev/pts/3)
+   * @return Transport on the master side, or nullptr on failure
+   */
+  static std::unique_ptr<PosixTransport> open_pty(std::string& slave_path);
+
+  /**
+   * @brief Use the process stdin/stdout (e.g. behind socat or a pipe)
+   */
+  static std::unique_ptr<PosixTransport> open_stdio();
+
+  /**
+   * @brief Listen on a Unix domain socket and accept one client
+   *
+   * Blocks until a client connects.
+   *
+   * @param path  Socket path (removed and re-created)
+   * @return Transport on the accepted connection, or nullptr on failure
+   */
+  static std::unique_ptr<PosixTransport> accept_unix(const std::string& path);
+
+  int read(uint8_t* buf, size_t len, uint32_t timeout_ms) override;
+  int write(const uint8_t* data, size_t len) override;
+  size_t flush() override;
+
+  /**
+   * @brief Get a consistent snapshot of the TX queue statistics
+   */
+  TxRingStats tx_stats() const;
+
+  /**
+   * @brief Clear the TX queue statistics
+   */
+  void reset_tx_stats();
+
+  /**
+   * @brief Check whether the peer has closed the connection
+   */
+  bool closed() const
+  {
+    return closed_;
+  }
+
+ private:
+  int read_fd_;
+  int write_fd_;
+  bool owns_fds_;
+  int hold_fd_ = -1;  // pty slave kept open so the master never sees EIO/HUP
+  int write_flags_;   // File status flags of write_fd before construction
+  bool closed_ = false;
+  TxRing tx_;
+  mutable std::mutex tx_lock_;
+};
+
+}  // namespace v4ports
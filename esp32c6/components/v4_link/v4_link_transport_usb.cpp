@@ -0,0 +1,106 @@
+/**
+ * @file v4_link_transport_usb.cpp
+ * @brief USB Serial/JTAG transport for ESP32-C6
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include "v4_link_transport_usb.hpp"
+
+#include <cstdlib>
+
+#include "driver/usb_serial_jtag.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+
+static const char* TAG = "v4_link_usb";
+
+namespace v4ports
+{
+
+UsbSerialJtagTransport::UsbSerialJtagTransport(size_t buffer_size, size_t tx_ring_size)
+    // The driver accepts a write only if it fits whole, so hand it at most
+    // half of its TX buffer at a time
+    : tx_(tx_ring_size), tx_chunk_(buffer_size / 2)
+{
+  // USB Serial/JTAG configuration
+  usb_serial_jtag_driver_config_t usb_config = {
+      .tx_buffer_size = static_cast<uint32_t>(buffer_size),
+      .rx_buffer_size = static_cast<uint32_t>(buffer_size),
+  };
+
+  // Install USB Serial/JTAG driver
+  esp_err_t ret = usb_serial_jtag_driver_install(&usb_config);
+  if (ret != ESP_OK)
+  {
+    ESP_LOGE(TAG, "Failed to install USB Serial/JTAG driver: %s", esp_err_to_name(ret));
+    abort();
+  }
+}
+
+UsbSerialJtagTransport::~UsbSerialJtagTransport()
+{
+  usb_serial_jtag_driver_uninstall();
+  ESP_LOGI(TAG, "USB Serial/JTAG driver uninstalled");
+}
+
+int UsbSerialJtagTransport::read(uint8_t* buf, size_t len, uint32_t timeout_ms)
+{
+  return usb_serial_jtag_read_bytes(buf, len, pdMS_TO_TICKS(timeout_ms));
+}
+
+int UsbSerialJtagTransport::write(const uint8_t* data, size_t len)
+{
+  taskENTER_CRITICAL(&tx_lock_);
+  bool queued = tx_.push(data, len);
+  taskEXIT_CRITICAL(&tx_lock_);
+  return queued ? static_cast<int>(len) : 0;
+}
+
+size_t UsbSerialJtagTransport::flush()
+{
+  while (true)
+  {
+    const uint8_t* run;
+    taskENTER_CRITICAL(&tx_lock_);
+    size_t len = tx_.peek(run);
+    taskEXIT_CRITICAL(&tx_lock_);
+    if (len == 0)
+    {
+      return 0;
+    }
+
+    len = (len < tx_chunk_) ? len : tx_chunk_;
+    int written = usb_serial_jtag_write_bytes((const char*)run, len, 0);
+    if (written <= 0)
+    {
+      // Driver buffer full (host not reading); retry on the next flush
+      taskENTER_CRITICAL(&tx_lock_);
+      size_t queued = tx_.size();
+      taskEXIT_CRITICAL(&tx_lock_);
+      return queued;
+    }
+
+    taskENTER_CRITICAL(&tx_lock_);
+    tx_.consume(static_cast<size_t>(written));
+    taskEXIT_CRITICAL(&tx_lock_);
+  }
+}
+
+TxRingStats UsbSerialJtagTransport::tx_stats() const
+{
+  taskENTER_CRITICAL(&tx_lock_);
+  TxRingStats s = tx_.stats();
+  taskEXIT_CRITICAL(&tx_lock_);
+  return s;
+}
+
+void UsbSerialJtagTransport::reset_tx_stats()
+{
+  taskENTER_CRITICAL(&tx_lock_);
+  tx_.reset_stats();
+  taskEXIT_CRITICAL(&tx_lock_);
+}
+
+}  // namespace v4ports
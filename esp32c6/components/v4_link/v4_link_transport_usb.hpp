@@ -0,0 +1,66 @@
+/**
+ * @file v4_link_transport_usb.hpp
+ * @brief USB Serial/JTAG transport for ESP32-C6
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+#include "v4_link_transport.hpp"
+#include "v4_link_tx_ring.hpp"
+
+namespace v4ports
+{
+
+/**
+ * @brief Transport over the ESP32-C6 native USB Serial/JTAG controller
+ *
+ * Installs the USB Serial/JTAG driver on construction and uninstalls it on
+ * destruction.
+ *
+ * Output never blocks: write() queues into a bounded TxRing and flush()
+ * moves as much as the driver accepts right now. If the host stops reading,
+ * responses that no longer fit are dropped (see TxRing) instead of stalling
+ * the link task and the VM.
+ */
+class UsbSerialJtagTransport : public Transport
+{
+ public:
+  /**
+   * @brief Install USB Serial/JTAG driver
+   *
+   * @param buffer_size   Driver RX/TX ring buffer size in bytes
+   * @param tx_ring_size  Outbound queue budget in bytes
+   */
+  explicit UsbSerialJtagTransport(size_t buffer_size = 1024, size_t tx_ring_size = 2048);
+
+  ~UsbSerialJtagTransport() override;
+
+  // Non-copyable
+  UsbSerialJtagTransport(const UsbSerialJtagTransport&) = delete;
+  UsbSerialJtagTransport& operator=(const UsbSerialJtagTransport&) = delete;
+
+  int read(uint8_t* buf, size_t len, uint32_t timeout_ms) override;
+  int write(const uint8_t* data, size_t len) override;
+  size_t flush() override;
+
+  /**
+   * @brief Get a consistent snapshot of the TX queue statistics
+   */
+  TxRingStats tx_stats() const;
+
+  /**
+   * @brief Clear the TX queue statistics
+   */
+  void reset_tx_stats();
+
+ private:
+  TxRing tx_;
+  size_t tx_chunk_;
+  mutable portMUX_TYPE tx_lock_ = portMUX_INITIALIZER_UNLOCKED;
+};
+
+}  // namespace v4ports
@@ -0,0 +1,78 @@
+/**
+ * @file v4_link_tx_ring.cpp
+ * @brief Bounded outbound ring buffer for V4-link responses
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include "v4_link_tx_ring.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace v4ports
+{
+
+TxRing::TxRing(size_t capacity) : buf_(new uint8_t[capacity]), capacity_(capacity) {}
+
+bool TxRing::push(const uint8_t* data, size_t len)
+{
+  if (len > capacity_ - size_)
+  {
+    stats_.frames_dropped++;
+    stats_.bytes_dropped += static_cast<uint32_t>(len);
+    return false;
+  }
+
+  // Copy in up to two pieces around the wrap point
+  size_t tail = (head_ + size_) % capacity_;
+  size_t first = std::min(len, capacity_ - tail);
+  std::memcpy(buf_.get() + tail, data, first);
+  std::memcpy(buf_.get(), data + first, len - first);
+  size_ += len;
+
+  stats_.frames_queued++;
+  stats_.high_water = std::max(stats_.high_water, static_cast<uint32_t>(size_));
+  return true;
+}
+
+size_t TxRing::peek(const uint8_t*& data) const
+{
+  data = buf_.get() + head_;
+  return std::min(size_, capacity_ - head_);
+}
+
+void TxRing::consume(size_t n)
+{
+  n = std::min(n, size_);
+  head_ = (head_ + n) % capacity_;
+  size_ -= n;
+  if (size_ == 0)
+  {
+    // Restart at the front so the next burst is one contiguous run
+    head_ = 0;
+  }
+  stats_.writes++;
+}
+
+void TxRing::clear()
+{
+  head_ = 0;
+  size_ = 0;
+}
+
+TxRingStats TxRing::stats() const
+{
+  TxRingStats s = stats_;
+  s.queued_bytes = static_cast<uint32_t>(size_);
+  return s;
+}
+
+void TxRing::reset_stats()
+{
+  stats_ = {};
+  stats_.high_water = static_cast<uint32_t>(size_);
+}
+
+}  // namespace v4ports
@@ -0,0 +1,118 @@
+/**
+ * @file v4_link_tx_ring.hpp
+ * @brief Bounded outbound ring buffer for V4-link responses
+ *
+ * Portable (no ESP-IDF dependencies) so it can be built and benchmarked
+ * on a Linux host as well as on the target.
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace v4ports
+{
+
+/**
+ * @brief TX ring statistics
+ */
+struct TxRingStats
+{
+  uint32_t queued_bytes;    ///< Bytes currently queued
+  uint32_t high_water;      ///< Maximum of queued_bytes since last reset
+  uint32_t frames_queued;   ///< Frames accepted
+  uint32_t frames_dropped;  ///< Frames dropped because the ring was full
+  uint32_t bytes_dropped;   ///< Bytes of dropped frames
+  uint32_t writes;          ///< Spans handed to the driver (after coalescing)
+};
+
+/**
+ * @brief Fixed-size byte ring with whole-frame tail drop
+ *
+ * Frames are appended back to back, so responses produced while one burst
+ * of input is processed leave in as few driver writes as possible.
+ *
+ * Drop policy: a frame that does not fit in the free space is dropped as a
+ * whole (never truncated) and counted; already queued frames are kept. The
+ * host sees a missing response and retries after its timeout.
+ *
+ * Not thread-safe; the owner serializes access.
+ */
+class TxRing
+{
+ public:
+  /**
+   * @brief Construct ring
+   *
+   * @param capacity  Memory budget in bytes
+   */
+  explicit TxRing(size_t capacity);
+
+  // Non-copyable
+  TxRing(const TxRing&) = delete;
+  TxRing& operator=(const TxRing&) = delete;
+
+  /**
+   * @brief Queue a frame
+   *
+   * @return true if queued, false if dropped (ring full)
+   */
+  bool push(const uint8_t* data, size_t len);
+
+  /**
+   * @brief Get the oldest contiguous run of queued bytes
+   *
+   * @param data  Receives a pointer to the run
+   * @return Run length (0 if empty)
+   */
+  size_t peek(const uint8_t*& data) const;
+
+  /**
+   * @brief Remove @p n bytes from the front after they were sent
+   */
+  void consume(size_t n);
+
+  /**
+   * @brief Drop everything queued (stats are kept)
+   */
+  void clear();
+
+  size_t size() const
+  {
+    return size_;
+  }
+
+  size_t capacity() const
+  {
+    return capacity_;
+  }
+
+  size_t free_space() const
+  {
+    return capacity_ - size_;
+  }
+
+  /**
+   * @brief Get statistics
+   */
+  TxRingStats stats() const;
+
+  /**
+   * @brief Clear counters (high-water restarts from the current fill)
+   */
+  void reset_stats();
+
+ private:
+  std::unique_ptr<uint8_t[]> buf_;
+  size_t capacity_;
+  size_t head_ = 0;  // Next byte to send
+  size_t size_ = 0;
+  TxRingStats stats_ = {};
+};
+
+}  // namespace v4ports
@@ -0,0 +1,320 @@
+/**
+ * @file v4_repl_compiler.c
+ * @brief Reusable V4-front compiler instance backed by a caller arena
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include "v4_repl_compiler.h"
+
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#else
+#include <ucontext.h>
+#endif
+
+#define ALIGN 16
+#define STACK_FILL 0xA5
+#define STACK_FILL_WORD 0xA5A5A5A5u
+// Bytes left unpainted below the painting frame (memset's own frame)
+#define PAINT_MARGIN 256
+
+struct V4Compiler
+{
+  uint8_t* stack;     // Compile stack (arena)
+  size_t stack_size;
+  uint8_t* painted;   // [stack, painted) still holds STACK_FILL
+  uint8_t* out;       // Output region (arena)
+  size_t out_size;
+  V4CompilerStats stats;
+
+  // Current job
+  V4Dict* dict;
+  const char* source;
+  V4FrontBuf* result;
+  V4FrontError* error;
+  int status;
+
+#ifdef ESP_PLATFORM
+  StaticTask_t tcb;
+  TaskHandle_t task;
+  TaskHandle_t caller;
+#else
+  ucontext_t caller;
+  ucontext_t job;
+#endif
+};
+
+static size_t align_up(size_t n)
+{
+  return (n + ALIGN - 1) & ~(size_t)(ALIGN - 1);
+}
+
+// Output region allocator; returns NULL once it is full
+static void* out_alloc(V4Compiler* c, size_t* used, size_t len, size_t align)
+{
+  size_t pos = (*used + align - 1) & ~(align - 1);
+  if (pos > c->out_size || len > c->out_size - pos)
+  {
+    return NULL;
+  }
+  *used = pos + len;
+  return c->out + pos;
+}
+
+// Copy V4-front's heap result into the output region
+static int copy_result(V4Compiler* c, const V4FrontBuf* buf)
+{
+  V4FrontBuf* out = c->result;
+  size_t used = 0;
+  memset(out, 0, sizeof(*out));
+
+  if (buf->word_count > 0)
+  {
+    out->words = (V4FrontWord*)out_alloc(c, &used,
+                                         (size_t)buf->word_count * sizeof(V4FrontWord),
+                                         sizeof(void*));
+    if (!out->words)
+    {
+      return V4_COMPILER_ERR_OUTPUT;
+    }
+    for (int i = 0; i < buf->word_count; i++)
+    {
+      const V4FrontWord* src = &buf->words[i];
+      size_t name_len = src->name ? strlen(src->name) + 1 : 0;
+      V4FrontWord* dst = &out->words[i];
+      memset(dst, 0, sizeof(*dst));
+      dst->name = (char*)out_alloc(c, &used, name_len, 1);
+      dst->code = (uint8_t*)out_alloc(c, &used, src->code_len, 1);
+      if ((name_len > 0 && !dst->name) || (src->code_len > 0 && !dst->code))
+      {
+        return V4_COMPILER_ERR_OUTPUT;
+      }
+      if (name_len > 0)
+      {
+        memcpy(dst->name, src->name, name_len);
+      }
+      memcpy(dst->code, src->code, src->code_len);
+      dst->code_len = src->code_len;
+    }
+    out->word_count = buf->word_count;
+  }
+
+  if (buf->data && buf->size > 0)
+  {
+    out->data = (uint8_t*)out_alloc(c, &used, buf->size, 1);
+    if (!out->data)
+    {
+      return V4_COMPILER_ERR_OUTPUT;
+    }
+    memcpy(out->data, buf->data, buf->size);
+    out->size = buf->size;
+  }
+
+  c->stats.output_used = (uint32_t)used;
+  return 0;
+}
+
+static int compile_job(V4Compiler* c)
+{
+  V4FrontContext* ctx = v4front_context_create();
+  if (!ctx)
+  {
+    return V4_COMPILER_ERR_CONTEXT;
+  }
+  if (c->dict && v4_dict_bind(c->dict, ctx, c->source) < 0)
+  {
+    v4front_context_destroy(ctx);
+    return V4_COMPILER_ERR_CONTEXT;
+  }
+
+  V4FrontBuf buf;
+  memset(&buf, 0, sizeof(buf));
+  v4front_err err = v4front_compile_with_context_ex(ctx, c->source, &buf, c->error);
+  v4front_context_destroy(ctx);
+  if (err != 0)
+  {
+    return V4_COMPILER_ERR_COMPILE;
+  }
+
+  int status = copy_result(c, &buf);
+  v4front_free(&buf);
+  return status;
+}
+
+// Runs on the compile stack
+static void run_job(V4Compiler* c)
+{
+  // Paint the unused stack below this frame, then find the lowest byte the
+  // compile overwrote (the stack grows down). Bytes below the last compile's
+  // low-water mark are still painted, so only the part above it is redone.
+  volatile uint8_t marker = 0;
+  uintptr_t top = (uintptr_t)&marker - PAINT_MARGIN;
+  uint8_t* limit = c->stack + (top - (uintptr_t)c->stack);
+  if (limit > c->painted)
+  {
+    memset(c->painted, STACK_FILL, (size_t)(limit - c->painted));
+  }
+
+  c->stats.output_used = 0;
+  c->status = compile_job(c);
+
+  // Word-wise up to the first dirty word, then byte-wise within it
+  const uint32_t* w = (const uint32_t*)c->stack;
+  while ((const uint8_t*)(w + 1) <= limit && *w == STACK_FILL_WORD)
+  {
+    w++;
+  }
+  const uint8_t* p = (const uint8_t*)w;
+  while (p < limit && *p == STACK_FILL)
+  {
+    p++;
+  }
+  c->painted = (uint8_t*)p;
+  c->stats.stack_used = (uint32_t)(c->stack + c->stack_size - p);
+  if (c->stats.stack_used > c->stats.stack_peak)
+  {
+    c->stats.stack_peak = c->stats.stack_used;
+  }
+  if (c->stats.output_used > c->stats.output_peak)
+  {
+    c->stats.output_peak = c->stats.output_used;
+  }
+}
+
+#ifdef ESP_PLATFORM
+
+static void compiler_task(void* arg)
+{
+  V4Compiler* c = (V4Compiler*)arg;
+  while (1)
+  {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    run_job(c);
+    xTaskNotifyGive(c->caller);
+  }
+}
+
+static int start(V4Compiler* c)
+{
+  c->task = xTaskCreateStatic(compiler_task, "v4_compile", (uint32_t)c->stack_size, c,
+                              uxTaskPriorityGet(NULL), (StackType_t*)c->stack, &c->tcb);
+  return c->task ? 0 : -1;
+}
+
+static void run(V4Compiler* c)
+{
+  c->caller = xTaskGetCurrentTaskHandle();
+  xTaskNotifyGive(c->task);
+  ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+}
+
+static void stop(V4Compiler* c)
+{
+  vTaskDelete(c->task);
+}
+
+#else
+
+static _Thread_local V4Compiler* running;
+
+static void job_entry(void)
+{
+  run_job(running);
+}
+
+static int start(V4Compiler* c)
+{
+  (void)c;
+  return 0;
+}
+
+static void run(V4Compiler* c)
+{
+  getcontext(&c->job);
+  c->job.uc_stack.ss_sp = c->stack;
+  c->job.uc_stack.ss_size = c->stack_size;
+  c->job.uc_link = &c->caller;
+  makecontext(&c->job, job_entry, 0);
+  running = c;
+  swapcontext(&c->caller, &c->job);
+  running = NULL;
+}
+
+static void stop(V4Compiler* c)
+{
+  (void)c;
+}
+
+#endif  // ESP_PLATFORM
+
+size_t v4_compiler_overhead(void)
+{
+  // Instance plus worst-case alignment of the arena and the stack
+  return align_up(sizeof(V4Compiler)) + 2 * ALIGN;
+}
+
+V4Compiler* v4_compiler_create(void* arena, size_t arena_size, size_t stack_size)
+{
+  uintptr_t base = ((uintptr_t)arena + ALIGN - 1) & ~(uintptr_t)(ALIGN - 1);
+  size_t skew = (size_t)(base - (uintptr_t)arena);
+  stack_size &= ~(size_t)(ALIGN - 1);
+  size_t head = align_up(sizeof(V4Compiler));
+  if (stack_size == 0 || arena_size < skew + head + stack_size)
+  {
+    return NULL;
+  }
+
+  V4Compiler* c = (V4Compiler*)base;
+  memset(c, 0, sizeof(*c));
+  c->stack = (uint8_t*)base + head;
+  c->stack_size = stack_size;
+  c->painted = c->stack;
+  c->out = c->stack + stack_size;
+  c->out_size = arena_size - skew - head - stack_size;
+  c->stats.stack_size = (uint32_t)stack_size;
+  c->stats.output_size = (uint32_t)c->out_size;
+
+  if (start(c) != 0)
+  {
+    return NULL;
+  }
+  return c;
+}
+
+void v4_compiler_destroy(V4Compiler* compiler)
+{
+  if (compiler)
+  {
+    stop(compiler);
+  }
+}
+
+int v4_compiler_compile(V4Compiler* compiler, V4Dict* dict, const char* source,
+                        V4FrontBuf* out, V4FrontError* error)
+{
+  compiler->dict = dict;
+  compiler->source = source;
+  compiler->result = out;
+  compiler->error = error;
+  compiler->status = V4_COMPILER_ERR_CONTEXT;
+  memset(out, 0, sizeof(*out));
+
+  run(compiler);
+
+  compiler->stats.compiles++;
+  if (compiler->status != 0)
+  {
+    memset(out, 0, sizeof(*out));
+  }
+  return compiler->status;
+}
+
+const V4CompilerStats* v4_compiler_stats(const V4Compiler* compiler)
+{
+  return &compiler->stats;
+}
@@ -0,0 +1,120 @@
+/**
+ * @file v4_repl_compiler.h
+ * @brief Reusable V4-front compiler instance backed by a caller arena
+ *
+ * V4-front keeps its working state (token buffer, control stack, word
+ * table) in locals of compile_internal(), about 7 KB of stack even with
+ * the reduced ESP32-C6 limits, so every task that compiles Forth needs an
+ * oversized stack. A compiler instance runs V4-front on a stack carved out
+ * of a caller-provided arena instead:
+ *
+ *   [V4Compiler][compile stack][output]
+ *
+ * On ESP-IDF the stack belongs to a statically allocated compiler task
+ * that the calling task hands each source to and waits for (task
+ * notifications); on the host the compile runs on the caller's thread,
+ * switched to the arena stack with ucontext. Either way the caller only
+ * needs stack for its own frames.
+ *
+ * The compiled words and immediate code are copied into the output region
+ * and V4-front's heap buffers are freed before v4_compiler_compile()
+ * returns, so results need no v4front_free() and nothing stays on the heap
+ * between compiles. The stack is painted before each compile, which gives
+ * the exact stack peak per compile alongside the output arena usage.
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "v4_repl_dict.h"
+#include "v4front/compile.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Compiler error codes */
+#define V4_COMPILER_ERR_OUTPUT -160  /**< Result does not fit in the output region */
+#define V4_COMPILER_ERR_CONTEXT -161 /**< No context, or the source uses too many words */
+#define V4_COMPILER_ERR_COMPILE -162 /**< V4-front rejected the source (V4FrontError) */
+
+typedef struct V4Compiler V4Compiler;
+
+/**
+ * @brief Stack and arena usage
+ */
+typedef struct V4CompilerStats
+{
+  uint32_t compiles;    /**< Calls to v4_compiler_compile() */
+  uint32_t stack_size;  /**< Compile stack size in bytes */
+  uint32_t stack_used;  /**< Stack bytes used by the last compile */
+  uint32_t stack_peak;  /**< Largest stack_used so far */
+  uint32_t output_size; /**< Output region size in bytes */
+  uint32_t output_used; /**< Output bytes of the last compile */
+  uint32_t output_peak; /**< Largest output_used so far */
+} V4CompilerStats;
+
+/**
+ * @brief Arena bytes taken by the instance itself (platform dependent)
+ *
+ * An arena of v4_compiler_overhead() + stack + output bytes gives an
+ * output region of at least the requested size.
+ */
+size_t v4_compiler_overhead(void);
+
+/**
+ * @brief Create a compiler instance in an arena
+ *
+ * The instance, its stack and its output region all live in @p arena;
+ * nothing is allocated. On ESP-IDF the compiler task runs at the priority
+ * of the creating task.
+ *
+ * @param arena       Memory for the instance; must stay valid until
+ *                    v4_compiler_destroy()
+ * @param arena_size  Arena size in bytes; what is left after the instance
+ *                    and @p stack_size is the output region
+ * @param stack_size  Compile stack size in bytes (V4-front needs about
+ *                    7 KB with the ESP32-C6 limits)
+ * @return Compiler, or NULL if the arena is too small (or the task could
+ *         not be created)
+ */
+V4Compiler* v4_compiler_create(void* arena, size_t arena_size, size_t stack_size);
+
+/**
+ * @brief Destroy a compiler instance (the arena may be reused afterwards)
+ */
+void v4_compiler_destroy(V4Compiler* compiler);
+
+/**
+ * @brief Compile Forth source on the compiler stack
+ *
+ * The source is compiled against a fresh V4-front context into which the
+ * words of @p dict that it refers to are bound (v4_dict_bind()).
+ * Must not be called from two tasks at once.
+ *
+ * @param compiler  Compiler
+ * @param dict      Words the source may use, or NULL
+ * @param source    NUL-terminated Forth source
+ * @param out       Receives the result; its buffers point into the arena
+ *                  and stay valid until the next compile (do not pass it
+ *                  to v4front_free())
+ * @param error     Receives the position and message of a compile error
+ * @return 0, V4_COMPILER_ERR_COMPILE, V4_COMPILER_ERR_CONTEXT, or
+ *         V4_COMPILER_ERR_OUTPUT
+ */
+int v4_compiler_compile(V4Compiler* compiler, V4Dict* dict, const char* source,
+                        V4FrontBuf* out, V4FrontError* error);
+
+/**
+ * @brief Get the stack and arena usage
+ */
+const V4CompilerStats* v4_compiler_stats(const V4Compiler* compiler);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,189 @@
+/**
+ * @file v4_repl_dict.c
+ * @brief Hashed REPL dictionary for the V4-front compiler context
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include "v4_repl_dict.h"
+
+#include <string.h>
+
+// Arena entry: [LEN u8][NAME...][NUL]
+#define ENTRY_OVERHEAD 2
+
+static char fold(char c)
+{
+  return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
+
+static int is_space(char c)
+{
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// FNV-1a over the case-folded name
+static uint32_t hash_name(const char* name, size_t len)
+{
+  uint32_t h = 2166136261u;
+  for (size_t i = 0; i < len; i++)
+  {
+    h ^= (uint8_t)fold(name[i]);
+    h *= 16777619u;
+  }
+  return h;
+}
+
+static int name_equal(const V4Dict* dict, const V4DictSlot* slot, const char* name,
+                      size_t len)
+{
+  const char* entry = dict->names + slot->name - 1;
+  if ((uint8_t)entry[0] != len)
+  {
+    return 0;
+  }
+  for (size_t i = 0; i < len; i++)
+  {
+    if (fold(entry[1 + i]) != fold(name[i]))
+    {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+// Slot holding @p name, or the empty slot where it would be inserted. The
+// load limit keeps an empty slot in every probe sequence.
+static uint32_t probe(const V4Dict* dict, const char* name, size_t len)
+{
+  uint32_t i = hash_name(name, len) & dict->mask;
+  while (dict->slots[i].name != 0 && !name_equal(dict, &dict->slots[i], name, len))
+  {
+    i = (i + 1) & dict->mask;
+  }
+  return i;
+}
+
+void v4_dict_init(V4Dict* dict, V4DictSlot* slots, size_t slot_count, char* names,
+                  size_t names_size)
+{
+  // Largest power of two not above slot_count
+  size_t n = 1;
+  while (n * 2 <= slot_count && n * 2 <= 0x80000000u)
+  {
+    n *= 2;
+  }
+
+  memset(dict, 0, sizeof(*dict));
+  if (slot_count > 0)
+  {
+    memset(slots, 0, n * sizeof(V4DictSlot));
+    dict->slots = slots;
+    dict->mask = (uint32_t)(n - 1);
+  }
+  dict->names = names;
+  dict->names_size = (names_size > 0xFFFFFFFEu) ? 0xFFFFFFFEu : (uint32_t)names_size;
+}
+
+int v4_dict_define(V4Dict* dict, const char* name, int wid)
+{
+  size_t len = name ? strlen(name) : 0;
+  if (len == 0 || len > V4_DICT_NAME_MAX)
+  {
+    return V4_DICT_ERR_NAME;
+  }
+
+  if (dict->slots != NULL)
+  {
+    V4DictSlot* slot = &dict->slots[probe(dict, name, len)];
+    if (slot->name != 0)
+    {
+      slot->wid = (uint16_t)wid;
+      return 0;
+    }
+  }
+
+  // Keep at least a quarter of the slots empty so probe sequences stay short
+  uint64_t capacity = (uint64_t)(dict->slots ? dict->mask + 1 : 0);
+  if (4 * ((uint64_t)dict->count + 1) > 3 * capacity ||
+      len + ENTRY_OVERHEAD > dict->names_size - dict->names_used)
+  {
+    return V4_DICT_ERR_FULL;
+  }
+
+  char* entry = dict->names + dict->names_used;
+  entry[0] = (char)len;
+  memcpy(entry + 1, name, len);
+  entry[1 + len] = '\0';
+
+  V4DictSlot* slot = &dict->slots[probe(dict, name, len)];
+  slot->name = dict->names_used + 1;
+  slot->wid = (uint16_t)wid;
+  slot->mark = 0;
+  dict->names_used += (uint32_t)(len + ENTRY_OVERHEAD);
+  dict->count++;
+  return 0;
+}
+
+int v4_dict_find(const V4Dict* dict, const char* name, size_t len)
+{
+  if (dict->count == 0 || len == 0 || len > V4_DICT_NAME_MAX)
+  {
+    return V4_DICT_ERR_NOT_FOUND;
+  }
+  const V4DictSlot* slot = &dict->slots[probe(dict, name, len)];
+  return (slot->name != 0) ? slot->wid : V4_DICT_ERR_NOT_FOUND;
+}
+
+int v4_dict_bind(V4Dict* dict, V4FrontContext* ctx, const char* source)
+{
+  if (dict->count == 0)
+  {
+    return 0;
+  }
+
+  // A new pass number makes every word unregistered again; on wrap-around
+  // the old marks have to go
+  if (++dict->epoch == 0)
+  {
+    for (uint32_t i = 0; i <= dict->mask; i++)
+    {
+      dict->slots[i].mark = 0;
+    }
+    dict->epoch = 1;
+  }
+
+  int bound = 0;
+  const char* p = source;
+  while (*p != '\0')
+  {
+    while (is_space(*p))
+    {
+      p++;
+    }
+    const char* token = p;
+    while (*p != '\0' && !is_space(*p))
+    {
+      p++;
+    }
+    size_t len = (size_t)(p - token);
+    if (len == 0 || len > V4_DICT_NAME_MAX)
+    {
+      continue;
+    }
+
+    V4DictSlot* slot = &dict->slots[probe(dict, token, len)];
+    if (slot->name == 0 || slot->mark == dict->epoch)
+    {
+      continue;
+    }
+    slot->mark = dict->epoch;
+    if (v4front_context_register_word(ctx, dict->names + slot->name, slot->wid) != 0)
+    {
+      return V4_DICT_ERR_CONTEXT;
+    }
+    bound++;
+  }
+  return bound;
+}
@@ -0,0 +1,120 @@
+/**
+ * @file v4_repl_dict.h
+ * @brief Hashed REPL dictionary for the V4-front compiler context
+ *
+ * V4-front keeps the words it can resolve in a fixed table searched
+ * linearly (MAX_WORDS=64 on the ESP32-C6), so a context that holds every
+ * word of a session runs out of slots and gets slower with each word. The
+ * REPL dictionary holds all user and built-in words instead: an
+ * open-addressing hash table (linear probing, at most 3/4 full) whose
+ * names are interned once in an append-only name arena. Each compile then
+ * uses a fresh compiler context into which v4_dict_bind() registers only
+ * the words the source refers to, so the context limit applies per
+ * compiled line, not per session.
+ *
+ * A slot is 8 bytes and a name costs its length + 2, so 64 words fit in
+ * about 2 KB and thousands of words scale linearly, with O(1) lookups.
+ * Names are compared ASCII case-insensitively, as in Forth; defining an
+ * existing name rebinds it to the new word id (the newest definition
+ * wins, as in the VM).
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "v4front/compile.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Dictionary error codes */
+#define V4_DICT_ERR_FULL -150      /**< Table at its load limit or name arena full */
+#define V4_DICT_ERR_NAME -151      /**< Empty name or longer than V4_DICT_NAME_MAX */
+#define V4_DICT_ERR_NOT_FOUND -152 /**< No word with that name */
+#define V4_DICT_ERR_CONTEXT -153   /**< Compiler context rejected a word */
+
+/** Longest word name in bytes */
+#define V4_DICT_NAME_MAX 255
+
+/**
+ * @brief Hash table slot
+ */
+typedef struct V4DictSlot
+{
+  uint32_t name; /**< Name arena offset + 1 (0 = empty) */
+  uint16_t wid;  /**< Word id */
+  uint16_t mark; /**< Last v4_dict_bind() pass that registered the word */
+} V4DictSlot;
+
+/**
+ * @brief REPL dictionary
+ *
+ * Caller-allocated; use v4_dict_init() before anything else. The counters
+ * may be read directly.
+ */
+typedef struct V4Dict
+{
+  V4DictSlot* slots;   /**< Hash table (caller memory) */
+  uint32_t mask;       /**< Slot count - 1 */
+  uint32_t count;      /**< Words defined */
+  char* names;         /**< Name arena (caller memory) */
+  uint32_t names_size; /**< Arena size in bytes */
+  uint32_t names_used; /**< Arena bytes in use */
+  uint16_t epoch;      /**< Current bind pass */
+} V4Dict;
+
+/**
+ * @brief Initialize an empty dictionary
+ *
+ * @param dict        Dictionary to initialize
+ * @param slots       Slot array; must stay valid as long as the dictionary
+ * @param slot_count  Number of slots, a power of two (rounded down
+ *                    otherwise); holds up to 3/4 as many words
+ * @param names       Name arena; must stay valid as long as the dictionary
+ * @param names_size  Arena size in bytes (each name takes its length + 2)
+ */
+void v4_dict_init(V4Dict* dict, V4DictSlot* slots, size_t slot_count, char* names,
+                  size_t names_size);
+
+/**
+ * @brief Define a word, or rebind an existing name
+ *
+ * @param dict  Dictionary
+ * @param name  Name (copied into the arena)
+ * @param wid   Word id (0-65535)
+ * @return 0, V4_DICT_ERR_NAME, or V4_DICT_ERR_FULL
+ */
+int v4_dict_define(V4Dict* dict, const char* name, int wid);
+
+/**
+ * @brief Look up a word
+ *
+ * @param dict  Dictionary
+ * @param name  Name (need not be NUL-terminated)
+ * @param len   Name length in bytes
+ * @return Word id (>= 0), or V4_DICT_ERR_NOT_FOUND
+ */
+int v4_dict_find(const V4Dict* dict, const char* name, size_t len);
+
+/**
+ * @brief Register the words a source refers to in a compiler context
+ *
+ * Every whitespace-separated token of @p source that names a dictionary
+ * word is registered once in @p ctx, under its interned name (which stays
+ * valid as long as the dictionary). Tokens that are not words (numbers,
+ * primitives, names defined by the source itself) are skipped.
+ *
+ * @return Number of words registered, or V4_DICT_ERR_CONTEXT if the
+ *         context is full (the source refers to too many words at once)
+ */
+int v4_dict_bind(V4Dict* dict, V4FrontContext* ctx, const char* source);
+
+#ifdef __cplusplus
+}
+#endif
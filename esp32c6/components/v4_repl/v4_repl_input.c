@@ -0,0 +1,284 @@
+/**
+ * @file v4_repl_input.c
+ * @brief Streaming REPL input: console bytes to complete compile units
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include "v4_repl_input.h"
+
+#include <string.h>
+
+// Longest echo of one input byte ("\b \b", "^C\n")
+#define ECHO_RESERVE 3
+
+static const char* const OPENERS[] = {"if", "begin", "do", "?do", "case"};
+static const char* const CLOSERS[] = {"then", "until", "again", "repeat",
+                                      "loop", "+loop", "endcase"};
+
+static int is_space(char c)
+{
+  return c == ' ' || c == '\t';
+}
+
+static char fold(char c)
+{
+  return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
+
+// Case-insensitive token comparison against a lowercase word
+static int token_is(const char* token, size_t len, const char* word)
+{
+  for (size_t i = 0; i < len; i++)
+  {
+    if (word[i] == '\0' || fold(token[i]) != word[i])
+    {
+      return 0;
+    }
+  }
+  return word[len] == '\0';
+}
+
+static int token_in(const char* token, size_t len, const char* const* words, size_t count)
+{
+  for (size_t i = 0; i < count; i++)
+  {
+    if (token_is(token, len, words[i]))
+    {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static void put_echo(V4Input* in, const char* s, size_t n)
+{
+  if (in->echo)
+  {
+    memcpy(in->echo + in->echo_len, s, n);
+    in->echo_len += n;
+  }
+}
+
+// Track definitions, control structures and comments over one line
+static void scan_line(V4Input* in, const char* p, const char* end)
+{
+  while (p < end)
+  {
+    if (in->in_paren)
+    {
+      while (p < end && *p != ')')
+      {
+        p++;
+      }
+      if (p < end)
+      {
+        p++;
+        in->in_paren = 0;
+      }
+      continue;
+    }
+
+    while (p < end && is_space(*p))
+    {
+      p++;
+    }
+    const char* token = p;
+    while (p < end && !is_space(*p))
+    {
+      p++;
+    }
+    size_t len = (size_t)(p - token);
+    if (len == 0)
+    {
+      break;
+    }
+
+    if (token_is(token, len, "\\"))
+    {
+      break;  // Comment to the end of the line
+    }
+    if (token_is(token, len, "("))
+    {
+      in->in_paren = 1;
+    }
+    else if (token_is(token, len, ".\"") || token_is(token, len, "s\""))
+    {
+      // Skip the string; an unterminated one ends with the line
+      while (p < end && *p != '"')
+      {
+        p++;
+      }
+      p += (p < end);
+    }
+    else if (token_is(token, len, ":"))
+    {
+      in->in_def = 1;
+    }
+    else if (token_is(token, len, ";"))
+    {
+      // The end of a definition closes whatever it left open; the
+      // compiler reports the mismatch
+      in->in_def = 0;
+      in->depth = 0;
+    }
+    else if (token_in(token, len, OPENERS, sizeof(OPENERS) / sizeof(OPENERS[0])))
+    {
+      if (in->depth < UINT16_MAX)
+      {
+        in->depth++;
+      }
+    }
+    else if (token_in(token, len, CLOSERS, sizeof(CLOSERS) / sizeof(CLOSERS[0])))
+    {
+      if (in->depth > 0)
+      {
+        in->depth--;
+      }
+    }
+  }
+}
+
+// Make room for @p n more bytes plus the NUL, dropping the finished lines of
+// an oversized unit first
+static int make_room(V4Input* in, size_t n)
+{
+  if (in->len + n + 1 <= in->size)
+  {
+    return 1;
+  }
+  in->overflow = 1;
+  if (in->line > 0)
+  {
+    memmove(in->buf, in->buf + in->line, in->len - in->line);
+    in->len -= in->line;
+    in->line = 0;
+  }
+  return in->len + n + 1 <= in->size;
+}
+
+static void reset_unit(V4Input* in)
+{
+  in->len = 0;
+  in->line = 0;
+  in->depth = 0;
+  in->in_def = 0;
+  in->in_paren = 0;
+  in->overflow = 0;
+}
+
+static int end_line(V4Input* in)
+{
+  scan_line(in, in->buf + in->line, in->buf + in->len);
+  in->lines++;
+  put_echo(in, "\n", 1);
+
+  if (v4_input_open(in))
+  {
+    // The unit goes on; an oversized one only needs its structure tracked
+    if (in->overflow)
+    {
+      in->len = 0;
+    }
+    else if (make_room(in, 1))
+    {
+      in->buf[in->len++] = '\n';
+    }
+    in->line = in->len;
+    return V4_INPUT_PENDING;
+  }
+
+  in->buf[in->len] = '\0';
+  in->done = 1;
+  if (in->overflow)
+  {
+    return V4_INPUT_ERR_OVERFLOW;
+  }
+  for (size_t i = 0; i < in->len; i++)
+  {
+    if (!is_space(in->buf[i]) && in->buf[i] != '\n')
+    {
+      in->units++;
+      return V4_INPUT_UNIT;
+    }
+  }
+  return V4_INPUT_EMPTY;
+}
+
+void v4_input_init(V4Input* in, char* buf, size_t size, char* echo, size_t echo_size)
+{
+  memset(in, 0, sizeof(*in));
+  in->buf = buf;
+  in->size = size;
+  in->echo = (echo && echo_size >= ECHO_RESERVE) ? echo : NULL;
+  in->echo_size = echo_size;
+  if (size > 0)
+  {
+    buf[0] = '\0';
+  }
+}
+
+int v4_input_feed(V4Input* in, const char* data, size_t len, size_t* consumed)
+{
+  if (in->done)
+  {
+    reset_unit(in);
+    in->done = 0;
+  }
+
+  int status = V4_INPUT_PENDING;
+  size_t i = 0;
+  while (i < len && status == V4_INPUT_PENDING)
+  {
+    if (in->echo && in->echo_size - in->echo_len < ECHO_RESERVE)
+    {
+      break;
+    }
+
+    char c = data[i++];
+    in->bytes++;
+    int was_cr = in->last_cr;
+    in->last_cr = (c == '\r');
+
+    if (c == '\r' || c == '\n')
+    {
+      if (c == '\n' && was_cr)
+      {
+        continue;  // LF of CRLF
+      }
+      status = end_line(in);
+    }
+    else if (c == '\b' || c == 127)
+    {
+      if (in->len > in->line)
+      {
+        in->len--;
+        put_echo(in, "\b \b", 3);
+      }
+    }
+    else if (c == 3)
+    {
+      reset_unit(in);
+      put_echo(in, "^C\n", 3);
+      status = V4_INPUT_ERR_CANCELLED;
+    }
+    else if (c == '\t' || (unsigned char)c >= 32)
+    {
+      c = (c == '\t') ? ' ' : c;
+      if (make_room(in, 2))  // Keep room for the line's '\n'
+      {
+        in->buf[in->len++] = c;
+      }
+      put_echo(in, &c, 1);
+    }
+  }
+
+  *consumed = i;
+  return status;
+}
+
+int v4_input_open(const V4Input* in)
+{
+  return in->in_def || in->depth > 0 || in->in_paren;
+}
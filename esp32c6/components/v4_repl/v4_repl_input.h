@@ -0,0 +1,109 @@
+/**
+ * @file v4_repl_input.h
+ * @brief Streaming REPL input: console bytes to complete compile units
+ *
+ * Reading the console one getchar() at a time, echoing each character
+ * with its own flush and compiling every line on its own caps input at
+ * one line and makes pasted source crawl. The input assembler is fed
+ * whatever the console has (a USB packet, a pasted block, a script) and
+ * returns complete units instead:
+ *
+ * - Lines are joined while a `:` definition, a control structure
+ *   (IF, BEGIN, DO, CASE) or a `( ... )` comment is still open, so a
+ *   definition can span lines. The structure is tracked incrementally:
+ *   each line is scanned once, when it ends.
+ * - Echo is collected in a caller buffer and written once per feed, not
+ *   once per byte.
+ * - CR, LF and CRLF end a line; backspace edits the current line; Ctrl-C
+ *   drops the open unit.
+ *
+ * A unit is NUL-terminated source with one '\n' per line, ready for
+ * v4_compiler_compile(). A unit larger than the buffer is consumed to its
+ * end and reported as V4_INPUT_ERR_OVERFLOW.
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** v4_input_feed() results */
+#define V4_INPUT_PENDING 0  /**< All bytes consumed, no unit complete yet */
+#define V4_INPUT_UNIT 1     /**< A unit is complete in buf */
+#define V4_INPUT_EMPTY 2    /**< A blank line at top level */
+
+/** Input error codes */
+#define V4_INPUT_ERR_OVERFLOW -170  /**< The unit did not fit and was dropped */
+#define V4_INPUT_ERR_CANCELLED -171 /**< Ctrl-C dropped the open unit */
+
+/**
+ * @brief Input assembler state
+ *
+ * Caller-allocated; use v4_input_init() before anything else. The unit
+ * and echo buffers and the counters may be read directly.
+ */
+typedef struct V4Input
+{
+  char* buf;         /**< Unit buffer (caller memory) */
+  size_t size;       /**< Unit buffer size in bytes */
+  size_t len;        /**< Bytes in buf, excluding the NUL */
+  size_t line;       /**< Start of the current line in buf */
+  char* echo;        /**< Echo buffer (caller memory), or NULL for no echo */
+  size_t echo_size;  /**< Echo buffer size in bytes (at least 3) */
+  size_t echo_len;   /**< Echo bytes waiting to be written */
+  uint16_t depth;    /**< Open control structures */
+  uint8_t in_def;    /**< Inside a `:` definition */
+  uint8_t in_paren;  /**< Inside a `( ... )` comment */
+  uint8_t last_cr;   /**< Last byte was CR (swallow the LF of CRLF) */
+  uint8_t overflow;  /**< The open unit lost bytes */
+  uint8_t done;      /**< buf holds a returned unit; reset on the next feed */
+  uint32_t bytes;    /**< Bytes fed */
+  uint32_t lines;    /**< Lines ended */
+  uint32_t units;    /**< Units returned */
+} V4Input;
+
+/**
+ * @brief Initialize the assembler
+ *
+ * @param in         Assembler
+ * @param buf        Unit buffer; bounds the size of one definition
+ * @param size       Unit buffer size in bytes
+ * @param echo       Echo buffer, or NULL to echo nothing
+ * @param echo_size  Echo buffer size in bytes
+ */
+void v4_input_init(V4Input* in, char* buf, size_t size, char* echo, size_t echo_size);
+
+/**
+ * @brief Feed console bytes
+ *
+ * Consumes bytes up to the end of the first unit (or error) and returns;
+ * call again with the rest. Also returns early, with V4_INPUT_PENDING,
+ * when the echo buffer is full. Write and clear the echo buffer
+ * (echo_len = 0) after every call.
+ *
+ * @param in        Assembler
+ * @param data      Bytes
+ * @param len       Number of bytes
+ * @param consumed  Receives the number of bytes used
+ * @return V4_INPUT_PENDING, V4_INPUT_UNIT (source in in->buf until the
+ *         next feed), V4_INPUT_EMPTY, or a V4_INPUT_ERR_* code
+ */
+int v4_input_feed(V4Input* in, const char* data, size_t len, size_t* consumed);
+
+/**
+ * @brief Check whether a unit is open (lines are waiting for its end)
+ *
+ * Use it to choose between the prompt and a continuation prompt.
+ */
+int v4_input_open(const V4Input* in);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,87 @@
+/**
+ * @file v4_repl_native.c
+ * @brief Native (C) words callable from compiled Forth
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include "v4_repl_native.h"
+
+#include <string.h>
+
+#define OP_LIT 0x00
+#define OP_STORE 0x31
+#define OP_RET 0x51
+#define OP_LIT_U8 0x76
+
+static v4_err port_read(void* user, v4_u32 addr, v4_u32* out)
+{
+  (void)user;
+  (void)addr;
+  *out = 0;
+  return 0;
+}
+
+static v4_err port_write(void* user, v4_u32 addr, v4_u32 val)
+{
+  (void)addr;
+  return v4_native_call((V4NativeTable*)user, val);
+}
+
+void v4_native_init(V4NativeTable* table)
+{
+  memset(table, 0, sizeof(*table));
+  table->mmio.base = V4_NATIVE_PORT;
+  table->mmio.size = 4;
+  table->mmio.read32 = port_read;
+  table->mmio.write32 = port_write;
+  table->mmio.user = table;
+}
+
+const V4_MMIO* v4_native_mmio(V4NativeTable* table)
+{
+  return &table->mmio;
+}
+
+int v4_native_register(V4NativeTable* table, struct Vm* vm, const char* name,
+                       V4NativeFn fn)
+{
+  if (table->count >= V4_NATIVE_MAX)
+  {
+    return V4_NATIVE_ERR_FULL;
+  }
+
+  // slot PORT ! ;
+  int slot = table->count;
+  uint8_t* code = table->code[slot];
+  code[0] = OP_LIT_U8;
+  code[1] = (uint8_t)slot;
+  code[2] = OP_LIT;
+  code[3] = (uint8_t)V4_NATIVE_PORT;
+  code[4] = (uint8_t)(V4_NATIVE_PORT >> 8);
+  code[5] = (uint8_t)(V4_NATIVE_PORT >> 16);
+  code[6] = (uint8_t)(V4_NATIVE_PORT >> 24);
+  code[7] = OP_STORE;
+  code[8] = OP_RET;
+
+  int wid = vm_register_word(vm, name, code, V4_NATIVE_CODE_LEN);
+  if (wid < 0)
+  {
+    return wid;
+  }
+
+  table->vm = vm;
+  table->fns[slot] = fn;
+  table->count++;
+  return wid;
+}
+
+v4_err v4_native_call(V4NativeTable* table, uint32_t slot)
+{
+  if (slot >= (uint32_t)table->count)
+  {
+    return V4_NATIVE_ERR_SLOT;
+  }
+  return table->fns[slot](table->vm);
+}
@@ -0,0 +1,99 @@
+/**
+ * @file v4_repl_native.h
+ * @brief Native (C) words callable from compiled Forth
+ *
+ * Each native function gets a slot in a dispatch table and a named VM word
+ * whose body is `slot PORT !`. The store hits a one-word MMIO window owned
+ * by the table, whose write handler calls the function in that slot
+ * directly. Native words are ordinary dictionary words, so they can be
+ * used inside definitions and control structures like any other word.
+ *
+ * The table's MMIO window must be passed in the VmConfig the VM is
+ * created with:
+ *
+ *   V4NativeTable natives;
+ *   v4_native_init(&natives);
+ *   VmConfig config = {..., .mmio = v4_native_mmio(&natives), .mmio_count = 1};
+ *   struct Vm* vm = vm_create(&config);
+ *   int wid = v4_native_register(&natives, vm, "led!", led_set_impl);
+ *   v4_dict_define(&dict, "led!", wid);
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "v4/vm_api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum number of native words per table */
+#define V4_NATIVE_MAX 32
+
+/** VM address of the call port (outside any realistic VM memory) */
+#define V4_NATIVE_PORT 0xFFFFFF00u
+
+/** Bytecode length of a native word body */
+#define V4_NATIVE_CODE_LEN 9
+
+/** Native error codes */
+#define V4_NATIVE_ERR_FULL -110 /**< No free slot */
+#define V4_NATIVE_ERR_SLOT -111 /**< Call port written with an unknown slot */
+
+/**
+ * @brief Native word implementation
+ *
+ * Arguments and results are passed on the data stack with vm_ds_pop() and
+ * vm_ds_push(). A non-zero return aborts execution with that error.
+ */
+typedef v4_err (*V4NativeFn)(struct Vm* vm);
+
+/**
+ * @brief Native dispatch table
+ *
+ * Caller-allocated; use v4_native_init() before anything else. One table
+ * serves one VM.
+ */
+typedef struct V4NativeTable
+{
+  struct Vm* vm;
+  V4NativeFn fns[V4_NATIVE_MAX];
+  uint8_t code[V4_NATIVE_MAX][V4_NATIVE_CODE_LEN]; /**< Word bodies */
+  int count;
+  V4_MMIO mmio;
+} V4NativeTable;
+
+/**
+ * @brief Initialize an empty table
+ */
+void v4_native_init(V4NativeTable* table);
+
+/**
+ * @brief Get the call port MMIO window for VmConfig.mmio
+ */
+const V4_MMIO* v4_native_mmio(V4NativeTable* table);
+
+/**
+ * @brief Register a native word in the VM
+ *
+ * Define the returned id in the REPL dictionary as well to use the
+ * word from Forth source.
+ *
+ * @return Word id (>= 0), V4_NATIVE_ERR_FULL, or a negative VM error
+ */
+int v4_native_register(V4NativeTable* table, struct Vm* vm, const char* name,
+                       V4NativeFn fn);
+
+/**
+ * @brief Call the native function in @p slot (what the call port does)
+ */
+v4_err v4_native_call(V4NativeTable* table, uint32_t slot);
+
+#ifdef __cplusplus
+}
+#endif
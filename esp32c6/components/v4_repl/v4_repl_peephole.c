@@ -0,0 +1,445 @@
+/**
+ * @file v4_repl_peephole.c
+ * @brief Peephole optimizer for compiled V4 words
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include "v4_repl_peephole.h"
+
+#include <string.h>
+
+// Opcodes modeled by the pass
+#define OP_LIT 0x00
+#define OP_DUP 0x01
+#define OP_DROP 0x02
+#define OP_SWAP 0x03
+#define OP_ADD 0x10
+#define OP_MUL 0x12
+#define OP_XOR 0x2A
+#define OP_LOAD 0x30
+#define OP_STORE 0x31
+#define OP_RET 0x51
+#define OP_SYS 0x60
+#define OP_LIT0 0x73
+#define OP_LIT1 0x74
+#define OP_LIT_U8 0x76
+
+// Symbolic stack depth; deeper words are left alone
+#define STACK_MAX 32
+
+// No previous instruction to pair with
+#define NO_INSN 0xFFFFu
+
+/**
+ * @brief Length of the instruction at @p pos, or 0 if unsupported/truncated
+ */
+static size_t insn_len(const uint8_t* code, size_t len, size_t pos)
+{
+  size_t n;
+  switch (code[pos])
+  {
+    case OP_LIT:
+      n = 5;
+      break;
+    case OP_SYS:
+    case OP_LIT_U8:
+      n = 2;
+      break;
+    case OP_DUP:
+    case OP_DROP:
+    case OP_SWAP:
+    case OP_ADD:
+    case OP_MUL:
+    case OP_XOR:
+    case OP_LOAD:
+    case OP_STORE:
+    case OP_RET:
+    case OP_LIT0:
+    case OP_LIT1:
+      n = 1;
+      break;
+    default:
+      return 0;
+  }
+  return (pos + n <= len) ? n : 0;
+}
+
+int v4_peephole_scan(const uint8_t* code, size_t len, V4PeepholeVisitor visit,
+                     void* user)
+{
+  int count = 0;
+  size_t pos = 0;
+  while (pos < len)
+  {
+    size_t n = insn_len(code, len, pos);
+    if (n == 0)
+    {
+      return V4_PEEPHOLE_ERR_UNSUPPORTED;
+    }
+    if (visit != NULL)
+    {
+      visit(code[pos], pos, user);
+    }
+    count++;
+    pos += n;
+  }
+  return count;
+}
+
+// Symbolic stack entry: a literal not emitted yet, or a value on the real
+// stack. Pending literals always form the top of the symbolic stack.
+typedef struct
+{
+  uint8_t pending;
+  int32_t value;
+} Slot;
+
+typedef struct
+{
+  uint8_t* out;
+  size_t cap;
+  size_t len;
+  uint32_t insns;
+  uint32_t folded;
+  uint32_t removed;
+  int overflow;
+
+  Slot stack[STACK_MAX];
+  int depth;    // Tracked entries; deeper values are the caller's
+  int pending;  // Number of pending entries on top
+
+  // Last emitted instruction, for DUP DROP / SWAP SWAP
+  uint16_t last_op;
+  size_t last_pos;
+} Emitter;
+
+static void emit_byte(Emitter* e, uint8_t byte)
+{
+  if (e->len < e->cap)
+  {
+    e->out[e->len] = byte;
+  }
+  else
+  {
+    e->overflow = 1;
+  }
+  e->len++;
+}
+
+static void emit_op(Emitter* e, uint8_t op)
+{
+  e->last_op = op;
+  e->last_pos = e->len;
+  e->insns++;
+  emit_byte(e, op);
+}
+
+static void emit_literal(Emitter* e, int32_t value)
+{
+  uint32_t u = (uint32_t)value;
+  if (u == 0)
+  {
+    emit_op(e, OP_LIT0);
+  }
+  else if (u == 1)
+  {
+    emit_op(e, OP_LIT1);
+  }
+  else if (u <= 0xFF)
+  {
+    emit_op(e, OP_LIT_U8);
+    emit_byte(e, (uint8_t)u);
+  }
+  else
+  {
+    emit_op(e, OP_LIT);
+    for (int b = 0; b < 4; b++)
+    {
+      emit_byte(e, (uint8_t)(u >> (8 * b)));
+    }
+  }
+  // A literal never pairs with what follows
+  e->last_op = NO_INSN;
+}
+
+/**
+ * @brief Emit the @p count topmost pending literals (bottom-up)
+ *
+ * Only entries that are pending anyway can be emitted, so @p count is
+ * clamped to the pending count.
+ */
+static void materialize_top(Emitter* e, int count)
+{
+  if (count > e->pending)
+  {
+    count = e->pending;
+  }
+  for (int i = e->depth - count; i < e->depth; i++)
+  {
+    emit_literal(e, e->stack[i].value);
+    e->stack[i].pending = 0;
+  }
+  e->pending -= count;
+}
+
+static void materialize_all(Emitter* e)
+{
+  materialize_top(e, e->pending);
+}
+
+// Pop @p count entries (all materialized or caller values)
+static void pop_real(Emitter* e, int count)
+{
+  e->depth = (e->depth > count) ? e->depth - count : 0;
+}
+
+static int push(Emitter* e, uint8_t pending, int32_t value)
+{
+  if (e->depth == STACK_MAX)
+  {
+    return -1;
+  }
+  e->stack[e->depth].pending = pending;
+  e->stack[e->depth].value = value;
+  e->depth++;
+  if (pending)
+  {
+    e->pending++;
+  }
+  return 0;
+}
+
+/**
+ * @brief Remove the last emitted instruction if it is @p op
+ */
+static int cancel_last(Emitter* e, uint8_t op)
+{
+  if (e->last_op != op || e->last_pos + 1 != e->len)
+  {
+    return 0;
+  }
+  e->len = e->last_pos;
+  e->insns--;
+  e->removed += 2;
+  e->last_op = NO_INSN;
+  return 1;
+}
+
+static int32_t fold(uint8_t op, int32_t a, int32_t b)
+{
+  uint32_t ua = (uint32_t)a;
+  uint32_t ub = (uint32_t)b;
+  switch (op)
+  {
+    case OP_ADD:
+      return (int32_t)(ua + ub);
+    case OP_MUL:
+      return (int32_t)(ua * ub);
+    default:
+      return (int32_t)(ua ^ ub);
+  }
+}
+
+static int rewrite(const uint8_t* code, size_t len, Emitter* e)
+{
+  size_t pos = 0;
+  while (pos < len)
+  {
+    uint8_t op = code[pos];
+    size_t n = insn_len(code, len, pos);
+    if (n == 0)
+    {
+      return V4_PEEPHOLE_ERR_UNSUPPORTED;
+    }
+
+    int top_pending = e->pending >= 1;
+    int two_pending = e->pending >= 2;
+    int err = 0;
+
+    switch (op)
+    {
+      case OP_LIT:
+      {
+        uint32_t v = (uint32_t)code[pos + 1] | ((uint32_t)code[pos + 2] << 8) |
+                     ((uint32_t)code[pos + 3] << 16) | ((uint32_t)code[pos + 4] << 24);
+        err = push(e, 1, (int32_t)v);
+        break;
+      }
+      case OP_LIT0:
+        err = push(e, 1, 0);
+        break;
+      case OP_LIT1:
+        err = push(e, 1, 1);
+        break;
+      case OP_LIT_U8:
+        err = push(e, 1, code[pos + 1]);
+        break;
+
+      case OP_DUP:
+        if (top_pending)
+        {
+          err = push(e, 1, e->stack[e->depth - 1].value);
+          e->removed++;
+        }
+        else
+        {
+          emit_op(e, OP_DUP);
+          err = push(e, 0, 0);
+        }
+        break;
+
+      case OP_DROP:
+        if (top_pending)
+        {
+          e->depth--;
+          e->pending--;
+          e->removed++;
+        }
+        else
+        {
+          if (!cancel_last(e, OP_DUP))
+          {
+            emit_op(e, OP_DROP);
+          }
+          pop_real(e, 1);
+        }
+        break;
+
+      case OP_SWAP:
+        if (two_pending)
+        {
+          Slot t = e->stack[e->depth - 1];
+          e->stack[e->depth - 1] = e->stack[e->depth - 2];
+          e->stack[e->depth - 2] = t;
+          e->removed++;
+        }
+        else
+        {
+          // The result is on the real stack, so nothing may stay pending
+          // below it
+          materialize_all(e);
+          if (!cancel_last(e, OP_SWAP))
+          {
+            emit_op(e, OP_SWAP);
+          }
+          pop_real(e, 2);
+          err = push(e, 0, 0) || push(e, 0, 0);
+        }
+        break;
+
+      case OP_ADD:
+      case OP_MUL:
+      case OP_XOR:
+        if (two_pending)
+        {
+          int32_t b = e->stack[--e->depth].value;
+          int32_t a = e->stack[--e->depth].value;
+          e->pending -= 2;
+          err = push(e, 1, fold(op, a, b));
+          e->folded++;
+        }
+        else
+        {
+          materialize_all(e);
+          emit_op(e, op);
+          pop_real(e, 2);
+          err = push(e, 0, 0);
+        }
+        break;
+
+      case OP_LOAD:
+        materialize_all(e);
+        emit_op(e, op);
+        pop_real(e, 1);
+        err = push(e, 0, 0);
+        break;
+
+      case OP_STORE:
+        // Consumes two and pushes nothing: literals below may stay pending
+        materialize_top(e, 2);
+        emit_op(e, op);
+        pop_real(e, 2);
+        break;
+
+      default:
+        // SYS and RET: unknown stack effect from here on
+        materialize_all(e);
+        emit_op(e, op);
+        for (size_t i = 1; i < n; i++)
+        {
+          emit_byte(e, code[pos + i]);
+        }
+        e->depth = 0;
+        break;
+    }
+
+    if (err != 0)
+    {
+      return V4_PEEPHOLE_ERR_UNSUPPORTED;
+    }
+    pos += n;
+  }
+
+  // Code without a final RET (e.g. REPL immediate code) leaves its
+  // literals on the stack
+  materialize_all(e);
+  return 0;
+}
+
+int v4_peephole_word(const uint8_t* code, size_t len, uint8_t* out, size_t cap,
+                     V4PeepholeStats* stats)
+{
+  int insns = v4_peephole_scan(code, len, NULL, NULL);
+
+  Emitter e;
+  memset(&e, 0, sizeof(e));
+  e.out = out;
+  e.cap = cap;
+  e.last_op = NO_INSN;
+
+  int err = (insns < 0) ? insns : rewrite(code, len, &e);
+  int improved = (err == 0) && ((int)e.insns < insns ||
+                                ((int)e.insns == insns && e.len < len));
+  int result = 0;
+  if (err != 0)
+  {
+    result = err;
+  }
+  else if (improved && e.overflow)
+  {
+    result = V4_PEEPHOLE_ERR_NO_SPACE;
+  }
+  else if (improved)
+  {
+    result = (int)e.len;
+  }
+
+  if (stats != NULL)
+  {
+    stats->words++;
+    stats->bytes_before += (uint32_t)len;
+    if (result > 0)
+    {
+      stats->optimized++;
+      stats->insns_before += (uint32_t)insns;
+      stats->insns_after += e.insns;
+      stats->bytes_after += (uint32_t)e.len;
+      stats->folded += e.folded;
+      stats->removed += e.removed;
+    }
+    else
+    {
+      stats->unsupported += (err == V4_PEEPHOLE_ERR_UNSUPPORTED);
+      stats->bytes_after += (uint32_t)len;
+      // Unsupported words cannot be counted past their first unknown opcode
+      if (insns > 0)
+      {
+        stats->insns_before += (uint32_t)insns;
+        stats->insns_after += (uint32_t)insns;
+      }
+    }
+  }
+  return result;
+}
@@ -0,0 +1,95 @@
+/**
+ * @file v4_repl_peephole.h
+ * @brief Peephole optimizer for compiled V4 words
+ *
+ * A post-pass over the bytecode V4-front emits for one word, run before the
+ * word is registered. Literals are not emitted where they are pushed but
+ * kept on a symbolic stack until an instruction needs them on the real
+ * one, so that:
+ * - arithmetic on literals (ADD, MUL, XOR) is folded into one literal
+ * - DUP of a literal becomes a second literal, a dropped literal vanishes,
+ *   and SWAP of two literals just reorders them
+ * - DUP DROP and SWAP SWAP pairs are removed
+ * - every literal is re-emitted in its shortest form (LIT0, LIT1, LIT_U8)
+ *
+ * The pass only rewrites straight-line code built from the instructions it
+ * models. A word with any other opcode (branches, calls, return stack
+ * words, ...) is reported as unsupported and must be used as is, so the
+ * pass never has to reason about jump targets.
+ *
+ * v4_peephole_scan() walks the same instruction table for tools that
+ * count instructions or profile opcode sequences.
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Peephole error codes */
+#define V4_PEEPHOLE_ERR_UNSUPPORTED -140 /**< Opcode the pass does not model */
+#define V4_PEEPHOLE_ERR_NO_SPACE -141    /**< Optimized code does not fit */
+
+/**
+ * @brief Optimizer counters, accumulated over calls
+ *
+ * Instruction counts equal dispatch counts for straight-line code. Words
+ * that are skipped or cannot be improved count with their original size.
+ */
+typedef struct V4PeepholeStats
+{
+  uint32_t words;         /**< Words passed to v4_peephole_word() */
+  uint32_t optimized;     /**< Words that were rewritten */
+  uint32_t unsupported;   /**< Words left alone (V4_PEEPHOLE_ERR_UNSUPPORTED) */
+  uint32_t insns_before;  /**< Instructions in */
+  uint32_t insns_after;   /**< Instructions out */
+  uint32_t bytes_before;  /**< Bytes in */
+  uint32_t bytes_after;   /**< Bytes out */
+  uint32_t folded;        /**< Operations evaluated at compile time */
+  uint32_t removed;       /**< DUP / DROP / SWAP instructions removed */
+} V4PeepholeStats;
+
+/**
+ * @brief Optimize the bytecode of one word
+ *
+ * @param code   Word bytecode
+ * @param len    Length in bytes
+ * @param out    Output buffer (must not overlap @p code)
+ * @param cap    Capacity of @p out
+ * @param stats  Counters to update (may be NULL)
+ * @return Length of the optimized code in @p out (> 0); 0 if it would not
+ *         be shorter (the original should be kept);
+ *         V4_PEEPHOLE_ERR_UNSUPPORTED or V4_PEEPHOLE_ERR_NO_SPACE
+ */
+int v4_peephole_word(const uint8_t* code, size_t len, uint8_t* out, size_t cap,
+                     V4PeepholeStats* stats);
+
+/**
+ * @brief Instruction visitor for v4_peephole_scan()
+ *
+ * @param op    Opcode
+ * @param pos   Offset of the instruction
+ * @param user  Caller context
+ */
+typedef void (*V4PeepholeVisitor)(uint8_t op, size_t pos, void* user);
+
+/**
+ * @brief Decode a word instruction by instruction
+ *
+ * @param visit  Called for every instruction (may be NULL to just count)
+ * @return Number of instructions, or V4_PEEPHOLE_ERR_UNSUPPORTED at the
+ *         first opcode outside the table (earlier ones are visited)
+ */
+int v4_peephole_scan(const uint8_t* code, size_t len, V4PeepholeVisitor visit,
+                     void* user);
+
+#ifdef __cplusplus
+}
+#endif
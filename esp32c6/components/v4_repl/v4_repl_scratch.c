@@ -0,0 +1,43 @@
+/**
+ * @file v4_repl_scratch.c
+ * @brief Transient execution of REPL lines without dictionary growth
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include "v4_repl_scratch.h"
+
+#include <string.h>
+
+#define OP_RET 0x51
+
+int v4_scratch_init(V4Scratch* scratch, struct Vm* vm, uint8_t* buf, size_t capacity)
+{
+  scratch->vm = vm;
+  scratch->buf = buf;
+  scratch->capacity = capacity;
+  scratch->wid = -1;
+
+  if (capacity == 0)
+  {
+    return V4_SCRATCH_ERR_TOO_LARGE;
+  }
+
+  // Registered once over the whole buffer; runs stop at the first RET
+  memset(buf, OP_RET, capacity);
+  scratch->wid = vm_register_word(vm, NULL, buf, (int)capacity);
+  return scratch->wid;
+}
+
+v4_err v4_scratch_exec(V4Scratch* scratch, const uint8_t* code, size_t len)
+{
+  if (len + 1 > scratch->capacity)
+  {
+    return V4_SCRATCH_ERR_TOO_LARGE;
+  }
+
+  memcpy(scratch->buf, code, len);
+  scratch->buf[len] = OP_RET;
+  return vm_exec(scratch->vm, vm_get_word(scratch->vm, scratch->wid));
+}
@@ -0,0 +1,70 @@
+/**
+ * @file v4_repl_scratch.h
+ * @brief Transient execution of REPL lines without dictionary growth
+ *
+ * Immediate code (the part of a REPL line that is not a definition) only
+ * runs once, so registering it as an anonymous word per line uses up a
+ * dictionary slot every time. The scratch area instead registers a single
+ * anonymous word once, whose code is a fixed buffer supplied by the caller;
+ * each line's code is copied into that buffer and the same word is run
+ * again. Sessions of any length then use one dictionary slot and constant
+ * memory.
+ *
+ * The VM references registered code in place (it does not copy it), which
+ * is what lets the buffer be rewritten between runs.
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "v4/vm_api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Scratch error codes (VM errors are passed through unchanged) */
+#define V4_SCRATCH_ERR_TOO_LARGE -100 /**< Code does not fit in the buffer */
+
+/**
+ * @brief Scratch execution area
+ *
+ * Caller-allocated; use v4_scratch_init() before anything else.
+ */
+typedef struct V4Scratch
+{
+  struct Vm* vm;
+  uint8_t* buf;     /**< Code buffer (caller memory) */
+  size_t capacity;  /**< Buffer size in bytes */
+  int wid;          /**< Word id of the scratch word */
+} V4Scratch;
+
+/**
+ * @brief Register the scratch word
+ *
+ * @param scratch   Scratch area to initialize
+ * @param vm        VM to run in
+ * @param buf       Code buffer; must stay valid as long as the VM uses it
+ * @param capacity  Buffer size in bytes (one byte is reserved for RET)
+ * @return Word id of the scratch word (>= 0), or a negative VM error
+ */
+int v4_scratch_init(V4Scratch* scratch, struct Vm* vm, uint8_t* buf, size_t capacity);
+
+/**
+ * @brief Run code once without registering a word
+ *
+ * The code is copied into the scratch buffer, so it may be freed after the
+ * call. A RET is appended in case the code does not end with one.
+ *
+ * @return 0 on success, V4_SCRATCH_ERR_TOO_LARGE, or a VM error
+ */
+v4_err v4_scratch_exec(V4Scratch* scratch, const uint8_t* code, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
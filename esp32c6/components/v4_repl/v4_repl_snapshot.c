@@ -0,0 +1,342 @@
+/**
+ * @file v4_repl_snapshot.c
+ * @brief Persistent dictionary snapshots for the V4 REPL
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include "v4_repl_snapshot.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_rom_crc.h"
+#include "nvs.h"
+
+#define SNAPSHOT_MAGIC 0x53443456u  // "V4DS"
+#define HEADER_LEN 24
+#define RECORD_HEADER_LEN 5
+
+struct V4Snapshot
+{
+  uint8_t* buf;     // Header followed by records
+  size_t capacity;  // Size of buf
+  size_t used;      // Header + records
+  int base_wid;
+  int count;
+  int overflow;
+};
+
+// Filler for word ids that were used by anonymous code when the image was
+// taken (RET)
+static const uint8_t FILLER_CODE[] = {0x51};
+
+static void put_u16(uint8_t* p, uint32_t v)
+{
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t* p, uint32_t v)
+{
+  put_u16(p, v);
+  put_u16(p + 2, v >> 16);
+}
+
+static uint32_t get_u16(const uint8_t* p)
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+}
+
+static uint32_t get_u32(const uint8_t* p)
+{
+  return get_u16(p) | (get_u16(p + 2) << 16);
+}
+
+V4Snapshot* v4_snapshot_create(size_t capacity, int base_wid)
+{
+  if (capacity < HEADER_LEN)
+  {
+    return NULL;
+  }
+
+  V4Snapshot* snap = (V4Snapshot*)calloc(1, sizeof(V4Snapshot));
+  if (!snap)
+  {
+    return NULL;
+  }
+
+  snap->buf = (uint8_t*)malloc(capacity);
+  if (!snap->buf)
+  {
+    free(snap);
+    return NULL;
+  }
+
+  snap->capacity = capacity;
+  snap->used = HEADER_LEN;
+  snap->base_wid = base_wid;
+  return snap;
+}
+
+void v4_snapshot_destroy(V4Snapshot* snap)
+{
+  if (snap)
+  {
+    free(snap->buf);
+    free(snap);
+  }
+}
+
+int v4_snapshot_register_word(V4Snapshot* snap, struct Vm* vm, V4Dict* dict,
+                              const char* name, const uint8_t* code, int code_len)
+{
+  size_t name_len = name ? strlen(name) : 0;
+  size_t rec_len = RECORD_HEADER_LEN + name_len + 1 + (size_t)code_len;
+  uint8_t* rec = NULL;
+
+  if (name_len > 0xFF || code_len < 0 || code_len > 0xFFFF ||
+      snap->used + rec_len > snap->capacity)
+  {
+    snap->overflow = 1;
+  }
+  else
+  {
+    // Journal first, so the VM sees names and code that stay valid for the
+    // lifetime of the snapshot
+    rec = snap->buf + snap->used;
+    rec[2] = (uint8_t)name_len;
+    put_u16(rec + 3, (uint32_t)code_len);
+    memcpy(rec + RECORD_HEADER_LEN, name ? name : "", name_len + 1);
+    memcpy(rec + RECORD_HEADER_LEN + name_len + 1, code, (size_t)code_len);
+    name = (const char*)(rec + RECORD_HEADER_LEN);
+    code = rec + RECORD_HEADER_LEN + name_len + 1;
+  }
+
+  int wid = vm_register_word(vm, name, code, code_len);
+  if (wid < 0)
+  {
+    return wid;
+  }
+
+  if (v4_dict_define(dict, name, wid) != 0)
+  {
+    return V4_SNAPSHOT_ERR_REGISTER;
+  }
+
+  if (rec)
+  {
+    put_u16(rec, (uint32_t)wid);
+    snap->used += rec_len;
+    snap->count++;
+  }
+  return wid;
+}
+
+int v4_snapshot_restore(V4Snapshot* snap, struct Vm* vm, V4Dict* dict,
+                        const uint8_t* image, size_t len)
+{
+  if (len < HEADER_LEN || get_u32(image) != SNAPSHOT_MAGIC ||
+      get_u16(image + 4) != V4_SNAPSHOT_VERSION)
+  {
+    return V4_SNAPSHOT_ERR_FORMAT;
+  }
+
+  size_t payload_len = get_u32(image + 16);
+  if (HEADER_LEN + payload_len > len)
+  {
+    return V4_SNAPSHOT_ERR_FORMAT;
+  }
+  if (HEADER_LEN + payload_len > snap->capacity)
+  {
+    return V4_SNAPSHOT_ERR_FULL;
+  }
+  if (esp_rom_crc32_le(0, image + HEADER_LEN, payload_len) != get_u32(image + 20))
+  {
+    return V4_SNAPSHOT_ERR_CHECKSUM;
+  }
+  if ((int)get_u32(image + 8) != snap->base_wid)
+  {
+    return V4_SNAPSHOT_ERR_MISMATCH;
+  }
+
+  // Keep the image in the journal; names and code are registered in place
+  if (image != snap->buf)
+  {
+    memcpy(snap->buf, image, HEADER_LEN + payload_len);
+  }
+  snap->used = HEADER_LEN;
+  snap->count = 0;
+  snap->overflow = 0;
+
+  size_t end = HEADER_LEN + payload_len;
+  size_t pos = HEADER_LEN;
+  int next_wid = snap->base_wid;
+  while (pos < end)
+  {
+    const uint8_t* rec = snap->buf + pos;
+    if (pos + RECORD_HEADER_LEN > end)
+    {
+      return V4_SNAPSHOT_ERR_FORMAT;
+    }
+    int wid = (int)get_u16(rec);
+    size_t name_len = rec[2];
+    size_t code_len = get_u16(rec + 3);
+    size_t rec_len = RECORD_HEADER_LEN + name_len + 1 + code_len;
+    const char* name = (const char*)(rec + RECORD_HEADER_LEN);
+    if (pos + rec_len > end || name[name_len] != '\0' || wid < next_wid)
+    {
+      return V4_SNAPSHOT_ERR_FORMAT;
+    }
+
+    // Re-create ids taken by anonymous code so later ids match
+    while (next_wid < wid)
+    {
+      if (vm_register_word(vm, NULL, FILLER_CODE, sizeof(FILLER_CODE)) != next_wid)
+      {
+        return V4_SNAPSHOT_ERR_MISMATCH;
+      }
+      next_wid++;
+    }
+
+    const uint8_t* code = rec + RECORD_HEADER_LEN + name_len + 1;
+    int got = vm_register_word(vm, name, code, (int)code_len);
+    if (got < 0)
+    {
+      return V4_SNAPSHOT_ERR_REGISTER;
+    }
+    if (got != wid)
+    {
+      return V4_SNAPSHOT_ERR_MISMATCH;
+    }
+    if (v4_dict_define(dict, name, wid) != 0)
+    {
+      return V4_SNAPSHOT_ERR_REGISTER;
+    }
+
+    next_wid = wid + 1;
+    pos += rec_len;
+    snap->used = pos;
+    snap->count++;
+  }
+
+  return snap->count;
+}
+
+const uint8_t* v4_snapshot_image(V4Snapshot* snap, size_t* len)
+{
+  size_t payload_len = snap->used - HEADER_LEN;
+  put_u32(snap->buf, SNAPSHOT_MAGIC);
+  put_u16(snap->buf + 4, V4_SNAPSHOT_VERSION);
+  put_u16(snap->buf + 6, 0);
+  put_u32(snap->buf + 8, (uint32_t)snap->base_wid);
+  put_u32(snap->buf + 12, (uint32_t)snap->count);
+  put_u32(snap->buf + 16, (uint32_t)payload_len);
+  put_u32(snap->buf + 20, esp_rom_crc32_le(0, snap->buf + HEADER_LEN, payload_len));
+  *len = snap->used;
+  return snap->buf;
+}
+
+int v4_snapshot_count(const V4Snapshot* snap)
+{
+  return snap->count;
+}
+
+int v4_snapshot_overflowed(const V4Snapshot* snap)
+{
+  return snap->overflow;
+}
+
+void v4_snapshot_clear(V4Snapshot* snap)
+{
+  snap->used = HEADER_LEN;
+  snap->count = 0;
+  snap->overflow = 0;
+}
+
+int v4_snapshot_save_nvs(V4Snapshot* snap, const char* nvs_namespace, const char* key)
+{
+  if (snap->overflow)
+  {
+    return V4_SNAPSHOT_ERR_FULL;
+  }
+
+  size_t len;
+  const uint8_t* image = v4_snapshot_image(snap, &len);
+
+  nvs_handle_t handle;
+  if (nvs_open(nvs_namespace, NVS_READWRITE, &handle) != ESP_OK)
+  {
+    return V4_SNAPSHOT_ERR_STORAGE;
+  }
+  esp_err_t err = nvs_set_blob(handle, key, image, len);
+  if (err == ESP_OK)
+  {
+    err = nvs_commit(handle);
+  }
+  nvs_close(handle);
+  return (err == ESP_OK) ? V4_SNAPSHOT_OK : V4_SNAPSHOT_ERR_STORAGE;
+}
+
+int v4_snapshot_load_nvs(V4Snapshot* snap, struct Vm* vm, V4Dict* dict,
+                         const char* nvs_namespace, const char* key)
+{
+  nvs_handle_t handle;
+  esp_err_t err = nvs_open(nvs_namespace, NVS_READONLY, &handle);
+  if (err == ESP_ERR_NVS_NOT_FOUND)
+  {
+    return V4_SNAPSHOT_ERR_NOT_FOUND;
+  }
+  if (err != ESP_OK)
+  {
+    return V4_SNAPSHOT_ERR_STORAGE;
+  }
+
+  size_t len = 0;
+  err = nvs_get_blob(handle, key, NULL, &len);
+  if (err == ESP_OK && len > snap->capacity)
+  {
+    nvs_close(handle);
+    return V4_SNAPSHOT_ERR_FULL;
+  }
+  if (err == ESP_OK)
+  {
+    // Read straight into the journal; restore() then registers in place
+    err = nvs_get_blob(handle, key, snap->buf, &len);
+  }
+  nvs_close(handle);
+
+  if (err == ESP_ERR_NVS_NOT_FOUND)
+  {
+    return V4_SNAPSHOT_ERR_NOT_FOUND;
+  }
+  if (err != ESP_OK)
+  {
+    return V4_SNAPSHOT_ERR_STORAGE;
+  }
+
+  int restored = v4_snapshot_restore(snap, vm, dict, snap->buf, len);
+  if (restored < 0)
+  {
+    v4_snapshot_clear(snap);
+  }
+  return restored;
+}
+
+int v4_snapshot_erase_nvs(const char* nvs_namespace, const char* key)
+{
+  nvs_handle_t handle;
+  if (nvs_open(nvs_namespace, NVS_READWRITE, &handle) != ESP_OK)
+  {
+    return V4_SNAPSHOT_ERR_STORAGE;
+  }
+  esp_err_t err = nvs_erase_key(handle, key);
+  if (err == ESP_OK)
+  {
+    err = nvs_commit(handle);
+  }
+  nvs_close(handle);
+  return (err == ESP_OK || err == ESP_ERR_NVS_NOT_FOUND) ? V4_SNAPSHOT_OK
+                                                         : V4_SNAPSHOT_ERR_STORAGE;
+}
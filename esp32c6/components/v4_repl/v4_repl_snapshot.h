@@ -0,0 +1,140 @@
+/**
+ * @file v4_repl_snapshot.h
+ * @brief Persistent dictionary snapshots for the V4 REPL
+ *
+ * The VM dictionary cannot be enumerated from outside the VM, so the
+ * snapshot journals every word as it is registered (VM word and REPL
+ * dictionary entry together) into a compact, versioned image:
+ *
+ *   Header:  [MAGIC "V4DS" u32][VERSION u16][RESERVED u16][BASE_WID u32]
+ *            [COUNT u32][PAYLOAD_LEN u32][CRC32 u32]
+ *   Record:  [WID u16][NAME_LEN u8][CODE_LEN u16][NAME... NUL][CODE...]
+ *
+ * All fields are little-endian; NAME_LEN excludes the NUL terminator and
+ * the CRC-32 covers the records. Restoring
+ * replays the records in one pass, reproducing the original word ids so
+ * compiled references between words stay valid.
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "v4/vm_api.h"
+#include "v4_repl_dict.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Current image format version */
+#define V4_SNAPSHOT_VERSION 1
+
+/** Snapshot error codes */
+#define V4_SNAPSHOT_OK 0
+#define V4_SNAPSHOT_ERR_FULL -1      /**< Journal capacity exceeded */
+#define V4_SNAPSHOT_ERR_FORMAT -2    /**< Not an image, or unsupported version */
+#define V4_SNAPSHOT_ERR_CHECKSUM -3  /**< Image CRC mismatch */
+#define V4_SNAPSHOT_ERR_MISMATCH -4  /**< Image taken on another base dictionary */
+#define V4_SNAPSHOT_ERR_REGISTER -5  /**< VM or dictionary rejected a word */
+#define V4_SNAPSHOT_ERR_STORAGE -6   /**< NVS read/write failed */
+#define V4_SNAPSHOT_ERR_NOT_FOUND -7 /**< No saved image */
+
+typedef struct V4Snapshot V4Snapshot;
+
+/**
+ * @brief Create a snapshot journal
+ *
+ * @param capacity  Image size limit in bytes (header included)
+ * @param base_wid  Word id of the first user word, i.e. the next id after
+ *                  all built-in words have been registered
+ * @return Snapshot, or NULL if out of memory
+ */
+V4Snapshot* v4_snapshot_create(size_t capacity, int base_wid);
+
+/**
+ * @brief Destroy a snapshot journal
+ *
+ * Word names and code registered in the VM point into its buffer, so
+ * destroy it only after the VM.
+ */
+void v4_snapshot_destroy(V4Snapshot* snap);
+
+/**
+ * @brief Register a word in the VM and REPL dictionary and journal it
+ *
+ * Use instead of the vm_register_word() / v4_dict_define() pair for every
+ * user word that should survive a reboot.
+ *
+ * @return Word id (>= 0), or a negative VM / V4_SNAPSHOT_ERR_REGISTER error
+ *         (dictionary full).
+ *         A word that no longer fits in the journal is still registered;
+ *         v4_snapshot_overflowed() then reports the snapshot as incomplete.
+ */
+int v4_snapshot_register_word(V4Snapshot* snap, struct Vm* vm, V4Dict* dict,
+                              const char* name, const uint8_t* code, int code_len);
+
+/**
+ * @brief Restore words from an image in one pass
+ *
+ * The VM and REPL dictionary must contain exactly the built-in words
+ * (next word id == base_wid). On success the journal holds the image, so
+ * a later save includes the restored words.
+ *
+ * @return Number of words restored, or a V4_SNAPSHOT_ERR_* code
+ */
+int v4_snapshot_restore(V4Snapshot* snap, struct Vm* vm, V4Dict* dict,
+                        const uint8_t* image, size_t len);
+
+/**
+ * @brief Get the current image
+ *
+ * @param snap  Snapshot
+ * @param len   Receives the image length in bytes
+ * @return Image bytes (valid until the next registration)
+ */
+const uint8_t* v4_snapshot_image(V4Snapshot* snap, size_t* len);
+
+/**
+ * @brief Number of journaled words
+ */
+int v4_snapshot_count(const V4Snapshot* snap);
+
+/**
+ * @brief Check whether a word did not fit in the journal
+ */
+int v4_snapshot_overflowed(const V4Snapshot* snap);
+
+/**
+ * @brief Drop all journaled words (the VM dictionary is not changed)
+ */
+void v4_snapshot_clear(V4Snapshot* snap);
+
+/**
+ * @brief Save the current image to NVS
+ *
+ * @return V4_SNAPSHOT_OK, V4_SNAPSHOT_ERR_FULL if the journal overflowed,
+ *         or V4_SNAPSHOT_ERR_STORAGE
+ */
+int v4_snapshot_save_nvs(V4Snapshot* snap, const char* nvs_namespace, const char* key);
+
+/**
+ * @brief Load an image from NVS and restore it
+ *
+ * @return Number of words restored, or a V4_SNAPSHOT_ERR_* code
+ */
+int v4_snapshot_load_nvs(V4Snapshot* snap, struct Vm* vm, V4Dict* dict,
+                         const char* nvs_namespace, const char* key);
+
+/**
+ * @brief Erase the saved image from NVS
+ */
+int v4_snapshot_erase_nvs(const char* nvs_namespace, const char* key);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,226 @@
+/**
+ * @file v4_sched.cpp
+ * @brief Cooperative scheduler for several V4 VMs
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include "v4_sched.hpp"
+
+namespace v4ports
+{
+
+VmScheduler::VmScheduler(uint8_t* pool, size_t pool_size, size_t vm_mem_size, Clock clock)
+    : pool_(pool),
+      pool_size_(pool_size),
+      vm_mem_size_(vm_mem_size),
+      clock_(clock),
+      stats_since_(clock())
+{
+}
+
+VmScheduler::~VmScheduler()
+{
+  for (size_t i = 0; i < count_; i++)
+  {
+    vm_destroy(tasks_[i].vm);
+  }
+}
+
+int VmScheduler::add(const VmTaskConfig& cfg)
+{
+  if (count_ >= VM_SCHED_MAX)
+  {
+    return VM_SCHED_ERR_FULL;
+  }
+  if (vm_mem_size_ == 0 || (count_ + 1) * vm_mem_size_ > pool_size_)
+  {
+    return VM_SCHED_ERR_NO_MEM;
+  }
+  if (cfg.step == nullptr || cfg.step_len == 0)
+  {
+    return VM_SCHED_ERR_CODE;
+  }
+
+  Task& task = tasks_[count_];
+  task = {};
+  task.owner = this;
+  task.id = static_cast<int>(count_);
+  task.cfg = cfg;
+  task.port = {VM_SCHED_PORT, 8, port_read, port_write, &task};
+
+  VmConfig vm_cfg = {
+      .mem = pool_ + count_ * vm_mem_size_,
+      .mem_size = static_cast<uint32_t>(vm_mem_size_),
+      .mmio = &task.port,
+      .mmio_count = 1,
+      .arena = nullptr,
+  };
+  task.vm = vm_create(&vm_cfg);
+  if (task.vm == nullptr)
+  {
+    return VM_SCHED_ERR_CREATE;
+  }
+
+  int wid = vm_register_word(task.vm, cfg.name, cfg.step, static_cast<int>(cfg.step_len));
+  if (wid < 0)
+  {
+    vm_destroy(task.vm);
+    return wid;
+  }
+  task.step = vm_get_word(task.vm, wid);
+  task.stats.name = cfg.name;
+  count_++;
+
+  if (cfg.init != nullptr && cfg.init_len > 0)
+  {
+    int init_wid =
+        vm_register_word(task.vm, nullptr, cfg.init, static_cast<int>(cfg.init_len));
+    v4_err err =
+        (init_wid < 0) ? init_wid : vm_exec(task.vm, vm_get_word(task.vm, init_wid));
+    if (err != 0)
+    {
+      task.stats.state = VmTaskState::FAULTED;
+      task.stats.last_error = err;
+    }
+  }
+
+  task.ready_at = clock_();
+  return task.id;
+}
+
+uint64_t VmScheduler::run_once()
+{
+  uint64_t now = clock_();
+  for (size_t i = 0; i < count_; i++)
+  {
+    Task& task = tasks_[i];
+    if (task.stats.state == VmTaskState::FAULTED || task.ready_at > now)
+    {
+      continue;
+    }
+    run_slice(task, now);
+    now = clock_();
+  }
+
+  uint64_t due = UINT64_MAX;
+  for (size_t i = 0; i < count_; i++)
+  {
+    const Task& task = tasks_[i];
+    if (task.stats.state != VmTaskState::FAULTED && task.ready_at < due)
+    {
+      due = task.ready_at;
+    }
+  }
+  return due;
+}
+
+void VmScheduler::run_slice(Task& task, uint64_t start)
+{
+  VmTaskStats& s = task.stats;
+  uint32_t latency = static_cast<uint32_t>(start - task.ready_at);
+  s.state = VmTaskState::READY;
+  s.slices++;
+  s.latency_sum_us += latency;
+  if (latency > s.latency_max_us)
+  {
+    s.latency_max_us = latency;
+  }
+
+  uint64_t now = start;
+  uint32_t steps = 0;
+  while (true)
+  {
+    task.sleep_requested = false;
+    task.yield_requested = false;
+
+    uint64_t step_start = now;
+    v4_err err = vm_exec(task.vm, task.step);
+    now = clock_();
+    steps++;
+    s.steps++;
+    if (now - step_start > task.cfg.slice_us)
+    {
+      s.overruns++;
+    }
+
+    if (err != 0)
+    {
+      s.state = VmTaskState::FAULTED;
+      s.last_error = err;
+      break;
+    }
+    if (task.sleep_requested && task.sleep_ms > 0)
+    {
+      s.sleeps++;
+      s.state = VmTaskState::SLEEPING;
+      task.ready_at = now + static_cast<uint64_t>(task.sleep_ms) * 1000;
+      break;
+    }
+    if (task.sleep_requested || task.yield_requested)
+    {
+      s.yields++;
+      task.ready_at = now;
+      break;
+    }
+    if (now - start >= task.cfg.slice_us ||
+        (task.cfg.slice_steps != 0 && steps >= task.cfg.slice_steps))
+    {
+      task.ready_at = now;
+      break;
+    }
+  }
+
+  s.cpu_us += now - start;
+}
+
+VmTaskStats VmScheduler::stats(int id) const
+{
+  if (id < 0 || static_cast<size_t>(id) >= count_)
+  {
+    return {};
+  }
+  return tasks_[id].stats;
+}
+
+void VmScheduler::reset_stats()
+{
+  for (size_t i = 0; i < count_; i++)
+  {
+    VmTaskStats& s = tasks_[i].stats;
+    s = {s.name, s.state, s.last_error, 0, 0, 0, 0, 0, 0, 0, 0};
+  }
+  stats_since_ = clock_();
+}
+
+v4_err VmScheduler::port_read(void* user, v4_u32 addr, v4_u32* out)
+{
+  Task* task = static_cast<Task*>(user);
+  if (addr < VM_SCHED_YIELD)
+  {
+    *out = static_cast<v4_u32>(task->owner->clock_() / 1000);
+  }
+  else
+  {
+    *out = static_cast<v4_u32>(task->id);
+  }
+  return 0;
+}
+
+v4_err VmScheduler::port_write(void* user, v4_u32 addr, v4_u32 value)
+{
+  Task* task = static_cast<Task*>(user);
+  if (addr < VM_SCHED_YIELD)
+  {
+    task->sleep_requested = true;
+    task->sleep_ms = value;
+  }
+  else
+  {
+    task->yield_requested = true;
+  }
+  return 0;
+}
+
+}  // namespace v4ports
@@ -0,0 +1,223 @@
+/**
+ * @file v4_sched.hpp
+ * @brief Cooperative scheduler for several V4 VMs
+ *
+ * VmScheduler owns up to VM_SCHED_MAX independent VMs, each with a fixed
+ * slice of a caller-provided memory pool, and runs them round-robin from
+ * one task. Every VM has a step word; a slice calls it repeatedly until
+ * the slice's time or step budget is spent or the program gives up the
+ * CPU. V4 cannot preempt a word, so budgets are checked between steps and
+ * a step that runs past its whole slice is counted as an overrun.
+ *
+ * Programs give up the CPU through a scheduler port in their MMIO space
+ * instead of blocking:
+ *
+ *   10 SLEEP !   \ sleep 10 ms once this step returns
+ *   0 YIELD !    \ end the slice once this step returns
+ *   SLEEP @      \ scheduler clock in ms
+ *   YIELD @      \ id of the running VM
+ *
+ * SYS DELAY_MS still blocks the whole scheduler, so programs meant to
+ * share the CPU sleep through the port instead.
+ *
+ * Portable (no ESP-IDF dependencies) so it can be built and tested on a
+ * Linux host as well as on the target.
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "v4/vm_api.h"
+
+namespace v4ports
+{
+
+/// Maximum number of VMs per scheduler
+constexpr size_t VM_SCHED_MAX = 8;
+
+/// VM address of the scheduler port (below the V4NativeTable call port)
+constexpr uint32_t VM_SCHED_PORT = 0xFFFFFE00u;
+constexpr uint32_t VM_SCHED_SLEEP = VM_SCHED_PORT;      ///< W: sleep ms, R: clock ms
+constexpr uint32_t VM_SCHED_YIELD = VM_SCHED_PORT + 4;  ///< W: end slice, R: VM id
+
+/// Scheduler error codes (negative, like V4 errors)
+constexpr int VM_SCHED_ERR_FULL = -120;    ///< VM_SCHED_MAX VMs already added
+constexpr int VM_SCHED_ERR_NO_MEM = -121;  ///< Memory pool exhausted
+constexpr int VM_SCHED_ERR_CREATE = -122;  ///< vm_create() failed
+constexpr int VM_SCHED_ERR_CODE = -123;    ///< Empty step word
+
+/**
+ * @brief One VM to be scheduled
+ *
+ * The code is run in place and must outlive the scheduler.
+ */
+struct VmTaskConfig
+{
+  const char* name;        ///< Name shown in statistics
+  const uint8_t* step;     ///< Step word, called once per step
+  size_t step_len;         ///< Step word length in bytes
+  const uint8_t* init;     ///< Optional word run once by add() (may be nullptr)
+  size_t init_len;         ///< Init word length in bytes
+  uint32_t slice_us;       ///< Time budget per slice
+  uint32_t slice_steps;    ///< Step budget per slice (0 = time budget only)
+};
+
+/**
+ * @brief Scheduling state of a VM
+ */
+enum class VmTaskState : uint8_t
+{
+  READY = 0,     ///< Runs in the next round
+  SLEEPING = 1,  ///< Waits for its wake time
+  FAULTED = 2,   ///< A step failed; no longer scheduled
+};
+
+/**
+ * @brief Per-VM statistics
+ *
+ * Scheduling latency is the time from a VM becoming runnable (its wake
+ * time, or the end of its previous slice) to the start of its next slice.
+ */
+struct VmTaskStats
+{
+  const char* name;
+  VmTaskState state;
+  int last_error;             ///< VM error that faulted the VM (0 = none)
+  uint32_t steps;             ///< Step words run
+  uint32_t slices;            ///< Slices run
+  uint32_t sleeps;            ///< Sleep requests
+  uint32_t yields;            ///< Yield requests
+  uint32_t overruns;          ///< Steps that alone took longer than the slice
+  uint64_t cpu_us;            ///< Time spent in the VM
+  uint64_t latency_sum_us;    ///< Sum of scheduling latencies
+  uint32_t latency_max_us;    ///< Worst scheduling latency
+};
+
+/**
+ * @brief Round-robin scheduler of V4 VMs
+ *
+ * Example usage:
+ * @code
+ * static uint8_t pool[3 * 4096];
+ * v4ports::VmScheduler sched(pool, sizeof(pool), 4096, clock_us);
+ * sched.add({"sensor", SENSOR_STEP, sizeof(SENSOR_STEP), nullptr, 0, 1000, 0});
+ * while (true)
+ * {
+ *   uint64_t due = sched.run_once();
+ *   // sleep until due
+ * }
+ * @endcode
+ */
+class VmScheduler
+{
+ public:
+  /// Monotonic microsecond clock
+  using Clock = uint64_t (*)();
+
+  /**
+   * @brief Construct an empty scheduler
+   *
+   * @param pool         Memory for all VMs (must outlive the scheduler)
+   * @param pool_size    Pool size in bytes
+   * @param vm_mem_size  Memory of each VM in bytes
+   * @param clock        Microsecond clock
+   */
+  VmScheduler(uint8_t* pool, size_t pool_size, size_t vm_mem_size, Clock clock);
+
+  /**
+   * @brief Destructor; destroys all VMs
+   */
+  ~VmScheduler();
+
+  // Non-copyable (VMs hold pointers into the scheduler)
+  VmScheduler(const VmScheduler&) = delete;
+  VmScheduler& operator=(const VmScheduler&) = delete;
+
+  /**
+   * @brief Create a VM, run its init word and make it ready
+   *
+   * A VM whose init word fails is added in the FAULTED state.
+   *
+   * @return VM id (>= 0) or a VM_SCHED_ERR_* / V4 error code
+   */
+  int add(const VmTaskConfig& cfg);
+
+  /**
+   * @brief Run one round: one slice for every VM that is due
+   *
+   * @return Clock time at which the next VM is due (UINT64_MAX if none is
+   *         runnable); the caller may sleep until then
+   */
+  uint64_t run_once();
+
+  /**
+   * @brief Get the number of VMs
+   */
+  size_t count() const
+  {
+    return count_;
+  }
+
+  /**
+   * @brief Get the VM with id @p id (e.g. to register extra words)
+   */
+  Vm* vm(int id) const
+  {
+    return (id >= 0 && static_cast<size_t>(id) < count_) ? tasks_[id].vm : nullptr;
+  }
+
+  /**
+   * @brief Get the statistics of VM @p id
+   */
+  VmTaskStats stats(int id) const;
+
+  /**
+   * @brief Get the time covered by the statistics
+   */
+  uint64_t elapsed_us() const
+  {
+    return clock_() - stats_since_;
+  }
+
+  /**
+   * @brief Clear all statistics
+   */
+  void reset_stats();
+
+ private:
+  struct Task
+  {
+    VmScheduler* owner;
+    int id;
+    Vm* vm;
+    Word* step;
+    V4_MMIO port;
+    VmTaskConfig cfg;
+    uint64_t ready_at;
+    uint32_t sleep_ms;
+    bool sleep_requested;
+    bool yield_requested;
+    VmTaskStats stats;
+  };
+
+  static v4_err port_read(void* user, v4_u32 addr, v4_u32* out);
+  static v4_err port_write(void* user, v4_u32 addr, v4_u32 value);
+
+  void run_slice(Task& task, uint64_t start);
+
+  uint8_t* pool_;
+  size_t pool_size_;
+  size_t vm_mem_size_;
+  Clock clock_;
+  uint64_t stats_since_;
+
+  Task tasks_[VM_SCHED_MAX] = {};
+  size_t count_ = 0;
+};
+
+}  // namespace v4ports
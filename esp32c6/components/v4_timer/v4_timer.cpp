@@ -0,0 +1,186 @@
+/**
+ * @file v4_timer.cpp
+ * @brief Periodic and deferred V4 words on a timer wheel
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include "v4_timer.hpp"
+
+namespace v4ports
+{
+
+namespace
+{
+
+constexpr uint64_t US_PER_TICK = 1000;
+
+uint32_t to_tick(uint64_t us)
+{
+  return static_cast<uint32_t>(us / US_PER_TICK);
+}
+
+}  // namespace
+
+TimerScheduler::TimerScheduler(Vm* vm, Clock clock)
+    : vm_(vm), clock_(clock), stats_since_(clock()), wheel_(to_tick(stats_since_))
+{
+}
+
+int TimerScheduler::every(const char* name, int wid, uint32_t period_ms,
+                          uint32_t delay_ms)
+{
+  if (period_ms == 0)
+  {
+    return TIMER_ERR_RANGE;
+  }
+  return arm(name, wid, period_ms, delay_ms);
+}
+
+int TimerScheduler::after(const char* name, int wid, uint32_t delay_ms)
+{
+  return arm(name, wid, 0, delay_ms);
+}
+
+int TimerScheduler::arm(const char* name, int wid, uint32_t period_ms, uint32_t delay_ms)
+{
+  if (period_ms > TIMER_MAX_MS || delay_ms > TIMER_MAX_MS)
+  {
+    return TIMER_ERR_RANGE;
+  }
+  if (wid < 0 || vm_get_word(vm_, wid) == nullptr)
+  {
+    return TIMER_ERR_WORD;
+  }
+
+  for (size_t i = 0; i < TIMER_MAX; i++)
+  {
+    if (TimerWheel::linked(nodes_[i]))
+    {
+      continue;
+    }
+    // Deadlines fall on whole ticks, so a run is never early
+    uint32_t due = to_tick(clock_()) + ((delay_ms > 0) ? delay_ms : 1);
+    Timer& timer = timers_[i];
+    timer = {};
+    timer.wid = wid;
+    timer.due_us = static_cast<uint64_t>(due) * US_PER_TICK;
+    timer.stats.name = name;
+    timer.stats.period_ms = period_ms;
+    timer.stats.armed = true;
+    wheel_.insert(nodes_[i], due);
+    return static_cast<int>(i);
+  }
+  return TIMER_ERR_FULL;
+}
+
+int TimerScheduler::cancel(int id)
+{
+  if (id < 0 || static_cast<size_t>(id) >= TIMER_MAX || !TimerWheel::linked(nodes_[id]))
+  {
+    return TIMER_ERR_ID;
+  }
+  wheel_.cancel(nodes_[id]);
+  timers_[id].stats.armed = false;
+  return 0;
+}
+
+uint64_t TimerScheduler::run_once()
+{
+  uint64_t now = clock_();
+  wheel_.advance(to_tick(now), on_expire, this);
+  if (wheel_.size() == 0)
+  {
+    return UINT64_MAX;
+  }
+  // Ticks are the clock's low 32 bits of ms; add the distance in ticks
+  uint32_t ahead = wheel_.next_expiry() - to_tick(now);
+  return (now / US_PER_TICK + ahead) * US_PER_TICK;
+}
+
+void TimerScheduler::on_expire(TimerNode& node, void* user)
+{
+  TimerScheduler* self = static_cast<TimerScheduler*>(user);
+  self->fire(static_cast<size_t>(&node - self->nodes_));
+}
+
+void TimerScheduler::fire(size_t index)
+{
+  Timer& timer = timers_[index];
+  TimerStats& s = timer.stats;
+
+  uint64_t start = clock_();
+  uint32_t late =
+      (start > timer.due_us) ? static_cast<uint32_t>(start - timer.due_us) : 0;
+  s.late_sum_us += late;
+  if (late > s.late_max_us)
+  {
+    s.late_max_us = late;
+  }
+  uint64_t period_us = static_cast<uint64_t>(s.period_ms) * US_PER_TICK;
+  if (s.runs > 0 && period_us > 0)
+  {
+    uint64_t interval = start - timer.last_start_us;
+    uint64_t jitter =
+        (interval > period_us) ? interval - period_us : period_us - interval;
+    if (jitter > s.jitter_max_us)
+    {
+      s.jitter_max_us = static_cast<uint32_t>(jitter);
+    }
+  }
+  timer.last_start_us = start;
+  s.runs++;
+
+  // Looked up per run: registering more words may move the word table
+  v4_err err = vm_exec(vm_, vm_get_word(vm_, timer.wid));
+  uint64_t end = clock_();
+  s.cpu_us += end - start;
+
+  if (err != 0)
+  {
+    s.last_error = err;
+    s.armed = false;
+    return;
+  }
+  if (period_us == 0)
+  {
+    s.armed = false;
+    return;
+  }
+
+  timer.due_us += period_us;
+  if (timer.due_us <= end)
+  {
+    uint64_t skipped = (end - timer.due_us) / period_us + 1;
+    s.missed += static_cast<uint32_t>(skipped);
+    timer.due_us += skipped * period_us;
+  }
+  wheel_.insert(nodes_[index], to_tick(timer.due_us));
+}
+
+TimerStats TimerScheduler::stats(int id) const
+{
+  if (id < 0 || static_cast<size_t>(id) >= TIMER_MAX)
+  {
+    return TimerStats{};
+  }
+  return timers_[id].stats;
+}
+
+void TimerScheduler::reset_stats()
+{
+  for (Timer& timer : timers_)
+  {
+    TimerStats fresh = {};
+    fresh.name = timer.stats.name;
+    fresh.period_ms = timer.stats.period_ms;
+    fresh.armed = timer.stats.armed;
+    fresh.last_error = timer.stats.last_error;
+    timer.stats = fresh;
+    timer.last_start_us = 0;
+  }
+  stats_since_ = clock_();
+}
+
+}  // namespace v4ports
@@ -0,0 +1,188 @@
+/**
+ * @file v4_timer.hpp
+ * @brief Periodic and deferred V4 words on a timer wheel
+ *
+ * Instead of a word that blinks with SYS DELAY_MS and holds the VM for
+ * the whole delay, a program registers short words and TimerScheduler
+ * runs them at a period or once at a deadline:
+ *
+ *   : led-toggle ( -- ) 0 @ 1 xor dup 0 ! 7 swap gpio! ;
+ *
+ *   timers.every("blink", led_toggle_wid, 500, 0);
+ *
+ * Many timers share one VM. Between runs nothing executes; the caller
+ * sleeps until the time returned by run_once(). Timers live in a
+ * millisecond TimerWheel, so arming and cancelling take constant time.
+ * Periodic deadlines advance by whole periods from the first one, so a
+ * late run does not shift the ones after it; a deadline that has already
+ * passed when the previous run ends is skipped and counted as missed.
+ *
+ * Each run records its lateness (start minus deadline) and, for periodic
+ * timers, how far the time since the previous start strayed from the
+ * period (jitter).
+ *
+ * Portable (no ESP-IDF dependencies) so it can be built and benchmarked
+ * on a Linux host as well as on the target.
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "v4/vm_api.h"
+#include "v4_timer_wheel.hpp"
+
+namespace v4ports
+{
+
+/// Maximum number of timers per scheduler
+constexpr size_t TIMER_MAX = 32;
+
+/// Longest period or delay in ms
+constexpr uint32_t TIMER_MAX_MS = TIMER_WHEEL_RANGE - 1;
+
+/// Timer error codes (negative, like V4 errors)
+constexpr int TIMER_ERR_FULL = -190;   ///< TIMER_MAX timers already armed
+constexpr int TIMER_ERR_WORD = -191;   ///< No word with that id
+constexpr int TIMER_ERR_ID = -192;     ///< No armed timer with that id
+constexpr int TIMER_ERR_RANGE = -193;  ///< Period 0 or above TIMER_MAX_MS
+
+/**
+ * @brief Per-timer statistics
+ */
+struct TimerStats
+{
+  const char* name;         ///< Name given when armed (nullptr = unused id)
+  uint32_t period_ms;       ///< Period (0 = one-shot)
+  bool armed;               ///< Still scheduled
+  int last_error;           ///< VM error that stopped the timer (0 = none)
+  uint32_t runs;            ///< Word runs
+  uint32_t missed;          ///< Periodic deadlines skipped
+  uint64_t cpu_us;          ///< Time spent in the word
+  uint64_t late_sum_us;     ///< Sum of start - deadline
+  uint32_t late_max_us;     ///< Worst start - deadline
+  uint32_t jitter_max_us;   ///< Worst |start - previous start - period|
+};
+
+/**
+ * @brief Runs V4 words at periods and deadlines
+ *
+ * Example usage:
+ * @code
+ * v4ports::TimerScheduler timers(vm, clock_us);
+ * timers.every("blink", blink_wid, 500, 0);
+ * timers.after("hello", hello_wid, 2000);
+ * while (true)
+ * {
+ *   uint64_t due = timers.run_once();
+ *   // sleep until due
+ * }
+ * @endcode
+ *
+ * Not thread-safe: all calls belong to the task that runs the VM.
+ */
+class TimerScheduler
+{
+ public:
+  /// Monotonic microsecond clock
+  using Clock = uint64_t (*)();
+
+  /**
+   * @brief Construct a scheduler without timers
+   *
+   * @param vm     VM that runs the words
+   * @param clock  Microsecond clock
+   */
+  TimerScheduler(Vm* vm, Clock clock);
+
+  // Non-copyable (the wheel links into the timer table)
+  TimerScheduler(const TimerScheduler&) = delete;
+  TimerScheduler& operator=(const TimerScheduler&) = delete;
+
+  /**
+   * @brief Run word @p wid every @p period_ms, first after @p delay_ms
+   *
+   * @param name       Name shown in statistics (must outlive the timer)
+   * @param wid        Word id, called as ( -- )
+   * @param period_ms  Period, 1 .. TIMER_MAX_MS
+   * @param delay_ms   Delay of the first run (0 = next tick)
+   * @return Timer id (>= 0) or a TIMER_ERR_* code
+   */
+  int every(const char* name, int wid, uint32_t period_ms, uint32_t delay_ms);
+
+  /**
+   * @brief Run word @p wid once, @p delay_ms from now
+   *
+   * @return Timer id (>= 0) or a TIMER_ERR_* code
+   */
+  int after(const char* name, int wid, uint32_t delay_ms);
+
+  /**
+   * @brief Disarm timer @p id; its id may be reused
+   *
+   * @return 0 or TIMER_ERR_ID
+   */
+  int cancel(int id);
+
+  /**
+   * @brief Run the words of all timers that are due
+   *
+   * @return Clock time by which run_once() should be called again
+   *         (UINT64_MAX if no timer is armed); the caller may sleep until
+   *         then
+   */
+  uint64_t run_once();
+
+  /**
+   * @brief Get the number of armed timers
+   */
+  size_t armed() const
+  {
+    return wheel_.size();
+  }
+
+  /**
+   * @brief Get the statistics of timer @p id
+   */
+  TimerStats stats(int id) const;
+
+  /**
+   * @brief Get the time covered by the statistics
+   */
+  uint64_t elapsed_us() const
+  {
+    return clock_() - stats_since_;
+  }
+
+  /**
+   * @brief Clear all statistics
+   */
+  void reset_stats();
+
+ private:
+  struct Timer
+  {
+    int wid;
+    uint64_t due_us;
+    uint64_t last_start_us;
+    TimerStats stats;
+  };
+
+  static void on_expire(TimerNode& node, void* user);
+
+  int arm(const char* name, int wid, uint32_t period_ms, uint32_t delay_ms);
+  void fire(size_t index);
+
+  Vm* vm_;
+  Clock clock_;
+  uint64_t stats_since_;
+  TimerWheel wheel_;
+  Timer timers_[TIMER_MAX] = {};
+  TimerNode nodes_[TIMER_MAX] = {};
+};
+
+}  // namespace v4ports
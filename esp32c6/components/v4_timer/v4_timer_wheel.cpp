@@ -0,0 +1,186 @@
+/**
+ * @file v4_timer_wheel.cpp
+ * @brief Hierarchical timer wheel with O(1) insert and cancel
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include "v4_timer_wheel.hpp"
+
+namespace v4ports
+{
+
+namespace
+{
+
+constexpr uint32_t SLOT_MASK = TIMER_WHEEL_SLOTS - 1;
+
+// Level whose span holds a deadline @p delta ticks ahead
+uint32_t level_for(uint32_t delta)
+{
+  uint32_t level = 0;
+  while (level + 1 < TIMER_WHEEL_LEVELS &&
+         delta >= (1u << (TIMER_WHEEL_BITS * (level + 1))))
+  {
+    level++;
+  }
+  return level;
+}
+
+uint64_t rotate_right(uint64_t bits, uint32_t n)
+{
+  return (n == 0) ? bits : (bits >> n) | (bits << (64 - n));
+}
+
+}  // namespace
+
+TimerWheel::TimerWheel(uint32_t now) : now_(now)
+{
+}
+
+void TimerWheel::link(TimerNode& node, uint32_t level, uint32_t slot)
+{
+  TimerNode*& head = slots_[level][slot];
+  node.next = head;
+  if (head != nullptr)
+  {
+    head->pprev = &node.next;
+  }
+  head = &node;
+  node.pprev = &head;
+  node.level = static_cast<uint8_t>(level);
+  node.slot = static_cast<uint8_t>(slot);
+  occupied_[level] |= 1ULL << slot;
+  size_++;
+}
+
+void TimerWheel::insert(TimerNode& node, uint32_t expires)
+{
+  cancel(node);
+
+  uint32_t delta = expires - now_;
+  if (static_cast<int32_t>(delta) <= 0)
+  {
+    delta = 1;
+  }
+  else if (delta >= TIMER_WHEEL_RANGE)
+  {
+    delta = TIMER_WHEEL_RANGE - 1;
+  }
+  node.expires = now_ + delta;
+
+  uint32_t level = level_for(delta);
+  link(node, level, (node.expires >> (TIMER_WHEEL_BITS * level)) & SLOT_MASK);
+}
+
+void TimerWheel::cancel(TimerNode& node)
+{
+  if (node.pprev == nullptr)
+  {
+    return;
+  }
+  *node.pprev = node.next;
+  if (node.next != nullptr)
+  {
+    node.next->pprev = node.pprev;
+  }
+  node.pprev = nullptr;
+  node.next = nullptr;
+  size_--;
+  if (slots_[node.level][node.slot] == nullptr)
+  {
+    occupied_[node.level] &= ~(1ULL << node.slot);
+  }
+}
+
+// Move the timers of the level's current slot down; called when the
+// level below wraps, after the levels above have been cascaded
+void TimerWheel::cascade(uint32_t level)
+{
+  uint32_t shift = TIMER_WHEEL_BITS * level;
+  uint32_t slot = (now_ >> shift) & SLOT_MASK;
+  if (slot == 0 && level + 1 < TIMER_WHEEL_LEVELS)
+  {
+    cascade(level + 1);
+  }
+
+  TimerNode* node = slots_[level][slot];
+  slots_[level][slot] = nullptr;
+  occupied_[level] &= ~(1ULL << slot);
+  while (node != nullptr)
+  {
+    TimerNode* next = node->next;
+    size_--;
+    // Due now goes to the current level 0 slot, expired right after
+    uint32_t to = level_for(node->expires - now_);
+    link(*node, to, (node->expires >> (TIMER_WHEEL_BITS * to)) & SLOT_MASK);
+    node = next;
+  }
+}
+
+void TimerWheel::expire(uint32_t slot, Expire fn, void* user)
+{
+  // Detach the slot so callbacks can insert and cancel freely
+  TimerNode* head = slots_[0][slot];
+  if (head == nullptr)
+  {
+    return;
+  }
+  slots_[0][slot] = nullptr;
+  occupied_[0] &= ~(1ULL << slot);
+  head->pprev = &head;
+
+  while (head != nullptr)
+  {
+    TimerNode& node = *head;
+    cancel(node);
+    fn(node, user);
+  }
+}
+
+void TimerWheel::advance(uint32_t to, Expire fn, void* user)
+{
+  while (static_cast<int32_t>(to - now_) > 0)
+  {
+    uint32_t next = now_ + 1;
+    if (occupied_[0] == 0)
+    {
+      // Nothing due before the next cascade
+      uint32_t boundary = (now_ | SLOT_MASK) + 1;
+      next = (to - now_ < boundary - now_) ? to : boundary;
+    }
+    now_ = next;
+    if ((now_ & SLOT_MASK) == 0)
+    {
+      cascade(1);
+    }
+    expire(now_ & SLOT_MASK, fn, user);
+  }
+}
+
+uint32_t TimerWheel::next_expiry() const
+{
+  uint32_t best = TIMER_WHEEL_RANGE - 1;
+  for (uint32_t level = 0; level < TIMER_WHEEL_LEVELS && size_ > 0; level++)
+  {
+    if (occupied_[level] == 0)
+    {
+      continue;
+    }
+    // Slots ahead of the current one until the first occupied slot (1..64)
+    uint32_t shift = TIMER_WHEEL_BITS * level;
+    uint32_t current = (now_ >> shift) & SLOT_MASK;
+    uint64_t ahead = rotate_right(occupied_[level], (current + 1) & SLOT_MASK);
+    uint32_t slots = static_cast<uint32_t>(__builtin_ctzll(ahead)) + 1;
+    // Tick at which that slot expires (level 0) or cascades
+    uint32_t delta = (((now_ >> shift) + slots) << shift) - now_;
+    if (delta < best)
+    {
+      best = delta;
+    }
+  }
+  return now_ + best;
+}
+
+}  // namespace v4ports
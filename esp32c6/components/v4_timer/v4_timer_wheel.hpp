@@ -0,0 +1,162 @@
+/**
+ * @file v4_timer_wheel.hpp
+ * @brief Hierarchical timer wheel with O(1) insert and cancel
+ *
+ * Timers are intrusive nodes owned by the caller, kept in one of
+ * TIMER_WHEEL_SLOTS slots on each of TIMER_WHEEL_LEVELS levels. Level 0
+ * holds timers due within TIMER_WHEEL_SLOTS ticks, one slot per tick;
+ * every further level covers TIMER_WHEEL_SLOTS times the span of the one
+ * below. Inserting picks the level from the distance to the deadline and
+ * links the node into a slot, cancelling unlinks it: both are constant
+ * time whatever the number of timers. Once the wheel reaches a higher
+ * level slot its timers are cascaded to the levels below, so every timer
+ * still expires on its exact tick.
+ *
+ * A tick is whatever the caller advances by (the timer scheduler uses
+ * milliseconds). Ticks are 32-bit and wrap; deadlines may be at most
+ * TIMER_WHEEL_RANGE - 1 ticks ahead.
+ *
+ * Portable (no ESP-IDF dependencies) so it can be built and benchmarked
+ * on a Linux host as well as on the target.
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace v4ports
+{
+
+/// Slot index bits per level
+constexpr uint32_t TIMER_WHEEL_BITS = 6;
+
+/// Slots per level
+constexpr uint32_t TIMER_WHEEL_SLOTS = 1u << TIMER_WHEEL_BITS;
+
+/// Levels (TIMER_WHEEL_SLOTS^levels ticks of range)
+constexpr uint32_t TIMER_WHEEL_LEVELS = 4;
+
+/// Ticks covered by the wheel (2^24 = 4.6 hours of 1 ms ticks)
+constexpr uint32_t TIMER_WHEEL_RANGE = 1u << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS);
+
+/**
+ * @brief One timer in a TimerWheel (embed or allocate statically)
+ *
+ * Only the wheel touches the fields; a node must not be moved or freed
+ * while it is linked.
+ */
+struct TimerNode
+{
+  TimerNode* next;    ///< Next node in the slot
+  TimerNode** pprev;  ///< Link pointing at this node (nullptr = not linked)
+  uint32_t expires;   ///< Tick at which the timer expires
+  uint8_t level;      ///< Level of the slot
+  uint8_t slot;       ///< Slot index within the level
+};
+
+/**
+ * @brief Timer wheel advanced by the caller
+ *
+ * Example usage:
+ * @code
+ * static v4ports::TimerNode blink;
+ * v4ports::TimerWheel wheel(now_ms());
+ * wheel.insert(blink, now_ms() + 500);
+ * while (true)
+ * {
+ *   wheel.advance(now_ms(), on_expired, nullptr);
+ *   // sleep until wheel.next_expiry()
+ * }
+ * @endcode
+ *
+ * Not thread-safe.
+ */
+class TimerWheel
+{
+ public:
+  /// Called for each expired node (already unlinked, may be inserted again)
+  using Expire = void (*)(TimerNode& node, void* user);
+
+  /**
+   * @brief Construct an empty wheel
+   *
+   * @param now  Current tick
+   */
+  explicit TimerWheel(uint32_t now);
+
+  // Non-copyable (nodes point into the slot table)
+  TimerWheel(const TimerWheel&) = delete;
+  TimerWheel& operator=(const TimerWheel&) = delete;
+
+  /**
+   * @brief Arm @p node to expire at tick @p expires
+   *
+   * A linked node is moved. A deadline that has already passed expires on
+   * the next tick; one TIMER_WHEEL_RANGE or more ahead is clamped.
+   */
+  void insert(TimerNode& node, uint32_t expires);
+
+  /**
+   * @brief Disarm @p node (no effect if it is not linked)
+   */
+  void cancel(TimerNode& node);
+
+  /**
+   * @brief Check whether @p node is armed
+   */
+  static bool linked(const TimerNode& node)
+  {
+    return node.pprev != nullptr;
+  }
+
+  /**
+   * @brief Move to tick @p to, calling @p fn for every timer that expires
+   *
+   * Timers expire in tick order. Runs of ticks with nothing due at level
+   * 0 are skipped, so a long advance costs one step per cascade rather
+   * than one per tick.
+   */
+  void advance(uint32_t to, Expire fn, void* user);
+
+  /**
+   * @brief Get the current tick
+   */
+  uint32_t now() const
+  {
+    return now_;
+  }
+
+  /**
+   * @brief Get the number of armed timers
+   */
+  size_t size() const
+  {
+    return size_;
+  }
+
+  /**
+   * @brief Get the tick by which advance() must be called next
+   *
+   * Exact if a timer is due within TIMER_WHEEL_SLOTS ticks, otherwise the
+   * next cascade that may bring one closer (advancing early is harmless).
+   *
+   * @return Tick, or now() + TIMER_WHEEL_RANGE - 1 if no timer is armed
+   */
+  uint32_t next_expiry() const;
+
+ private:
+  void link(TimerNode& node, uint32_t level, uint32_t slot);
+  void cascade(uint32_t level);
+  void expire(uint32_t slot, Expire fn, void* user);
+
+  uint32_t now_;
+  size_t size_ = 0;
+  TimerNode* slots_[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS] = {};
+  uint64_t occupied_[TIMER_WHEEL_LEVELS] = {};  // Bit per non-empty slot
+};
+
+}  // namespace v4ports
@@ -0,0 +1,145 @@
+/**
+ * @file main.cpp
+ * @brief V4 Blink Example for ESP32-C6
+ *
+ * Simple LED blink example to verify GPIO and Timer HAL implementation.
+ * The blink is a V4 word run every 500 ms by a timer scheduler rather
+ * than a loop around hal_delay_ms(), so the VM is free between toggles
+ * and a second periodic word shares it. Timing statistics are printed to
+ * the serial console every 5 seconds.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "v4/hal.h"
+#include "v4/vm_api.h"
+#include "v4_timer.hpp"
+
+// LED pin configuration for ESP32-C6
+// GPIO7: Simple on-board LED (can be controlled with standard GPIO)
+// GPIO8: WS2812 RGB LED (requires special driver)
+#define LED_PIN 7
+
+// Blink interval in milliseconds
+#define BLINK_INTERVAL_MS 500
+
+// Uptime counter interval in milliseconds
+#define COUNT_INTERVAL_MS 10
+
+// Statistics report interval in milliseconds
+#define REPORT_INTERVAL_MS 5000
+
+// VM memory: LED state at 0, uptime count at 4
+static uint8_t vm_mem[256];
+
+// blink ( -- ) 0 @ 1 XOR DUP 0 ! 7 SWAP GPIO_WRITE
+static const uint8_t BLINK_WORD[] = {
+    0x73, 0x30,           // LIT0, LOAD
+    0x74, 0x2A,           // LIT1, XOR
+    0x01, 0x73, 0x31,     // DUP, LIT0, STORE
+    0x76, LED_PIN, 0x03,  // LIT_U8 7, SWAP
+    0x60, 0x01,           // SYS GPIO_WRITE
+    0x51,                 // RET
+};
+
+// count ( -- ) 4 @ 1 + 4 !
+static const uint8_t COUNT_WORD[] = {
+    0x76, 4, 0x30,  // LIT_U8 4, LOAD
+    0x74, 0x10,     // LIT1, ADD
+    0x76, 4, 0x31,  // LIT_U8 4, STORE
+    0x51,           // RET
+};
+
+static uint64_t clock_us()
+{
+  return hal_micros();
+}
+
+static void print_stats(const v4ports::TimerScheduler& timers, const int* ids, int count)
+{
+  int32_t uptime;
+  memcpy(&uptime, vm_mem + 4, sizeof(uptime));
+  printf("[%6" PRIu32 " ms] LED %s | count %" PRId32 "\n", hal_millis(),
+         vm_mem[0] ? "ON " : "OFF", uptime);
+  for (int i = 0; i < count; i++)
+  {
+    v4ports::TimerStats s = timers.stats(ids[i]);
+    uint32_t late_avg = (s.runs > 0) ? static_cast<uint32_t>(s.late_sum_us / s.runs) : 0;
+    printf("  %-6s every %4" PRIu32 " ms: %6" PRIu32 " runs, %" PRIu32
+           " missed, late avg %" PRIu32 " / max %" PRIu32 " us, jitter max %" PRIu32
+           " us\n",
+           s.name, s.period_ms, s.runs, s.missed, late_avg, s.late_max_us,
+           s.jitter_max_us);
+  }
+}
+
+extern "C" void app_main(void)
+{
+  printf("\n");
+  printf("========================================\n");
+  printf("V4 Blink Example - ESP32-C6\n");
+  printf("========================================\n");
+  printf("LED Pin: GPIO%d\n", LED_PIN);
+  printf("Blink Interval: %d ms\n", BLINK_INTERVAL_MS);
+  printf("========================================\n\n");
+
+  // Initialize GPIO pin for LED output
+  int err = hal_gpio_mode(LED_PIN, HAL_GPIO_OUTPUT);
+  if (err != 0)
+  {
+    printf("ERROR: Failed to initialize GPIO%d (error code: %d)\n", LED_PIN, err);
+    return;
+  }
+  printf("GPIO%d initialized as OUTPUT\n\n", LED_PIN);
+
+  VmConfig cfg = {
+      .mem = vm_mem,
+      .mem_size = sizeof(vm_mem),
+      .mmio = nullptr,
+      .mmio_count = 0,
+      .arena = nullptr,
+  };
+  Vm* vm = vm_create(&cfg);
+  if (vm == nullptr)
+  {
+    printf("ERROR: Failed to create VM\n");
+    return;
+  }
+
+  // Both words share the VM; each run is a few instructions
+  v4ports::TimerScheduler timers(vm, clock_us);
+  int blink_wid = vm_register_word(vm, "blink", BLINK_WORD, sizeof(BLINK_WORD));
+  int count_wid = vm_register_word(vm, "count", COUNT_WORD, sizeof(COUNT_WORD));
+  int ids[2] = {
+      timers.every("blink", blink_wid, BLINK_INTERVAL_MS, BLINK_INTERVAL_MS),
+      timers.every("count", count_wid, COUNT_INTERVAL_MS, COUNT_INTERVAL_MS),
+  };
+  if (ids[0] < 0 || ids[1] < 0)
+  {
+    printf("ERROR: Failed to start timers (%d, %d)\n", ids[0], ids[1]);
+    vm_destroy(vm);
+    return;
+  }
+
+  uint32_t next_report = hal_millis() + REPORT_INTERVAL_MS;
+  while (1)
+  {
+    uint64_t due = timers.run_once();
+
+    if (static_cast<int32_t>(hal_millis() - next_report) >= 0)
+    {
+      print_stats(timers, ids, 2);
+      timers.reset_stats();
+      next_report += REPORT_INTERVAL_MS;
+    }
+
+    // Sleep until the next word is due (deadlines fall on whole ms)
+    uint64_t now = hal_micros();
+    if (due > now)
+    {
+      hal_delay_ms(static_cast<uint32_t>((due - now + 999) / 1000));
+    }
+  }
+}
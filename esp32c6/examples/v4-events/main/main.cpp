@@ -0,0 +1,158 @@
+/**
+ * @file main.cpp
+ * @brief GPIO and timer interrupts handled by V4 words on the ESP32-C6
+ *
+ * The BOOT button (GPIO9, falling edge) toggles the LED on GPIO7 and a
+ * 1 ms hardware timer counts ticks in VM memory, both through handler
+ * words run by EventDispatcher. The task sleeps until an ISR notifies it
+ * and prints event counts and ISR-to-handler latency every 5 seconds.
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "v4/hal.h"
+#include "v4/vm_api.h"
+#include "v4_event.hpp"
+#include "v4_event_isr.hpp"
+
+static const char* TAG = "v4-events";
+
+// Pins
+static constexpr gpio_num_t BUTTON_GPIO = GPIO_NUM_9;
+static constexpr int LED_GPIO = 7;
+
+// Event sources
+static constexpr uint16_t SRC_BUTTON = 0;
+static constexpr uint16_t SRC_TICK = 1;
+
+// Timer period
+static constexpr uint32_t TICK_US = 1000;
+
+// Dispatch limits per wakeup
+static constexpr size_t DISPATCH_MAX_EVENTS = 16;
+static constexpr uint32_t DISPATCH_BUDGET_US = 1000;
+
+// Statistics report interval
+static constexpr uint64_t REPORT_US = 5ULL * 1000 * 1000;
+
+// VM memory: LED state at 0, tick count at 4
+static uint8_t vm_mem[4096];
+
+// One ring per ISR
+static v4ports::Event button_slots[16];
+static v4ports::Event tick_slots[64];
+static v4ports::EventRing button_ring(button_slots, 16);
+static v4ports::EventRing tick_ring(tick_slots, 64);
+
+// on-button ( level -- ) DROP 0 @ 1 XOR DUP 0 ! 7 SWAP GPIO_WRITE
+static const uint8_t ON_BUTTON[] = {
+    0x02,                       // DROP (falling edge only, level is 0)
+    0x73, 0x30,                 // LIT0, LOAD
+    0x74, 0x2A,                 // LIT1, XOR
+    0x01, 0x73, 0x31,           // DUP, LIT0, STORE
+    0x76, LED_GPIO, 0x03,       // LIT_U8 7, SWAP
+    0x60, 0x01,                 // SYS GPIO_WRITE
+    0x51,                       // RET
+};
+
+// on-tick ( n -- ) 4 !
+static const uint8_t ON_TICK[] = {
+    0x76, 4, 0x31,  // LIT_U8 4, STORE
+    0x51,           // RET
+};
+
+static uint64_t clock_us()
+{
+  return static_cast<uint64_t>(esp_timer_get_time());
+}
+
+static void print_stats(const v4ports::EventDispatcher& events)
+{
+  v4ports::EventStats s = events.stats();
+  int32_t ticks;
+  memcpy(&ticks, vm_mem + 4, sizeof(ticks));
+  unsigned avg = (s.dispatched > 0)
+                     ? static_cast<unsigned>(s.latency_sum_us / s.dispatched)
+                     : 0;
+  printf("events: %u handled, %u dropped, high water %u, %u budget stops, "
+         "%u faults; tick %ld, led %u\n",
+         static_cast<unsigned>(s.dispatched), static_cast<unsigned>(s.dropped),
+         static_cast<unsigned>(s.high_water), static_cast<unsigned>(s.budget_stops),
+         static_cast<unsigned>(s.faults), static_cast<long>(ticks),
+         static_cast<unsigned>(vm_mem[0]));
+  printf("latency: avg %u us, max %u us\n", avg,
+         static_cast<unsigned>(s.latency_max_us));
+}
+
+extern "C" void app_main()
+{
+  if (hal_gpio_mode(LED_GPIO, HAL_GPIO_OUTPUT) != 0)
+  {
+    ESP_LOGE(TAG, "Failed to initialize GPIO%d", LED_GPIO);
+    return;
+  }
+
+  VmConfig cfg = {
+      .mem = vm_mem,
+      .mem_size = sizeof(vm_mem),
+      .mmio = nullptr,
+      .mmio_count = 0,
+      .arena = nullptr,
+  };
+  Vm* vm = vm_create(&cfg);
+  if (vm == nullptr)
+  {
+    ESP_LOGE(TAG, "Failed to create VM");
+    return;
+  }
+
+  v4ports::EventDispatcher events(vm, clock_us);
+  events.attach(button_ring);
+  events.attach(tick_ring);
+  int button_wid = vm_register_word(vm, "on-button", ON_BUTTON, sizeof(ON_BUTTON));
+  int tick_wid = vm_register_word(vm, "on-tick", ON_TICK, sizeof(ON_TICK));
+  if (events.bind(SRC_BUTTON, button_wid) != 0 || events.bind(SRC_TICK, tick_wid) != 0)
+  {
+    ESP_LOGE(TAG, "Failed to bind handler words");
+    return;
+  }
+
+  TaskHandle_t self = xTaskGetCurrentTaskHandle();
+  esp_err_t err = v4ports::event_gpio_attach(button_ring, BUTTON_GPIO,
+                                             GPIO_INTR_NEGEDGE, SRC_BUTTON, self);
+  if (err == ESP_OK)
+  {
+    err = v4ports::event_timer_attach(tick_ring, TICK_US, SRC_TICK, self);
+  }
+  if (err != ESP_OK)
+  {
+    ESP_LOGE(TAG, "Failed to attach interrupts: %s", esp_err_to_name(err));
+    return;
+  }
+  ESP_LOGI(TAG, "Press BOOT to toggle the LED; %u us tick",
+           static_cast<unsigned>(TICK_US));
+
+  while (true)
+  {
+    // Sleep until an ISR posts (the timeout only paces the report)
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+    while (events.pending())
+    {
+      events.dispatch(DISPATCH_MAX_EVENTS, DISPATCH_BUDGET_US);
+    }
+
+    if (events.elapsed_us() >= REPORT_US)
+    {
+      print_stats(events);
+      events.reset_stats();
+    }
+  }
+}
@@ -3,19 +3,50 @@
 V4-link Host Script
 
 Send bytecode to ESP32-C6 running V4-link demo via USB Serial/JTAG.
-Supports PING, EXEC, and RESET commands.
+Supports PING, EXEC, and RESET commands. Bytecode larger than one frame is
+uploaded automatically with BEGIN/CHUNK/COMMIT. Many bytecode files can be
+deployed with --deploy, which keeps a window of tagged frames in flight.
+
+--exec first asks the device to run the program from its bytecode cache
+(EXEC_HASH) and only uploads it on a miss.
+
+--exec FILE --async runs the program in the device's worker task: the EXEC
+is acknowledged at once and the host polls with short EXEC_WAIT requests, so
+long programs need no long timeout. --status and --abort query or stop the
+running job.
+
+--load IMAGE registers every word of a linkable image built with
+v4-image-build in one transfer (LOAD, or a chunked upload committed with
+COMMIT_LOAD) and prints the word ID assigned to each name.
+
+Uploads that compress well are sent as EXEC_LZ: the bytecode is
+LZ-compressed on the host and decompressed by the device while the frame
+arrives (--no-compress sends it as is).
+
+--stats dumps the link telemetry (byte/frame/error counters and log2
+latency histograms for frame decode, VM execution and TX).
+
+--profile dumps the device execution profile (CONFIG_V4_LINK_PROFILE) as a
+report of programs sorted by VM time; bytecode files given to --profile,
+--exec or --deploy label their programs by name instead of hash.
 
 Usage:
     python v4_link_send.py --port /dev/ttyACM0 --ping
     python v4_link_send.py --port /dev/ttyACM0 --exec examples/lit42.bin
     python v4_link_send.py --port /dev/ttyACM0 --exec examples/hello.bin
     python v4_link_send.py --port /dev/ttyACM0 --reset
+    python v4_link_send.py --port /dev/ttyACM0 --deploy words/*.bin --window 8
+    python v4_link_send.py --port /dev/ttyACM0 --profile words/*.bin
+    python v4_link_send.py --port /dev/ttyACM0 --stats
+    python v4_link_send.py --port /dev/ttyACM0 --load app.v4i
+    python v4_link_send.py --port /dev/ttyACM0 --exec examples/led_sos.bin --async
 """
 
 import argparse
 import struct
 import sys
 import time
+import zlib
 from pathlib import Path
 
 try:
@@ -27,15 +58,104 @@ except ImportError:
 # Protocol constants
 STX = 0xA5
 CMD_EXEC = 0x10
+CMD_BEGIN = 0x11
+CMD_CHUNK = 0x12
+CMD_COMMIT = 0x13
+CMD_TAGGED = 0x14
+CMD_EXEC_HASH = 0x15
+CMD_PROFILE = 0x16
+CMD_STATS = 0x17
+CMD_EXEC_ASYNC = 0x18
+CMD_EXEC_STATUS = 0x19
+CMD_EXEC_WAIT = 0x1A
+CMD_EXEC_ABORT = 0x1B
+CMD_LOAD = 0x1C
+CMD_EXEC_LZ = 0x1D
 CMD_PING = 0x20
 CMD_RESET = 0xFF
 
+# Maximum payload of a single frame (device bytecode buffer size)
+MAX_PAYLOAD = 512
+
+# Chunk header: [SEQ u16 LE]
+CHUNK_HEADER_LEN = 2
+
+# EXEC_LZ header: [RAW_LEN u16 LE], followed by the compressed program
+LZ_HEADER_LEN = 2
+LZ_MIN_MATCH = 4
+LZ_WINDOW = 4096
+
+# COMMIT flags: load the upload as an image instead of executing it
+COMMIT_LOAD = 0x01
+
+# Linkable image (v4_image.h, little-endian)
+#   Header: [MAGIC u32][VERSION u16][FLAGS u16][WORD_COUNT u16][IMPORT_COUNT u16]
+#           [RELOC_COUNT u16][ENTRY u16][STRINGS_LEN u32][CODE_LEN u32]
+#           [PAYLOAD_LEN u32][CRC32 u32]
+#   Word:   [NAME_OFF u16][CODE_LEN u16][CODE_OFF u32]
+IMAGE_HEADER = struct.Struct("<IHHHHHHIIII")
+IMAGE_WORD = struct.Struct("<HHI")
+IMAGE_IMPORT_LEN = 2
+IMAGE_RELOC_LEN = 8
+IMAGE_MAGIC = 0x4D493456
+
+# Tagged frame header: [SEQ u8][CMD]; the device remembers the last 16 results
+TAG_HEADER_LEN = 2
+TAG_WINDOW_MAX = 16
+
+# PROFILE flags
+PROFILE_CLEAR = 0x01
+
+# Profile dump (little-endian)
+#   Header: [VERSION u8][COUNT u8][TICKS_PER_US u16][SAMPLES u32]
+#           [IDLE_SAMPLES u32][UNTRACKED_CALLS u32]
+#   Entry:  [HASH u64][CALLS u32][ERRORS u32][TICKS u64][SAMPLES u32]
+PROFILE_HEADER = struct.Struct("<BBHIII")
+PROFILE_ENTRY = struct.Struct("<QIIQI")
+
+# STATS flags
+STATS_RESET = 0x01
+
+# Link telemetry dump (little-endian)
+#   Header:     [VERSION u8][BUCKETS u8][TICKS_PER_US u16]
+#   Counters:   STATS_COUNTERS, u32 each
+#   Results:    10 x u32, responses by error code
+#   Histograms: decode, exec, tx; BUCKETS x u32 each (log2 of clock ticks)
+STATS_HEADER = struct.Struct("<BBH")
+STATS_COUNTERS = [
+    "rx_bytes",
+    "tx_bytes",
+    "frames",
+    "crc_errors",
+    "oversized",
+    "rx_discarded",
+    "idle_drops",
+    "responses",
+    "lz_raw_bytes",
+    "lz_wire_bytes",
+]
+# Counters present in each telemetry format version
+STATS_VERSION_COUNTERS = {1: 8, 2: 10}
+STATS_RESULT_CODES = 10
+STATS_HISTOGRAMS = ["decode", "exec", "tx"]
+
+# Async job status: [STATE u8][RESULT u8][JOB u16][ELAPSED_MS u32]
+EXEC_STATUS = struct.Struct("<BBHI")
+EXEC_STATE_NAMES = {0: "IDLE", 1: "RUNNING", 2: "DONE"}
+EXEC_STATE_RUNNING = 1
+EXEC_STATE_DONE = 2
+
 # Error codes
 ERR_OK = 0x00
 ERR_ERROR = 0x01
 ERR_INVALID_FRAME = 0x02
 ERR_BUFFER_FULL = 0x03
 ERR_VM_ERROR = 0x04
+ERR_SEQUENCE = 0x05
+ERR_CHECKSUM = 0x06
+ERR_NOT_FOUND = 0x07
+ERR_BUSY = 0x08
+ERR_ABORTED = 0x09
 
 ERROR_NAMES = {
     ERR_OK: "OK",
@@ -43,6 +163,11 @@ ERROR_NAMES = {
     ERR_INVALID_FRAME: "INVALID_FRAME",
     ERR_BUFFER_FULL: "BUFFER_FULL",
     ERR_VM_ERROR: "VM_ERROR",
+    ERR_SEQUENCE: "SEQUENCE",
+    ERR_CHECKSUM: "CHECKSUM",
+    ERR_NOT_FOUND: "NOT_FOUND",
+    ERR_BUSY: "BUSY",
+    ERR_ABORTED: "ABORTED",
 }
 
 
@@ -60,11 +185,69 @@ def calc_crc8(data):
     return crc
 
 
-def encode_frame(cmd, payload=b""):
+def program_hash(bytecode):
+    """64-bit FNV-1a of the program bytes (key of the device bytecode cache)."""
+    h = 0xCBF29CE484222325
+    for byte in bytecode:
+        h ^= byte
+        h = (h * 0x100000001B3) & 0xFFFFFFFFFFFFFFFF
+    return h
+
+
+def lz_compress(data):
+    """
+    Compress bytecode for EXEC_LZ (greedy LZ4-style sequences).
+
+    Each sequence is [TOKEN][LIT_EXT...][LITERALS...][OFFSET u16 LE][MATCH_EXT...];
+    the stream ends with a sequence of literals only. Mirrors lz_compress() in
+    v4_link_lz.cpp.
+    """
+    out = bytearray()
+
+    def put_ext(value):
+        while value >= 255:
+            out.append(255)
+            value -= 255
+        out.append(value)
+
+    def sequence(literals, offset=0, match=0):
+        m = match - LZ_MIN_MATCH if match else 0
+        out.append((min(len(literals), 15) << 4) | min(m, 15))
+        if len(literals) >= 15:
+            put_ext(len(literals) - 15)
+        out.extend(literals)
+        if match:
+            out.extend(struct.pack("<H", offset))
+            if m >= 15:
+                put_ext(m - 15)
+
+    last = {}  # 4-byte prefix -> most recent position
+    anchor = 0
+    i = 0
+    while i + LZ_MIN_MATCH <= len(data):
+        key = data[i : i + LZ_MIN_MATCH]
+        cand = last.get(key)
+        last[key] = i
+        if cand is None or i - cand > LZ_WINDOW:
+            i += 1
+            continue
+        match = LZ_MIN_MATCH
+        while i + match < len(data) and data[cand + match] == data[i + match]:
+            match += 1
+        sequence(data[anchor:i], i - cand, match)
+        for k in range(i + 1, min(i + match, len(data) - LZ_MIN_MATCH + 1)):
+            last[data[k : k + LZ_MIN_MATCH]] = k
+        i += match
+        anchor = i
+    sequence(data[anchor:])
+    return bytes(out)
+
+
+def encode_frame(cmd, payload=b"", max_payload=MAX_PAYLOAD):
     """Encode a V4-link frame with CRC-8."""
     length = len(payload)
-    if length > 512:
-        raise ValueError(f"Payload too large: {length} bytes (max 512)")
+    if length > max_payload:
+        raise ValueError(f"Payload too large: {length} bytes (max {max_payload})")
 
     # Frame: [STX][LEN_L][LEN_H][CMD][DATA...][CRC8]
     frame = struct.pack("<BBB", STX, length & 0xFF, (length >> 8) & 0xFF)
@@ -99,9 +282,150 @@ def decode_response(data):
     return err_code, None
 
 
-def send_command(ser, cmd, payload=b"", timeout=1.0):
+class ResponseReader:
+    """Incremental decoder for device responses (plain and batched acks)."""
+
+    def __init__(self, ser):
+        self.ser = ser
+        self.buf = bytearray()
+        self.crc_errors = 0
+
+    def read(self, timeout):
+        """Return payloads of the frames received within timeout (may be empty)."""
+        deadline = time.monotonic() + timeout
+        frames = self._extract()
+        while not frames:
+            remaining = deadline - time.monotonic()
+            if remaining <= 0:
+                break
+            self.ser.timeout = remaining
+            data = self.ser.read(max(1, self.ser.in_waiting))
+            if not data:
+                break
+            self.buf += data
+            frames = self._extract()
+        return frames
+
+    def _extract(self):
+        frames = []
+        while True:
+            start = self.buf.find(STX)
+            if start < 0:
+                self.buf.clear()
+                break
+            del self.buf[:start]
+            if len(self.buf) < 4:
+                break
+            length = self.buf[1] | (self.buf[2] << 8)
+            if length == 0 or length > 2 * TAG_WINDOW_MAX:
+                # Not a response header (damaged frame); resync on the next STX
+                self.crc_errors += 1
+                del self.buf[:1]
+                continue
+            if len(self.buf) < length + 4:
+                break
+            if calc_crc8(self.buf[1 : length + 3]) != self.buf[length + 3]:
+                # Corrupted response; resync on the next STX
+                self.crc_errors += 1
+                del self.buf[:1]
+                continue
+            frames.append(bytes(self.buf[3 : length + 3]))
+            del self.buf[: length + 4]
+        return frames
+
+
+def send_windowed(ser, commands, window=8, timeout=1.0, max_retries=5):
+    """
+    Send (cmd, payload) pairs as TAGGED frames with up to `window` in flight.
+
+    The device executes tagged frames strictly in sequence order and answers a
+    gap with SEQUENCE, so a lost frame is resent together with the frames
+    that were rejected after it. Frames that were executed but whose ack was
+    lost are resent alone and re-acknowledged from the device's result cache.
+
+    Returns (results, stats); results holds one error code per command, or
+    None for commands that were never acknowledged.
+    """
+    window = max(1, min(window, TAG_WINDOW_MAX))
+    reader = ResponseReader(ser)
+
+    # A tagged PING with seq 0 opens the sequence
+    items = [(CMD_PING, b"")] + list(commands)
+    frames = [
+        encode_frame(CMD_TAGGED, bytes([i & 0xFF, cmd]) + payload)
+        for i, (cmd, payload) in enumerate(items)
+    ]
+    results = [None] * len(frames)
+    retries = [0] * len(frames)
+    stats = {"frames": len(frames), "sent": 0, "retransmits": 0, "rejected": 0}
+
+    base = 0  # oldest unacknowledged frame
+    next_ = 0  # next frame to send
+    recovering = False  # stale SEQUENCE acks are expected after a go-back
+    requested = set()  # holes already resent
+
+    def go_back():
+        nonlocal next_, recovering
+        retries[base] += 1
+        stats["retransmits"] += next_ - base
+        next_ = base
+        recovering = True
+        return retries[base] <= max_retries
+
+    while base < len(frames):
+        while next_ < len(frames) and next_ - base < window:
+            ser.write(frames[next_])
+            stats["sent"] += 1
+            next_ += 1
+        ser.flush()
+
+        received = reader.read(timeout)
+        if not received:
+            if not go_back():
+                break
+            continue
+
+        gap = False
+        highest = base - 1
+        for data in received:
+            if len(data) == 1:
+                # Plain response: the device dropped a corrupted frame. With a
+                # single frame in flight it can only be that one.
+                stats["rejected"] += 1
+                gap = gap or next_ - base == 1
+                continue
+            for k in range(0, len(data) - 1, 2):
+                seq, err = data[k], data[k + 1]
+                idx = base + ((seq - base) & 0xFF)
+                if idx >= next_ or results[idx] is not None:
+                    continue
+                if err == ERR_SEQUENCE:
+                    gap = gap or not recovering
+                    continue
+                results[idx] = err
+                highest = max(highest, idx)
+                recovering = False
+
+        # Selective retransmit of executed frames whose ack was lost
+        for i in range(base, highest):
+            if results[i] is None and i not in requested:
+                requested.add(i)
+                ser.write(frames[i])
+                stats["retransmits"] += 1
+
+        while base < len(frames) and results[base] is not None:
+            base += 1
+
+        if gap and base < next_ and not go_back():
+            break
+
+    stats["crc_errors"] = reader.crc_errors
+    return results[1:], stats
+
+
+def send_command(ser, cmd, payload=b"", timeout=1.0, max_payload=MAX_PAYLOAD):
     """Send command and wait for response."""
-    frame = encode_frame(cmd, payload)
+    frame = encode_frame(cmd, payload, max_payload)
 
     print(f"Sending frame ({len(frame)} bytes): {frame.hex()}")
     ser.write(frame)
@@ -127,6 +451,212 @@ def send_command(ser, cmd, payload=b"", timeout=1.0):
     return err_code, None
 
 
+def read_data_response(ser, timeout=1.0):
+    """Read one data response [STX][LEN_L][LEN_H][ERR][DATA...][CRC8]."""
+    deadline = time.monotonic() + timeout
+    buf = bytearray()
+    while time.monotonic() < deadline:
+        start = buf.find(STX)
+        if start < 0:
+            buf.clear()
+        else:
+            del buf[:start]
+            if len(buf) >= 4:
+                length = buf[1] | (buf[2] << 8)
+                if len(buf) >= length + 4:
+                    if length == 0 or calc_crc8(buf[1 : length + 3]) != buf[length + 3]:
+                        return None, None, "Corrupted data response"
+                    return buf[3], bytes(buf[4 : length + 3]), None
+        ser.timeout = max(0.001, deadline - time.monotonic())
+        buf += ser.read(max(1, ser.in_waiting))
+    return None, None, "Timeout waiting for response"
+
+
+def decode_profile(data):
+    """Decode a profile dump into (header dict, list of entry dicts)."""
+    if len(data) < PROFILE_HEADER.size:
+        raise ValueError("Profile dump too short")
+    version, count, ticks_per_us, samples, idle, untracked = PROFILE_HEADER.unpack_from(
+        data
+    )
+    if version != 1:
+        raise ValueError(f"Unsupported profile format version {version}")
+    if len(data) != PROFILE_HEADER.size + count * PROFILE_ENTRY.size:
+        raise ValueError("Profile dump length does not match its entry count")
+
+    header = {
+        "ticks_per_us": ticks_per_us or 1,
+        "samples": samples,
+        "idle_samples": idle,
+        "untracked_calls": untracked,
+    }
+    entries = []
+    for i in range(count):
+        digest, calls, errors, ticks, hits = PROFILE_ENTRY.unpack_from(
+            data, PROFILE_HEADER.size + i * PROFILE_ENTRY.size
+        )
+        entries.append(
+            {
+                "hash": digest,
+                "calls": calls,
+                "errors": errors,
+                "ticks": ticks,
+                "samples": hits,
+            }
+        )
+    return header, entries
+
+
+def print_profile(header, entries, names):
+    """Print profile entries sorted by total VM time."""
+    ticks_per_us = header["ticks_per_us"]
+    total_ticks = sum(e["ticks"] for e in entries) or 1
+    samples = header["samples"] or 1
+
+    print(
+        f"{'program':<24} {'calls':>8} {'errors':>6} {'total us':>12} {'avg us':>10} "
+        f"{'time%':>6} {'samples':>8} {'smpl%':>6}"
+    )
+    for e in sorted(entries, key=lambda e: e["ticks"], reverse=True):
+        name = names.get(e["hash"], f"{e['hash']:016x}")
+        total_us = e["ticks"] / ticks_per_us
+        avg_us = total_us / e["calls"] if e["calls"] else 0.0
+        print(
+            f"{name:<24} {e['calls']:>8} {e['errors']:>6} {total_us:>12.1f} "
+            f"{avg_us:>10.2f} {100.0 * e['ticks'] / total_ticks:>6.1f} {e['samples']:>8} "
+            f"{100.0 * e['samples'] / samples:>6.1f}"
+        )
+    print(
+        f"{header['samples']} samples, {header['idle_samples']} idle "
+        f"({100.0 * header['idle_samples'] / samples:.1f}%), "
+        f"{header['untracked_calls']} untracked executions"
+    )
+
+
+def cmd_profile(ser, names, clear=False, timeout=1.0):
+    """Dump the device execution profile (PROFILE command)."""
+    print("Sending PROFILE...")
+    payload = bytes([PROFILE_CLEAR]) if clear else b""
+    ser.write(encode_frame(CMD_PROFILE, payload))
+    ser.flush()
+
+    err_code, data, error = read_data_response(ser, timeout)
+    if error:
+        print(f"Error: {error}")
+        return False
+    if err_code != ERR_OK:
+        err_name = ERROR_NAMES.get(err_code, f"UNKNOWN(0x{err_code:02x})")
+        print(f"Response: {err_name} (profiler not enabled on the device?)")
+        return False
+
+    try:
+        header, entries = decode_profile(data)
+    except ValueError as e:
+        print(f"Error: {e}")
+        return False
+    print_profile(header, entries, names)
+    return True
+
+
+def decode_stats(data):
+    """Decode a link telemetry dump into a dict."""
+    if len(data) < STATS_HEADER.size:
+        raise ValueError("Stats dump too short")
+    version, buckets, ticks_per_us = STATS_HEADER.unpack_from(data)
+    if version not in STATS_VERSION_COUNTERS:
+        raise ValueError(f"Unsupported stats format version {version}")
+    counters = STATS_VERSION_COUNTERS[version]
+    words = counters + STATS_RESULT_CODES + len(STATS_HISTOGRAMS) * buckets
+    if len(data) != STATS_HEADER.size + 4 * words:
+        raise ValueError("Stats dump length does not match its bucket count")
+
+    values = struct.unpack_from(f"<{words}I", data, STATS_HEADER.size)
+    stats = dict.fromkeys(STATS_COUNTERS, 0)
+    stats.update(zip(STATS_COUNTERS[:counters], values))
+    pos = counters
+    stats["results"] = list(values[pos : pos + STATS_RESULT_CODES])
+    pos += STATS_RESULT_CODES
+    stats["ticks_per_us"] = ticks_per_us
+    for name in STATS_HISTOGRAMS:
+        stats[name] = list(values[pos : pos + buckets])
+        pos += buckets
+    return stats
+
+
+def histogram_percentile(buckets, fraction):
+    """Upper bound (in ticks) of the bucket holding the given fraction of samples.
+
+    The last bucket is open-ended, so its bound is infinite.
+    """
+    total = sum(buckets)
+    seen = 0
+    for b, count in enumerate(buckets):
+        seen += count
+        if seen >= fraction * total:
+            if b == len(buckets) - 1:
+                return float("inf")
+            return 0 if b == 0 else (1 << b) - 1
+    return 0
+
+
+def print_stats(stats):
+    """Print link telemetry counters and latency histograms."""
+    for name in STATS_COUNTERS:
+        print(f"{name:<14} {stats[name]:>10}")
+    if stats["lz_wire_bytes"]:
+        ratio = stats["lz_raw_bytes"] / stats["lz_wire_bytes"]
+        print(f"{'lz_ratio':<14} {ratio:>9.2f}x")
+    results = ", ".join(
+        f"{ERROR_NAMES.get(code, code)}={count}"
+        for code, count in enumerate(stats["results"])
+        if count
+    )
+    print(f"{'results':<14} {results or '-'}")
+
+    ticks_per_us = stats["ticks_per_us"]
+    if ticks_per_us == 0:
+        print("Latency histograms not timed (no clock on the device)")
+        return
+
+    print(f"\n{'latency':<8} {'count':>8} {'p50 us':>10} {'p99 us':>10} {'max us':>10}")
+    for name in STATS_HISTOGRAMS:
+        buckets = stats[name]
+        count = sum(buckets)
+        if count == 0:
+            print(f"{name:<8} {0:>8}")
+            continue
+        p50, p99, worst = (
+            histogram_percentile(buckets, fraction) / ticks_per_us
+            for fraction in (0.5, 0.99, 1.0)
+        )
+        print(f"{name:<8} {count:>8} {p50:>10.2f} {p99:>10.2f} {worst:>10.2f}")
+    print("(upper bounds of log2 buckets)")
+
+
+def cmd_stats(ser, reset=False, timeout=1.0):
+    """Dump the device link telemetry (STATS command)."""
+    print("Sending STATS...")
+    payload = bytes([STATS_RESET]) if reset else b""
+    ser.write(encode_frame(CMD_STATS, payload))
+    ser.flush()
+
+    err_code, data, error = read_data_response(ser, timeout)
+    if error:
+        print(f"Error: {error}")
+        return False
+    if err_code != ERR_OK:
+        print(f"Response: {ERROR_NAMES.get(err_code, f'UNKNOWN(0x{err_code:02x})')}")
+        return False
+
+    try:
+        stats = decode_stats(data)
+    except ValueError as e:
+        print(f"Error: {e}")
+        return False
+    print_stats(stats)
+    return True
+
+
 def cmd_ping(ser, timeout=1.0):
     """Send PING command."""
     print("Sending PING...")
@@ -140,8 +670,53 @@ def cmd_ping(ser, timeout=1.0):
     return err_code == ERR_OK
 
 
-def cmd_exec(ser, bytecode, timeout=1.0):
-    """Send EXEC command with bytecode."""
+def cmd_exec(
+    ser,
+    bytecode,
+    timeout=1.0,
+    chunk_size=MAX_PAYLOAD - CHUNK_HEADER_LEN,
+    use_cache=True,
+    compress=True,
+    baud=115200,
+):
+    """
+    Execute bytecode on the device.
+
+    With use_cache, the program is first run by hash from the device cache;
+    it is only uploaded (EXEC, or chunked if it exceeds one frame) on a miss.
+    With compress, a program that fits the device buffer and shrinks is
+    uploaded as EXEC_LZ instead.
+    """
+    if use_cache:
+        digest = program_hash(bytecode)
+        print(f"Sending EXEC_HASH {digest:016x}...")
+        err_code, error = send_command(
+            ser, CMD_EXEC_HASH, struct.pack("<Q", digest), timeout=timeout
+        )
+        if error:
+            print(f"Error: {error}")
+            return False
+        if err_code == ERR_OK:
+            print("Response: OK (cache hit)")
+            return True
+        if err_code not in (ERR_NOT_FOUND, ERR_ERROR):
+            # ERR_ERROR: firmware without EXEC_HASH support
+            err_name = ERROR_NAMES.get(err_code, f"UNKNOWN(0x{err_code:02x})")
+            print(f"Response: {err_name}")
+            return False
+        print("Cache miss, uploading program")
+
+    if compress and len(bytecode) <= MAX_PAYLOAD - LZ_HEADER_LEN:
+        payload = struct.pack("<H", len(bytecode)) + lz_compress(bytecode)
+        if len(payload) < len(bytecode):
+            result = cmd_exec_lz(ser, bytecode, payload, timeout=timeout, baud=baud)
+            if result is not None:
+                return result
+            print("Device does not support EXEC_LZ, sending uncompressed")
+
+    if len(bytecode) > MAX_PAYLOAD:
+        return cmd_exec_chunked(ser, bytecode, timeout=timeout, chunk_size=chunk_size)
+
     print(f"Sending EXEC with {len(bytecode)} bytes of bytecode...")
     print(f"Bytecode: {bytecode.hex()}")
 
@@ -155,6 +730,250 @@ def cmd_exec(ser, bytecode, timeout=1.0):
     return err_code == ERR_OK
 
 
+def cmd_exec_lz(ser, bytecode, payload, timeout=1.0, baud=115200):
+    """
+    Execute bytecode uploaded as a compressed EXEC_LZ frame.
+
+    Returns None if the device rejects the command (firmware without EXEC_LZ).
+    """
+    # 10 bits per byte on the wire; frames add STX, LEN, CMD and CRC
+    byte_ms = 10 * 1000 / baud
+    plain_ms = (len(bytecode) + 5) * byte_ms
+    lz_ms = (len(payload) + 5) * byte_ms
+    print(
+        f"Sending EXEC_LZ with {len(bytecode)} bytes compressed to {len(payload)} "
+        f"({len(bytecode) / len(payload):.2f}x, {plain_ms:.1f} -> {lz_ms:.1f} ms "
+        f"at {baud} baud)..."
+    )
+
+    err_code, error = send_command(ser, CMD_EXEC_LZ, payload, timeout=timeout)
+    if error:
+        print(f"Error: {error}")
+        return False
+    if err_code == ERR_ERROR:
+        return None
+
+    err_name = ERROR_NAMES.get(err_code, f"UNKNOWN(0x{err_code:02x})")
+    print(f"Response: {err_name}")
+    return err_code == ERR_OK
+
+
+def exec_control(ser, cmd, payload=b"", timeout=1.0):
+    """Send EXEC_STATUS / EXEC_WAIT / EXEC_ABORT; return (status dict, error)."""
+    ser.write(encode_frame(cmd, payload))
+    ser.flush()
+    err_code, data, error = read_data_response(ser, timeout)
+    if error:
+        return None, error
+    if err_code != ERR_OK:
+        err_name = ERROR_NAMES.get(err_code, f"UNKNOWN(0x{err_code:02x})")
+        return None, f"{err_name} (async exec not enabled on the device?)"
+    if len(data) != EXEC_STATUS.size:
+        return None, "Malformed job status"
+    state, result, job, elapsed_ms = EXEC_STATUS.unpack(data)
+    return {"state": state, "result": result, "job": job, "elapsed_ms": elapsed_ms}, None
+
+
+def format_status(status):
+    """One-line description of an async job status."""
+    state = EXEC_STATE_NAMES.get(status["state"], str(status["state"]))
+    text = f"job {status['job']} {state}, {status['elapsed_ms']} ms"
+    if status["state"] == EXEC_STATE_DONE:
+        text += ", result " + ERROR_NAMES.get(status["result"], f"0x{status['result']:02x}")
+    return text
+
+
+def cmd_exec_async(ser, bytecode, timeout=1.0, poll_ms=250):
+    """Run bytecode in the device worker task and poll until it finishes."""
+    print(f"Sending EXEC_ASYNC with {len(bytecode)} bytes of bytecode...")
+    err_code, error = send_command(ser, CMD_EXEC_ASYNC, bytecode, timeout=timeout)
+    if error:
+        print(f"Error: {error}")
+        return False
+    if err_code != ERR_OK:
+        print(f"Response: {ERROR_NAMES.get(err_code, f'UNKNOWN(0x{err_code:02x})')}")
+        return False
+
+    # Each EXEC_WAIT returns after at most poll_ms, so the timeout stays short
+    try:
+        while True:
+            status, error = exec_control(
+                ser, CMD_EXEC_WAIT, struct.pack("<H", poll_ms), timeout + poll_ms / 1000
+            )
+            if error:
+                print(f"Error: {error}")
+                return False
+            if status["state"] != EXEC_STATE_RUNNING:
+                break
+            print(f"  {format_status(status)}")
+    except KeyboardInterrupt:
+        status, error = exec_control(ser, CMD_EXEC_ABORT, timeout=timeout)
+        print(f"Aborted: {error or format_status(status)}")
+        return False
+
+    print(f"Response: {format_status(status)}")
+    return status["result"] == ERR_OK
+
+
+def cmd_exec_status(ser, abort=False, timeout=1.0):
+    """Print the async job status, optionally aborting the running job."""
+    print("Sending EXEC_ABORT..." if abort else "Sending EXEC_STATUS...")
+    status, error = exec_control(
+        ser, CMD_EXEC_ABORT if abort else CMD_EXEC_STATUS, timeout=timeout
+    )
+    if error:
+        print(f"Error: {error}")
+        return False
+    print(f"Response: {format_status(status)}")
+    return True
+
+
+def check_response(step, err_code, error):
+    """Print why a plain response is not OK."""
+    if error:
+        print(f"Error during {step}: {error}")
+        return False
+    if err_code != ERR_OK:
+        err_name = ERROR_NAMES.get(err_code, f"UNKNOWN(0x{err_code:02x})")
+        print(f"{step} rejected: {err_name}")
+        return False
+    return True
+
+
+def upload_chunks(ser, data, timeout=1.0, chunk_size=MAX_PAYLOAD - CHUNK_HEADER_LEN):
+    """Send data with BEGIN/CHUNK; the caller sends COMMIT."""
+    chunk_size = max(1, min(chunk_size, 0xFFFF - CHUNK_HEADER_LEN))
+    chunks = [data[i : i + chunk_size] for i in range(0, len(data), chunk_size)]
+    if len(chunks) > 0x10000:
+        print(f"Error: too many chunks ({len(chunks)}); increase --chunk-size")
+        return False
+
+    print(f"Uploading {len(data)} bytes in {len(chunks)} chunks...")
+
+    err_code, error = send_command(
+        ser, CMD_BEGIN, struct.pack("<I", len(data)), timeout=timeout
+    )
+    if not check_response("BEGIN", err_code, error):
+        return False
+
+    frame_limit = chunk_size + CHUNK_HEADER_LEN
+    for seq, chunk in enumerate(chunks):
+        payload = struct.pack("<H", seq) + chunk
+        err_code, error = send_command(
+            ser, CMD_CHUNK, payload, timeout=timeout, max_payload=frame_limit
+        )
+        if not check_response(f"CHUNK {seq}", err_code, error):
+            return False
+    return True
+
+
+def cmd_exec_chunked(ser, bytecode, timeout=1.0, chunk_size=MAX_PAYLOAD - CHUNK_HEADER_LEN):
+    """Upload bytecode with BEGIN/CHUNK/COMMIT and execute it."""
+    if not upload_chunks(ser, bytecode, timeout=timeout, chunk_size=chunk_size):
+        return False
+
+    checksum = zlib.crc32(bytecode) & 0xFFFFFFFF
+    err_code, error = send_command(
+        ser, CMD_COMMIT, struct.pack("<I", checksum), timeout=timeout
+    )
+    if not check_response("COMMIT", err_code, error):
+        return False
+
+    print("Response: OK")
+    return True
+
+
+def image_word_names(image):
+    """Return the word names of a linkable image ("" for the entry word)."""
+    if len(image) < IMAGE_HEADER.size:
+        raise ValueError("Image too short")
+    magic, version, _, words, imports, relocs = IMAGE_HEADER.unpack_from(image)[:6]
+    if magic != IMAGE_MAGIC or version != 1:
+        raise ValueError("Not a version 1 V4 image")
+    strings = (
+        IMAGE_HEADER.size
+        + words * IMAGE_WORD.size
+        + imports * IMAGE_IMPORT_LEN
+        + relocs * IMAGE_RELOC_LEN
+    )
+    names = []
+    for i in range(words):
+        entry = IMAGE_HEADER.size + i * IMAGE_WORD.size
+        name_off = IMAGE_WORD.unpack_from(image, entry)[0]
+        end = image.index(b"\0", strings + name_off)
+        names.append(image[strings + name_off : end].decode("utf-8", "replace"))
+    return names
+
+
+def cmd_load(ser, image, timeout=1.0, chunk_size=MAX_PAYLOAD - CHUNK_HEADER_LEN):
+    """Register all words of a linkable image (LOAD) and print their IDs."""
+    try:
+        names = image_word_names(image)
+    except ValueError as e:
+        print(f"Error: {e}")
+        return False
+
+    # One frame when it fits, otherwise a chunked upload loaded on COMMIT
+    if len(image) <= MAX_PAYLOAD:
+        print(f"Sending LOAD ({len(image)} bytes, {len(names)} words)...")
+        ser.write(encode_frame(CMD_LOAD, image))
+    else:
+        if not upload_chunks(ser, image, timeout=timeout, chunk_size=chunk_size):
+            return False
+        checksum = zlib.crc32(image) & 0xFFFFFFFF
+        print(f"Sending COMMIT (load, {len(names)} words)...")
+        ser.write(encode_frame(CMD_COMMIT, struct.pack("<IB", checksum, COMMIT_LOAD)))
+    ser.flush()
+
+    err_code, data, error = read_data_response(ser, timeout)
+    if error:
+        print(f"Error: {error}")
+        return False
+    if err_code != ERR_OK:
+        print(f"Response: {ERROR_NAMES.get(err_code, f'UNKNOWN(0x{err_code:02x})')}")
+        return False
+
+    count = struct.unpack_from("<H", data)[0] if len(data) >= 2 else -1
+    if count != len(names) or len(data) != 2 + 2 * count:
+        print("Error: malformed LOAD response")
+        return False
+    for name, wid in zip(names, struct.unpack_from(f"<{count}H", data, 2)):
+        print(f"  {wid:5d}  {name or '(entry)'}")
+    print("Response: OK")
+    return True
+
+
+def cmd_deploy(ser, paths, window=8, timeout=1.0):
+    """Execute many bytecode files with pipelined TAGGED EXEC frames."""
+    limit = MAX_PAYLOAD - TAG_HEADER_LEN
+    commands = []
+    for path in paths:
+        bytecode = Path(path).read_bytes()
+        if len(bytecode) > limit:
+            print(f"Error: {path} is {len(bytecode)} bytes (max {limit}); use --exec")
+            return False
+        commands.append((CMD_EXEC, bytecode))
+
+    print(f"Deploying {len(commands)} words (window {window})...")
+    start = time.monotonic()
+    results, stats = send_windowed(ser, commands, window=window, timeout=timeout)
+    elapsed = time.monotonic() - start
+
+    ok = True
+    for path, err in zip(paths, results):
+        if err != ERR_OK:
+            err_name = "NO_ACK" if err is None else ERROR_NAMES.get(err, f"0x{err:02x}")
+            print(f"{path}: {err_name}")
+            ok = False
+
+    rate = stats["frames"] / elapsed if elapsed > 0 else 0.0
+    print(
+        f"{stats['frames']} frames in {elapsed * 1000:.1f} ms ({rate:.0f} frames/s), "
+        f"{stats['retransmits']} retransmitted, {stats['rejected']} rejected"
+    )
+    return ok
+
+
 def cmd_reset(ser, timeout=1.0):
     """Send RESET command."""
     print("Sending RESET...")
@@ -182,7 +1001,69 @@ def main():
     parser.add_argument(
         "--exec", metavar="FILE", help="Send EXEC command with bytecode from file"
     )
+    parser.add_argument(
+        "--no-cache",
+        action="store_true",
+        help="Always upload --exec bytecode instead of trying EXEC_HASH first",
+    )
+    parser.add_argument(
+        "--no-compress",
+        action="store_true",
+        help="Upload --exec bytecode uncompressed instead of as EXEC_LZ",
+    )
+    parser.add_argument(
+        "--async",
+        dest="run_async",
+        action="store_true",
+        help="Run --exec bytecode in the device worker task and poll for completion",
+    )
+    parser.add_argument(
+        "--status", action="store_true", help="Show the status of the async job"
+    )
+    parser.add_argument("--abort", action="store_true", help="Abort the async job")
     parser.add_argument("--reset", action="store_true", help="Send RESET command")
+    parser.add_argument(
+        "--load",
+        metavar="IMAGE",
+        help="Register all words of a linkable image built with v4-image-build",
+    )
+    parser.add_argument(
+        "--deploy",
+        metavar="FILE",
+        nargs="+",
+        help="Execute several bytecode files with pipelined (windowed) transfers",
+    )
+    parser.add_argument(
+        "--profile",
+        metavar="FILE",
+        nargs="*",
+        help="Dump the device execution profile; FILEs label programs by name",
+    )
+    parser.add_argument(
+        "--profile-clear",
+        action="store_true",
+        help="Clear the device profile after dumping it",
+    )
+    parser.add_argument(
+        "--stats", action="store_true", help="Dump the device link telemetry"
+    )
+    parser.add_argument(
+        "--stats-reset",
+        action="store_true",
+        help="Reset the device link telemetry after dumping it",
+    )
+    parser.add_argument(
+        "--window",
+        type=int,
+        default=8,
+        help=f"Frames in flight for --deploy (1-{TAG_WINDOW_MAX}, default: 8)",
+    )
+    parser.add_argument(
+        "--chunk-size",
+        type=int,
+        default=MAX_PAYLOAD - CHUNK_HEADER_LEN,
+        help="Data bytes per CHUNK frame for uploads larger than one frame",
+    )
     parser.add_argument(
         "-t", "--timeout", type=float, default=5.0, help="Response timeout in seconds"
     )
@@ -190,8 +1071,24 @@ def main():
     args = parser.parse_args()
 
     # Check that at least one command is specified
-    if not any([args.ping, args.exec, args.reset]):
-        parser.error("Must specify at least one command: --ping, --exec, or --reset")
+    profile = args.profile is not None or args.profile_clear
+    stats = args.stats or args.stats_reset
+    commands = [
+        args.ping,
+        args.load,
+        args.exec,
+        args.deploy,
+        profile,
+        stats,
+        args.status,
+    ]
+    if not any(commands + [args.abort, args.reset]):
+        parser.error(
+            "Must specify at least one command: --ping, --load, --exec, --deploy, "
+            "--profile, --stats, --status, --abort, or --reset"
+        )
+    if args.run_async and not args.exec:
+        parser.error("--async requires --exec")
 
     # Open serial port
     try:
@@ -210,6 +1107,19 @@ def main():
             if not cmd_ping(ser, timeout=args.timeout):
                 success = False
 
+        if args.load:
+            image_path = Path(args.load)
+            if not image_path.exists():
+                print(f"Error: Image file not found: {image_path}")
+                success = False
+            elif not cmd_load(
+                ser,
+                image_path.read_bytes(),
+                timeout=args.timeout,
+                chunk_size=args.chunk_size,
+            ):
+                success = False
+
         if args.exec:
             bytecode_path = Path(args.exec)
             if not bytecode_path.exists():
@@ -217,9 +1127,48 @@ def main():
                 success = False
             else:
                 bytecode = bytecode_path.read_bytes()
-                if not cmd_exec(ser, bytecode, timeout=args.timeout):
+                if args.run_async:
+                    if not cmd_exec_async(ser, bytecode, timeout=args.timeout):
+                        success = False
+                elif not cmd_exec(
+                    ser,
+                    bytecode,
+                    timeout=args.timeout,
+                    chunk_size=args.chunk_size,
+                    use_cache=not args.no_cache,
+                    compress=not args.no_compress,
+                    baud=args.baud,
+                ):
                     success = False
 
+        if args.deploy:
+            missing = [p for p in args.deploy if not Path(p).exists()]
+            if missing:
+                print(f"Error: Bytecode file not found: {missing[0]}")
+                success = False
+            elif not cmd_deploy(
+                ser, args.deploy, window=args.window, timeout=args.timeout
+            ):
+                success = False
+
+        if profile:
+            names = {}
+            for name in (args.profile or []) + (args.deploy or []) + [args.exec]:
+                if name and Path(name).exists():
+                    names[program_hash(Path(name).read_bytes())] = Path(name).name
+            if not cmd_profile(
+                ser, names, clear=args.profile_clear, timeout=args.timeout
+            ):
+                success = False
+
+        if args.status or args.abort:
+            if not cmd_exec_status(ser, abort=args.abort, timeout=args.timeout):
+                success = False
+
+        if stats:
+            if not cmd_stats(ser, reset=args.stats_reset, timeout=args.timeout):
+                success = False
+
         if args.reset:
             if not cmd_reset(ser, timeout=args.timeout):
                 success = False
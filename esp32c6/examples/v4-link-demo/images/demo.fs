@@ -0,0 +1,2 @@
+\ Top-level code runs once after all words are registered
+3 4 sum-of-squares drop
@@ -0,0 +1,4 @@
+\ Arithmetic helpers, loaded as one image with v4_link_send.py --load
+: square ( n -- n*n ) dup * ;
+: cube ( n -- n*n*n ) dup square * ;
+: sum-of-squares ( a b -- a*a+b*b ) square swap square + ;
@@ -12,16 +12,44 @@
 #include <stdio.h>
 
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "sdkconfig.h"
 #include "v4/vm_api.h"
+#include "v4_link_cache.hpp"
+#include "v4_link_cache_partition.hpp"
+#include "v4_link_exec_worker.hpp"
 #include "v4_link_port.hpp"
+#include "v4_link_profiler.hpp"
+#include "v4_link_service.hpp"
 
 static const char* TAG = "v4_link_demo";
 
 // VM memory (4KB)
 static uint8_t vm_memory[4096];
 
+// Top half of VM memory is reserved for chunked uploads (BEGIN/CHUNK/COMMIT)
+static constexpr size_t UPLOAD_REGION_OFFSET = 2048;
+
+// Resident code and names of images loaded with LOAD
+static uint8_t image_store[4096];
+
+#if CONFIG_V4_LINK_PROFILE
+// Profiler clock. begin/end run on the link task or the exec worker task,
+// so it must be safe from any task and must not wrap during a long
+// program; esp_timer is both, at microsecond resolution.
+static uint64_t profile_clock()
+{
+  return static_cast<uint64_t>(esp_timer_get_time());
+}
+
+static void profile_sample(void* arg)
+{
+  static_cast<v4ports::Profiler*>(arg)->sample();
+}
+#endif
+
 extern "C" void app_main()
 {
   ESP_LOGI(TAG, "V4-link Demo starting...");
@@ -50,9 +78,51 @@ extern "C" void app_main()
     // Initialize V4-link port
     // Uses USB Serial/JTAG
     v4ports::Esp32c6LinkPort link(vm, 512);
+    link.set_upload_region(vm_memory + UPLOAD_REGION_OFFSET,
+                           sizeof(vm_memory) - UPLOAD_REGION_OFFSET);
+    link.set_image_store(image_store, sizeof(image_store));
+
+    // Remember executed programs so the host can re-run them by hash;
+    // persisted in the cache partition when present
+    v4ports::BytecodeCache cache(CONFIG_V4_LINK_CACHE_SIZE, CONFIG_V4_LINK_CACHE_ENTRIES);
+    v4ports::PartitionCacheStore cache_store(CONFIG_V4_LINK_CACHE_PARTITION);
+    if (cache_store.valid())
+    {
+      cache.attach_store(&cache_store);
+    }
+    link.set_cache(&cache);
+
+    // EXEC_ASYNC runs programs in a worker task, so PING / STATS / EXEC_STATUS
+    // are answered while a long program (e.g. one full of delays) runs
+    v4ports::ExecWorker worker(512);
+    link.set_exec_worker(&worker);
+
+#if CONFIG_V4_LINK_PROFILE
+    // Time executions in microseconds and sample the running program from
+    // the esp_timer task; dumped with v4_link_send.py --profile
+    static v4ports::Profiler profiler(profile_clock, 1);
+    link.set_profiler(&profiler);
+
+    esp_timer_handle_t sampler = nullptr;
+    const esp_timer_create_args_t sampler_args = {
+        .callback = profile_sample,
+        .arg = &profiler,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "v4_profile",
+        .skip_unhandled_events = true,
+    };
+    if (esp_timer_create(&sampler_args, &sampler) == ESP_OK)
+    {
+      esp_timer_start_periodic(sampler, 1000000 / CONFIG_V4_LINK_PROFILE_SAMPLE_HZ);
+    }
+    ESP_LOGI(TAG, "Profiler: %d Hz sampling", CONFIG_V4_LINK_PROFILE_SAMPLE_HZ);
+#endif
 
     ESP_LOGI(TAG, "V4-link ready on USB Serial/JTAG");
     ESP_LOGI(TAG, "Buffer capacity: %u bytes", link.buffer_capacity());
+    ESP_LOGI(TAG, "Upload capacity: %u bytes", link.upload_capacity());
+    ESP_LOGI(TAG, "Bytecode cache: %u programs loaded",
+             (unsigned)cache.stats().entries);
     ESP_LOGI(TAG, "");
     ESP_LOGI(TAG, "Waiting for bytecode from host...");
     ESP_LOGI(TAG, "Reducing log level to ERROR to avoid USB Serial/JTAG conflicts");
@@ -65,14 +135,18 @@ extern "C" void app_main()
     esp_log_level_set("v4_link", ESP_LOG_INFO);
     esp_log_level_set("v4_link_port", ESP_LOG_INFO);
 
-    // Main loop: poll for incoming data
-    while (true)
+    // Serve the link from a dedicated task that blocks on USB RX, so frames
+    // are dispatched as soon as they arrive (no polling tick)
+    v4ports::LinkService service(link);
+    if (!service.start())
     {
-      link.poll();
-
-      // Small delay to prevent busy-wait
-      vTaskDelay(pdMS_TO_TICKS(1));
+      ESP_LOGE(TAG, "Failed to start V4-link service");
+      vm_destroy(vm);
+      return;
     }
+
+    // Link and service live on this stack frame; park the main task
+    vTaskSuspend(nullptr);
   }
   catch (const std::exception& e)
   {
@@ -0,0 +1,78 @@
+/**
+ * @file main.cpp
+ * @brief Several V4 VMs sharing one ESP32-C6 task
+ *
+ * Runs the demo programs (see multi_vm.hpp) under a VmScheduler and
+ * prints per-VM CPU share and scheduling latency every 5 seconds.
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include <stdio.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "multi_vm.hpp"
+#include "v4/hal.h"
+
+static const char* TAG = "v4-multi-vm";
+
+// Memory of each VM
+static constexpr size_t VM_MEM_SIZE = 4096;
+
+// Memory pool for all VMs
+static uint8_t vm_pool[v4ports::VM_SCHED_MAX * VM_MEM_SIZE];
+
+// Statistics report interval
+static constexpr uint64_t REPORT_US = 5ULL * 1000 * 1000;
+
+static uint64_t clock_us()
+{
+  return static_cast<uint64_t>(esp_timer_get_time());
+}
+
+extern "C" void app_main()
+{
+  // Pins pulsed by the sensor and control programs
+  if (hal_gpio_mode(7, HAL_GPIO_OUTPUT) != 0 || hal_gpio_mode(8, HAL_GPIO_OUTPUT) != 0)
+  {
+    ESP_LOGE(TAG, "Failed to initialize GPIO7/GPIO8");
+    return;
+  }
+
+  v4ports::VmScheduler sched(vm_pool, sizeof(vm_pool), VM_MEM_SIZE, clock_us);
+  size_t count;
+  const v4ports::VmTaskConfig* tasks = v4ports::multi_vm_tasks(count);
+  for (size_t i = 0; i < count; i++)
+  {
+    int id = sched.add(tasks[i]);
+    if (id < 0)
+    {
+      ESP_LOGE(TAG, "Failed to add VM %s: %d", tasks[i].name, id);
+      return;
+    }
+  }
+  ESP_LOGI(TAG, "%u VMs running", static_cast<unsigned>(count));
+
+  while (true)
+  {
+    uint64_t due = sched.run_once();
+    uint64_t now = clock_us();
+
+    if (sched.elapsed_us() >= REPORT_US)
+    {
+      v4ports::multi_vm_print(sched);
+      sched.reset_stats();
+    }
+
+    // Sleep until the next VM is due (whole ticks only)
+    if (due > now + 1000)
+    {
+      uint64_t wait_ms = (due == UINT64_MAX) ? 1000 : (due - now) / 1000;
+      vTaskDelay(pdMS_TO_TICKS(wait_ms));
+    }
+  }
+}
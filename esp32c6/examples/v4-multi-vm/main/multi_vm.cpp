@@ -0,0 +1,108 @@
+/**
+ * @file multi_vm.cpp
+ * @brief Demo programs and report for the multi-VM scheduler
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include "multi_vm.hpp"
+
+#include <cstdio>
+
+namespace v4ports
+{
+
+namespace
+{
+
+// SLEEP port address as LIT operand (little-endian)
+#define SLEEP_PORT_LIT                                                     \
+  0x00, VM_SCHED_SLEEP & 0xFF, (VM_SCHED_SLEEP >> 8) & 0xFF,               \
+      (VM_SCHED_SLEEP >> 16) & 0xFF, VM_SCHED_SLEEP >> 24
+
+// 7 1 GPIO_WRITE  7 0 GPIO_WRITE  10 SLEEP !
+const uint8_t SENSOR_STEP[] = {
+    0x76, 7, 0x74, 0x60, 0x01,  // LIT_U8 7, LIT1, SYS GPIO_WRITE
+    0x76, 7, 0x73, 0x60, 0x01,  // LIT_U8 7, LIT0, SYS GPIO_WRITE
+    0x76, 10, SLEEP_PORT_LIT,   // LIT_U8 10, LIT SLEEP
+    0x31,                       // STORE
+    0x51,                       // RET
+};
+
+// 8 1 GPIO_WRITE  8 0 GPIO_WRITE  5 SLEEP !
+const uint8_t CONTROL_STEP[] = {
+    0x76, 8, 0x74, 0x60, 0x01,  // LIT_U8 8, LIT1, SYS GPIO_WRITE
+    0x76, 8, 0x73, 0x60, 0x01,  // LIT_U8 8, LIT0, SYS GPIO_WRITE
+    0x76, 5, SLEEP_PORT_LIT,    // LIT_U8 5, LIT SLEEP
+    0x31,                       // STORE
+    0x51,                       // RET
+};
+
+#undef SLEEP_PORT_LIT
+
+// 0 followed by BUSY_PAIRS x (DUP DROP), then DROP
+constexpr size_t BUSY_PAIRS = 256;
+uint8_t busy_step[1 + 2 * BUSY_PAIRS + 2];
+
+const uint8_t* build_busy_step()
+{
+  size_t n = 0;
+  busy_step[n++] = 0x73;  // LIT0
+  for (size_t i = 0; i < BUSY_PAIRS; i++)
+  {
+    busy_step[n++] = 0x01;  // DUP
+    busy_step[n++] = 0x02;  // DROP
+  }
+  busy_step[n++] = 0x02;  // DROP
+  busy_step[n++] = 0x51;  // RET
+  return busy_step;
+}
+
+const char* state_name(VmTaskState state)
+{
+  switch (state)
+  {
+    case VmTaskState::READY:
+      return "ready";
+    case VmTaskState::SLEEPING:
+      return "sleeping";
+    default:
+      return "faulted";
+  }
+}
+
+}  // namespace
+
+const VmTaskConfig* multi_vm_tasks(size_t& count)
+{
+  static const VmTaskConfig tasks[] = {
+      {"sensor", SENSOR_STEP, sizeof(SENSOR_STEP), nullptr, 0, 1000, 0},
+      {"control", CONTROL_STEP, sizeof(CONTROL_STEP), nullptr, 0, 1000, 0},
+      {"busy", build_busy_step(), sizeof(busy_step), nullptr, 0, 2000, 0},
+  };
+  count = sizeof(tasks) / sizeof(tasks[0]);
+  return tasks;
+}
+
+void multi_vm_print(const VmScheduler& sched)
+{
+  uint64_t elapsed = sched.elapsed_us();
+  printf("vm,state,steps,slices,sleeps,overruns,cpu_pct,lat_avg_us,lat_max_us\n");
+  for (size_t i = 0; i < sched.count(); i++)
+  {
+    VmTaskStats s = sched.stats(static_cast<int>(i));
+    double cpu = (elapsed > 0) ? 100.0 * static_cast<double>(s.cpu_us) / elapsed : 0.0;
+    double lat = (s.slices > 0) ? static_cast<double>(s.latency_sum_us) / s.slices : 0.0;
+    printf("%s,%s,%lu,%lu,%lu,%lu,%.1f,%.1f,%lu\n", s.name, state_name(s.state),
+           static_cast<unsigned long>(s.steps), static_cast<unsigned long>(s.slices),
+           static_cast<unsigned long>(s.sleeps), static_cast<unsigned long>(s.overruns),
+           cpu, lat, static_cast<unsigned long>(s.latency_max_us));
+    if (s.state == VmTaskState::FAULTED)
+    {
+      printf("  %s faulted with error %d\n", s.name, s.last_error);
+    }
+  }
+}
+
+}  // namespace v4ports
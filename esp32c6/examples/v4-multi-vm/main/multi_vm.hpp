@@ -0,0 +1,38 @@
+/**
+ * @file multi_vm.hpp
+ * @brief Demo programs and report for the multi-VM scheduler
+ *
+ * Three programs share the CPU:
+ * - sensor:  pulses GPIO7, then sleeps 10 ms
+ * - control: pulses GPIO8, then sleeps 5 ms
+ * - busy:    never sleeps; stands in for a compute-bound program
+ *
+ * Portable (no ESP-IDF dependencies): the Linux host build and the
+ * v4-multi-vm example share it and only provide the clock.
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include "v4_sched.hpp"
+
+namespace v4ports
+{
+
+/**
+ * @brief Get the demo programs
+ */
+const VmTaskConfig* multi_vm_tasks(size_t& count);
+
+/**
+ * @brief Print per-VM statistics as CSV
+ *
+ * Columns: vm,state,steps,slices,sleeps,overruns,cpu_pct,lat_avg_us,lat_max_us
+ */
+void multi_vm_print(const VmScheduler& sched);
+
+}  // namespace v4ports
@@ -7,16 +7,27 @@
  */
 
 #include <fcntl.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "driver/usb_serial_jtag.h"
 #include "driver/usb_serial_jtag_vfs.h"
+#include "esp_timer.h"
 #include "esp_vfs_dev.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "nvs_flash.h"
 #include "v4/hal.h"
 #include "v4/vm_api.h"
+#include "v4_repl_compiler.h"
+#include "v4_repl_dict.h"
+#include "v4_repl_input.h"
+#include "v4_repl_native.h"
+#include "v4_repl_peephole.h"
+#include "v4_repl_scratch.h"
+#include "v4_repl_snapshot.h"
 #include "v4front/compile.h"
 
 // VM configuration
@@ -24,13 +35,47 @@
 
 // REPL configuration
 #define REPL_PROMPT "v4> "
-#define MAX_LINE_LENGTH 256
+#define CONT_PROMPT "... "
+#define INPUT_UNIT_SIZE 2048  // Longest definition or multi-line unit
+#define INPUT_CHUNK 256       // Console bytes per read
+#define ECHO_SIZE 512
+#define SCRATCH_SIZE 1024  // Immediate code per line
+
+// Compiler instance: V4-front runs on an 8 KB stack in its own arena, so
+// the REPL task needs no compiler-sized stack
+#define COMPILER_STACK_SIZE (8 * 1024)
+#define COMPILER_OUTPUT_SIZE (2 * 1024)
+#define COMPILER_ARENA_SIZE (COMPILER_STACK_SIZE + COMPILER_OUTPUT_SIZE + 1024)
+
+// REPL dictionary: up to 192 words in 4 KB (the V4-front context alone holds
+// 64 in 4.9 KB); each line is compiled against just the words it uses
+#define DICT_SLOTS 256
+#define DICT_NAMES_SIZE (2 * 1024)
+
+// Dictionary snapshot configuration (stored as an NVS blob)
+#define SNAPSHOT_CAPACITY (4 * 1024)
+#define SNAPSHOT_NAMESPACE "v4repl"
+#define SNAPSHOT_KEY "dict"
 
 // LED configuration
 #define LED_GPIO 7  // GPIO7 for LED
 
 static uint8_t arena_buf[ARENA_SIZE];
-static int led_state = 0;  // Track LED state for toggle
+static uint8_t scratch_buf[SCRATCH_SIZE];
+static V4NativeTable natives;
+static V4DictSlot dict_slots[DICT_SLOTS];
+static char dict_names[DICT_NAMES_SIZE];
+static V4Dict dict;
+static uint8_t compiler_arena[COMPILER_ARENA_SIZE] __attribute__((aligned(16)));
+static V4Compiler *compiler;
+static char input_buf[INPUT_UNIT_SIZE];
+static char echo_buf[ECHO_SIZE];
+static V4Input input;
+
+// Peephole optimizer state (#opt)
+static bool opt_enabled = true;
+static V4PeepholeStats opt_stats;
+static uint8_t opt_buf[SCRATCH_SIZE];
 
 /**
  * @brief Print welcome banner
@@ -44,7 +89,8 @@ static void print_banner(void)
   printf("Forth Interactive Shell\n");
   printf("Type Forth code and press Enter\n");
   printf("Arena: %d bytes\n", ARENA_SIZE);
-  printf("Stack: 16KB (optimized via v4_front)\n");
+  printf("Compiler: %d KB stack + %d KB output (arena)\n", COMPILER_STACK_SIZE / 1024,
+         COMPILER_OUTPUT_SIZE / 1024);
   printf("Console: USB Serial/JTAG\n");
   printf("System: ESP32-C6 with V4-hal\n");  // TODO: Add system_info to HAL API
   printf("LED: GPIO%d\n", LED_GPIO);
@@ -52,11 +98,11 @@ static void print_banner(void)
 }
 
 /**
- * @brief Set LED state - Native Forth word for "n led!" syntax
+ * @brief Set LED state - Native Forth word "led!"
  * Stack effect: ( n -- )
  * Takes 0 or non-zero value from stack
  */
-static int led_set_impl(struct Vm *vm)
+static v4_err led_set_impl(struct Vm *vm)
 {
   v4_i32 value;
   int err = vm_ds_pop(vm, &value);
@@ -71,35 +117,152 @@ static int led_set_impl(struct Vm *vm)
 }
 
 /**
- * @brief Process and execute Forth code line
+ * @brief Run the peephole optimizer over compiled code in place
+ * @return New code length (the original length if nothing changed)
  */
-static void process_line(struct Vm *vm, V4FrontContext *ctx, const char *line)
+static size_t optimize_code(uint8_t *code, size_t len)
 {
-  if (strlen(line) == 0)
+  if (!opt_enabled || len > sizeof(opt_buf))
   {
-    return;
+    return len;
   }
 
-  // Handle "n led!" pattern with special parsing
-  if (strstr(line, "led!") != NULL)
+  int n = v4_peephole_word(code, len, opt_buf, len, &opt_stats);
+  if (n <= 0)
   {
-    int value;
-    if (sscanf(line, "%d led!", &value) == 1)
+    return len;
+  }
+  memcpy(code, opt_buf, (size_t)n);
+  return (size_t)n;
+}
+
+/**
+ * @brief Print peephole optimizer counters
+ */
+static void print_opt_stats(void)
+{
+  printf("Optimizer %s: %lu/%lu words rewritten (%lu unsupported)\n",
+         opt_enabled ? "on" : "off", (unsigned long)opt_stats.optimized,
+         (unsigned long)opt_stats.words, (unsigned long)opt_stats.unsupported);
+  printf("  instructions %lu -> %lu, bytes %lu -> %lu, %lu folded, %lu removed\n",
+         (unsigned long)opt_stats.insns_before, (unsigned long)opt_stats.insns_after,
+         (unsigned long)opt_stats.bytes_before, (unsigned long)opt_stats.bytes_after,
+         (unsigned long)opt_stats.folded, (unsigned long)opt_stats.removed);
+}
+
+/**
+ * @brief Print compiler stack and arena usage
+ */
+static void print_mem_stats(void)
+{
+  const V4CompilerStats *st = v4_compiler_stats(compiler);
+  printf("Compiler: %lu compiles\n", (unsigned long)st->compiles);
+  printf("  stack  last %lu, peak %lu of %lu bytes\n", (unsigned long)st->stack_used,
+         (unsigned long)st->stack_peak, (unsigned long)st->stack_size);
+  printf("  output last %lu, peak %lu of %lu bytes\n", (unsigned long)st->output_used,
+         (unsigned long)st->output_peak, (unsigned long)st->output_size);
+  printf("Dictionary: %lu words, %lu/%lu name bytes\n", (unsigned long)dict.count,
+         (unsigned long)dict.names_used, (unsigned long)dict.names_size);
+  printf("Input: %lu bytes, %lu lines, %lu units\n", (unsigned long)input.bytes,
+         (unsigned long)input.lines, (unsigned long)input.units);
+}
+
+/**
+ * @brief Handle snapshot, optimizer and memory meta-commands
+ * @return true if the line was a meta-command
+ */
+static bool process_meta(V4Snapshot *snap, const char *line)
+{
+  if (strcmp(line, "#save") == 0)
+  {
+    int err = v4_snapshot_save_nvs(snap, SNAPSHOT_NAMESPACE, SNAPSHOT_KEY);
+    if (err == V4_SNAPSHOT_ERR_FULL)
     {
-      v4_i32 val = (v4_i32)value;
-      vm_ds_push(vm, val);
-      led_set_impl(vm);
-      printf("ok\n");
-      return;
+      printf("ERROR: Snapshot full (%d bytes), not saved\n", SNAPSHOT_CAPACITY);
     }
+    else if (err != V4_SNAPSHOT_OK)
+    {
+      printf("ERROR: Failed to save snapshot (code %d)\n", err);
+    }
+    else
+    {
+      size_t len;
+      v4_snapshot_image(snap, &len);
+      printf("Saved %d words (%u bytes)\n", v4_snapshot_count(snap), (unsigned)len);
+    }
+    return true;
   }
 
-  // Compile Forth source with new API
-  V4FrontBuf buf = {0};
+  if (strcmp(line, "#wipe") == 0)
+  {
+    int err = v4_snapshot_erase_nvs(SNAPSHOT_NAMESPACE, SNAPSHOT_KEY);
+    if (err != V4_SNAPSHOT_OK)
+    {
+      printf("ERROR: Failed to erase snapshot (code %d)\n", err);
+    }
+    else
+    {
+      printf("Snapshot erased (words stay defined until reboot)\n");
+    }
+    return true;
+  }
+
+  if (strcmp(line, "#mem") == 0)
+  {
+    print_mem_stats();
+    return true;
+  }
+
+  if (strncmp(line, "#opt", 4) == 0 && (line[4] == '\0' || line[4] == ' '))
+  {
+    const char *arg = line + 4;
+    while (*arg == ' ')
+    {
+      arg++;
+    }
+    if (strcmp(arg, "on") == 0)
+    {
+      opt_enabled = true;
+    }
+    else if (strcmp(arg, "off") == 0)
+    {
+      opt_enabled = false;
+    }
+    else if (*arg != '\0')
+    {
+      printf("Usage: #opt [on|off]\n");
+      return true;
+    }
+    print_opt_stats();
+    return true;
+  }
+
+  return false;
+}
+
+/**
+ * @brief Process and execute a unit of Forth code (one or more lines)
+ */
+static void process_line(struct Vm *vm, V4Scratch *scratch, V4Snapshot *snap,
+                         const char *line)
+{
+  if (strlen(line) == 0)
+  {
+    return;
+  }
+
+  if (process_meta(snap, line))
+  {
+    return;
+  }
+
+  // Compile on the compiler's own stack, against a fresh context that knows
+  // just the words the line uses; the result lives in the compiler arena
+  V4FrontBuf buf;
   V4FrontError error = {0};
-  v4front_err err = v4front_compile_with_context_ex(ctx, line, &buf, &error);
+  int err = v4_compiler_compile(compiler, &dict, line, &buf, &error);
 
-  if (err != 0)
+  if (err == V4_COMPILER_ERR_COMPILE)
   {
     // Compilation error - format with position information
     char error_buf[512];
@@ -107,40 +270,46 @@ static void process_line(struct Vm *vm, V4FrontContext *ctx, const char *line)
     printf("%s", error_buf);  // error_buf already contains newlines
     return;
   }
+  if (err == V4_COMPILER_ERR_CONTEXT)
+  {
+    printf("ERROR: Line refers to too many words, split it\n");
+    return;
+  }
+  if (err != 0)
+  {
+    printf("ERROR: Compiled code exceeds %d bytes\n", COMPILER_OUTPUT_SIZE);
+    return;
+  }
 
-  // Register compiled words to VM and compiler context
+  // Register compiled words to VM and dictionary, journaling them in the
+  // snapshot so #save can persist them
   for (int i = 0; i < buf.word_count; i++)
   {
     V4FrontWord *word = &buf.words[i];
 
-    // Register to VM
-    int wid = vm_register_word(vm, word->name, word->code, (int)word->code_len);
+    size_t code_len = optimize_code(word->code, word->code_len);
+    int wid = v4_snapshot_register_word(snap, vm, &dict, word->name, word->code,
+                                        (int)code_len);
     if (wid < 0)
     {
       printf("ERROR: Failed to register word '%s' (code %d)\n", word->name, wid);
-      v4front_free(&buf);
-      return;
-    }
-
-    // Register to compiler context so it can be used in subsequent compilations
-    v4front_err ctx_err = v4front_context_register_word(ctx, word->name, wid);
-    if (ctx_err != 0)
-    {
-      printf("ERROR: Failed to register word '%s' to compiler (code %ld)\n", word->name,
-             (long)ctx_err);
-      v4front_free(&buf);
       return;
     }
   }
 
-  // Execute immediate code if any
+  // Execute immediate code if any, in the scratch word so no dictionary
+  // slot is used per line
   if (buf.data && buf.size > 0)
   {
-    int wid = vm_register_word(vm, NULL, buf.data, (int)buf.size);
-    struct Word *entry = vm_get_word(vm, wid);
-    v4_err vm_err = vm_exec(vm, entry);
+    size_t code_len = optimize_code(buf.data, buf.size);
+    v4_err vm_err = v4_scratch_exec(scratch, buf.data, code_len);
 
-    if (vm_err != 0)
+    if (vm_err == V4_SCRATCH_ERR_TOO_LARGE)
+    {
+      printf("ERROR: Line too long (%u bytes of code, max %d)\n", (unsigned)buf.size,
+             SCRATCH_SIZE - 1);
+    }
+    else if (vm_err != 0)
     {
       printf("ERROR: VM execution failed (code %d)\n", vm_err);
     }
@@ -164,62 +333,19 @@ static void process_line(struct Vm *vm, V4FrontContext *ctx, const char *line)
   {
     printf("ok\n");
   }
-
-  v4front_free(&buf);
 }
 
 /**
- * @brief Read a line from stdin with simple echo
+ * @brief Write the echo collected by the last feed in one go
  */
-static int read_line(char *buffer, size_t max_len)
+static void write_echo(V4Input *in)
 {
-  size_t pos = 0;
-
-  while (pos < max_len - 1)
+  if (in->echo_len > 0)
   {
-    int c = getchar();
-
-    if (c == EOF || c < 0)
-    {
-      vTaskDelay(pdMS_TO_TICKS(10));
-      continue;
-    }
-
-    // Handle backspace
-    if (c == '\b' || c == 127)
-    {
-      if (pos > 0)
-      {
-        pos--;
-        printf("\b \b");  // Erase character on screen
-        fflush(stdout);
-      }
-      continue;
-    }
-
-    // Handle carriage return or newline
-    if (c == '\r' || c == '\n')
-    {
-      buffer[pos] = '\0';
-      printf("\n");
-      fflush(stdout);
-      return pos;
-    }
-
-    // Ignore control characters (except handled above)
-    if (c < 32)
-    {
-      continue;
-    }
-
-    // Echo and store character
-    buffer[pos++] = (char)c;
-    putchar(c);
+    fwrite(in->echo, 1, in->echo_len, stdout);
     fflush(stdout);
+    in->echo_len = 0;
   }
-
-  buffer[pos] = '\0';
-  return pos;
 }
 
 /**
@@ -227,6 +353,14 @@ static int read_line(char *buffer, size_t max_len)
  */
 void app_main(void)
 {
+  // Initialize NVS for dictionary snapshots
+  esp_err_t nvs_err = nvs_flash_init();
+  if (nvs_err == ESP_ERR_NVS_NO_FREE_PAGES || nvs_err == ESP_ERR_NVS_NEW_VERSION_FOUND)
+  {
+    nvs_flash_erase();
+    nvs_err = nvs_flash_init();
+  }
+
   // Configure USB Serial/JTAG for non-blocking REPL
   // Based on: https://www.esp32.com/viewtopic.php?t=27944
 
@@ -263,12 +397,14 @@ void app_main(void)
 
   print_banner();
 
-  // Create VM with arena allocator
+  // Create VM with arena allocator; the native word call port is its only
+  // MMIO window
+  v4_native_init(&natives);
   VmConfig config = {
       .mem = arena_buf,
       .mem_size = ARENA_SIZE,
-      .mmio = NULL,
-      .mmio_count = 0,
+      .mmio = v4_native_mmio(&natives),
+      .mmio_count = 1,
       .arena = NULL,
   };
 
@@ -293,18 +429,17 @@ void app_main(void)
     printf("LED GPIO%d initialized\n", LED_GPIO);
   }
 
-  // Register LED control native words
-  // TODO: Need to find correct API for registering native functions
-  // For now, document the available words
-
-  // Create V4-front compiler context
-  V4FrontContext *ctx = v4front_context_create();
-  if (!ctx)
+  compiler = v4_compiler_create(compiler_arena, sizeof(compiler_arena),
+                                COMPILER_STACK_SIZE);
+  if (!compiler)
   {
-    printf("ERROR: Failed to create compiler context\n");
+    printf("ERROR: Failed to create compiler\n");
     return;
   }
-  printf("Compiler context created\n");
+
+  // Dictionary of all words known to the compiler
+  v4_dict_init(&dict, dict_slots, DICT_SLOTS, dict_names, sizeof(dict_names));
+  printf("Dictionary created (%d words max)\n", DICT_SLOTS * 3 / 4);
 
   // Register LED control functions as V4 words using SYS instructions and memory
   // Use standard GPIO SYS calls (0x01=WRITE) and store state in VM memory at address 0
@@ -351,22 +486,82 @@ void app_main(void)
       0x51             // RET
   };
 
-  int wid_on = vm_register_word(vm, "led-on", led_on_code, sizeof(led_on_code));
-  int wid_off = vm_register_word(vm, "led-off", led_off_code, sizeof(led_off_code));
+  // The hand-written words go through the same optimizer as compiled ones
+  size_t led_on_len = optimize_code(led_on_code, sizeof(led_on_code));
+  size_t led_off_len = optimize_code(led_off_code, sizeof(led_off_code));
+  size_t led_toggle_len = optimize_code(led_toggle_code, sizeof(led_toggle_code));
+
+  int wid_on = vm_register_word(vm, "led-on", led_on_code, (int)led_on_len);
+  int wid_off = vm_register_word(vm, "led-off", led_off_code, (int)led_off_len);
   int wid_toggle =
-      vm_register_word(vm, "led-toggle", led_toggle_code, sizeof(led_toggle_code));
+      vm_register_word(vm, "led-toggle", led_toggle_code, (int)led_toggle_len);
 
   if (wid_on >= 0 && wid_off >= 0 && wid_toggle >= 0)
   {
-    // Register to compiler context so they can be used in definitions
-    v4front_context_register_word(ctx, "led-on", wid_on);
-    v4front_context_register_word(ctx, "led-off", wid_off);
-    v4front_context_register_word(ctx, "led-toggle", wid_toggle);
-    printf("LED control words registered\n\n");
+    // Define in the dictionary so they can be used in definitions
+    v4_dict_define(&dict, "led-on", wid_on);
+    v4_dict_define(&dict, "led-off", wid_off);
+    v4_dict_define(&dict, "led-toggle", wid_toggle);
+    printf("LED control words registered\n");
   }
   else
   {
-    printf("WARNING: Failed to register LED words\n\n");
+    printf("WARNING: Failed to register LED words\n");
+  }
+
+  // Native C words
+  int wid_led_set = v4_native_register(&natives, vm, "led!", led_set_impl);
+  if (wid_led_set >= 0)
+  {
+    v4_dict_define(&dict, "led!", wid_led_set);
+  }
+  else
+  {
+    printf("WARNING: Failed to register native word led! (code %d)\n", wid_led_set);
+  }
+
+  // Scratch word for immediate code, registered once
+  V4Scratch scratch;
+  int wid_scratch = v4_scratch_init(&scratch, vm, scratch_buf, sizeof(scratch_buf));
+  if (wid_scratch < 0)
+  {
+    printf("ERROR: Failed to register scratch word (code %d)\n", wid_scratch);
+    return;
+  }
+
+  // User words start right after the built-ins; restore the saved ones
+  V4Snapshot *snap = v4_snapshot_create(SNAPSHOT_CAPACITY, wid_scratch + 1);
+  if (!snap)
+  {
+    printf("ERROR: Failed to create snapshot\n");
+    return;
+  }
+
+  if (nvs_err != ESP_OK)
+  {
+    printf("WARNING: NVS unavailable, #save disabled\n\n");
+  }
+  else
+  {
+    int64_t t0 = esp_timer_get_time();
+    int restored =
+        v4_snapshot_load_nvs(snap, vm, &dict, SNAPSHOT_NAMESPACE, SNAPSHOT_KEY);
+    int64_t t1 = esp_timer_get_time();
+
+    if (restored >= 0)
+    {
+      printf("Restored %d words from snapshot in %ld.%03ld ms\n\n", restored,
+             (long)((t1 - t0) / 1000), (long)((t1 - t0) % 1000));
+    }
+    else if (restored == V4_SNAPSHOT_ERR_NOT_FOUND)
+    {
+      printf("No saved snapshot\n\n");
+    }
+    else
+    {
+      // A partial restore leaves stray words; a reboot after #wipe is clean
+      printf("WARNING: Snapshot not restored (code %d), use #wipe\n\n", restored);
+    }
   }
 
   printf("Available LED commands:\n");
@@ -376,31 +571,68 @@ void app_main(void)
   printf("  n led!     - Set LED (0=off, non-zero=on)\n");
   printf("\nYou can now use these in word definitions and control structures:\n");
   printf("  : blink led-on led-off ;\n");
-  printf("  1 if led-on then\n\n");
-
-  // Main REPL loop
-  char line[MAX_LINE_LENGTH];
+  printf("  1 if led-on then\n");
+  printf("  : flash 1 led! 0 led! ;\n");
+  printf("\nSnapshot commands:\n");
+  printf("  #save      - Save user words to flash (restored at boot)\n");
+  printf("  #wipe      - Erase the saved words\n");
+  printf("  #opt [on|off] - Peephole optimizer switch and counters\n");
+  printf("  #mem       - Compiler stack/arena and dictionary usage\n");
+  printf("\nDefinitions may span lines (prompt %s) and scripts can be pasted;\n",
+         CONT_PROMPT);
+  printf("Ctrl-C drops an unfinished definition.\n\n");
+
+  // Main REPL loop: read whatever the console has, echo it in one write and
+  // run each complete unit; prompt only once the input has gone idle, so a
+  // pasted script runs without a prompt per line
+  v4_input_init(&input, input_buf, sizeof(input_buf), echo_buf, sizeof(echo_buf));
+  static char chunk[INPUT_CHUNK];
+  size_t chunk_len = 0;
+  size_t chunk_pos = 0;
+  bool prompt = true;
   while (1)
   {
-    // Print prompt
-    printf("%s", REPL_PROMPT);
-    fflush(stdout);
+    if (chunk_pos == chunk_len)
+    {
+      int n = read(fileno(stdin), chunk, sizeof(chunk));
+      if (n <= 0)
+      {
+        if (prompt)
+        {
+          printf("%s", v4_input_open(&input) ? CONT_PROMPT : REPL_PROMPT);
+          fflush(stdout);
+          prompt = false;
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+        continue;
+      }
+      chunk_len = (size_t)n;
+      chunk_pos = 0;
+    }
 
-    // Read line
-    int len = read_line(line, MAX_LINE_LENGTH);
+    uint32_t lines = input.lines;
+    size_t used;
+    int status = v4_input_feed(&input, chunk + chunk_pos, chunk_len - chunk_pos, &used);
+    chunk_pos += used;
+    write_echo(&input);
 
-    // Skip empty lines
-    if (len == 0)
+    if (status == V4_INPUT_UNIT)
     {
-      continue;
+      process_line(vm, &scratch, snap, input.buf);
+    }
+    else if (status == V4_INPUT_ERR_OVERFLOW)
+    {
+      printf("ERROR: Input exceeds %d bytes, dropped\n", INPUT_UNIT_SIZE - 1);
+    }
+    if (status != V4_INPUT_PENDING || input.lines != lines)
+    {
+      prompt = true;
     }
-
-    // Process the line
-    process_line(vm, ctx, line);
   }
 
   // Cleanup (unreachable in this implementation)
   printf("\nExiting V4 REPL\n");
-  v4front_context_destroy(ctx);
   vm_destroy(vm);
+  v4_compiler_destroy(compiler);
+  v4_snapshot_destroy(snap);
 }
@@ -0,0 +1,199 @@
+/**
+ * @file vm_bench.cpp
+ * @brief V4 VM interpreter benchmark kernels and runner
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include "vm_bench.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+#include "v4/hal.h"
+#include "v4/vm_api.h"
+#include "v4front/compile.h"
+
+namespace v4ports
+{
+
+namespace
+{
+
+// GPIO driven by the sys kernel
+constexpr int BENCH_GPIO = 7;
+
+// GPIO-HI: pin 1 SYS GPIO_WRITE, hand-assembled so the kernel exercises
+// the SYS path independently of compiler support for it
+const uint8_t GPIO_HI_CODE[] = {
+    0x76, BENCH_GPIO,  // LIT_U8 pin
+    0x74,              // LIT1
+    0x60, 0x01,        // SYS 0x01 (V4_SYS_GPIO_WRITE)
+    0x51               // RET
+};
+
+const VmBenchKernel KERNELS[] = {
+    {"fib", ": FIB DUP 1 > IF DUP 1 - RECURSE SWAP 2 - RECURSE + THEN ;", "20 FIB",
+     21891, true, 6765},
+    {"sieve",
+     ": FLAG 4 * 1024 + ; "
+     ": SIEVE 512 0 DO 1 I FLAG ! LOOP "
+     "0 512 2 DO I FLAG @ IF 1 + "
+     "I DUP * 512 < IF 512 I DUP * DO 0 I FLAG ! J +LOOP THEN "
+     "THEN LOOP ;",
+     "SIEVE", 510, true, 97},
+    {"arith", ": ARITH 0 10000 0 DO I + 3 * I XOR LOOP ;", "ARITH", 10000, true,
+     -20446128},
+    {"mem", ": MEM 0 1024 0 DO I I 4 * 8192 + ! I 4 * 8192 + @ + LOOP ;", "MEM", 1024,
+     true, 523776},
+    {"calls", ": INC 1 + ; : CALLS 0 10000 0 DO INC LOOP ;", "CALLS", 10000, true,
+     10000},
+    {"sys", ": SYSLOOP 1000 0 DO GPIO-HI LOOP ;", "SYSLOOP", 1000, false, 0},
+};
+
+// Compile @p source and register its words; buf keeps the code alive
+bool compile(Vm* vm, V4FrontContext* ctx, const char* source, V4FrontBuf& buf)
+{
+  V4FrontError error = {};
+  if (v4front_compile_with_context_ex(ctx, source, &buf, &error) != 0)
+  {
+    char msg[256];
+    v4front_format_error(&error, source, msg, sizeof(msg));
+    std::fprintf(stderr, "%s", msg);
+    return false;
+  }
+
+  for (int i = 0; i < buf.word_count; i++)
+  {
+    V4FrontWord* word = &buf.words[i];
+    int wid =
+        vm_register_word(vm, word->name, word->code, static_cast<int>(word->code_len));
+    if (wid < 0 || v4front_context_register_word(ctx, word->name, wid) != 0)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+const VmBenchKernel* vm_bench_kernels(size_t& count)
+{
+  count = sizeof(KERNELS) / sizeof(KERNELS[0]);
+  return KERNELS;
+}
+
+VmBench::VmBench(uint8_t* mem, size_t mem_size, Clock now_ns)
+    : mem_(mem), mem_size_(mem_size), now_ns_(now_ns)
+{
+  hal_gpio_mode(BENCH_GPIO, HAL_GPIO_OUTPUT);
+}
+
+VmBenchResult VmBench::run(const VmBenchKernel& kernel, uint64_t min_ns)
+{
+  VmBenchResult result = {kernel.name, 0, kernel.ops, 0, false};
+
+  std::memset(mem_, 0, mem_size_);
+  VmConfig cfg = {
+      .mem = mem_,
+      .mem_size = static_cast<uint32_t>(mem_size_),
+      .mmio = nullptr,
+      .mmio_count = 0,
+      .arena = nullptr,
+  };
+  Vm* vm = vm_create(&cfg);
+  V4FrontContext* ctx = v4front_context_create();
+  V4FrontBuf setup = {};
+  V4FrontBuf code = {};
+  int wid = -1;
+
+  if (vm != nullptr && ctx != nullptr)
+  {
+    int wid_gpio =
+        vm_register_word(vm, "GPIO-HI", GPIO_HI_CODE, sizeof(GPIO_HI_CODE));
+    if (wid_gpio >= 0)
+    {
+      v4front_context_register_word(ctx, "GPIO-HI", wid_gpio);
+    }
+
+    if (compile(vm, ctx, kernel.setup, setup) && compile(vm, ctx, kernel.run, code) &&
+        code.data != nullptr && code.size > 0)
+    {
+      wid = vm_register_word(vm, nullptr, code.data, static_cast<int>(code.size));
+    }
+  }
+
+  if (wid >= 0)
+  {
+    // One checked run, then batches doubling in size until min_ns has passed
+    Word* entry = vm_get_word(vm, wid);
+    v4_i32 top = 0;
+    bool ok = vm_exec(vm, entry) == 0;
+    if (ok && kernel.check)
+    {
+      ok = vm_ds_pop(vm, &top) == 0 && top == kernel.expected;
+      if (!ok)
+      {
+        std::fprintf(stderr, "%s: expected %ld, got %ld\n", kernel.name,
+                     static_cast<long>(kernel.expected), static_cast<long>(top));
+      }
+    }
+
+    uint32_t batch = 1;
+    while (ok && result.total_ns < min_ns)
+    {
+      uint64_t t0 = now_ns_();
+      for (uint32_t i = 0; ok && i < batch; i++)
+      {
+        ok = vm_exec(vm, entry) == 0;
+        if (kernel.check)
+        {
+          vm_ds_pop(vm, &top);
+        }
+      }
+      result.total_ns += now_ns_() - t0;
+      result.runs += batch;
+      batch *= 2;
+    }
+    result.ok = ok;
+  }
+
+  // The VM runs registered code in place: free the code after the VM
+  if (ctx != nullptr)
+  {
+    v4front_context_destroy(ctx);
+  }
+  if (vm != nullptr)
+  {
+    vm_destroy(vm);
+  }
+  v4front_free(&code);
+  v4front_free(&setup);
+  return result;
+}
+
+void VmBench::print_header()
+{
+  std::printf("kernel,runs,ops_per_run,ns_per_run,ns_per_op,ops_per_s,status\n");
+}
+
+void VmBench::print(const VmBenchResult& result)
+{
+  if (!result.ok || result.runs == 0)
+  {
+    std::printf("%s,0,%lu,0,0,0,FAIL\n", result.name,
+                static_cast<unsigned long>(result.ops_per_run));
+    return;
+  }
+
+  double ns_per_run = static_cast<double>(result.total_ns) / result.runs;
+  double ns_per_op = ns_per_run / result.ops_per_run;
+  std::printf("%s,%lu,%lu,%.1f,%.2f,%.0f,ok\n", result.name,
+              static_cast<unsigned long>(result.runs),
+              static_cast<unsigned long>(result.ops_per_run), ns_per_run, ns_per_op,
+              1e9 / ns_per_op);
+}
+
+}  // namespace v4ports
@@ -0,0 +1,101 @@
+/**
+ * @file vm_bench.hpp
+ * @brief V4 VM interpreter benchmark kernels and runner
+ *
+ * Kernels are Forth source compiled with V4-front and executed with
+ * vm_exec(), so the suite measures the interpreter as applications use it.
+ * Each kernel runs in a fresh VM, is repeated until a minimum measuring
+ * time has passed, and its result is checked against the expected value.
+ *
+ * Portable (no ESP-IDF dependencies): the Linux host build and the
+ * v4-vm-bench example share it and only provide the clock.
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace v4ports
+{
+
+/**
+ * @brief Benchmark kernel
+ */
+struct VmBenchKernel
+{
+  const char* name;
+  const char* setup;   ///< Definitions, compiled once
+  const char* run;     ///< Immediate code executed per run
+  uint32_t ops;        ///< Operations per run (loop iterations, calls, ...)
+  bool check;          ///< Whether run leaves @ref expected on the stack
+  int32_t expected;
+};
+
+/**
+ * @brief Benchmark result
+ */
+struct VmBenchResult
+{
+  const char* name;
+  uint32_t runs;
+  uint32_t ops_per_run;
+  uint64_t total_ns;
+  bool ok;  ///< Compiled, executed and produced the expected result
+};
+
+/**
+ * @brief Get the standard kernels
+ *
+ * fib (recursive calls), sieve, arith (tight arithmetic loop), mem
+ * (LOAD/STORE loop), calls (word calls) and sys (SYS calls).
+ */
+const VmBenchKernel* vm_bench_kernels(size_t& count);
+
+/**
+ * @brief Kernel runner
+ */
+class VmBench
+{
+ public:
+  /// Monotonic clock in nanoseconds
+  using Clock = uint64_t (*)();
+
+  /**
+   * @param mem       VM memory (at least 16 KB for the standard kernels)
+   * @param mem_size  VM memory size in bytes
+   * @param now_ns    Clock
+   */
+  VmBench(uint8_t* mem, size_t mem_size, Clock now_ns);
+
+  /**
+   * @brief Run one kernel
+   *
+   * @param kernel  Kernel
+   * @param min_ns  Minimum measuring time
+   * @return Result (ok == false on compile, VM or result errors)
+   */
+  VmBenchResult run(const VmBenchKernel& kernel, uint64_t min_ns);
+
+  /**
+   * @brief Print the CSV header
+   */
+  static void print_header();
+
+  /**
+   * @brief Print one result as CSV
+   *
+   * Columns: kernel,runs,ops_per_run,ns_per_run,ns_per_op,ops_per_s,status
+   */
+  static void print(const VmBenchResult& result);
+
+ private:
+  uint8_t* mem_;
+  size_t mem_size_;
+  Clock now_ns_;
+};
+
+}  // namespace v4ports
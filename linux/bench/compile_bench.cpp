@@ -0,0 +1,351 @@
+/**
+ * @file compile_bench.cpp
+ * @brief Compile throughput with the hashed REPL dictionary and compiler instance
+ *
+ * Compiles a generated source of N definitions line by line, as the REPL
+ * does, each word calling two earlier ones:
+ * - shared context: one V4-front context that every new word is registered
+ *   in (the REPL before the dictionary); stops when the context is full
+ * - dictionary: all words in a V4Dict, each line compiled against a fresh
+ *   context holding only the words it refers to (v4_dict_bind())
+ * - compiler instance: as dictionary, through a V4Compiler running V4-front
+ *   on its arena stack; reports the stack and output peak of a compile
+ * Lines compiled every way must produce the same bytecode. Also reports
+ * lookup cost against a linear name table, and dictionary memory.
+ *
+ * Usage: compile_bench [words]
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include <strings.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "v4_repl_compiler.h"
+#include "v4_repl_dict.h"
+#include "v4front/compile.h"
+
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+
+constexpr int MAX_WORDS = 60000;
+constexpr int LOOKUP_RUNS = 200000;
+constexpr size_t NAME_BYTES = 8;  // "w59999" + length byte + NUL
+constexpr size_t COMPILER_STACK_SIZE = 32 * 1024;
+constexpr size_t COMPILER_ARENA_SIZE = 64 * 1024;
+
+volatile long sink;
+
+struct Line
+{
+  std::string name;
+  std::string source;
+};
+
+double seconds_since(Clock::time_point t0)
+{
+  return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+std::string word_name(int i)
+{
+  return "w" + std::to_string(i);
+}
+
+// Smallest power of two that holds @p words at the 3/4 load limit
+size_t slots_for(int words)
+{
+  size_t slots = 4;
+  while (slots * 3 < static_cast<size_t>(words) * 4 + 4)
+  {
+    slots *= 2;
+  }
+  return slots;
+}
+
+// Definitions that call two earlier words; every 16th line also runs one
+std::vector<Line> build_source(int words)
+{
+  std::vector<Line> lines;
+  for (int i = 0; i < words; i++)
+  {
+    std::string name = word_name(i);
+    std::string body = (i < 2) ? std::to_string(i + 1)
+                               : word_name(i - 1) + " " + word_name((i * 7) % i) + " +";
+    std::string source = ": " + name + " " + body + " ;";
+    if (i % 16 == 15)
+    {
+      source += " " + name + " drop";
+    }
+    lines.push_back({name, source});
+  }
+  return lines;
+}
+
+uint64_t fnv1a(const uint8_t* data, size_t len)
+{
+  uint64_t h = 0xCBF29CE484222325ull;
+  for (size_t i = 0; i < len; i++)
+  {
+    h = (h ^ data[i]) * 0x100000001B3ull;
+  }
+  return h;
+}
+
+// Hash of the line's definition, 0 if it did not compile to one word
+uint64_t compile_line(V4FrontContext* ctx, const Line& line)
+{
+  V4FrontBuf buf = {};
+  V4FrontError error = {};
+  if (v4front_compile_with_context_ex(ctx, line.source.c_str(), &buf, &error) != 0)
+  {
+    return 0;
+  }
+  uint64_t h = 0;
+  if (buf.word_count == 1)
+  {
+    h = fnv1a(buf.words[0].code, buf.words[0].code_len);
+  }
+  v4front_free(&buf);
+  return h;
+}
+
+// One context holding every word; returns lines compiled
+size_t run_shared(const std::vector<Line>& lines, std::vector<uint64_t>& hashes,
+                  double& elapsed)
+{
+  V4FrontContext* ctx = v4front_context_create();
+  auto t0 = Clock::now();
+  size_t done = 0;
+  for (const Line& line : lines)
+  {
+    uint64_t h = compile_line(ctx, line);
+    if (h == 0 || v4front_context_register_word(ctx, line.name.c_str(),
+                                                static_cast<int>(done)) != 0)
+    {
+      break;
+    }
+    hashes.push_back(h);
+    done++;
+  }
+  elapsed = seconds_since(t0);
+  v4front_context_destroy(ctx);
+  return done;
+}
+
+// Fresh context per line, words resolved through the dictionary
+size_t run_dict(V4Dict* dict, const std::vector<Line>& lines,
+                std::vector<uint64_t>& hashes, double& elapsed)
+{
+  auto t0 = Clock::now();
+  size_t done = 0;
+  for (const Line& line : lines)
+  {
+    V4FrontContext* ctx = v4front_context_create();
+    uint64_t h = 0;
+    if (v4_dict_bind(dict, ctx, line.source.c_str()) >= 0)
+    {
+      h = compile_line(ctx, line);
+    }
+    v4front_context_destroy(ctx);
+    if (h == 0 || v4_dict_define(dict, line.name.c_str(), static_cast<int>(done)) != 0)
+    {
+      break;
+    }
+    hashes.push_back(h);
+    done++;
+  }
+  elapsed = seconds_since(t0);
+  return done;
+}
+
+// Dictionary compile through a compiler instance
+size_t run_compiler(V4Compiler* compiler, V4Dict* dict, const std::vector<Line>& lines,
+                    std::vector<uint64_t>& hashes, double& elapsed)
+{
+  auto t0 = Clock::now();
+  size_t done = 0;
+  for (const Line& line : lines)
+  {
+    V4FrontBuf buf;
+    V4FrontError error = {};
+    if (v4_compiler_compile(compiler, dict, line.source.c_str(), &buf, &error) != 0 ||
+        buf.word_count != 1 ||
+        v4_dict_define(dict, line.name.c_str(), static_cast<int>(done)) != 0)
+    {
+      break;
+    }
+    hashes.push_back(fnv1a(buf.words[0].code, buf.words[0].code_len));
+    done++;
+  }
+  elapsed = seconds_since(t0);
+  return done;
+}
+
+// ns per lookup: hashed dictionary vs a linear case-insensitive scan
+void bench_lookup(int words)
+{
+  std::vector<std::string> names;
+  for (int i = 0; i < words; i++)
+  {
+    names.push_back(word_name(i));
+  }
+
+  size_t slots = slots_for(words);
+  std::vector<V4DictSlot> slot_mem(slots);
+  std::vector<char> name_mem(words * NAME_BYTES);
+  V4Dict dict;
+  v4_dict_init(&dict, slot_mem.data(), slots, name_mem.data(), name_mem.size());
+  for (int i = 0; i < words; i++)
+  {
+    v4_dict_define(&dict, names[i].c_str(), i);
+  }
+
+  uint32_t seed = 0x2545F491;
+  std::vector<int> order(LOOKUP_RUNS);
+  for (int& k : order)
+  {
+    seed = seed * 1664525u + 1013904223u;
+    k = static_cast<int>((seed >> 8) % static_cast<uint32_t>(words));
+  }
+
+  long sum = 0;
+  auto t0 = Clock::now();
+  for (int k : order)
+  {
+    sum += v4_dict_find(&dict, names[k].c_str(), names[k].size());
+  }
+  double hashed = seconds_since(t0);
+
+  int runs = (words > 1024) ? LOOKUP_RUNS / 16 : LOOKUP_RUNS;
+  t0 = Clock::now();
+  for (int r = 0; r < runs; r++)
+  {
+    const char* wanted = names[order[r]].c_str();
+    for (int i = words - 1; i >= 0; i--)
+    {
+      if (strcasecmp(names[i].c_str(), wanted) == 0)
+      {
+        sum += i;
+        break;
+      }
+    }
+  }
+  double linear = seconds_since(t0);
+  sink = sum;
+
+  size_t bytes = slots * sizeof(V4DictSlot) + dict.names_used;
+  std::printf("%6d %10.1f %10.1f %8u %10.1f\n", words, hashed * 1e9 / LOOKUP_RUNS,
+              linear * 1e9 / runs, static_cast<unsigned>(bytes),
+              static_cast<double>(bytes) / words);
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  int words = (argc > 1) ? std::atoi(argv[1]) : 2000;
+  if (words < 2 || words > MAX_WORDS)
+  {
+    std::fprintf(stderr, "Usage: %s [words] (2-%d)\n", argv[0], MAX_WORDS);
+    return EXIT_FAILURE;
+  }
+
+  std::vector<Line> lines = build_source(words);
+  size_t source_bytes = 0;
+  for (const Line& line : lines)
+  {
+    source_bytes += line.source.size() + 1;
+  }
+  std::printf("V4-front compile benchmark: %d lines, %u bytes of source\n\n", words,
+              static_cast<unsigned>(source_bytes));
+
+  std::vector<uint64_t> shared_hashes;
+  double shared_s = 0;
+  size_t shared = run_shared(lines, shared_hashes, shared_s);
+
+  size_t slots = slots_for(words);
+  std::vector<V4DictSlot> slot_mem(slots);
+  std::vector<char> name_mem(words * NAME_BYTES);
+  V4Dict dict;
+  v4_dict_init(&dict, slot_mem.data(), slots, name_mem.data(), name_mem.size());
+  std::vector<uint64_t> dict_hashes;
+  double dict_s = 0;
+  size_t compiled = run_dict(&dict, lines, dict_hashes, dict_s);
+
+  std::vector<V4DictSlot> inst_slot_mem(slots);
+  std::vector<char> inst_name_mem(words * NAME_BYTES);
+  V4Dict inst_dict;
+  v4_dict_init(&inst_dict, inst_slot_mem.data(), slots, inst_name_mem.data(),
+               inst_name_mem.size());
+  alignas(16) static uint8_t arena[COMPILER_ARENA_SIZE];
+  V4Compiler* compiler = v4_compiler_create(arena, sizeof(arena), COMPILER_STACK_SIZE);
+  std::vector<uint64_t> inst_hashes;
+  double inst_s = 0;
+  size_t inst = (compiler != nullptr)
+                    ? run_compiler(compiler, &inst_dict, lines, inst_hashes, inst_s)
+                    : 0;
+
+  std::printf("%-15s %8s %12s %12s\n", "mode", "lines", "lines/s", "us/line");
+  std::printf("%-15s %8u %12.0f %12.2f%s\n", "shared context",
+              static_cast<unsigned>(shared), shared / shared_s, shared_s * 1e6 / shared,
+              (shared < lines.size()) ? "  (context full)" : "");
+  std::printf("%-15s %8u %12.0f %12.2f\n", "dictionary", static_cast<unsigned>(compiled),
+              compiled / dict_s, dict_s * 1e6 / compiled);
+  std::printf("%-15s %8u %12.0f %12.2f\n", "compiler inst.", static_cast<unsigned>(inst),
+              inst / inst_s, inst_s * 1e6 / inst);
+
+  bool ok = compiled == lines.size() && inst == lines.size();
+  for (size_t i = 0; ok && i < shared; i++)
+  {
+    ok = shared_hashes[i] == dict_hashes[i];
+  }
+  for (size_t i = 0; ok && i < inst; i++)
+  {
+    ok = inst_hashes[i] == dict_hashes[i];
+  }
+
+  if (compiler != nullptr)
+  {
+    const V4CompilerStats* st = v4_compiler_stats(compiler);
+    std::printf("\nCompiler instance: stack peak %u of %u bytes, output peak %u of %u "
+                "bytes, %u bytes of instance\n",
+                static_cast<unsigned>(st->stack_peak),
+                static_cast<unsigned>(st->stack_size),
+                static_cast<unsigned>(st->output_peak),
+                static_cast<unsigned>(st->output_size),
+                static_cast<unsigned>(v4_compiler_overhead()));
+    v4_compiler_destroy(compiler);
+  }
+
+  size_t dict_bytes = slots * sizeof(V4DictSlot) + dict.names_used;
+  std::printf("\nDictionary: %u words, %u slots, %u name bytes, %u bytes total "
+              "(%.1f per word)\n",
+              static_cast<unsigned>(dict.count), static_cast<unsigned>(slots),
+              static_cast<unsigned>(dict.names_used), static_cast<unsigned>(dict_bytes),
+              static_cast<double>(dict_bytes) / dict.count);
+
+  std::printf("\n%6s %10s %10s %8s %10s\n", "words", "hash ns", "linear ns", "bytes",
+              "bytes/word");
+  for (int n : {64, 1024, 4096})
+  {
+    bench_lookup(n);
+  }
+
+  if (!ok)
+  {
+    std::fprintf(stderr, "ERROR: dictionary compile failed or differs from shared "
+                         "context or compiler instance\n");
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,254 @@
+/**
+ * @file event_bench.cpp
+ * @brief Event ring stress test and ISR-to-handler latency (Linux host)
+ *
+ * Two parts:
+ * - ring: a producer thread pushes a sequence through one EventRing as
+ *   fast as it can (retrying while the ring is full) and a consumer thread
+ *   checks that every value arrives once and in order
+ * - dispatch: two producer threads stand in for a GPIO and a timer ISR,
+ *   each posting into its own ring at a fixed interval without retrying;
+ *   the VM thread waits for events and runs a handler word per event
+ *   through EventDispatcher, which counts them in VM memory
+ * Exits with failure if an event is lost, duplicated or reordered in the
+ * ring test, or if handled + dropped events do not add up to the posted
+ * ones in the dispatch test.
+ *
+ * Usage: event_bench [events] [interval_us]
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include "v4_event.hpp"
+
+using v4ports::Event;
+using v4ports::EventDispatcher;
+using v4ports::EventRing;
+using v4ports::EventStats;
+
+namespace
+{
+
+constexpr size_t STRESS_SLOTS = 256;
+constexpr size_t ISR_SLOTS = 64;
+constexpr size_t VM_MEM_SIZE = 4096;
+constexpr uint16_t SRC_GPIO = 0;
+constexpr uint16_t SRC_TIMER = 1;
+constexpr size_t DISPATCH_MAX_EVENTS = 16;
+constexpr uint32_t DISPATCH_BUDGET_US = 200;
+
+uint64_t steady_us()
+{
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                                   std::chrono::steady_clock::now().time_since_epoch())
+                                   .count());
+}
+
+// ( value -- ) DROP, then add 1 to the cell at addr
+#define COUNT_HANDLER(addr)                                                   \
+  {                                                                           \
+    0x02, 0x76, addr, 0x30, 0x74, 0x10, 0x76, addr, 0x31, 0x51                \
+  }
+
+const uint8_t ON_GPIO[] = COUNT_HANDLER(0);
+const uint8_t ON_TIMER[] = COUNT_HANDLER(4);
+
+#undef COUNT_HANDLER
+
+bool run_ring_stress(uint32_t events)
+{
+  static Event slots[STRESS_SLOTS];
+  EventRing ring(slots, STRESS_SLOTS);
+  uint32_t retries = 0;
+
+  auto t0 = std::chrono::steady_clock::now();
+  std::thread producer([&] {
+    for (uint32_t i = 0; i < events; i++)
+    {
+      Event ev = {SRC_GPIO, 0, static_cast<int32_t>(i), 0};
+      while (!ring.push(ev))
+      {
+        retries++;
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  uint32_t expected = 0;
+  uint32_t errors = 0;
+  while (expected < events)
+  {
+    Event ev;
+    if (!ring.pop(ev))
+    {
+      std::this_thread::yield();
+      continue;
+    }
+    if (ev.value != static_cast<int32_t>(expected))
+    {
+      errors++;
+    }
+    expected++;
+  }
+  producer.join();
+  double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+  std::printf("ring: %u events through %u slots in %.1f ms (%.1f M/s), %u full "
+              "retries, high water %u, %u out of order\n",
+              static_cast<unsigned>(events), static_cast<unsigned>(STRESS_SLOTS), s * 1e3,
+              events / s / 1e6, static_cast<unsigned>(retries),
+              static_cast<unsigned>(ring.high_water()), static_cast<unsigned>(errors));
+  return errors == 0 && ring.size() == 0;
+}
+
+// Stand-in ISR: posts @p events at a fixed interval
+void isr_thread(EventRing& ring, uint16_t source, uint32_t events, uint32_t interval_us,
+                std::atomic<uint32_t>& posted)
+{
+  uint64_t next = steady_us();
+  for (uint32_t i = 0; i < events; i++)
+  {
+    next += interval_us;
+    while (steady_us() < next)
+    {
+      std::this_thread::yield();
+    }
+    uint32_t now = static_cast<uint32_t>(steady_us());
+    ring.push({source, 0, static_cast<int32_t>(i), now});
+    posted.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+// Latency below which @p pct percent of the events were handled (log2 us)
+uint32_t percentile(const EventStats& s, double pct)
+{
+  uint64_t target = static_cast<uint64_t>(s.dispatched * pct / 100.0);
+  uint64_t seen = 0;
+  for (size_t i = 0; i < v4ports::EVENT_LATENCY_BUCKETS; i++)
+  {
+    seen += s.latency_hist[i];
+    if (seen > target)
+    {
+      return 1u << i;
+    }
+  }
+  return 1u << (v4ports::EVENT_LATENCY_BUCKETS - 1);
+}
+
+bool run_dispatch(uint32_t events, uint32_t interval_us)
+{
+  static uint8_t vm_mem[VM_MEM_SIZE];
+  std::memset(vm_mem, 0, sizeof(vm_mem));
+  VmConfig cfg = {
+      .mem = vm_mem,
+      .mem_size = static_cast<uint32_t>(sizeof(vm_mem)),
+      .mmio = nullptr,
+      .mmio_count = 0,
+      .arena = nullptr,
+  };
+  Vm* vm = vm_create(&cfg);
+  if (vm == nullptr)
+  {
+    std::fprintf(stderr, "event_bench: cannot create VM\n");
+    return false;
+  }
+
+  static Event gpio_slots[ISR_SLOTS];
+  static Event timer_slots[ISR_SLOTS];
+  EventRing gpio_ring(gpio_slots, ISR_SLOTS);
+  EventRing timer_ring(timer_slots, ISR_SLOTS);
+  EventDispatcher events_out(vm, steady_us);
+  events_out.attach(gpio_ring);
+  events_out.attach(timer_ring);
+  int gpio_wid = vm_register_word(vm, "on-gpio", ON_GPIO, sizeof(ON_GPIO));
+  int timer_wid = vm_register_word(vm, "on-timer", ON_TIMER, sizeof(ON_TIMER));
+  if (events_out.bind(SRC_GPIO, gpio_wid) != 0 ||
+      events_out.bind(SRC_TIMER, timer_wid) != 0)
+  {
+    std::fprintf(stderr, "event_bench: cannot bind handlers\n");
+    vm_destroy(vm);
+    return false;
+  }
+
+  std::atomic<uint32_t> posted{0};
+  std::atomic<int> running{2};
+  auto isr = [&](EventRing& ring, uint16_t source, uint32_t interval) {
+    isr_thread(ring, source, events / 2, interval, posted);
+    running.fetch_sub(1, std::memory_order_release);
+  };
+  // Each posts every 2 intervals, 1 us apart in period so they drift past
+  // each other and sometimes arrive together
+  std::thread gpio(isr, std::ref(gpio_ring), SRC_GPIO, interval_us * 2);
+  std::thread timer(isr, std::ref(timer_ring), SRC_TIMER, interval_us * 2 + 1);
+
+  uint32_t wakeups = 0;
+  while (running.load(std::memory_order_acquire) > 0 || events_out.pending())
+  {
+    if (!events_out.pending())
+    {
+      std::this_thread::yield();
+      continue;
+    }
+    wakeups++;
+    events_out.dispatch(DISPATCH_MAX_EVENTS, DISPATCH_BUDGET_US);
+  }
+  gpio.join();
+  timer.join();
+
+  EventStats s = events_out.stats();
+  uint32_t gpio_count;
+  uint32_t timer_count;
+  std::memcpy(&gpio_count, vm_mem, 4);
+  std::memcpy(&timer_count, vm_mem + 4, 4);
+  vm_destroy(vm);
+
+  double avg =
+      (s.dispatched > 0) ? static_cast<double>(s.latency_sum_us) / s.dispatched : 0;
+  std::printf("dispatch: %u posted, %u handled (gpio %u, timer %u), %u dropped, "
+              "high water %u/%u\n",
+              static_cast<unsigned>(posted.load()), static_cast<unsigned>(s.dispatched),
+              static_cast<unsigned>(gpio_count), static_cast<unsigned>(timer_count),
+              static_cast<unsigned>(s.dropped), static_cast<unsigned>(s.high_water),
+              static_cast<unsigned>(ISR_SLOTS));
+  std::printf("latency: avg %.1f us, p50 < %u us, p99 < %u us, max %u us; %u wakeups, "
+              "%u budget stops, %u faults\n",
+              avg, static_cast<unsigned>(percentile(s, 50)),
+              static_cast<unsigned>(percentile(s, 99)),
+              static_cast<unsigned>(s.latency_max_us), static_cast<unsigned>(wakeups),
+              static_cast<unsigned>(s.budget_stops), static_cast<unsigned>(s.faults));
+
+  return s.faults == 0 && s.dispatched + s.dropped == posted.load() &&
+         gpio_count + timer_count == s.dispatched;
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  long events = (argc > 1) ? std::atol(argv[1]) : 200000;
+  long interval_us = (argc > 2) ? std::atol(argv[2]) : 10;
+  if (events < 2 || events > 100000000 || interval_us < 1 || interval_us > 1000000)
+  {
+    std::fprintf(stderr, "Usage: %s [events] [interval_us]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  bool ok = run_ring_stress(static_cast<uint32_t>(events) * 10);
+  ok = run_dispatch(static_cast<uint32_t>(events), static_cast<uint32_t>(interval_us)) &&
+       ok;
+  if (!ok)
+  {
+    std::fprintf(stderr, "ERROR: events lost, duplicated or miscounted\n");
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
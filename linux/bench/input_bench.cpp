@@ -0,0 +1,222 @@
+/**
+ * @file input_bench.cpp
+ * @brief REPL console input: per-byte echo vs the streaming input assembler
+ *
+ * Loads a generated Forth script of multi-line definitions as if it were
+ * pasted into the console, arriving in USB-sized chunks:
+ * - per-byte: the old read_line() path, one write + flush per echoed byte
+ *   to an unbuffered stream (how stdout reaches the USB Serial/JTAG driver)
+ * - assembler: V4Input joins lines into units with one echo write per chunk
+ * - assembler + compile: each unit is also compiled with a compiler
+ *   instance and its words defined in the REPL dictionary
+ * The echo goes to /dev/null, so the times are CPU cost only.
+ *
+ * Usage: input_bench [script_bytes]
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "v4_repl_compiler.h"
+#include "v4_repl_dict.h"
+#include "v4_repl_input.h"
+#include "v4front/compile.h"
+
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+
+constexpr size_t CHUNK = 64;  // USB full-speed bulk packet
+constexpr size_t MAX_LINE_LENGTH = 256;
+constexpr size_t UNIT_SIZE = 2048;
+constexpr size_t ECHO_SIZE = 512;
+constexpr size_t DICT_SLOTS = 4096;
+constexpr size_t DICT_NAMES_SIZE = 32 * 1024;
+constexpr size_t COMPILER_STACK_SIZE = 32 * 1024;
+constexpr size_t COMPILER_ARENA_SIZE = 64 * 1024;
+
+struct Result
+{
+  double seconds;
+  size_t writes;
+  size_t units;
+  size_t failed;
+};
+
+double seconds_since(Clock::time_point t0)
+{
+  return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+// Definitions spread over three lines, each used once at top level
+std::string build_script(size_t bytes)
+{
+  std::string script;
+  for (int i = 0; script.size() < bytes; i++)
+  {
+    std::string name = "w" + std::to_string(i);
+    std::string body = (i == 0) ? "1" : "w" + std::to_string(i - 1) + " 1 +";
+    script += ": " + name + " ( -- n )\r\n  " + body + "\r\n  dup drop ;\r\n";
+    script += name + " drop\r\n";
+  }
+  return script;
+}
+
+// Echo each byte on its own, as read_line() did
+Result run_per_byte(const std::string& script, std::FILE* out)
+{
+  Result r = {};
+  size_t pos = 0;
+  auto t0 = Clock::now();
+  for (char c : script)
+  {
+    if (c == '\r' || c == '\n')
+    {
+      std::fputc('\n', out);
+      std::fflush(out);
+      r.writes++;
+      r.units += (pos > 0);
+      pos = 0;
+      continue;
+    }
+    if (pos < MAX_LINE_LENGTH - 1)
+    {
+      pos++;
+      std::fputc(c, out);
+      std::fflush(out);
+      r.writes++;
+    }
+  }
+  r.seconds = seconds_since(t0);
+  return r;
+}
+
+Result run_assembler(const std::string& script, std::FILE* out, V4Compiler* compiler,
+                     V4Dict* dict)
+{
+  static char unit[UNIT_SIZE];
+  static char echo[ECHO_SIZE];
+  V4Input in;
+  v4_input_init(&in, unit, sizeof(unit), echo, sizeof(echo));
+
+  Result r = {};
+  int next_wid = 0;
+  auto t0 = Clock::now();
+  for (size_t off = 0; off < script.size(); off += CHUNK)
+  {
+    const char* chunk = script.data() + off;
+    size_t len = std::min(CHUNK, script.size() - off);
+    size_t pos = 0;
+    while (pos < len)
+    {
+      size_t used;
+      int status = v4_input_feed(&in, chunk + pos, len - pos, &used);
+      pos += used;
+      if (in.echo_len > 0)
+      {
+        std::fwrite(in.echo, 1, in.echo_len, out);
+        std::fflush(out);
+        in.echo_len = 0;
+        r.writes++;
+      }
+      if (status != V4_INPUT_UNIT)
+      {
+        r.failed += (status < 0);
+        continue;
+      }
+      r.units++;
+      if (compiler == nullptr)
+      {
+        continue;
+      }
+
+      V4FrontBuf buf;
+      V4FrontError error = {};
+      if (v4_compiler_compile(compiler, dict, in.buf, &buf, &error) != 0)
+      {
+        r.failed++;
+        continue;
+      }
+      for (int i = 0; i < buf.word_count; i++)
+      {
+        v4_dict_define(dict, buf.words[i].name, next_wid++);
+      }
+    }
+  }
+  r.seconds = seconds_since(t0);
+  return r;
+}
+
+void print_row(const char* mode, const Result& r, size_t bytes)
+{
+  std::printf("%-20s %8u %8u %10.2f %10.1f\n", mode, static_cast<unsigned>(r.units),
+              static_cast<unsigned>(r.writes), r.seconds * 1e3,
+              r.seconds * 1e6 / (static_cast<double>(bytes) / 1024));
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  size_t bytes = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 4096;
+  if (bytes == 0 || bytes > 1024 * 1024)
+  {
+    std::fprintf(stderr, "Usage: %s [script_bytes] (1-1048576)\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  std::FILE* out = std::fopen("/dev/null", "w");
+  if (out == nullptr)
+  {
+    std::fprintf(stderr, "input_bench: cannot open /dev/null\n");
+    return EXIT_FAILURE;
+  }
+  std::setvbuf(out, nullptr, _IONBF, 0);
+
+  std::string script = build_script(bytes);
+  std::printf("REPL input benchmark: %u bytes of script in %u-byte chunks\n\n",
+              static_cast<unsigned>(script.size()), static_cast<unsigned>(CHUNK));
+
+  static std::vector<V4DictSlot> slots(DICT_SLOTS);
+  static std::vector<char> names(DICT_NAMES_SIZE);
+  V4Dict dict;
+  v4_dict_init(&dict, slots.data(), slots.size(), names.data(), names.size());
+  alignas(16) static uint8_t arena[COMPILER_ARENA_SIZE];
+  V4Compiler* compiler = v4_compiler_create(arena, sizeof(arena), COMPILER_STACK_SIZE);
+  if (compiler == nullptr)
+  {
+    std::fprintf(stderr, "input_bench: cannot create compiler\n");
+    return EXIT_FAILURE;
+  }
+
+  Result per_byte = run_per_byte(script, out);
+  Result assembler = run_assembler(script, out, nullptr, nullptr);
+  Result compiled = run_assembler(script, out, compiler, &dict);
+
+  std::printf("%-20s %8s %8s %10s %10s\n", "mode", "units", "writes", "ms", "us/KB");
+  print_row("per-byte echo", per_byte, script.size());
+  print_row("assembler", assembler, script.size());
+  print_row("assembler + compile", compiled, script.size());
+  std::printf("\n(per-byte units are lines; multi-line definitions do not compile "
+              "that way)\n");
+
+  v4_compiler_destroy(compiler);
+  std::fclose(out);
+
+  if (assembler.failed > 0 || compiled.failed > 0 || compiled.units != assembler.units)
+  {
+    std::fprintf(stderr, "ERROR: %u units failed to assemble or compile\n",
+                 static_cast<unsigned>(assembler.failed + compiled.failed));
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,165 @@
+/**
+ * @file link_ingest_bench.cpp
+ * @brief V4-link ingest microbenchmark (per-byte vs bulk)
+ *
+ * Builds a synthetic RX stream of EXEC frames separated by line noise and
+ * pushes it through FrameDecoder::feed_byte() (one state machine step per
+ * byte, as Esp32c6LinkPort::poll() used to do) and FrameDecoder::feed()
+ * (bulk path) with the chunk sizes seen on target.
+ *
+ * Usage: link_ingest_bench [megabytes]
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "v4_link_frame.hpp"
+
+using v4ports::FrameDecoder;
+namespace proto = v4ports::proto;
+
+namespace
+{
+
+constexpr size_t PAYLOAD_CAPACITY = 512;
+
+// Deterministic xorshift PRNG so every run measures the same stream
+uint32_t next_rand(uint32_t& state)
+{
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+std::vector<uint8_t> build_stream(size_t target_bytes, size_t& frame_count)
+{
+  std::vector<uint8_t> stream;
+  stream.reserve(target_bytes + PAYLOAD_CAPACITY + 32);
+  uint32_t seed = 0x12345678;
+  frame_count = 0;
+
+  while (stream.size() < target_bytes)
+  {
+    // Inter-frame noise (never STX, so every frame is recoverable)
+    size_t noise = next_rand(seed) % 16;
+    for (size_t i = 0; i < noise; ++i)
+    {
+      uint8_t b = static_cast<uint8_t>(next_rand(seed));
+      stream.push_back(b == proto::STX ? 0x00 : b);
+    }
+
+    size_t len = 1 + next_rand(seed) % PAYLOAD_CAPACITY;
+    size_t start = stream.size();
+    stream.push_back(proto::STX);
+    stream.push_back(static_cast<uint8_t>(len & 0xFF));
+    stream.push_back(static_cast<uint8_t>(len >> 8));
+    stream.push_back(proto::CMD_EXEC);
+    for (size_t i = 0; i < len; ++i)
+    {
+      stream.push_back(static_cast<uint8_t>(next_rand(seed)));
+    }
+    stream.push_back(
+        v4ports::crc8_update(0, &stream[start + 1], stream.size() - start - 1));
+    ++frame_count;
+  }
+  return stream;
+}
+
+struct Result
+{
+  double seconds;
+  size_t frames;
+  size_t errors;
+  uint32_t checksum;
+};
+
+template <typename Ingest>
+Result run(const std::vector<uint8_t>& stream, Ingest ingest)
+{
+  static uint8_t payload[PAYLOAD_CAPACITY];
+  Result r = {0.0, 0, 0, 0};
+  FrameDecoder decoder(
+      payload, sizeof(payload),
+      [&r](uint8_t cmd, const uint8_t* data, size_t len)
+      {
+        ++r.frames;
+        r.checksum = r.checksum * 31 + cmd + static_cast<uint32_t>(len) + data[len - 1];
+      },
+      [&r](uint8_t) { ++r.errors; });
+
+  auto t0 = std::chrono::steady_clock::now();
+  ingest(decoder, stream.data(), stream.size());
+  auto t1 = std::chrono::steady_clock::now();
+  r.seconds = std::chrono::duration<double>(t1 - t0).count();
+  return r;
+}
+
+bool report(const char* name, const Result& r, const Result& ref, size_t bytes)
+{
+  double mbps = static_cast<double>(bytes) / (1024.0 * 1024.0) / r.seconds;
+  std::printf("%-22s %10.2f MB/s  (%zu frames, %zu errors)\n", name, mbps, r.frames,
+              r.errors);
+  if (r.frames != ref.frames || r.errors != ref.errors || r.checksum != ref.checksum)
+  {
+    std::printf("  ERROR: result differs from feed_byte reference\n");
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  size_t megabytes = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 64;
+  if (megabytes == 0)
+  {
+    megabytes = 1;
+  }
+
+  size_t expected_frames = 0;
+  std::vector<uint8_t> stream = build_stream(megabytes * 1024 * 1024, expected_frames);
+
+  std::printf("V4-link ingest benchmark\n");
+  std::printf("stream: %zu bytes, %zu frames, payload capacity %zu\n\n", stream.size(),
+              expected_frames, PAYLOAD_CAPACITY);
+
+  Result per_byte = run(stream,
+                        [](FrameDecoder& d, const uint8_t* data, size_t len)
+                        {
+                          for (size_t i = 0; i < len; ++i)
+                          {
+                            d.feed_byte(data[i]);
+                          }
+                        });
+
+  auto chunked = [](size_t chunk)
+  {
+    return [chunk](FrameDecoder& d, const uint8_t* data, size_t len)
+    {
+      for (size_t off = 0; off < len; off += chunk)
+      {
+        d.feed(data + off, (len - off < chunk) ? len - off : chunk);
+      }
+    };
+  };
+
+  Result bulk_64 = run(stream, chunked(64));
+  Result bulk_128 = run(stream, chunked(128));
+  Result bulk_1024 = run(stream, chunked(1024));
+
+  bool ok = per_byte.frames == expected_frames && per_byte.errors == 0;
+  ok &= report("feed_byte", per_byte, per_byte, stream.size());
+  ok &= report("feed (64B chunks)", bulk_64, per_byte, stream.size());
+  ok &= report("feed (128B chunks)", bulk_128, per_byte, stream.size());
+  ok &= report("feed (1024B chunks)", bulk_1024, per_byte, stream.size());
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,299 @@
+/**
+ * @file link_loopback_bench.cpp
+ * @brief V4-link round-trip latency and EXEC throughput benchmark
+ *
+ * Runs LinkPort + V4 VM on one end of a Unix socketpair in a server thread
+ * and drives it from a C++ client on the other end:
+ * - PING round-trip latency (min / p50 / p99 / max)
+ * - EXEC throughput with full-size payloads (MB/s, frames/s)
+ * - The same EXEC stream pipelined as TAGGED frames with a window in flight
+ *
+ * Usage: link_loopback_bench [ping_count] [exec_count]
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "v4/vm_api.h"
+#include "v4_link_port.hpp"
+#include "v4_link_transport_posix.hpp"
+
+namespace proto = v4ports::proto;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+
+constexpr size_t BUFFER_SIZE = 512;
+
+// Re-register budget: RESET the VM before the dictionary fills up
+constexpr int EXECS_PER_RESET = 16;
+
+// Tagged frames in flight for the pipelined run
+constexpr size_t WINDOW = 8;
+
+std::vector<uint8_t> encode_frame(uint8_t cmd, const std::vector<uint8_t>& payload)
+{
+  std::vector<uint8_t> frame;
+  frame.reserve(payload.size() + 5);
+  frame.push_back(proto::STX);
+  frame.push_back(static_cast<uint8_t>(payload.size() & 0xFF));
+  frame.push_back(static_cast<uint8_t>(payload.size() >> 8));
+  frame.push_back(cmd);
+  frame.insert(frame.end(), payload.begin(), payload.end());
+  frame.push_back(v4ports::crc8_update(0, frame.data() + 1, frame.size() - 1));
+  return frame;
+}
+
+bool write_all(int fd, const std::vector<uint8_t>& data)
+{
+  size_t done = 0;
+  while (done < data.size())
+  {
+    ssize_t n = write(fd, data.data() + done, data.size() - done);
+    if (n <= 0)
+    {
+      return false;
+    }
+    done += static_cast<size_t>(n);
+  }
+  return true;
+}
+
+// Read one 5-byte response and return its error code (-1 on failure)
+int read_response(int fd)
+{
+  uint8_t resp[5];
+  size_t got = 0;
+  while (got < sizeof(resp))
+  {
+    ssize_t n = read(fd, resp + got, sizeof(resp) - got);
+    if (n <= 0)
+    {
+      return -1;
+    }
+    got += static_cast<size_t>(n);
+  }
+  if (resp[0] != proto::STX || v4ports::crc8_update(0, resp + 1, 3) != resp[4])
+  {
+    return -1;
+  }
+  return resp[3];
+}
+
+// Read one ack batch and return the number of OK acks (-1 on failure)
+int read_acks(int fd)
+{
+  uint8_t frame[4 + 2 * proto::TAG_WINDOW_MAX];
+  size_t need = 3;
+  size_t got = 0;
+  while (got < need)
+  {
+    ssize_t n = read(fd, frame + got, need - got);
+    if (n <= 0)
+    {
+      return -1;
+    }
+    got += static_cast<size_t>(n);
+    if (got == 3)
+    {
+      size_t len = frame[1] | (frame[2] << 8);
+      if (frame[0] != proto::STX || len < 2 || len > 2 * proto::TAG_WINDOW_MAX)
+      {
+        return -1;
+      }
+      need = 4 + len;
+    }
+  }
+  if (v4ports::crc8_update(0, frame + 1, need - 2) != frame[need - 1])
+  {
+    return -1;
+  }
+  int acked = 0;
+  for (size_t i = 3; i + 1 < need; i += 2)
+  {
+    if (frame[i + 1] != proto::ERR_OK)
+    {
+      return -1;
+    }
+    acked++;
+  }
+  return acked;
+}
+
+double percentile(std::vector<double>& sorted, double p)
+{
+  size_t idx = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1));
+  return sorted[idx];
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  int ping_count = (argc > 1) ? std::atoi(argv[1]) : 10000;
+  int exec_count = (argc > 2) ? std::atoi(argv[2]) : 2000;
+  if (ping_count < 1 || exec_count < 1)
+  {
+    std::fprintf(stderr, "Usage: %s [ping_count] [exec_count]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  int fds[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+  {
+    std::perror("socketpair");
+    return EXIT_FAILURE;
+  }
+
+  static uint8_t vm_memory[4096];
+  VmConfig cfg = {
+      .mem = vm_memory,
+      .mem_size = sizeof(vm_memory),
+      .mmio = nullptr,
+      .mmio_count = 0,
+      .arena = nullptr,
+  };
+  Vm* vm = vm_create(&cfg);
+  if (vm == nullptr)
+  {
+    std::fprintf(stderr, "Failed to create VM\n");
+    return EXIT_FAILURE;
+  }
+
+  // Server: LinkPort on fds[0]
+  std::atomic<bool> stop{false};
+  std::thread server(
+      [&]()
+      {
+        auto transport = std::make_unique<v4ports::PosixTransport>(fds[0], fds[0]);
+        v4ports::LinkPort link(vm, std::move(transport), BUFFER_SIZE);
+        while (!stop.load(std::memory_order_relaxed))
+        {
+          link.poll(10);
+        }
+      });
+
+  int client = fds[1];
+  bool ok = true;
+
+  // PING round-trip latency
+  std::vector<uint8_t> ping = encode_frame(proto::CMD_PING, {});
+  std::vector<double> rtt_us;
+  rtt_us.reserve(static_cast<size_t>(ping_count));
+  for (int i = 0; i < ping_count && ok; ++i)
+  {
+    auto t0 = Clock::now();
+    ok = write_all(client, ping) && read_response(client) == proto::ERR_OK;
+    auto t1 = Clock::now();
+    rtt_us.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+  }
+
+  // EXEC throughput: full buffer of LIT_U8 n DROP triples, then RET
+  auto make_program = [](size_t limit)
+  {
+    std::vector<uint8_t> code;
+    while (code.size() + 4 <= limit)
+    {
+      code.push_back(0x76);  // LIT_U8
+      code.push_back(static_cast<uint8_t>(code.size()));
+      code.push_back(0x02);  // DROP
+    }
+    code.push_back(0x51);  // RET
+    return code;
+  };
+  std::vector<uint8_t> program = make_program(BUFFER_SIZE);
+  std::vector<uint8_t> exec = encode_frame(proto::CMD_EXEC, program);
+  std::vector<uint8_t> reset = encode_frame(proto::CMD_RESET, {});
+
+  auto t_exec0 = Clock::now();
+  for (int i = 0; i < exec_count && ok; ++i)
+  {
+    if (i % EXECS_PER_RESET == 0)
+    {
+      ok = write_all(client, reset) && read_response(client) == proto::ERR_OK;
+    }
+    ok = ok && write_all(client, exec) && read_response(client) == proto::ERR_OK;
+  }
+  auto t_exec1 = Clock::now();
+
+  // Pipelined EXEC: same stream as TAGGED frames, WINDOW in flight. The
+  // sequence is opened with a tagged PING.
+  std::vector<uint8_t> tagged_program =
+      make_program(BUFFER_SIZE - proto::TAG_HEADER_LEN);
+  std::vector<std::vector<uint8_t>> stream;
+  auto push_tagged = [&](uint8_t cmd, const std::vector<uint8_t>& payload)
+  {
+    std::vector<uint8_t> body = {static_cast<uint8_t>(stream.size()), cmd};
+    body.insert(body.end(), payload.begin(), payload.end());
+    stream.push_back(encode_frame(proto::CMD_TAGGED, body));
+  };
+  push_tagged(proto::CMD_PING, {});
+  for (int i = 0; i < exec_count; ++i)
+  {
+    if (i % EXECS_PER_RESET == 0)
+    {
+      push_tagged(proto::CMD_RESET, {});
+    }
+    push_tagged(proto::CMD_EXEC, tagged_program);
+  }
+
+  auto t_pipe0 = Clock::now();
+  size_t sent = 0;
+  size_t acked = 0;
+  while (ok && acked < stream.size())
+  {
+    while (ok && sent < stream.size() && sent - acked < WINDOW)
+    {
+      ok = write_all(client, stream[sent++]);
+    }
+    int n = ok ? read_acks(client) : -1;
+    ok = (n > 0);
+    acked += (n > 0) ? static_cast<size_t>(n) : 0;
+  }
+  auto t_pipe1 = Clock::now();
+
+  stop = true;
+  server.join();
+  close(client);
+  vm_destroy(vm);
+
+  if (!ok)
+  {
+    std::fprintf(stderr, "ERROR: link request failed\n");
+    return EXIT_FAILURE;
+  }
+
+  std::sort(rtt_us.begin(), rtt_us.end());
+  double exec_s = std::chrono::duration<double>(t_exec1 - t_exec0).count();
+  double payload_mb =
+      static_cast<double>(program.size()) * exec_count / (1024.0 * 1024.0);
+
+  std::printf("V4-link loopback benchmark (socketpair)\n\n");
+  std::printf("ping x%d: min %.1f us, p50 %.1f us, p99 %.1f us, max %.1f us\n",
+              ping_count, rtt_us.front(), percentile(rtt_us, 0.50),
+              percentile(rtt_us, 0.99), rtt_us.back());
+  std::printf("exec x%d (%zu B): %.2f MB/s, %.0f frames/s\n", exec_count,
+              program.size(), payload_mb / exec_s, exec_count / exec_s);
+
+  double pipe_s = std::chrono::duration<double>(t_pipe1 - t_pipe0).count();
+  double pipe_mb =
+      static_cast<double>(tagged_program.size()) * exec_count / (1024.0 * 1024.0);
+  std::printf("exec pipelined x%d (%zu B, window %zu): %.2f MB/s, %.0f frames/s\n",
+              exec_count, tagged_program.size(), WINDOW, pipe_mb / pipe_s,
+              exec_count / pipe_s);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,268 @@
+/**
+ * @file lz_bench.cpp
+ * @brief Compressed EXEC payloads: ratio, decode speed and link time
+ *
+ * Compresses typical V4-link programs (LED patterns as produced by
+ * generate_examples.py, unrolled GPIO sequences, a random incompressible
+ * blob) with lz_compress(), streams each EXEC_LZ frame through a
+ * FrameDecoder in small pieces and checks that the decompressed program
+ * matches. Link time is the frame time at the given baud rate (10 bits per
+ * byte); compressed transfers add the measured decode time. Programs that do
+ * not shrink are sent as plain EXEC, as v4_link_send.py does.
+ *
+ * Usage: lz_bench [baud]
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "v4_link_frame.hpp"
+#include "v4_link_lz.hpp"
+
+using Clock = std::chrono::steady_clock;
+namespace proto = v4ports::proto;
+
+namespace
+{
+
+constexpr size_t BUFFER_SIZE = 4096;
+constexpr size_t FRAME_OVERHEAD = 5;  // STX, LEN (2), CMD, CRC
+constexpr size_t FEED_PIECE = 64;     // Bytes per feed(), like a USB packet
+constexpr int DECODE_RUNS = 2000;
+
+constexpr uint8_t OP_LIT = 0x00;
+constexpr uint8_t OP_DROP = 0x02;
+constexpr uint8_t OP_RET = 0x51;
+constexpr uint8_t OP_SYS = 0x60;
+constexpr uint8_t OP_LIT1 = 0x74;
+constexpr uint8_t OP_LIT0 = 0x73;
+constexpr uint8_t OP_LIT_U8 = 0x76;
+constexpr uint8_t SYS_GPIO_WRITE = 0x01;
+constexpr uint8_t SYS_DELAY_MS = 0x22;
+constexpr uint8_t LED = 7;
+
+struct Program
+{
+  const char* name;
+  std::vector<uint8_t> code;
+};
+
+void led(std::vector<uint8_t>& code, bool on)
+{
+  code.insert(code.end(), {OP_LIT_U8, LED, on ? OP_LIT1 : OP_LIT0, OP_SYS,
+                           SYS_GPIO_WRITE, OP_DROP});
+}
+
+void delay(std::vector<uint8_t>& code, uint32_t ms)
+{
+  code.push_back(OP_LIT);
+  for (int b = 0; b < 4; b++)
+  {
+    code.push_back(static_cast<uint8_t>(ms >> (8 * b)));
+  }
+  code.insert(code.end(), {OP_SYS, SYS_DELAY_MS});
+}
+
+std::vector<Program> build_corpus()
+{
+  std::vector<Program> corpus;
+
+  Program blink{"blink x10", {}};
+  for (int i = 0; i < 10; i++)
+  {
+    led(blink.code, true);
+    delay(blink.code, 200);
+    led(blink.code, false);
+    delay(blink.code, 200);
+  }
+  blink.code.push_back(OP_RET);
+  corpus.push_back(blink);
+
+  Program sos{"sos x4", {}};
+  const uint32_t units[] = {1, 1, 1, 3, 3, 3, 1, 1, 1};
+  for (int r = 0; r < 4; r++)
+  {
+    for (uint32_t u : units)
+    {
+      led(sos.code, true);
+      delay(sos.code, 100 * u);
+      led(sos.code, false);
+      delay(sos.code, 100);
+    }
+    delay(sos.code, 700);
+  }
+  sos.code.push_back(OP_RET);
+  corpus.push_back(sos);
+
+  // PWM-like bit pattern: irregular on/off runs without delays
+  Program pattern{"pattern 2k", {}};
+  uint32_t bits = 0xB5A3C96Fu;
+  while (pattern.code.size() < 2000)
+  {
+    led(pattern.code, (bits & 1) != 0);
+    bits = (bits >> 1) | (bits << 31);
+  }
+  pattern.code.push_back(OP_RET);
+  corpus.push_back(pattern);
+
+  // Varying delays: the 4-byte literals differ, the surrounding code repeats
+  Program ramp{"ramp", {}};
+  for (uint32_t ms = 10; ms <= 400; ms += 10)
+  {
+    led(ramp.code, true);
+    delay(ramp.code, ms);
+    led(ramp.code, false);
+    delay(ramp.code, 410 - ms);
+  }
+  ramp.code.push_back(OP_RET);
+  corpus.push_back(ramp);
+
+  Program noise{"random", {}};
+  uint32_t seed = 0x12345678;
+  for (int i = 0; i < 1024; i++)
+  {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    noise.code.push_back(static_cast<uint8_t>(seed));
+  }
+  corpus.push_back(noise);
+
+  return corpus;
+}
+
+std::vector<uint8_t> encode_frame(uint8_t cmd, const std::vector<uint8_t>& payload)
+{
+  std::vector<uint8_t> frame = {proto::STX, static_cast<uint8_t>(payload.size()),
+                                static_cast<uint8_t>(payload.size() >> 8), cmd};
+  frame.insert(frame.end(), payload.begin(), payload.end());
+  frame.push_back(v4ports::crc8_update(0, &frame[1], frame.size() - 1));
+  return frame;
+}
+
+// Stream an EXEC_LZ frame through a FrameDecoder the way LinkPort does
+bool stream_frame(const std::vector<uint8_t>& frame, const std::vector<uint8_t>& expected)
+{
+  static uint8_t buffer[BUFFER_SIZE];
+  v4ports::LzDecoder lz;
+  bool ok = false;
+  bool started = false;
+
+  v4ports::FrameDecoder decoder(
+      buffer, sizeof(buffer),
+      [&](uint8_t cmd, const uint8_t*, size_t)
+      {
+        const uint8_t* program = buffer + proto::LZ_HEADER_LEN;
+        ok = cmd == proto::CMD_EXEC_LZ && lz.done() && lz.produced() == expected.size() &&
+             std::memcmp(program, expected.data(), expected.size()) == 0;
+      },
+      [](uint8_t) {});
+  decoder.set_stream(
+      [](uint8_t cmd, size_t, size_t& header_len)
+      {
+        header_len = proto::LZ_HEADER_LEN;
+        return cmd == proto::CMD_EXEC_LZ;
+      },
+      [&](const uint8_t* data, size_t len)
+      {
+        if (!started)
+        {
+          started = true;
+          lz.begin(buffer + proto::LZ_HEADER_LEN, buffer[0] | (buffer[1] << 8));
+        }
+        lz.feed(data, len);
+      });
+
+  for (size_t pos = 0; pos < frame.size(); pos += FEED_PIECE)
+  {
+    decoder.feed(frame.data() + pos, std::min(FEED_PIECE, frame.size() - pos));
+  }
+  return ok;
+}
+
+// Decode @p packed DECODE_RUNS times; returns ns per decode
+double time_decode(const std::vector<uint8_t>& packed, size_t raw_len)
+{
+  static uint8_t out[BUFFER_SIZE];
+  v4ports::LzDecoder lz;
+  auto t0 = Clock::now();
+  for (int i = 0; i < DECODE_RUNS; i++)
+  {
+    lz.begin(out, raw_len);
+    lz.feed(packed.data(), packed.size());
+  }
+  auto t1 = Clock::now();
+  return std::chrono::duration<double, std::nano>(t1 - t0).count() / DECODE_RUNS;
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  long baud = (argc > 1) ? std::atol(argv[1]) : 115200;
+  if (baud <= 0)
+  {
+    std::fprintf(stderr, "Usage: %s [baud]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  double byte_us = 10.0 * 1e6 / static_cast<double>(baud);
+
+  std::printf("V4-link compressed EXEC benchmark (%ld baud)\n\n", baud);
+  std::printf("%-11s %6s %6s %6s %9s %9s %9s %8s\n", "program", "raw", "lz", "ratio",
+              "decode us", "plain ms", "lz ms", "speedup");
+
+  size_t total_plain = 0;
+  size_t total_sent = 0;
+  bool failed = false;
+  for (const Program& program : build_corpus())
+  {
+    const std::vector<uint8_t>& code = program.code;
+    std::vector<uint8_t> packed(v4ports::lz_bound(code.size()));
+    size_t packed_len = v4ports::lz_compress(code.data(), code.size(), packed.data(),
+                                             packed.size());
+    packed.resize(packed_len);
+
+    std::vector<uint8_t> payload = {static_cast<uint8_t>(code.size()),
+                                    static_cast<uint8_t>(code.size() >> 8)};
+    payload.insert(payload.end(), packed.begin(), packed.end());
+    if (packed_len == 0 || !stream_frame(encode_frame(proto::CMD_EXEC_LZ, payload), code))
+    {
+      std::printf("%-11s round trip FAILED\n", program.name);
+      failed = true;
+      continue;
+    }
+
+    // The host falls back to plain EXEC when compression does not pay off
+    size_t plain_frame = code.size() + FRAME_OVERHEAD;
+    size_t lz_frame = payload.size() + FRAME_OVERHEAD;
+    bool use_lz = lz_frame < plain_frame;
+    double decode_us = time_decode(packed, code.size()) / 1000.0;
+    double plain_ms = plain_frame * byte_us / 1000.0;
+    double lz_ms = use_lz ? (lz_frame * byte_us + decode_us) / 1000.0 : plain_ms;
+
+    total_plain += plain_frame;
+    total_sent += use_lz ? lz_frame : plain_frame;
+    std::printf("%-11s %6u %6u %5.2fx %9.2f %9.2f %9.2f %7.2fx%s\n", program.name,
+                static_cast<unsigned>(code.size()), static_cast<unsigned>(packed_len),
+                static_cast<double>(code.size()) / packed_len, decode_us, plain_ms, lz_ms,
+                plain_ms / lz_ms, use_lz ? "" : " (plain)");
+  }
+
+  std::printf("\nWire bytes: %u plain, %u with automatic compression (%.2fx)\n",
+              static_cast<unsigned>(total_plain), static_cast<unsigned>(total_sent),
+              total_sent ? static_cast<double>(total_plain) / total_sent : 0.0);
+
+  if (failed)
+  {
+    std::fprintf(stderr, "ERROR: compressed round trip failed\n");
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
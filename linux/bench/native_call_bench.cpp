@@ -0,0 +1,160 @@
+/**
+ * @file native_call_bench.cpp
+ * @brief Native word calls vs SYS bytecode calls
+ *
+ * Runs the same GPIO write through both paths a V4 program can take to
+ * reach C code:
+ * - SYS:    `pin 1 SYS GPIO_WRITE` (HAL call through the SYS opcode)
+ * - native: `1 slot PORT !` (V4NativeTable dispatch through the call port),
+ *           i.e. the body of a registered native word
+ *
+ * Each program is one word containing CALLS_PER_PROGRAM calls, executed
+ * repeatedly; the result is ns per call including interpreter overhead.
+ *
+ * Usage: native_call_bench [runs]
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "v4/hal.h"
+#include "v4/vm_api.h"
+#include "v4_repl_native.h"
+
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+
+constexpr int CALLS_PER_PROGRAM = 64;
+constexpr int LED_PIN = 7;
+
+v4_err led_set(struct Vm* vm)
+{
+  v4_i32 value;
+  int err = vm_ds_pop(vm, &value);
+  if (err != 0)
+  {
+    return err;
+  }
+  hal_gpio_write(LED_PIN, (value != 0) ? HAL_GPIO_HIGH : HAL_GPIO_LOW);
+  return 0;
+}
+
+std::vector<uint8_t> sys_program()
+{
+  std::vector<uint8_t> code;
+  for (int i = 0; i < CALLS_PER_PROGRAM; ++i)
+  {
+    code.insert(code.end(), {
+                                0x76, LED_PIN,  // LIT_U8 pin
+                                0x74,           // LIT1
+                                0x60, 0x01,     // SYS 0x01 (V4_SYS_GPIO_WRITE)
+                            });
+  }
+  code.push_back(0x51);  // RET
+  return code;
+}
+
+std::vector<uint8_t> native_program(const V4NativeTable& natives, int slot)
+{
+  std::vector<uint8_t> code;
+  for (int i = 0; i < CALLS_PER_PROGRAM; ++i)
+  {
+    code.push_back(0x74);  // LIT1
+    // Native word body without its RET
+    const uint8_t* body = natives.code[slot];
+    code.insert(code.end(), body, body + V4_NATIVE_CODE_LEN - 1);
+  }
+  code.push_back(0x51);  // RET
+  return code;
+}
+
+// Run a registered word @p runs times; returns ns per call, or < 0 on error
+double run(Vm* vm, int wid, int runs)
+{
+  auto t0 = Clock::now();
+  for (int i = 0; i < runs; ++i)
+  {
+    if (vm_exec(vm, vm_get_word(vm, wid)) != 0)
+    {
+      return -1.0;
+    }
+  }
+  auto t1 = Clock::now();
+  double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+  return ns / (static_cast<double>(runs) * CALLS_PER_PROGRAM);
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  int runs = (argc > 1) ? std::atoi(argv[1]) : 20000;
+  if (runs < 1)
+  {
+    std::fprintf(stderr, "Usage: %s [runs]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  static V4NativeTable natives;
+  v4_native_init(&natives);
+
+  static uint8_t vm_memory[4096];
+  VmConfig cfg = {
+      .mem = vm_memory,
+      .mem_size = sizeof(vm_memory),
+      .mmio = v4_native_mmio(&natives),
+      .mmio_count = 1,
+      .arena = nullptr,
+  };
+  Vm* vm = vm_create(&cfg);
+  if (vm == nullptr)
+  {
+    std::fprintf(stderr, "Failed to create VM\n");
+    return EXIT_FAILURE;
+  }
+
+  hal_gpio_mode(LED_PIN, HAL_GPIO_OUTPUT);
+  int wid_led = v4_native_register(&natives, vm, "led!", led_set);
+
+  // Programs must outlive the VM: it runs registered code in place
+  std::vector<uint8_t> sys_code = sys_program();
+  std::vector<uint8_t> native_code = native_program(natives, 0);
+  int wid_sys = vm_register_word(vm, "bench-sys", sys_code.data(),
+                                 static_cast<int>(sys_code.size()));
+  int wid_native = vm_register_word(vm, "bench-native", native_code.data(),
+                                    static_cast<int>(native_code.size()));
+  if (wid_led < 0 || wid_sys < 0 || wid_native < 0)
+  {
+    std::fprintf(stderr, "Failed to register words\n");
+    vm_destroy(vm);
+    return EXIT_FAILURE;
+  }
+
+  // Warm up both paths, then measure
+  run(vm, wid_sys, runs / 10 + 1);
+  run(vm, wid_native, runs / 10 + 1);
+  double sys_ns = run(vm, wid_sys, runs);
+  double native_ns = run(vm, wid_native, runs);
+  vm_destroy(vm);
+
+  if (sys_ns < 0 || native_ns < 0)
+  {
+    std::fprintf(stderr, "ERROR: VM execution failed\n");
+    return EXIT_FAILURE;
+  }
+
+  std::printf("V4 native word benchmark (%d calls x %d runs)\n\n", CALLS_PER_PROGRAM,
+              runs);
+  std::printf("SYS GPIO_WRITE: %.1f ns/call\n", sys_ns);
+  std::printf("native led!:    %.1f ns/call (%.2fx)\n", native_ns, sys_ns / native_ns);
+
+  return EXIT_SUCCESS;
+}
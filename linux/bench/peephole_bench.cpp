@@ -0,0 +1,397 @@
+/**
+ * @file peephole_bench.cpp
+ * @brief Peephole optimizer: code size and dispatch count before and after
+ *
+ * Straight-line kernels compiled with V4-front and the hand-written LED
+ * words of v4-repl-demo are run through v4_peephole_word(). Each kernel
+ * body is repeated BODY_REPEAT times in one word; both versions are
+ * registered, executed and checked to leave the same stack and memory,
+ * then timed. The vm_bench kernels are scanned as well to show how much of
+ * a typical program is outside the straight-line subset the pass handles.
+ *
+ * --profile prints the most frequent adjacent opcode pairs of the whole
+ * corpus, i.e. the candidates for fused instructions in the VM.
+ *
+ * Usage: peephole_bench [--profile] [runs]
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "v4/hal.h"
+#include "v4/vm_api.h"
+#include "v4_repl_peephole.h"
+#include "v4front/compile.h"
+#include "vm_bench.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+
+constexpr int BODY_REPEAT = 16;
+constexpr int LED_PIN = 7;
+constexpr size_t VM_MEM_SIZE = 16 * 1024;
+constexpr size_t CHECK_BYTES = 2048;  // Memory compared between versions
+constexpr int MAX_DEPTH = 64;
+constexpr uint8_t OP_RET = 0x51;
+
+struct Kernel
+{
+  const char* name;
+  const char* body;  ///< Forth source, or nullptr for @ref code
+  std::vector<uint8_t> code;
+};
+
+// v4-repl-demo LED words without their RET
+const std::vector<uint8_t> LED_ON = {0x74, 0x01, 0x73, 0x31, 0x76,
+                                     LED_PIN, 0x03, 0x60, 0x01};
+const std::vector<uint8_t> LED_TOGGLE = {0x73, 0x30, 0x74, 0x2A, 0x01, 0x73,
+                                         0x31, 0x76, LED_PIN, 0x03, 0x60, 0x01};
+
+struct Version
+{
+  std::vector<uint8_t> code;
+  int insns;
+  int wid;
+};
+
+struct Snapshot
+{
+  std::vector<v4_i32> stack;
+  std::vector<uint8_t> mem;
+};
+
+uint8_t vm_memory[VM_MEM_SIZE];
+
+bool compile_word(const std::string& source, std::vector<uint8_t>& code)
+{
+  V4FrontContext* ctx = v4front_context_create();
+  if (ctx == nullptr)
+  {
+    return false;
+  }
+  V4FrontBuf buf = {};
+  V4FrontError error = {};
+  bool ok = v4front_compile_with_context_ex(ctx, source.c_str(), &buf, &error) == 0 &&
+            buf.word_count == 1;
+  if (ok)
+  {
+    code.assign(buf.words[0].code, buf.words[0].code + buf.words[0].code_len);
+  }
+  else
+  {
+    char msg[512];
+    v4front_format_error(&error, source.c_str(), msg, sizeof(msg));
+    std::fprintf(stderr, "%s", msg);
+  }
+  v4front_free(&buf);
+  v4front_context_destroy(ctx);
+  return ok;
+}
+
+// Run @p wid once from a clean state and capture the result
+bool run_once(Vm* vm, int wid, Snapshot& snap)
+{
+  std::memset(vm_memory, 0, CHECK_BYTES);
+  v4_i32 v;
+  while (vm_ds_pop(vm, &v) == 0)
+  {
+  }
+  if (vm_exec(vm, vm_get_word(vm, wid)) != 0)
+  {
+    return false;
+  }
+  snap.stack.clear();
+  while (vm_ds_pop(vm, &v) == 0 && snap.stack.size() < MAX_DEPTH)
+  {
+    snap.stack.push_back(v);
+  }
+  snap.mem.assign(vm_memory, vm_memory + CHECK_BYTES);
+  return true;
+}
+
+// Execute @p wid @p runs times; returns ns per run, or < 0 on error
+double time_word(Vm* vm, int wid, int runs)
+{
+  auto t0 = Clock::now();
+  for (int i = 0; i < runs; ++i)
+  {
+    if (vm_exec(vm, vm_get_word(vm, wid)) != 0)
+    {
+      return -1.0;
+    }
+    v4_i32 v;
+    while (vm_ds_pop(vm, &v) == 0)
+    {
+    }
+  }
+  auto t1 = Clock::now();
+  return std::chrono::duration<double, std::nano>(t1 - t0).count() / runs;
+}
+
+// Adjacent opcode pairs over the corpus
+struct PairProfile
+{
+  uint32_t counts[256][256] = {};
+  int prev = -1;
+
+  static void visit(uint8_t op, size_t /*pos*/, void* user)
+  {
+    auto* self = static_cast<PairProfile*>(user);
+    if (self->prev >= 0)
+    {
+      self->counts[self->prev][op]++;
+    }
+    self->prev = op;
+  }
+
+  void add(const std::vector<uint8_t>& code)
+  {
+    prev = -1;
+    v4_peephole_scan(code.data(), code.size(), visit, this);
+  }
+
+  void print(size_t top) const
+  {
+    struct Pair
+    {
+      uint32_t count;
+      int a;
+      int b;
+    };
+    std::vector<Pair> pairs;
+    uint64_t total = 0;
+    for (int a = 0; a < 256; a++)
+    {
+      for (int b = 0; b < 256; b++)
+      {
+        if (counts[a][b] != 0)
+        {
+          pairs.push_back({counts[a][b], a, b});
+          total += counts[a][b];
+        }
+      }
+    }
+    std::sort(pairs.begin(), pairs.end(),
+              [](const Pair& x, const Pair& y) { return x.count > y.count; });
+    std::printf("\nMost frequent opcode pairs (%llu pairs decoded):\n",
+                static_cast<unsigned long long>(total));
+    for (size_t i = 0; i < pairs.size() && i < top; i++)
+    {
+      std::printf("  0x%02X 0x%02X  %6u  %5.1f%%\n", pairs[i].a, pairs[i].b,
+                  static_cast<unsigned>(pairs[i].count), 100.0 * pairs[i].count / total);
+    }
+  }
+};
+
+// Scan the vm_bench kernel definitions: how many words the pass can handle
+void scan_vm_bench(PairProfile* profile)
+{
+  size_t count = 0;
+  const v4ports::VmBenchKernel* kernels = v4ports::vm_bench_kernels(count);
+  int words = 0;
+  int supported = 0;
+  for (size_t k = 0; k < count; k++)
+  {
+    V4FrontContext* ctx = v4front_context_create();
+    if (ctx == nullptr)
+    {
+      continue;
+    }
+    // The sys kernel calls a hand-assembled word
+    v4front_context_register_word(ctx, "GPIO-HI", 0);
+    V4FrontBuf buf = {};
+    V4FrontError error = {};
+    if (v4front_compile_with_context_ex(ctx, kernels[k].setup, &buf, &error) != 0)
+    {
+      std::printf("vm_bench %-6s  (not compiled)\n", kernels[k].name);
+      v4front_context_destroy(ctx);
+      continue;
+    }
+    int ok = 0;
+    for (int i = 0; i < buf.word_count; i++)
+    {
+      const V4FrontWord& word = buf.words[i];
+      std::vector<uint8_t> code(word.code, word.code + word.code_len);
+      ok += v4_peephole_scan(code.data(), code.size(), nullptr, nullptr) >= 0;
+      if (profile != nullptr)
+      {
+        profile->add(code);
+      }
+    }
+    std::printf("vm_bench %-6s  %d/%d words in the optimizer subset\n", kernels[k].name,
+                ok, buf.word_count);
+    words += buf.word_count;
+    supported += ok;
+    v4front_free(&buf);
+    v4front_context_destroy(ctx);
+  }
+  std::printf("vm_bench total   %d/%d words\n", supported, words);
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  bool profile = false;
+  int runs = 20000;
+  for (int i = 1; i < argc; i++)
+  {
+    if (std::strcmp(argv[i], "--profile") == 0)
+    {
+      profile = true;
+    }
+    else if ((runs = std::atoi(argv[i])) < 1)
+    {
+      std::fprintf(stderr, "Usage: %s [--profile] [runs]\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::vector<Kernel> kernels = {
+      {"fold", "2 3 + 4 * 1000 + 64 !", {}},
+      {"address", "5 16 4 * 1024 + ! 16 4 * 1024 + @ drop", {}},
+      {"dup-drop", "64 @ dup drop 1 + 64 !", {}},
+      {"swap-swap", "64 @ 3 swap swap + 64 !", {}},
+      {"literals", "7 dup * 300 xor 0 xor 68 !", {}},
+      {"led-on", nullptr, LED_ON},
+      {"led-toggle", nullptr, LED_TOGGLE},
+  };
+
+  VmConfig cfg = {
+      .mem = vm_memory,
+      .mem_size = sizeof(vm_memory),
+      .mmio = nullptr,
+      .mmio_count = 0,
+      .arena = nullptr,
+  };
+  Vm* vm = vm_create(&cfg);
+  if (vm == nullptr)
+  {
+    std::fprintf(stderr, "Failed to create VM\n");
+    return EXIT_FAILURE;
+  }
+  hal_gpio_mode(LED_PIN, HAL_GPIO_OUTPUT);
+
+  PairProfile* pairs = profile ? new PairProfile() : nullptr;
+  V4PeepholeStats stats = {};
+  // Versions must outlive the VM: it runs registered code in place
+  std::vector<Version> versions(kernels.size() * 2);
+  bool failed = false;
+
+  std::printf("V4 peephole benchmark (body x %d, %d runs)\n\n", BODY_REPEAT, runs);
+  std::printf("%-11s %11s %11s %10s %10s %8s\n", "kernel", "insns", "bytes", "ns/run",
+              "ns/run opt", "speedup");
+
+  for (size_t k = 0; k < kernels.size(); k++)
+  {
+    const Kernel& kernel = kernels[k];
+    Version& orig = versions[2 * k];
+    Version& opt = versions[2 * k + 1];
+
+    if (kernel.body != nullptr)
+    {
+      std::string source = std::string(": bench-") + kernel.name;
+      for (int r = 0; r < BODY_REPEAT; r++)
+      {
+        source += std::string(" ") + kernel.body;
+      }
+      source += " ;";
+      if (!compile_word(source, orig.code))
+      {
+        std::printf("%-11s (not compiled)\n", kernel.name);
+        failed = true;
+        continue;
+      }
+    }
+    else
+    {
+      for (int r = 0; r < BODY_REPEAT; r++)
+      {
+        orig.code.insert(orig.code.end(), kernel.code.begin(), kernel.code.end());
+      }
+      orig.code.push_back(OP_RET);
+    }
+    if (pairs != nullptr)
+    {
+      pairs->add(orig.code);
+    }
+
+    opt.code.resize(orig.code.size());
+    int n = v4_peephole_word(orig.code.data(), orig.code.size(), opt.code.data(),
+                             opt.code.size(), &stats);
+    if (n < 0)
+    {
+      std::printf("%-11s (not optimized, code %d)\n", kernel.name, n);
+      failed = true;
+      continue;
+    }
+    opt.code = (n > 0) ? std::vector<uint8_t>(opt.code.begin(), opt.code.begin() + n)
+                       : orig.code;
+    orig.insns = v4_peephole_scan(orig.code.data(), orig.code.size(), nullptr, nullptr);
+    opt.insns = v4_peephole_scan(opt.code.data(), opt.code.size(), nullptr, nullptr);
+
+    orig.wid = vm_register_word(vm, kernel.name, orig.code.data(),
+                                static_cast<int>(orig.code.size()));
+    opt.wid = vm_register_word(vm, kernel.name, opt.code.data(),
+                               static_cast<int>(opt.code.size()));
+    Snapshot before;
+    Snapshot after;
+    if (orig.wid < 0 || opt.wid < 0 || !run_once(vm, orig.wid, before) ||
+        !run_once(vm, opt.wid, after))
+    {
+      std::printf("%-11s (VM error)\n", kernel.name);
+      failed = true;
+      continue;
+    }
+    if (before.stack != after.stack || before.mem != after.mem)
+    {
+      std::printf("%-11s MISMATCH: optimized code changes the result\n", kernel.name);
+      failed = true;
+      continue;
+    }
+
+    time_word(vm, orig.wid, runs / 10 + 1);
+    time_word(vm, opt.wid, runs / 10 + 1);
+    double ns = time_word(vm, orig.wid, runs);
+    double ns_opt = time_word(vm, opt.wid, runs);
+    std::printf("%-11s %4d -> %-4d %4u -> %-4u %10.1f %10.1f %7.2fx\n", kernel.name,
+                orig.insns, opt.insns, static_cast<unsigned>(orig.code.size()),
+                static_cast<unsigned>(opt.code.size()), ns, ns_opt,
+                ns_opt > 0 ? ns / ns_opt : 0.0);
+  }
+
+  std::printf("\n%u/%u words rewritten: %u -> %u instructions, %u -> %u bytes "
+              "(%u folded, %u removed)\n\n",
+              static_cast<unsigned>(stats.optimized), static_cast<unsigned>(stats.words),
+              static_cast<unsigned>(stats.insns_before),
+              static_cast<unsigned>(stats.insns_after),
+              static_cast<unsigned>(stats.bytes_before),
+              static_cast<unsigned>(stats.bytes_after),
+              static_cast<unsigned>(stats.folded), static_cast<unsigned>(stats.removed));
+
+  scan_vm_bench(pairs);
+  if (pairs != nullptr)
+  {
+    pairs->print(12);
+    delete pairs;
+  }
+
+  vm_destroy(vm);
+  if (failed)
+  {
+    std::fprintf(stderr, "ERROR: peephole benchmark failed\n");
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,85 @@
+/**
+ * @file sched_bench.cpp
+ * @brief Multi-VM scheduler run (Linux host)
+ *
+ * Runs the programs shared with the v4-multi-vm example under a
+ * VmScheduler for a fixed time, sleeping whenever no VM is due, and prints
+ * per-VM CPU share and scheduling latency as CSV. Exits with failure if a
+ * VM faults or a sleeping VM never got to run.
+ *
+ * Usage: sched_bench [run_ms]
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include "multi_vm.hpp"
+
+namespace
+{
+
+constexpr size_t VM_MEM_SIZE = 4096;
+
+uint64_t steady_us()
+{
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                                   std::chrono::steady_clock::now().time_since_epoch())
+                                   .count());
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  int run_ms = (argc > 1) ? std::atoi(argv[1]) : 1000;
+  if (run_ms < 1)
+  {
+    std::fprintf(stderr, "Usage: %s [run_ms]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  static uint8_t vm_pool[v4ports::VM_SCHED_MAX * VM_MEM_SIZE];
+  v4ports::VmScheduler sched(vm_pool, sizeof(vm_pool), VM_MEM_SIZE, steady_us);
+  size_t count;
+  const v4ports::VmTaskConfig* tasks = v4ports::multi_vm_tasks(count);
+  for (size_t i = 0; i < count; i++)
+  {
+    int id = sched.add(tasks[i]);
+    if (id < 0)
+    {
+      std::fprintf(stderr, "Failed to add VM %s: %d\n", tasks[i].name, id);
+      return EXIT_FAILURE;
+    }
+  }
+
+  uint64_t end = steady_us() + static_cast<uint64_t>(run_ms) * 1000;
+  while (true)
+  {
+    uint64_t due = sched.run_once();
+    uint64_t now = steady_us();
+    if (now >= end)
+    {
+      break;
+    }
+    if (due > now)
+    {
+      std::this_thread::sleep_for(std::chrono::microseconds((due < end ? due : end) - now));
+    }
+  }
+
+  v4ports::multi_vm_print(sched);
+
+  bool ok = true;
+  for (size_t i = 0; i < count; i++)
+  {
+    v4ports::VmTaskStats s = sched.stats(static_cast<int>(i));
+    ok = ok && s.state != v4ports::VmTaskState::FAULTED && s.slices > 0;
+  }
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
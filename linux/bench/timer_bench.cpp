@@ -0,0 +1,277 @@
+/**
+ * @file timer_bench.cpp
+ * @brief Timer wheel operation cost and timer scheduler jitter (Linux host)
+ *
+ * Two parts:
+ * - wheel: arms N timers with random deadlines, cancels half of them and
+ *   advances through the rest, for several N; insert and cancel should
+ *   cost the same whatever N is. Every timer must expire exactly on its
+ *   tick, in tick order, and no cancelled timer may expire.
+ * - sched: TIMER_MAX periodic words with periods of 1 .. TIMER_MAX ms
+ *   share one VM under a TimerScheduler for a fixed time, sleeping until
+ *   the next deadline; each word counts its runs in VM memory. Prints
+ *   lateness and jitter per period group.
+ * Exits with failure if the wheel misfires, a word faults, or a word's
+ * count does not match its deadlines.
+ *
+ * Usage: timer_bench [run_ms]
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "v4_timer.hpp"
+
+using v4ports::TimerNode;
+using v4ports::TimerScheduler;
+using v4ports::TimerStats;
+using v4ports::TimerWheel;
+
+namespace
+{
+
+constexpr size_t VM_MEM_SIZE = 4096;
+
+uint64_t steady_us()
+{
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                                   std::chrono::steady_clock::now().time_since_epoch())
+                                   .count());
+}
+
+double elapsed_ns(std::chrono::steady_clock::time_point t0)
+{
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0)
+      .count();
+}
+
+struct WheelCheck
+{
+  const TimerWheel* wheel;
+  const TimerNode* nodes;
+  const std::vector<bool>* cancelled;
+  uint32_t last;
+  size_t expired;
+  size_t misfired;
+  size_t out_of_order;
+};
+
+void on_wheel_expire(TimerNode& node, void* user)
+{
+  WheelCheck* check = static_cast<WheelCheck*>(user);
+  if (node.expires != check->wheel->now())
+  {
+    check->misfired++;
+  }
+  if (static_cast<int32_t>(node.expires - check->last) < 0)
+  {
+    check->out_of_order++;
+  }
+  if ((*check->cancelled)[static_cast<size_t>(&node - check->nodes)])
+  {
+    check->misfired++;
+  }
+  check->last = node.expires;
+  check->expired++;
+}
+
+bool run_wheel(size_t n, std::mt19937& rng)
+{
+  std::vector<TimerNode> nodes(n);
+  std::vector<bool> cancelled(n, false);
+  // Start near the 32-bit wrap so deadlines cross it
+  uint32_t start = 0xFFFFFFFFu - 5000;
+  TimerWheel wheel(start);
+  std::uniform_int_distribution<uint32_t> delay(1, 1u << 20);
+
+  auto t0 = std::chrono::steady_clock::now();
+  for (TimerNode& node : nodes)
+  {
+    wheel.insert(node, start + delay(rng));
+  }
+  double insert_ns = elapsed_ns(t0) / n;
+
+  t0 = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < n; i += 2)
+  {
+    wheel.cancel(nodes[i]);
+    cancelled[i] = true;
+  }
+  double cancel_ns = elapsed_ns(t0) / ((n + 1) / 2);
+
+  WheelCheck check = {&wheel, nodes.data(), &cancelled, start, 0, 0, 0};
+  t0 = std::chrono::steady_clock::now();
+  while (wheel.size() > 0)
+  {
+    wheel.advance(wheel.next_expiry(), on_wheel_expire, &check);
+  }
+  double advance_ms = elapsed_ns(t0) / 1e6;
+
+  size_t still_linked = 0;
+  for (size_t i = 0; i < n; i++)
+  {
+    still_linked += TimerWheel::linked(nodes[i]) ? 1 : 0;
+  }
+  bool ok = check.expired == n - (n + 1) / 2 && check.misfired == 0 &&
+            check.out_of_order == 0 && still_linked == 0;
+  std::printf("%7u timers: insert %5.1f ns, cancel %5.1f ns, expire all %7.2f ms "
+              "(%u ticks), %u misfired: %s\n",
+              static_cast<unsigned>(n), insert_ns, cancel_ns, advance_ms,
+              static_cast<unsigned>(wheel.now() - start),
+              static_cast<unsigned>(check.misfired + check.out_of_order),
+              ok ? "ok" : "FAIL");
+  return ok;
+}
+
+// ( -- ) add 1 to the cell at addr
+#define COUNT_WORD(addr)                                                      \
+  {                                                                           \
+    0x76, addr, 0x30, 0x74, 0x10, 0x76, addr, 0x31, 0x51                      \
+  }
+
+bool run_sched(uint32_t run_ms)
+{
+  static uint8_t vm_mem[VM_MEM_SIZE];
+  std::memset(vm_mem, 0, sizeof(vm_mem));
+  VmConfig cfg = {
+      .mem = vm_mem,
+      .mem_size = static_cast<uint32_t>(sizeof(vm_mem)),
+      .mmio = nullptr,
+      .mmio_count = 0,
+      .arena = nullptr,
+  };
+  Vm* vm = vm_create(&cfg);
+  if (vm == nullptr)
+  {
+    std::fprintf(stderr, "timer_bench: cannot create VM\n");
+    return false;
+  }
+
+  TimerScheduler timers(vm, steady_us);
+  // V4 runs word code in place, so it stays in static storage
+  static uint8_t code[v4ports::TIMER_MAX][9];
+  static char names[v4ports::TIMER_MAX][8];
+  int ids[v4ports::TIMER_MAX];
+  for (size_t i = 0; i < v4ports::TIMER_MAX; i++)
+  {
+    uint8_t addr = static_cast<uint8_t>(i * 4);
+    const uint8_t word[] = COUNT_WORD(addr);
+    std::memcpy(code[i], word, sizeof(word));
+    std::snprintf(names[i], sizeof(names[i]), "t%u", static_cast<unsigned>(i + 1));
+    int wid = vm_register_word(vm, names[i], code[i], sizeof(code[i]));
+    uint32_t period = static_cast<uint32_t>(i + 1);
+    ids[i] = timers.every(names[i], wid, period, period);
+    if (ids[i] < 0)
+    {
+      std::fprintf(stderr, "timer_bench: cannot arm %s: %d\n", names[i], ids[i]);
+      vm_destroy(vm);
+      return false;
+    }
+  }
+
+  uint64_t end = steady_us() + static_cast<uint64_t>(run_ms) * 1000;
+  uint32_t wakeups = 0;
+  while (true)
+  {
+    uint64_t due = timers.run_once();
+    wakeups++;
+    uint64_t now = steady_us();
+    if (now >= end)
+    {
+      break;
+    }
+    if (due > now)
+    {
+      std::this_thread::sleep_for(std::chrono::microseconds(due - now));
+    }
+  }
+
+  uint32_t elapsed_ms = static_cast<uint32_t>(timers.elapsed_us() / 1000);
+
+  // Group periods 1-4, 5-8, ... so the table stays short
+  constexpr size_t GROUP = 4;
+  uint32_t total_runs = 0;
+  uint32_t total_missed = 0;
+  bool ok = true;
+  std::printf("periods   runs  missed  late_avg_us  late_max_us  jitter_max_us\n");
+  for (size_t g = 0; g < v4ports::TIMER_MAX; g += GROUP)
+  {
+    uint32_t runs = 0;
+    uint32_t missed = 0;
+    uint64_t late_sum = 0;
+    uint32_t late_max = 0;
+    uint32_t jitter_max = 0;
+    for (size_t i = g; i < g + GROUP; i++)
+    {
+      TimerStats s = timers.stats(ids[i]);
+      uint32_t count;
+      std::memcpy(&count, vm_mem + i * 4, sizeof(count));
+      // One deadline per period since arming; missed ones are skipped
+      uint32_t deadlines = elapsed_ms / s.period_ms;
+      if (!s.armed || s.last_error != 0 || count != s.runs ||
+          s.runs + s.missed + 1 < deadlines || s.runs + s.missed > deadlines + 1)
+      {
+        std::fprintf(stderr, "timer_bench: %s: %u runs + %u missed for %u deadlines\n",
+                     s.name, static_cast<unsigned>(s.runs),
+                     static_cast<unsigned>(s.missed), static_cast<unsigned>(deadlines));
+        ok = false;
+      }
+      runs += s.runs;
+      missed += s.missed;
+      late_sum += s.late_sum_us;
+      late_max = (s.late_max_us > late_max) ? s.late_max_us : late_max;
+      jitter_max = (s.jitter_max_us > jitter_max) ? s.jitter_max_us : jitter_max;
+    }
+    std::printf("%2u-%-2u  %7u  %6u  %11.1f  %11u  %13u\n", static_cast<unsigned>(g + 1),
+                static_cast<unsigned>(g + GROUP), static_cast<unsigned>(runs),
+                static_cast<unsigned>(missed),
+                (runs > 0) ? static_cast<double>(late_sum) / runs : 0.0,
+                static_cast<unsigned>(late_max), static_cast<unsigned>(jitter_max));
+    total_runs += runs;
+    total_missed += missed;
+  }
+  std::printf("sched: %u timers on one VM for %u ms, %u word runs in %u wakeups, "
+              "%u missed\n",
+              static_cast<unsigned>(v4ports::TIMER_MAX), static_cast<unsigned>(run_ms),
+              static_cast<unsigned>(total_runs), static_cast<unsigned>(wakeups),
+              static_cast<unsigned>(total_missed));
+  vm_destroy(vm);
+  return ok;
+}
+
+#undef COUNT_WORD
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  long run_ms = (argc > 1) ? std::atol(argv[1]) : 2000;
+  if (run_ms < 100 || run_ms > 3600000)
+  {
+    std::fprintf(stderr, "Usage: %s [run_ms]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  std::mt19937 rng(1);
+  bool ok = true;
+  for (size_t n : {64, 1024, 16384, 262144})
+  {
+    ok = run_wheel(n, rng) && ok;
+  }
+  ok = run_sched(static_cast<uint32_t>(run_ms)) && ok;
+  if (!ok)
+  {
+    std::fprintf(stderr, "ERROR: timers misfired or miscounted\n");
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
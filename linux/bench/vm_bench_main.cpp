@@ -0,0 +1,59 @@
+/**
+ * @file vm_bench_main.cpp
+ * @brief V4 VM interpreter benchmark suite (Linux host)
+ *
+ * Runs the kernels shared with the v4-vm-bench example and prints the
+ * results as CSV. Exits with failure if any kernel fails to compile, run
+ * or produce its expected result.
+ *
+ * Usage: vm_bench [min_ms_per_kernel]
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include "vm_bench.hpp"
+
+namespace
+{
+
+uint64_t steady_ns()
+{
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                   std::chrono::steady_clock::now().time_since_epoch())
+                                   .count());
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  int min_ms = (argc > 1) ? std::atoi(argv[1]) : 200;
+  if (min_ms < 1)
+  {
+    std::fprintf(stderr, "Usage: %s [min_ms_per_kernel]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  static uint8_t vm_memory[16 * 1024];
+  v4ports::VmBench bench(vm_memory, sizeof(vm_memory), steady_ns);
+  size_t count;
+  const v4ports::VmBenchKernel* kernels = v4ports::vm_bench_kernels(count);
+
+  bool ok = true;
+  v4ports::VmBench::print_header();
+  for (size_t i = 0; i < count; i++)
+  {
+    v4ports::VmBenchResult result =
+        bench.run(kernels[i], static_cast<uint64_t>(min_ms) * 1000000u);
+    v4ports::VmBench::print(result);
+    ok = ok && result.ok;
+  }
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,26 @@
+/**
+ * @file esp_log.h
+ * @brief Minimal ESP-IDF logging shim for Linux host builds
+ *
+ * Lets portable component sources keep using ESP_LOGx. Output goes to
+ * stderr so stdout stays free for link traffic in --stdio mode.
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#ifndef V4_PORTS_LINUX_ESP_LOG_H
+#define V4_PORTS_LINUX_ESP_LOG_H
+
+#include <stdio.h>
+
+#define V4_HOST_LOG(level, tag, fmt, ...) \
+  fprintf(stderr, level " (%s) " fmt "\n", tag, ##__VA_ARGS__)
+
+#define ESP_LOGE(tag, fmt, ...) V4_HOST_LOG("E", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) V4_HOST_LOG("W", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) V4_HOST_LOG("I", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...) ((void)(tag))
+#define ESP_LOGV(tag, fmt, ...) ((void)(tag))
+
+#endif  // V4_PORTS_LINUX_ESP_LOG_H
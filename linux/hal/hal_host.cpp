@@ -0,0 +1,394 @@
+/**
+ * @file hal_host.cpp
+ * @brief Simulated V4 HAL for Linux host builds
+ *
+ * Backs the V4 HAL C API with virtual GPIO pins, a waveform log and a real
+ * or virtual clock, so the VM (including its SYS path) and HAL-dependent
+ * examples run natively. See hal_host.h.
+ *
+ * Pin levels and the clock are atomics, so the hot GPIO and clock paths
+ * take no lock unless the waveform log is recording.
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <new>
+
+#include "hal_host.h"
+#include "v4/hal.h"
+
+namespace
+{
+
+std::atomic<int> pin_modes[HAL_HOST_GPIO_PINS];
+std::atomic<int> pin_levels[HAL_HOST_GPIO_PINS];
+
+uint64_t monotonic_us()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000u +
+         static_cast<uint64_t>(ts.tv_nsec) / 1000u;
+}
+
+std::atomic<int> clock_source{HAL_HOST_CLOCK_REAL};
+std::atomic<uint64_t> boot_us{monotonic_us()};
+std::atomic<uint64_t> virtual_us{0};
+
+uint64_t now_us()
+{
+  if (clock_source.load(std::memory_order_relaxed) == HAL_HOST_CLOCK_VIRTUAL)
+  {
+    return virtual_us.load(std::memory_order_relaxed);
+  }
+  return monotonic_us() - boot_us.load(std::memory_order_relaxed);
+}
+
+bool valid_pin(int pin)
+{
+  return pin >= 0 && pin < HAL_HOST_GPIO_PINS;
+}
+
+// Waveform log and clock limit
+std::mutex sim_mutex;
+std::atomic<bool> recording{false};
+hal_host_wave_event_t* wave_log = nullptr;
+size_t wave_capacity = 0;
+size_t wave_count = 0;
+uint64_t limit_us = UINT64_MAX;
+void (*limit_hook)() = nullptr;
+
+void record_locked(int pin, int level)
+{
+  if (wave_count < wave_capacity)
+  {
+    wave_log[wave_count++] = {now_us(), static_cast<uint8_t>(pin),
+                              static_cast<uint8_t>(level)};
+  }
+}
+
+void set_level(int pin, int level)
+{
+  int previous = pin_levels[pin].exchange(level, std::memory_order_relaxed);
+  if (previous != level && recording.load(std::memory_order_relaxed))
+  {
+    std::lock_guard<std::mutex> lock(sim_mutex);
+    record_locked(pin, level);
+  }
+}
+
+// Calls the limit hook once time has reached the limit
+void check_limit()
+{
+  void (*hook)() = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(sim_mutex);
+    if (limit_hook != nullptr && now_us() >= limit_us)
+    {
+      hook = limit_hook;
+      limit_hook = nullptr;
+      limit_us = UINT64_MAX;
+    }
+  }
+  if (hook != nullptr)
+  {
+    hook();
+  }
+}
+
+// Virtual delays advance the clock, stopping at the limit
+void virtual_delay(uint64_t us)
+{
+  {
+    std::lock_guard<std::mutex> lock(sim_mutex);
+    uint64_t now = virtual_us.load(std::memory_order_relaxed);
+    uint64_t end = now + us;
+    if (limit_hook != nullptr && end > limit_us)
+    {
+      end = (limit_us > now) ? limit_us : now;
+    }
+    virtual_us.store(end, std::memory_order_relaxed);
+  }
+  check_limit();
+}
+
+// Real delays sleep on a condition variable so another thread can end them early
+std::mutex delay_mutex;
+std::condition_variable delay_cv;
+uint32_t delay_generation = 0;
+
+void interruptible_sleep(uint64_t us)
+{
+  {
+    std::lock_guard<std::mutex> lock(sim_mutex);
+    uint64_t now = now_us();
+    if (limit_hook != nullptr && now + us > limit_us)
+    {
+      us = (limit_us > now) ? limit_us - now : 0;
+    }
+  }
+  {
+    std::unique_lock<std::mutex> lock(delay_mutex);
+    uint32_t generation = delay_generation;
+    delay_cv.wait_for(lock, std::chrono::microseconds(us),
+                      [&] { return delay_generation != generation; });
+  }
+  check_limit();
+}
+
+void delay(uint64_t us)
+{
+  if (clock_source.load(std::memory_order_relaxed) == HAL_HOST_CLOCK_VIRTUAL)
+  {
+    virtual_delay(us);
+  }
+  else
+  {
+    interruptible_sleep(us);
+  }
+}
+
+}  // namespace
+
+extern "C"
+{
+  int hal_gpio_mode(int pin, hal_gpio_mode_t mode)
+  {
+    if (!valid_pin(pin))
+    {
+      return -1;
+    }
+    pin_modes[pin].store(static_cast<int>(mode), std::memory_order_relaxed);
+    return 0;
+  }
+
+  int hal_gpio_write(int pin, hal_gpio_value_t value)
+  {
+    if (!valid_pin(pin))
+    {
+      return -1;
+    }
+    set_level(pin, (value != HAL_GPIO_LOW) ? 1 : 0);
+    return 0;
+  }
+
+  int hal_gpio_read(int pin, hal_gpio_value_t* value)
+  {
+    if (!valid_pin(pin) || value == nullptr)
+    {
+      return -1;
+    }
+    *value = static_cast<hal_gpio_value_t>(pin_levels[pin].load(std::memory_order_relaxed));
+    return 0;
+  }
+
+  uint32_t hal_millis(void)
+  {
+    return static_cast<uint32_t>(now_us() / 1000u);
+  }
+
+  uint64_t hal_micros(void)
+  {
+    return now_us();
+  }
+
+  void hal_delay_ms(uint32_t ms)
+  {
+    delay(static_cast<uint64_t>(ms) * 1000u);
+  }
+
+  void hal_delay_us(uint32_t us)
+  {
+    delay(us);
+  }
+
+  void hal_host_abort_delay(void)
+  {
+    {
+      std::lock_guard<std::mutex> lock(delay_mutex);
+      delay_generation++;
+    }
+    delay_cv.notify_all();
+  }
+
+  void hal_host_clock_set(hal_host_clock_t clock)
+  {
+    std::lock_guard<std::mutex> lock(sim_mutex);
+    boot_us.store(monotonic_us(), std::memory_order_relaxed);
+    virtual_us.store(0, std::memory_order_relaxed);
+    clock_source.store(clock, std::memory_order_relaxed);
+  }
+
+  hal_host_clock_t hal_host_clock_get(void)
+  {
+    return static_cast<hal_host_clock_t>(clock_source.load(std::memory_order_relaxed));
+  }
+
+  void hal_host_clock_advance(uint64_t us)
+  {
+    if (clock_source.load(std::memory_order_relaxed) == HAL_HOST_CLOCK_VIRTUAL)
+    {
+      virtual_delay(us);
+    }
+  }
+
+  void hal_host_clock_limit(uint64_t limit, void (*hook)(void))
+  {
+    std::lock_guard<std::mutex> lock(sim_mutex);
+    limit_us = (hook != nullptr) ? limit : UINT64_MAX;
+    limit_hook = hook;
+  }
+
+  int hal_host_gpio_drive(int pin, hal_gpio_value_t value)
+  {
+    if (!valid_pin(pin))
+    {
+      return -1;
+    }
+    set_level(pin, (value != HAL_GPIO_LOW) ? 1 : 0);
+    return 0;
+  }
+
+  int hal_host_waveform_start(size_t capacity)
+  {
+    std::lock_guard<std::mutex> lock(sim_mutex);
+    delete[] wave_log;
+    wave_log = new (std::nothrow) hal_host_wave_event_t[capacity];
+    wave_capacity = (wave_log != nullptr) ? capacity : 0;
+    wave_count = 0;
+    if (wave_log == nullptr)
+    {
+      recording.store(false, std::memory_order_relaxed);
+      return -1;
+    }
+
+    for (int pin = 0; pin < HAL_HOST_GPIO_PINS; pin++)
+    {
+      if (pin_modes[pin].load(std::memory_order_relaxed) == HAL_GPIO_OUTPUT)
+      {
+        record_locked(pin, pin_levels[pin].load(std::memory_order_relaxed));
+      }
+    }
+    recording.store(true, std::memory_order_relaxed);
+    return 0;
+  }
+
+  void hal_host_waveform_stop(void)
+  {
+    std::lock_guard<std::mutex> lock(sim_mutex);
+    recording.store(false, std::memory_order_relaxed);
+    delete[] wave_log;
+    wave_log = nullptr;
+    wave_capacity = 0;
+    wave_count = 0;
+  }
+
+  size_t hal_host_waveform_count(void)
+  {
+    std::lock_guard<std::mutex> lock(sim_mutex);
+    return wave_count;
+  }
+
+  size_t hal_host_waveform_read(size_t first, hal_host_wave_event_t* out, size_t max)
+  {
+    std::lock_guard<std::mutex> lock(sim_mutex);
+    size_t n = 0;
+    for (size_t i = first; i < wave_count && n < max; i++)
+    {
+      out[n++] = wave_log[i];
+    }
+    return n;
+  }
+
+  int hal_host_waveform_write_vcd(const char* path)
+  {
+    std::lock_guard<std::mutex> lock(sim_mutex);
+    FILE* f = std::fopen(path, "w");
+    if (f == nullptr)
+    {
+      return -1;
+    }
+
+    // One wire per pin that changed; identifiers are printable characters
+    bool used[HAL_HOST_GPIO_PINS] = {};
+    for (size_t i = 0; i < wave_count; i++)
+    {
+      used[wave_log[i].pin] = true;
+    }
+
+    std::fprintf(f, "$timescale 1us $end\n$scope module gpio $end\n");
+    for (int pin = 0; pin < HAL_HOST_GPIO_PINS; pin++)
+    {
+      if (used[pin])
+      {
+        std::fprintf(f, "$var wire 1 %c gpio%d $end\n", '!' + pin, pin);
+      }
+    }
+    std::fprintf(f, "$upscope $end\n$enddefinitions $end\n");
+
+    uint64_t time = UINT64_MAX;
+    for (size_t i = 0; i < wave_count; i++)
+    {
+      const hal_host_wave_event_t& e = wave_log[i];
+      if (e.time_us != time)
+      {
+        time = e.time_us;
+        std::fprintf(f, "#%llu\n", static_cast<unsigned long long>(time));
+      }
+      std::fprintf(f, "%d%c\n", e.level, '!' + e.pin);
+    }
+
+    return (std::fclose(f) == 0) ? 0 : -1;
+  }
+
+  size_t hal_host_console_write(const char* data, size_t len)
+  {
+    size_t written = std::fwrite(data, 1, len, stdout);
+    std::fflush(stdout);
+    return written;
+  }
+
+  int hal_host_console_getc(uint32_t timeout_ms)
+  {
+    struct pollfd pfd = {STDIN_FILENO, POLLIN, 0};
+    int ready = poll(&pfd, 1, static_cast<int>(timeout_ms));
+    if (ready <= 0)
+    {
+      return -1;
+    }
+    unsigned char c;
+    ssize_t n = read(STDIN_FILENO, &c, 1);
+    if (n <= 0)
+    {
+      return -2;
+    }
+    return c;
+  }
+
+  int hal_host_console_read(char* data, size_t max, uint32_t timeout_ms)
+  {
+    struct pollfd pfd = {STDIN_FILENO, POLLIN, 0};
+    int ready = poll(&pfd, 1, static_cast<int>(timeout_ms));
+    if (ready <= 0)
+    {
+      return -1;
+    }
+    ssize_t n = read(STDIN_FILENO, data, max);
+    if (n <= 0)
+    {
+      return -2;
+    }
+    return static_cast<int>(n);
+  }
+}
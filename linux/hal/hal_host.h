@@ -0,0 +1,153 @@
+/**
+ * @file hal_host.h
+ * @brief Linux host extensions of the V4 HAL
+ *
+ * The host HAL simulates the board the HAL-dependent code normally runs on:
+ * - Virtual GPIO: pins keep their mode and level; input levels are driven
+ *   with hal_host_gpio_drive()
+ * - Waveform log: level changes are recorded with timestamps and can be
+ *   written as a VCD (Value Change Dump) file for any waveform viewer
+ * - Clock: the wall clock, or a virtual clock that only advances through
+ *   HAL delays and hal_host_clock_advance(), so delays take no real time
+ * - Console bridge: character I/O over stdin/stdout
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "v4/hal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Number of simulated GPIO pins */
+#define HAL_HOST_GPIO_PINS 64
+
+/**
+ * @brief Clock source of the host HAL
+ */
+typedef enum
+{
+  HAL_HOST_CLOCK_REAL = 0,    /**< Monotonic wall clock; delays sleep */
+  HAL_HOST_CLOCK_VIRTUAL = 1, /**< Virtual time; delays fast-forward it */
+} hal_host_clock_t;
+
+/**
+ * @brief One recorded GPIO level change
+ */
+typedef struct
+{
+  uint64_t time_us; /**< hal_micros() at the change */
+  uint8_t pin;
+  uint8_t level;
+} hal_host_wave_event_t;
+
+/**
+ * @brief End all hal_delay_ms() / hal_delay_us() calls in progress
+ *
+ * Used as the ExecWorker abort hook, so aborting a job does not wait for
+ * the delay it is sleeping in.
+ */
+void hal_host_abort_delay(void);
+
+/**
+ * @brief Select the clock source and restart time at 0
+ */
+void hal_host_clock_set(hal_host_clock_t clock);
+
+/**
+ * @brief Get the clock source
+ */
+hal_host_clock_t hal_host_clock_get(void);
+
+/**
+ * @brief Advance virtual time (no effect on the real clock)
+ */
+void hal_host_clock_advance(uint64_t us);
+
+/**
+ * @brief Call @p hook once time reaches @p limit_us
+ *
+ * Checked by HAL delays: a virtual delay that would pass the limit stops
+ * at it, then calls the hook. Meant to end simulations of programs that
+ * never return (e.g. by writing results and exiting). Pass NULL to clear.
+ */
+void hal_host_clock_limit(uint64_t limit_us, void (*hook)(void));
+
+/**
+ * @brief Drive the level seen by hal_gpio_read() on an input pin
+ *
+ * @return 0, or -1 for an invalid pin
+ */
+int hal_host_gpio_drive(int pin, hal_gpio_value_t value);
+
+/**
+ * @brief Start recording GPIO level changes
+ *
+ * The current level of every output pin is recorded first. Recording stops
+ * silently when @p capacity events are stored.
+ *
+ * @return 0, or -1 if the log could not be allocated
+ */
+int hal_host_waveform_start(size_t capacity);
+
+/**
+ * @brief Stop recording and free the log
+ */
+void hal_host_waveform_stop(void);
+
+/**
+ * @brief Get the number of recorded events
+ */
+size_t hal_host_waveform_count(void);
+
+/**
+ * @brief Copy recorded events starting at @p first
+ *
+ * @return Number of events copied
+ */
+size_t hal_host_waveform_read(size_t first, hal_host_wave_event_t* out, size_t max);
+
+/**
+ * @brief Write the recorded events as a VCD file (1 us timescale)
+ *
+ * @return 0, or -1 on I/O errors
+ */
+int hal_host_waveform_write_vcd(const char* path);
+
+/**
+ * @brief Console bridge: write bytes to stdout
+ *
+ * @return Number of bytes written
+ */
+size_t hal_host_console_write(const char* data, size_t len);
+
+/**
+ * @brief Console bridge: read one byte from stdin
+ *
+ * Waits up to @p timeout_ms of real time; input comes from outside the
+ * simulation, so the virtual clock does not apply.
+ *
+ * @return Byte (0-255), -1 on timeout, -2 at end of input
+ */
+int hal_host_console_getc(uint32_t timeout_ms);
+
+/**
+ * @brief Console bridge: read whatever stdin has, up to @p max bytes
+ *
+ * Waits like hal_host_console_getc() for the first byte only, so a pasted
+ * or piped block arrives in a few reads instead of one call per byte.
+ *
+ * @return Bytes read (> 0), -1 on timeout, -2 at end of input
+ */
+int hal_host_console_read(char* data, size_t max, uint32_t timeout_ms);
+
+#ifdef __cplusplus
+}
+#endif
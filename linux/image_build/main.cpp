@@ -0,0 +1,847 @@
+/**
+ * @file main.cpp
+ * @brief Ahead-of-time builder of linkable V4 bytecode images
+ *
+ * Compiles a Forth source tree with V4-front into one v4_image (see
+ * v4_image.h): every colon definition becomes a named word, and the
+ * top-level code of all files becomes the entry word run after loading.
+ *
+ * V4-front emits final word ids into the code, so references are found by
+ * compiling every definition twice with the known words registered under
+ * two different sets of ids. Bytes that differ between the two results are
+ * word id operands: a difference of REF_DELTA is a reference to a known
+ * word (identified by its id in the first compile), a difference of
+ * PAD_COUNT is a reference to the word being defined (V4-front numbers new
+ * words after the words already in its context, which the second compile
+ * pads). Anything else is rejected rather than guessed. Pads, imports and
+ * earlier words share V4-front's MAX_WORDS slots, so only a few pads are
+ * used; a reference to the word being defined then differs only in its low
+ * byte and is widened to a whole word id operand.
+ *
+ * Usage:
+ *   v4-image-build -o OUT [--import NAME]... [-O] [--list] [--check] PATH...
+ *
+ * PATH is a source file or a directory searched recursively for .fs, .fth,
+ * .4th and .f files (in name order). Words the device provides (native
+ * words, earlier images) are declared with --import and resolved by name
+ * when the image is loaded. -O runs the peephole optimizer of v4_repl over
+ * both compiles of every word before they are compared (words that call
+ * other words are left as compiled). --check loads the image into a host VM.
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "v4/vm_api.h"
+#include "v4_image.h"
+#include "v4_repl_peephole.h"
+#include "v4front/compile.h"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+// Word ids of the two probing compiles
+constexpr uint32_t IMPORT_BASE_A = 0x1111;
+constexpr uint32_t WORD_BASE_A = 0x2222;
+constexpr uint32_t REF_DELTA = 0x2222;
+constexpr uint32_t PAD_COUNT = 16;
+constexpr uint32_t PAD_BASE = 0x7000;
+constexpr size_t MAX_SYMBOLS = 0x1000;
+
+// Word slots of a V4-front context (its default MAX_WORDS, which the host
+// build keeps)
+constexpr size_t FRONT_MAX_WORDS = 256;
+
+// Bytes of a word id operand (the probing ids above need two)
+constexpr size_t WORD_ID_WIDTH = 2;
+
+constexpr uint8_t OP_RET = 0x51;
+
+struct Reloc
+{
+  uint32_t offset;  // Within the word's code
+  uint16_t target;
+  uint8_t kind;
+  uint8_t width;
+};
+
+struct ImageWord
+{
+  std::string name;  // Empty for the entry word
+  std::vector<uint8_t> code;
+  std::vector<Reloc> relocs;
+};
+
+struct Source
+{
+  std::vector<std::pair<std::string, std::string>> definitions;  // name, text
+  std::string top_level;
+};
+
+bool is_source_file(const fs::path& path)
+{
+  std::string ext = path.extension().string();
+  return ext == ".fs" || ext == ".fth" || ext == ".4th" || ext == ".f";
+}
+
+bool collect_files(const char* arg, std::vector<fs::path>& files)
+{
+  std::error_code ec;
+  fs::path path(arg);
+  if (fs::is_directory(path, ec))
+  {
+    std::vector<fs::path> found;
+    for (const auto& entry : fs::recursive_directory_iterator(path, ec))
+    {
+      if (entry.is_regular_file() && is_source_file(entry.path()))
+      {
+        found.push_back(entry.path());
+      }
+    }
+    std::sort(found.begin(), found.end());
+    files.insert(files.end(), found.begin(), found.end());
+    return !ec;
+  }
+  if (!fs::is_regular_file(path, ec))
+  {
+    std::fprintf(stderr, "v4-image-build: %s: no such file or directory\n", arg);
+    return false;
+  }
+  files.push_back(path);
+  return true;
+}
+
+bool read_file(const fs::path& path, std::string& text)
+{
+  std::ifstream in(path, std::ios::binary);
+  if (!in)
+  {
+    std::fprintf(stderr, "v4-image-build: cannot read %s\n", path.c_str());
+    return false;
+  }
+  text.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  return true;
+}
+
+// Split source into colon definitions and top-level code. Only as much
+// Forth is understood as needed to find definition boundaries: comments are
+// dropped and string literals are kept whole, so a ';' inside them is not
+// taken as the end of a definition.
+bool split_source(const std::string& text, const fs::path& path, Source& out)
+{
+  size_t pos = 0;
+  bool in_def = false;
+  std::string def_name;
+  std::string def_text;
+
+  auto skip_space = [&]
+  {
+    while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos])))
+    {
+      pos++;
+    }
+  };
+  auto next_token = [&](size_t& start) -> std::string
+  {
+    skip_space();
+    start = pos;
+    while (pos < text.size() && !std::isspace(static_cast<unsigned char>(text[pos])))
+    {
+      pos++;
+    }
+    return text.substr(start, pos - start);
+  };
+  auto skip_to = [&](char end)
+  {
+    size_t found = text.find(end, pos);
+    pos = (found == std::string::npos) ? text.size() : found + 1;
+  };
+
+  while (true)
+  {
+    size_t start;
+    std::string token = next_token(start);
+    if (token.empty())
+    {
+      break;
+    }
+
+    std::string upper = token;
+    std::transform(upper.begin(), upper.end(), upper.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+
+    if (token == "\\")
+    {
+      skip_to('\n');
+      continue;
+    }
+    if (token == "(")
+    {
+      skip_to(')');
+      continue;
+    }
+    if (upper == ".(")
+    {
+      skip_to(')');
+    }
+    else if (upper == ".\"" || upper == "S\"")
+    {
+      skip_to('"');
+    }
+    else if (token == ":" && !in_def)
+    {
+      size_t name_start;
+      def_name = next_token(name_start);
+      if (def_name.empty())
+      {
+        std::fprintf(stderr, "v4-image-build: %s: ':' without a name\n", path.c_str());
+        return false;
+      }
+      in_def = true;
+      def_text = ": " + def_name;
+      continue;
+    }
+    else if (token == ";" && in_def)
+    {
+      out.definitions.emplace_back(def_name, def_text + " ;\n");
+      in_def = false;
+      continue;
+    }
+
+    std::string& dest = in_def ? def_text : out.top_level;
+    dest.push_back(in_def ? ' ' : '\n');
+    dest.append(text, start, pos - start);
+  }
+
+  if (in_def)
+  {
+    std::fprintf(stderr, "v4-image-build: %s: definition of '%s' is not terminated\n",
+                 path.c_str(), def_name.c_str());
+    return false;
+  }
+  return true;
+}
+
+// Compile @p source with imports and earlier words registered under one
+// set of ids (second == false) or the other (second == true)
+bool compile(const std::string& source, const std::vector<std::string>& imports,
+             const std::vector<ImageWord>& words, bool second, V4FrontBuf& buf)
+{
+  V4FrontContext* ctx = v4front_context_create();
+  if (ctx == nullptr)
+  {
+    return false;
+  }
+
+  bool ok = true;
+  char pad_name[32];
+  if (second)
+  {
+    for (uint32_t p = 0; ok && p < PAD_COUNT; p++)
+    {
+      std::snprintf(pad_name, sizeof(pad_name), "__v4image_pad%u", (unsigned)p);
+      ok = v4front_context_register_word(ctx, pad_name,
+                                         static_cast<int>(PAD_BASE + p)) == 0;
+    }
+  }
+  uint32_t delta = second ? REF_DELTA : 0;
+  for (size_t k = 0; ok && k < imports.size(); k++)
+  {
+    ok = v4front_context_register_word(ctx, imports[k].c_str(),
+                                       static_cast<int>(IMPORT_BASE_A + delta + k)) == 0;
+  }
+  for (size_t i = 0; ok && i < words.size(); i++)
+  {
+    ok = v4front_context_register_word(ctx, words[i].name.c_str(),
+                                       static_cast<int>(WORD_BASE_A + delta + i)) == 0;
+  }
+  if (!ok)
+  {
+    std::fprintf(stderr, "v4-image-build: V4-front context rejected the probing ids\n");
+    v4front_context_destroy(ctx);
+    return false;
+  }
+
+  V4FrontError error = {};
+  buf = {};
+  if (v4front_compile_with_context_ex(ctx, source.c_str(), &buf, &error) != 0)
+  {
+    char msg[512];
+    v4front_format_error(&error, source.c_str(), msg, sizeof(msg));
+    std::fprintf(stderr, "%s", msg);
+    ok = false;
+  }
+  v4front_context_destroy(ctx);
+  return ok;
+}
+
+// Check that the second compile fits a V4-front context: the pads, the
+// imports and @p words words (including the one being defined)
+bool front_has_room(size_t imports, size_t words)
+{
+  if (PAD_COUNT + imports + words <= FRONT_MAX_WORDS)
+  {
+    return true;
+  }
+  std::fprintf(stderr,
+               "v4-image-build: %u imports and %u words exceed V4-front's MAX_WORDS "
+               "(%u, of which %u are taken by probing)\n",
+               static_cast<unsigned>(imports), static_cast<unsigned>(words),
+               static_cast<unsigned>(FRONT_MAX_WORDS), static_cast<unsigned>(PAD_COUNT));
+  return false;
+}
+
+uint32_t get_le(const uint8_t* p, size_t width)
+{
+  uint32_t v = 0;
+  for (size_t b = width; b-- > 0;)
+  {
+    v = (v << 8) | p[b];
+  }
+  return v;
+}
+
+// Find the word id operands of one word from its two compiles
+bool find_relocs(const uint8_t* a, const uint8_t* b, size_t len, size_t imports,
+                 size_t self, ImageWord& word)
+{
+  size_t i = 0;
+  while (i < len)
+  {
+    if (a[i] == b[i])
+    {
+      i++;
+      continue;
+    }
+    size_t start = i;
+    while (i < len && a[i] != b[i])
+    {
+      i++;
+    }
+    size_t width = i - start;
+    uint32_t va = (width <= 4) ? get_le(a + start, width) : 0;
+    uint32_t vb = (width <= 4) ? get_le(b + start, width) : 0;
+
+    Reloc r = {static_cast<uint32_t>(start), 0, 0, static_cast<uint8_t>(width)};
+    if (width <= 4 && vb - va == REF_DELTA && va >= IMPORT_BASE_A &&
+        va < IMPORT_BASE_A + imports)
+    {
+      r.kind = V4_IMAGE_RELOC_IMPORT;
+      r.target = static_cast<uint16_t>(va - IMPORT_BASE_A);
+    }
+    else if (width <= 4 && vb - va == REF_DELTA && va >= WORD_BASE_A &&
+             va < WORD_BASE_A + self)
+    {
+      r.kind = V4_IMAGE_RELOC_WORD;
+      r.target = static_cast<uint16_t>(va - WORD_BASE_A);
+    }
+    else if (width <= 4 && vb - va == PAD_COUNT && !word.name.empty())
+    {
+      r.kind = V4_IMAGE_RELOC_WORD;
+      r.target = static_cast<uint16_t>(self);
+      // Only the low byte changed; the rest of the operand follows it
+      if (width < WORD_ID_WIDTH && start + WORD_ID_WIDTH <= len)
+      {
+        r.width = WORD_ID_WIDTH;
+        i = start + WORD_ID_WIDTH;
+      }
+    }
+    else
+    {
+      std::fprintf(stderr,
+                   "v4-image-build: '%s': code at offset %u depends on word ids in an "
+                   "unknown way\n",
+                   word.name.empty() ? "(top level)" : word.name.c_str(),
+                   static_cast<unsigned>(start));
+      return false;
+    }
+    word.relocs.push_back(r);
+  }
+  return true;
+}
+
+// Optimize both compiles of a word; either both are replaced or neither
+void optimize_pair(const uint8_t*& code_a, const uint8_t*& code_b, size_t& len,
+                   std::vector<uint8_t>& opt_a, std::vector<uint8_t>& opt_b,
+                   V4PeepholeStats* stats)
+{
+  opt_a.resize(len);
+  opt_b.resize(len);
+  V4PeepholeStats trial = {};
+  int n_a = v4_peephole_word(code_a, len, opt_a.data(), len, &trial);
+  int n_b = v4_peephole_word(code_b, len, opt_b.data(), len, nullptr);
+  if (n_a > 0 && n_a == n_b)
+  {
+    code_a = opt_a.data();
+    code_b = opt_b.data();
+    len = static_cast<size_t>(n_a);
+  }
+  else if (n_a > 0)
+  {
+    // The two compiles optimize differently: keep both, count the word as kept
+    trial.optimized = 0;
+    trial.insns_after = trial.insns_before;
+    trial.bytes_after = trial.bytes_before;
+    trial.folded = 0;
+    trial.removed = 0;
+  }
+  stats->words += trial.words;
+  stats->optimized += trial.optimized;
+  stats->unsupported += trial.unsupported;
+  stats->insns_before += trial.insns_before;
+  stats->insns_after += trial.insns_after;
+  stats->bytes_before += trial.bytes_before;
+  stats->bytes_after += trial.bytes_after;
+  stats->folded += trial.folded;
+  stats->removed += trial.removed;
+}
+
+// Compile one definition (or the top-level code) into @p word, optimizing it
+// when @p opt is set
+bool build_word(const std::string& source, const std::vector<std::string>& imports,
+                const std::vector<ImageWord>& words, V4PeepholeStats* opt,
+                ImageWord& word)
+{
+  V4FrontBuf a;
+  V4FrontBuf b;
+  if (!compile(source, imports, words, false, a))
+  {
+    return false;
+  }
+  if (!compile(source, imports, words, true, b))
+  {
+    v4front_free(&a);
+    return false;
+  }
+
+  bool entry = word.name.empty();
+  const uint8_t* code_a = nullptr;
+  const uint8_t* code_b = nullptr;
+  size_t len_a = 0;
+  size_t len_b = 0;
+  bool ok = true;
+  if (entry)
+  {
+    ok = a.word_count == 0 && b.word_count == 0;
+    code_a = a.data;
+    code_b = b.data;
+    len_a = a.size;
+    len_b = b.size;
+  }
+  else
+  {
+    ok = a.word_count == 1 && b.word_count == 1 && a.size == 0;
+    if (ok)
+    {
+      code_a = a.words[0].code;
+      code_b = b.words[0].code;
+      len_a = a.words[0].code_len;
+      len_b = b.words[0].code_len;
+      word.name = a.words[0].name;
+    }
+  }
+  if (!ok)
+  {
+    std::fprintf(stderr, "v4-image-build: '%s': expected exactly one definition\n",
+                 entry ? "(top level)" : word.name.c_str());
+  }
+  else if (len_a != len_b)
+  {
+    std::fprintf(stderr,
+                 "v4-image-build: '%s': code size depends on word ids, cannot relocate\n",
+                 entry ? "(top level)" : word.name.c_str());
+    ok = false;
+  }
+  else
+  {
+    std::vector<uint8_t> opt_a;
+    std::vector<uint8_t> opt_b;
+    if (opt != nullptr)
+    {
+      optimize_pair(code_a, code_b, len_a, opt_a, opt_b, opt);
+    }
+    ok = find_relocs(code_a, code_b, len_a, imports.size(), words.size(), word);
+    word.code.assign(code_a, code_a + len_a);
+    if (entry)
+    {
+      word.code.push_back(OP_RET);
+    }
+  }
+
+  v4front_free(&a);
+  v4front_free(&b);
+  return ok;
+}
+
+void put_u16(std::vector<uint8_t>& out, uint32_t v)
+{
+  out.push_back(static_cast<uint8_t>(v));
+  out.push_back(static_cast<uint8_t>(v >> 8));
+}
+
+void put_u32(std::vector<uint8_t>& out, uint32_t v)
+{
+  put_u16(out, v);
+  put_u16(out, v >> 16);
+}
+
+// Serialize the image, keeping only the imports that are referenced
+bool write_image(const std::vector<ImageWord>& words, bool has_entry,
+                 const std::vector<std::string>& all_imports, std::vector<uint8_t>& image,
+                 std::vector<std::string>& imports)
+{
+  std::vector<int> import_index(all_imports.size(), -1);
+  for (const ImageWord& w : words)
+  {
+    for (const Reloc& r : w.relocs)
+    {
+      if (r.kind == V4_IMAGE_RELOC_IMPORT && import_index[r.target] < 0)
+      {
+        import_index[r.target] = static_cast<int>(imports.size());
+        imports.push_back(all_imports[r.target]);
+      }
+    }
+  }
+
+  // Offset 0 is the empty name of the entry word
+  std::vector<uint8_t> strings(1, 0);
+  auto add_string = [&](const std::string& s)
+  {
+    uint32_t off = static_cast<uint32_t>(strings.size());
+    strings.insert(strings.end(), s.begin(), s.end());
+    strings.push_back(0);
+    return off;
+  };
+
+  std::vector<uint8_t> words_table;
+  std::vector<uint8_t> relocs_table;
+  std::vector<uint8_t> code;
+  size_t reloc_count = 0;
+  for (const ImageWord& w : words)
+  {
+    if (w.code.size() > 0xFFFF)
+    {
+      std::fprintf(stderr, "v4-image-build: '%s' is too large\n", w.name.c_str());
+      return false;
+    }
+    uint32_t code_off = static_cast<uint32_t>(code.size());
+    put_u16(words_table, w.name.empty() ? 0 : add_string(w.name));
+    put_u16(words_table, static_cast<uint32_t>(w.code.size()));
+    put_u32(words_table, code_off);
+    for (const Reloc& r : w.relocs)
+    {
+      uint32_t target = (r.kind == V4_IMAGE_RELOC_IMPORT)
+                            ? static_cast<uint32_t>(import_index[r.target])
+                            : r.target;
+      put_u32(relocs_table, code_off + r.offset);
+      put_u16(relocs_table, target);
+      relocs_table.push_back(r.kind);
+      relocs_table.push_back(r.width);
+      reloc_count++;
+    }
+    code.insert(code.end(), w.code.begin(), w.code.end());
+  }
+
+  std::vector<uint8_t> imports_table;
+  for (const std::string& name : imports)
+  {
+    put_u16(imports_table, add_string(name));
+  }
+  if (strings.size() > 0xFFFF || reloc_count > 0xFFFF)
+  {
+    std::fprintf(stderr, "v4-image-build: too many names or references\n");
+    return false;
+  }
+
+  std::vector<uint8_t> payload;
+  for (const auto* section :
+       {&words_table, &imports_table, &relocs_table, &strings, &code})
+  {
+    payload.insert(payload.end(), section->begin(), section->end());
+  }
+
+  image.clear();
+  put_u32(image, V4_IMAGE_MAGIC);
+  put_u16(image, V4_IMAGE_VERSION);
+  put_u16(image, 0);
+  put_u16(image, static_cast<uint32_t>(words.size()));
+  put_u16(image, static_cast<uint32_t>(imports.size()));
+  put_u16(image, static_cast<uint32_t>(reloc_count));
+  put_u16(image, has_entry ? static_cast<uint32_t>(words.size() - 1) : V4_IMAGE_NO_ENTRY);
+  put_u32(image, static_cast<uint32_t>(strings.size()));
+  put_u32(image, static_cast<uint32_t>(code.size()));
+  put_u32(image, static_cast<uint32_t>(payload.size()));
+  put_u32(image, v4_image_crc32(0, payload.data(), payload.size()));
+  image.insert(image.end(), payload.begin(), payload.end());
+  return true;
+}
+
+// Imports resolve to RET words in the --check VM
+struct CheckImports
+{
+  Vm* vm;
+  const std::vector<std::string>* names;
+  std::vector<int> wids;
+};
+
+int check_resolve(void* user, const char* name)
+{
+  CheckImports* ci = static_cast<CheckImports*>(user);
+  for (size_t k = 0; k < ci->names->size(); k++)
+  {
+    if ((*ci->names)[k] == name)
+    {
+      return ci->wids[k];
+    }
+  }
+  return -1;
+}
+
+bool check_image(const std::vector<uint8_t>& image,
+                 const std::vector<std::string>& imports)
+{
+  static const uint8_t STUB[] = {OP_RET};
+  static uint8_t vm_memory[16 * 1024];
+  VmConfig cfg = {
+      .mem = vm_memory,
+      .mem_size = static_cast<uint32_t>(sizeof(vm_memory)),
+      .mmio = nullptr,
+      .mmio_count = 0,
+      .arena = nullptr,
+  };
+  Vm* vm = vm_create(&cfg);
+  if (vm == nullptr)
+  {
+    return false;
+  }
+
+  // Occupy a few ids first so the image does not load at the ids it was
+  // probed with by accident
+  CheckImports ci = {vm, &imports, {}};
+  for (int i = 0; i < 3; i++)
+  {
+    vm_register_word(vm, nullptr, STUB, sizeof(STUB));
+  }
+  for (const std::string& name : imports)
+  {
+    ci.wids.push_back(vm_register_word(vm, name.c_str(), STUB, sizeof(STUB)));
+  }
+
+  V4ImageInfo info;
+  v4_image_parse(image.data(), image.size(), &info);
+  std::vector<uint8_t> store(info.resident_size);
+  std::vector<int> wids(info.word_count);
+  int n = v4_image_load(vm, image.data(), image.size(), store.data(), store.size(),
+                        check_resolve, &ci, wids.data(), wids.size());
+  vm_destroy(vm);
+  if (n < 0)
+  {
+    std::fprintf(stderr, "v4-image-build: check failed: load returned %d\n", n);
+    return false;
+  }
+  std::printf("check: %d words loaded and entry run on a host VM\n", n);
+  return true;
+}
+
+void list_image(const std::vector<ImageWord>& words,
+                const std::vector<std::string>& imports, size_t image_size)
+{
+  std::printf("%-4s %-24s %6s %s\n", "idx", "word", "bytes", "references");
+  for (size_t i = 0; i < words.size(); i++)
+  {
+    const ImageWord& w = words[i];
+    std::string refs;
+    for (const Reloc& r : w.relocs)
+    {
+      if (!refs.empty())
+      {
+        refs += ", ";
+      }
+      refs += (r.kind == V4_IMAGE_RELOC_IMPORT) ? "import " : "";
+      refs += (r.kind == V4_IMAGE_RELOC_IMPORT) ? imports[r.target]
+              : (r.target == i)                 ? "self"
+                                                : words[r.target].name;
+    }
+    std::printf("%-4u %-24s %6u %s\n", static_cast<unsigned>(i),
+                w.name.empty() ? "(entry)" : w.name.c_str(),
+                static_cast<unsigned>(w.code.size()), refs.c_str());
+  }
+  std::printf("image: %u bytes\n", static_cast<unsigned>(image_size));
+}
+
+void usage(const char* argv0)
+{
+  std::fprintf(stderr,
+               "Usage: %s -o OUT [--import NAME]... [-O] [--list] [--check] PATH...\n"
+               "PATH is a Forth source file or a directory of them.\n",
+               argv0);
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  const char* out_path = nullptr;
+  std::vector<std::string> imports;
+  std::vector<fs::path> files;
+  bool list = false;
+  bool check = false;
+  bool optimize = false;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (std::strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+    {
+      out_path = argv[++i];
+    }
+    else if (std::strcmp(argv[i], "--import") == 0 && i + 1 < argc)
+    {
+      imports.emplace_back(argv[++i]);
+    }
+    else if (std::strcmp(argv[i], "-O") == 0)
+    {
+      optimize = true;
+    }
+    else if (std::strcmp(argv[i], "--list") == 0)
+    {
+      list = true;
+    }
+    else if (std::strcmp(argv[i], "--check") == 0)
+    {
+      check = true;
+    }
+    else if (argv[i][0] == '-')
+    {
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+    else if (!collect_files(argv[i], files))
+    {
+      return EXIT_FAILURE;
+    }
+  }
+  if (files.empty() || (out_path == nullptr && !list && !check))
+  {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  if (imports.size() > MAX_SYMBOLS)
+  {
+    std::fprintf(stderr, "v4-image-build: too many imports\n");
+    return EXIT_FAILURE;
+  }
+
+  V4PeepholeStats opt_stats = {};
+  V4PeepholeStats* opt = optimize ? &opt_stats : nullptr;
+
+  // Definitions in file order; top-level code of all files forms the entry
+  std::vector<ImageWord> words;
+  std::string top_level;
+  for (const fs::path& path : files)
+  {
+    std::string text;
+    Source source;
+    if (!read_file(path, text) || !split_source(text, path, source))
+    {
+      return EXIT_FAILURE;
+    }
+    for (const auto& def : source.definitions)
+    {
+      if (words.size() >= MAX_SYMBOLS)
+      {
+        std::fprintf(stderr, "v4-image-build: too many words\n");
+        return EXIT_FAILURE;
+      }
+      if (!front_has_room(imports.size(), words.size() + 1))
+      {
+        return EXIT_FAILURE;
+      }
+      ImageWord word;
+      word.name = def.first;
+      if (!build_word(def.second, imports, words, opt, word))
+      {
+        std::fprintf(stderr, "v4-image-build: %s: failed to compile '%s'\n", path.c_str(),
+                     def.first.c_str());
+        return EXIT_FAILURE;
+      }
+      words.push_back(std::move(word));
+    }
+    top_level += source.top_level;
+  }
+
+  bool has_entry = top_level.find_first_not_of(" \t\r\n") != std::string::npos;
+  if (has_entry)
+  {
+    ImageWord entry;
+    if (!front_has_room(imports.size(), words.size()))
+    {
+      return EXIT_FAILURE;
+    }
+    if (!build_word(top_level, imports, words, opt, entry))
+    {
+      std::fprintf(stderr, "v4-image-build: failed to compile top-level code\n");
+      return EXIT_FAILURE;
+    }
+    words.push_back(std::move(entry));
+  }
+  if (words.empty())
+  {
+    std::fprintf(stderr, "v4-image-build: no words or code found\n");
+    return EXIT_FAILURE;
+  }
+
+  std::vector<uint8_t> image;
+  std::vector<std::string> used_imports;
+  if (!write_image(words, has_entry, imports, image, used_imports))
+  {
+    return EXIT_FAILURE;
+  }
+
+  if (list)
+  {
+    list_image(words, imports, image.size());
+  }
+  if (optimize)
+  {
+    std::printf("peephole: %u/%u words rewritten (%u unsupported), %u -> %u bytes\n",
+                static_cast<unsigned>(opt_stats.optimized),
+                static_cast<unsigned>(opt_stats.words),
+                static_cast<unsigned>(opt_stats.unsupported),
+                static_cast<unsigned>(opt_stats.bytes_before),
+                static_cast<unsigned>(opt_stats.bytes_after));
+  }
+  if (check && !check_image(image, used_imports))
+  {
+    return EXIT_FAILURE;
+  }
+  if (out_path != nullptr)
+  {
+    FILE* f = std::fopen(out_path, "wb");
+    if (f == nullptr || std::fwrite(image.data(), 1, image.size(), f) != image.size() ||
+        std::fclose(f) != 0)
+    {
+      std::fprintf(stderr, "v4-image-build: cannot write %s\n", out_path);
+      return EXIT_FAILURE;
+    }
+    std::printf("%s: %u words, %u imports, %u bytes\n", out_path,
+                static_cast<unsigned>(words.size()),
+                static_cast<unsigned>(used_imports.size()),
+                static_cast<unsigned>(image.size()));
+  }
+  return EXIT_SUCCESS;
+}
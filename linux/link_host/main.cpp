@@ -0,0 +1,299 @@
+/**
+ * @file main.cpp
+ * @brief V4-link host server for Linux
+ *
+ * Runs the V4 VM behind the V4-link port on a POSIX transport, so host
+ * tools such as v4_link_send.py can talk to it exactly like a board.
+ *
+ * Usage:
+ *   v4-link-host                 # create a pty and print its path
+ *   v4-link-host --stdio         # speak V4-link on stdin/stdout
+ *   v4-link-host --unix PATH     # accept one client on a Unix socket
+ *
+ * Options:
+ *   --buffer N   Bytecode buffer size (default: 512)
+ *   --mem N      VM memory size (default: 4096)
+ *   --upload N   Bytes at the top of VM memory reserved for chunked
+ *                uploads (default: half of VM memory)
+ *   --images N   Store for images loaded with LOAD (default: 16384)
+ *   --cache N    Bytecode cache budget in bytes (default: 16384, 0 = off)
+ *   --cache-file PATH
+ *                Persist the bytecode cache in PATH
+ *   --profile    Profile executions (1 kHz sampling) for PROFILE
+ *   --virtual-clock
+ *                Run HAL delays under virtual time (no real waiting)
+ *   --vcd PATH   Record GPIO changes and write them to PATH on exit
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "hal_host.h"
+#include "v4/vm_api.h"
+#include "v4_link_cache.hpp"
+#include "v4_link_exec_worker.hpp"
+#include "v4_link_port.hpp"
+#include "v4_link_profiler.hpp"
+#include "v4_link_transport_posix.hpp"
+
+namespace
+{
+
+constexpr size_t CACHE_ENTRIES = 64;
+constexpr auto PROFILE_SAMPLE_PERIOD = std::chrono::milliseconds(1);
+constexpr size_t WAVEFORM_EVENTS = 1024 * 1024;
+
+volatile std::sig_atomic_t stop_requested = 0;
+
+void on_signal(int)
+{
+  stop_requested = 1;
+}
+
+uint64_t steady_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void usage(const char* argv0)
+{
+  std::fprintf(stderr,
+               "Usage: %s [--stdio | --unix PATH] [--buffer N] [--mem N]"
+               " [--upload N] [--images N]\n"
+               "       [--cache N] [--cache-file PATH] [--profile]\n"
+               "       [--virtual-clock] [--vcd PATH]\n"
+               "Without --stdio/--unix a pseudo terminal is created.\n",
+               argv0);
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  bool use_stdio = false;
+  std::string unix_path;
+  size_t buffer_size = 512;
+  size_t mem_size = 4096;
+  long upload_size = -1;
+  size_t image_store_size = 16384;
+  size_t cache_size = 16384;
+  std::string cache_path;
+  bool profile = false;
+  bool virtual_clock = false;
+  std::string vcd_path;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    if (std::strcmp(argv[i], "--stdio") == 0)
+    {
+      use_stdio = true;
+    }
+    else if (std::strcmp(argv[i], "--unix") == 0 && i + 1 < argc)
+    {
+      unix_path = argv[++i];
+    }
+    else if (std::strcmp(argv[i], "--buffer") == 0 && i + 1 < argc)
+    {
+      buffer_size = std::strtoul(argv[++i], nullptr, 0);
+    }
+    else if (std::strcmp(argv[i], "--mem") == 0 && i + 1 < argc)
+    {
+      mem_size = std::strtoul(argv[++i], nullptr, 0);
+    }
+    else if (std::strcmp(argv[i], "--upload") == 0 && i + 1 < argc)
+    {
+      upload_size = std::strtol(argv[++i], nullptr, 0);
+    }
+    else if (std::strcmp(argv[i], "--images") == 0 && i + 1 < argc)
+    {
+      image_store_size = std::strtoul(argv[++i], nullptr, 0);
+    }
+    else if (std::strcmp(argv[i], "--cache") == 0 && i + 1 < argc)
+    {
+      cache_size = std::strtoul(argv[++i], nullptr, 0);
+    }
+    else if (std::strcmp(argv[i], "--cache-file") == 0 && i + 1 < argc)
+    {
+      cache_path = argv[++i];
+    }
+    else if (std::strcmp(argv[i], "--profile") == 0)
+    {
+      profile = true;
+    }
+    else if (std::strcmp(argv[i], "--virtual-clock") == 0)
+    {
+      virtual_clock = true;
+    }
+    else if (std::strcmp(argv[i], "--vcd") == 0 && i + 1 < argc)
+    {
+      vcd_path = argv[++i];
+    }
+    else
+    {
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Simulated board
+  if (virtual_clock)
+  {
+    hal_host_clock_set(HAL_HOST_CLOCK_VIRTUAL);
+  }
+  if (!vcd_path.empty() && hal_host_waveform_start(WAVEFORM_EVENTS) != 0)
+  {
+    std::fprintf(stderr, "Failed to allocate waveform log\n");
+    return EXIT_FAILURE;
+  }
+
+  // Initialize V4 VM
+  std::vector<uint8_t> vm_memory(mem_size);
+  VmConfig cfg = {
+      .mem = vm_memory.data(),
+      .mem_size = static_cast<uint32_t>(vm_memory.size()),
+      .mmio = nullptr,
+      .mmio_count = 0,
+      .arena = nullptr,
+  };
+
+  Vm* vm = vm_create(&cfg);
+  if (vm == nullptr)
+  {
+    std::fprintf(stderr, "Failed to create VM\n");
+    return EXIT_FAILURE;
+  }
+
+  // Open transport
+  std::unique_ptr<v4ports::PosixTransport> transport;
+  if (use_stdio)
+  {
+    transport = v4ports::PosixTransport::open_stdio();
+    std::fprintf(stderr, "V4-link host on stdin/stdout\n");
+  }
+  else if (!unix_path.empty())
+  {
+    std::fprintf(stderr, "V4-link host waiting for client on %s\n", unix_path.c_str());
+    transport = v4ports::PosixTransport::accept_unix(unix_path);
+  }
+  else
+  {
+    std::string pty_path;
+    transport = v4ports::PosixTransport::open_pty(pty_path);
+    if (transport)
+    {
+      std::printf("%s\n", pty_path.c_str());
+      std::fflush(stdout);
+      std::fprintf(stderr, "V4-link host listening on %s\n", pty_path.c_str());
+    }
+  }
+
+  if (!transport)
+  {
+    vm_destroy(vm);
+    return EXIT_FAILURE;
+  }
+
+  std::signal(SIGINT, on_signal);
+  std::signal(SIGTERM, on_signal);
+
+  {
+    v4ports::PosixTransport* peer = transport.get();
+    v4ports::LinkPort link(vm, std::move(transport), buffer_size);
+    link.set_latency_clock(steady_ns, 1000);
+
+    size_t upload = (upload_size < 0) ? mem_size / 2 : static_cast<size_t>(upload_size);
+    if (upload > mem_size)
+    {
+      upload = mem_size;
+    }
+    link.set_upload_region(vm_memory.data() + (mem_size - upload), upload);
+
+    // Resident code and names of loaded images
+    std::vector<uint8_t> image_store(image_store_size);
+    if (image_store_size > 0)
+    {
+      link.set_image_store(image_store.data(), image_store.size());
+    }
+
+    v4ports::BytecodeCache cache(cache_size, CACHE_ENTRIES);
+    std::unique_ptr<v4ports::FileCacheStore> cache_store;
+    if (!cache_path.empty())
+    {
+      cache_store = std::make_unique<v4ports::FileCacheStore>(cache_path.c_str());
+      cache.attach_store(cache_store.get());
+      std::fprintf(stderr, "Bytecode cache: %u programs loaded from %s\n",
+                   (unsigned)cache.stats().entries, cache_path.c_str());
+    }
+    if (cache_size > 0)
+    {
+      link.set_cache(&cache);
+    }
+
+    // Steady clock in ns, reported as 1000 ticks per microsecond
+    v4ports::Profiler profiler(steady_ns, 1000);
+    std::atomic<bool> sampling{profile};
+    std::thread sampler;
+    if (profile)
+    {
+      link.set_profiler(&profiler);
+      sampler = std::thread(
+          [&]
+          {
+            while (sampling.load())
+            {
+              std::this_thread::sleep_for(PROFILE_SAMPLE_PERIOD);
+              profiler.sample();
+            }
+          });
+    }
+
+    // EXEC_ASYNC runs programs here; aborting ends a HAL delay at once
+    v4ports::ExecWorker worker(buffer_size);
+    worker.set_abort_hook(hal_host_abort_delay);
+    link.set_exec_worker(&worker);
+
+    while (!stop_requested && !peer->closed())
+    {
+      link.poll(100);
+    }
+
+    // Persist what was cached since the last idle poll
+    if (!worker.busy())
+    {
+      cache.flush();
+    }
+    link.set_exec_worker(nullptr);
+
+    sampling.store(false);
+    if (sampler.joinable())
+    {
+      sampler.join();
+    }
+  }
+
+  vm_destroy(vm);
+
+  if (!vcd_path.empty())
+  {
+    if (hal_host_waveform_write_vcd(vcd_path.c_str()) != 0)
+    {
+      std::fprintf(stderr, "Failed to write %s\n", vcd_path.c_str());
+      return EXIT_FAILURE;
+    }
+    std::fprintf(stderr, "GPIO waveform written to %s\n", vcd_path.c_str());
+  }
+  return EXIT_SUCCESS;
+}
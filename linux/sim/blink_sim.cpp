@@ -0,0 +1,131 @@
+/**
+ * @file blink_sim.cpp
+ * @brief v4-blink example on the simulated host HAL
+ *
+ * Runs the unmodified v4-blink app_main() for a given span of (by default
+ * virtual) time, records GPIO7, and checks that it toggled every
+ * BLINK_INTERVAL_MS. Under the virtual clock the run takes no wall-clock
+ * time and the waveform is exact, so the check is strict.
+ *
+ * Usage: blink_sim [--ms N] [--real] [--vcd FILE]
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "hal_host.h"
+
+extern "C" void app_main(void);
+
+namespace
+{
+
+constexpr int LED_PIN = 7;
+constexpr uint64_t BLINK_INTERVAL_US = 500 * 1000;
+constexpr uint64_t REAL_TOLERANCE_US = 20 * 1000;
+
+const char* vcd_path = nullptr;
+uint64_t run_us = 0;
+std::chrono::steady_clock::time_point started;
+
+// Limit hook: app_main() never returns, so the run ends here
+void finish()
+{
+  double wall_ms = std::chrono::duration<double, std::milli>(
+                       std::chrono::steady_clock::now() - started)
+                       .count();
+  bool is_virtual = hal_host_clock_get() == HAL_HOST_CLOCK_VIRTUAL;
+
+  std::vector<hal_host_wave_event_t> events(hal_host_waveform_count());
+  hal_host_waveform_read(0, events.data(), events.size());
+
+  // Every level change of the LED after the initial one is one interval
+  uint64_t last = 0;
+  size_t edges = 0;
+  size_t bad = 0;
+  for (const hal_host_wave_event_t& e : events)
+  {
+    if (e.pin != LED_PIN)
+    {
+      continue;
+    }
+    if (edges > 0)
+    {
+      uint64_t interval = e.time_us - last;
+      uint64_t error = (interval > BLINK_INTERVAL_US) ? interval - BLINK_INTERVAL_US
+                                                      : BLINK_INTERVAL_US - interval;
+      if (error > (is_virtual ? 0 : REAL_TOLERANCE_US))
+      {
+        bad++;
+      }
+    }
+    last = e.time_us;
+    edges++;
+  }
+
+  size_t expected = static_cast<size_t>(run_us / BLINK_INTERVAL_US);
+  bool ok = bad == 0 && edges + 1 >= expected;
+  std::fprintf(stderr,
+               "blink_sim: %s clock, %llu ms simulated in %.1f ms, %u edges on GPIO%d, "
+               "%u off-period: %s\n",
+               is_virtual ? "virtual" : "real",
+               static_cast<unsigned long long>(hal_micros() / 1000), wall_ms,
+               static_cast<unsigned>(edges), LED_PIN, static_cast<unsigned>(bad),
+               ok ? "ok" : "FAIL");
+
+  if (vcd_path != nullptr && hal_host_waveform_write_vcd(vcd_path) != 0)
+  {
+    std::fprintf(stderr, "blink_sim: cannot write %s\n", vcd_path);
+    ok = false;
+  }
+  std::fflush(stdout);
+  std::exit(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  uint64_t run_ms = 10000;
+  hal_host_clock_t clock = HAL_HOST_CLOCK_VIRTUAL;
+  for (int i = 1; i < argc; i++)
+  {
+    if (std::strcmp(argv[i], "--ms") == 0 && i + 1 < argc)
+    {
+      run_ms = std::strtoull(argv[++i], nullptr, 10);
+    }
+    else if (std::strcmp(argv[i], "--real") == 0)
+    {
+      clock = HAL_HOST_CLOCK_REAL;
+    }
+    else if (std::strcmp(argv[i], "--vcd") == 0 && i + 1 < argc)
+    {
+      vcd_path = argv[++i];
+    }
+    else
+    {
+      std::fprintf(stderr, "Usage: %s [--ms N] [--real] [--vcd FILE]\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  run_us = run_ms * 1000;
+  hal_host_clock_set(clock);
+  if (hal_host_waveform_start(static_cast<size_t>(run_us / BLINK_INTERVAL_US) + 16) != 0)
+  {
+    std::fprintf(stderr, "blink_sim: cannot allocate waveform log\n");
+    return EXIT_FAILURE;
+  }
+  hal_host_clock_limit(run_us, finish);
+
+  started = std::chrono::steady_clock::now();
+  app_main();
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,297 @@
+/**
+ * @file repl_sim.cpp
+ * @brief Forth REPL on the simulated host HAL
+ *
+ * Host counterpart of v4-repl-demo: input is read through the console
+ * bridge in blocks and joined into units (definitions may span lines),
+ * compiled with V4-front and run in the REPL scratch word, with
+ * the `led!` native word on GPIO7. Delays run under the virtual clock by
+ * default, so scripted sessions piped into stdin finish at once and
+ * produce the same output and waveform on every run.
+ *
+ * Usage: repl_sim [--real] [--vcd FILE]
+ *
+ * @copyright Copyright 2025 Akihito Kirisaki
+ * @license Dual-licensed under MIT or Apache-2.0
+ */
+
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "hal_host.h"
+#include "v4/vm_api.h"
+#include "v4_repl_compiler.h"
+#include "v4_repl_dict.h"
+#include "v4_repl_input.h"
+#include "v4_repl_native.h"
+#include "v4_repl_scratch.h"
+#include "v4front/compile.h"
+
+namespace
+{
+
+constexpr int LED_PIN = 7;
+constexpr size_t VM_MEM_SIZE = 16 * 1024;
+constexpr size_t SCRATCH_SIZE = 1024;
+constexpr size_t DICT_SLOTS = 4096;
+constexpr size_t DICT_NAMES_SIZE = 32 * 1024;
+constexpr size_t COMPILER_STACK_SIZE = 32 * 1024;
+constexpr size_t COMPILER_ARENA_SIZE = 64 * 1024;
+constexpr size_t WAVEFORM_EVENTS = 64 * 1024;
+constexpr size_t INPUT_UNIT_SIZE = 16 * 1024;
+constexpr size_t INPUT_CHUNK = 4096;
+constexpr uint32_t CONSOLE_POLL_MS = 100;
+
+uint8_t vm_memory[VM_MEM_SIZE];
+uint8_t scratch_buf[SCRATCH_SIZE];
+V4NativeTable natives;
+V4DictSlot dict_slots[DICT_SLOTS];
+char dict_names[DICT_NAMES_SIZE];
+V4Dict dict;
+alignas(16) uint8_t compiler_arena[COMPILER_ARENA_SIZE];
+V4Compiler* compiler;
+char input_buf[INPUT_UNIT_SIZE];
+V4Input input;
+
+v4_err led_set(struct Vm* vm)
+{
+  v4_i32 value;
+  int err = vm_ds_pop(vm, &value);
+  if (err != 0)
+  {
+    return err;
+  }
+  hal_gpio_write(LED_PIN, (value != 0) ? HAL_GPIO_HIGH : HAL_GPIO_LOW);
+  return 0;
+}
+
+void print(const char* text)
+{
+  hal_host_console_write(text, std::strlen(text));
+}
+
+void process_line(Vm* vm, V4Scratch* scratch, const char* line)
+{
+  if (line[0] == '\0')
+  {
+    return;
+  }
+
+  // Compile on the compiler's arena stack, against a fresh context that
+  // knows just the words the line uses
+  V4FrontBuf buf;
+  V4FrontError error = {};
+  int status = v4_compiler_compile(compiler, &dict, line, &buf, &error);
+  if (status == V4_COMPILER_ERR_COMPILE)
+  {
+    char msg[512];
+    v4front_format_error(&error, line, msg, sizeof(msg));
+    print(msg);
+    return;
+  }
+  if (status == V4_COMPILER_ERR_CONTEXT)
+  {
+    print("ERROR: Line refers to too many words, split it\n");
+    return;
+  }
+  if (status != 0)
+  {
+    print("ERROR: Compiled code does not fit in the compiler arena\n");
+    return;
+  }
+
+  char out[128];
+  for (int i = 0; i < buf.word_count; i++)
+  {
+    V4FrontWord* word = &buf.words[i];
+    // Compiled code lives in the compiler arena, but the VM runs it in place
+    uint8_t* code = static_cast<uint8_t*>(std::malloc(word->code_len));
+    if (code != nullptr)
+    {
+      std::memcpy(code, word->code, word->code_len);
+    }
+    int wid = (code != nullptr)
+                  ? vm_register_word(vm, word->name, code, static_cast<int>(word->code_len))
+                  : -1;
+    if (wid < 0 || v4_dict_define(&dict, word->name, wid) != 0)
+    {
+      std::snprintf(out, sizeof(out), "ERROR: Failed to register word '%s' (code %d)\n",
+                    word->name, wid);
+      print(out);
+      return;
+    }
+  }
+
+  if (buf.data != nullptr && buf.size > 0)
+  {
+    v4_err err = v4_scratch_exec(scratch, buf.data, buf.size);
+    if (err == V4_SCRATCH_ERR_TOO_LARGE)
+    {
+      std::snprintf(out, sizeof(out), "ERROR: Line too long (%u bytes of code)\n",
+                    static_cast<unsigned>(buf.size));
+    }
+    else if (err != 0)
+    {
+      std::snprintf(out, sizeof(out), "ERROR: VM execution failed (code %d)\n", err);
+    }
+    else if (vm_ds_depth_public(vm) > 0)
+    {
+      v4_i32 top;
+      vm_ds_pop(vm, &top);
+      std::snprintf(out, sizeof(out), " => %ld (0x%08lX)\n", static_cast<long>(top),
+                    static_cast<unsigned long>(static_cast<uint32_t>(top)));
+    }
+    else
+    {
+      std::snprintf(out, sizeof(out), "ok\n");
+    }
+    print(out);
+  }
+  else
+  {
+    print("ok\n");
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  hal_host_clock_t clock = HAL_HOST_CLOCK_VIRTUAL;
+  const char* vcd_path = nullptr;
+  for (int i = 1; i < argc; i++)
+  {
+    if (std::strcmp(argv[i], "--real") == 0)
+    {
+      clock = HAL_HOST_CLOCK_REAL;
+    }
+    else if (std::strcmp(argv[i], "--vcd") == 0 && i + 1 < argc)
+    {
+      vcd_path = argv[++i];
+    }
+    else
+    {
+      std::fprintf(stderr, "Usage: %s [--real] [--vcd FILE]\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  hal_host_clock_set(clock);
+  hal_gpio_mode(LED_PIN, HAL_GPIO_OUTPUT);
+  hal_gpio_write(LED_PIN, HAL_GPIO_LOW);
+  if (vcd_path != nullptr && hal_host_waveform_start(WAVEFORM_EVENTS) != 0)
+  {
+    std::fprintf(stderr, "repl_sim: cannot allocate waveform log\n");
+    return EXIT_FAILURE;
+  }
+
+  v4_native_init(&natives);
+  VmConfig config = {
+      .mem = vm_memory,
+      .mem_size = static_cast<uint32_t>(sizeof(vm_memory)),
+      .mmio = v4_native_mmio(&natives),
+      .mmio_count = 1,
+      .arena = nullptr,
+  };
+  Vm* vm = vm_create(&config);
+  if (vm == nullptr)
+  {
+    std::fprintf(stderr, "repl_sim: cannot create VM\n");
+    return EXIT_FAILURE;
+  }
+  v4_dict_init(&dict, dict_slots, DICT_SLOTS, dict_names, sizeof(dict_names));
+  compiler =
+      v4_compiler_create(compiler_arena, sizeof(compiler_arena), COMPILER_STACK_SIZE);
+  if (compiler == nullptr)
+  {
+    std::fprintf(stderr, "repl_sim: cannot create compiler\n");
+    return EXIT_FAILURE;
+  }
+
+  V4Scratch scratch;
+  int led_wid = v4_native_register(&natives, vm, "led!", led_set);
+  if (led_wid < 0 || v4_dict_define(&dict, "led!", led_wid) != 0 ||
+      v4_scratch_init(&scratch, vm, scratch_buf, sizeof(scratch_buf)) < 0)
+  {
+    std::fprintf(stderr, "repl_sim: cannot register words\n");
+    return EXIT_FAILURE;
+  }
+
+  // The terminal echoes by itself, so the assembler only joins lines into
+  // units; a prompt is shown once input goes idle
+  v4_input_init(&input, input_buf, sizeof(input_buf), nullptr, 0);
+  bool interactive = isatty(STDIN_FILENO) != 0;
+  bool prompt = true;
+  char chunk[INPUT_CHUNK];
+  bool eof = false;
+  while (!eof)
+  {
+    int n =
+        hal_host_console_read(chunk, sizeof(chunk), interactive ? 0 : CONSOLE_POLL_MS);
+    if (n == -1 && interactive)
+    {
+      if (prompt)
+      {
+        print(v4_input_open(&input) ? "... " : "v4> ");
+        prompt = false;
+      }
+      n = hal_host_console_read(chunk, sizeof(chunk), CONSOLE_POLL_MS);
+    }
+    if (n == -1)
+    {
+      continue;
+    }
+    if (n == -2)
+    {
+      // End a last line that has no line end
+      eof = true;
+      chunk[0] = '\n';
+      n = 1;
+    }
+
+    size_t pos = 0;
+    while (pos < static_cast<size_t>(n))
+    {
+      size_t used;
+      int status = v4_input_feed(&input, chunk + pos, n - pos, &used);
+      pos += used;
+      if (status == V4_INPUT_UNIT)
+      {
+        process_line(vm, &scratch, input.buf);
+      }
+      else if (status == V4_INPUT_ERR_OVERFLOW)
+      {
+        print("ERROR: Input unit too large, dropped\n");
+      }
+      prompt = true;
+    }
+  }
+  if (v4_input_open(&input))
+  {
+    print("ERROR: Input ended inside a definition\n");
+  }
+
+  std::fprintf(stderr, "repl_sim: %s clock at %llu us\n",
+               (clock == HAL_HOST_CLOCK_VIRTUAL) ? "virtual" : "real",
+               static_cast<unsigned long long>(hal_micros()));
+  const V4CompilerStats* st = v4_compiler_stats(compiler);
+  std::fprintf(stderr, "repl_sim: compiler stack peak %u of %u bytes, output peak %u\n",
+               static_cast<unsigned>(st->stack_peak),
+               static_cast<unsigned>(st->stack_size),
+               static_cast<unsigned>(st->output_peak));
+  int status = EXIT_SUCCESS;
+  if (vcd_path != nullptr && hal_host_waveform_write_vcd(vcd_path) != 0)
+  {
+    std::fprintf(stderr, "repl_sim: cannot write %s\n", vcd_path);
+    status = EXIT_FAILURE;
+  }
+
+  v4_compiler_destroy(compiler);
+  vm_destroy(vm);
+  return status;
+}